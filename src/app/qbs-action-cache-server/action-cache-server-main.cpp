@@ -0,0 +1,110 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "actioncacheserver.h"
+
+#include <logging/translator.h>
+
+#include <QtCore/qcommandlineoption.h>
+#include <QtCore/qcommandlineparser.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qdir.h>
+#include <QtNetwork/qhostaddress.h>
+
+#include <iostream>
+
+int main(int argc, char *argv[])
+{
+    using qbs::Internal::Tr;
+
+    QCoreApplication app(argc, argv);
+    const QCommandLineOption directoryOpt(QStringLiteral("directory"),
+            Tr::tr("The directory in which the cache entries are stored. "
+                   "The default is the current directory."), QStringLiteral("directory"));
+    const QCommandLineOption addressOpt(QStringLiteral("address"),
+            Tr::tr("The address to listen on. The default is 127.0.0.1."),
+            QStringLiteral("address"), QStringLiteral("127.0.0.1"));
+    const QCommandLineOption portOpt(QStringLiteral("port"),
+            Tr::tr("The TCP port to listen on. The default is 0, which means that "
+                   "a free port is chosen."), QStringLiteral("port"), QStringLiteral("0"));
+    const QCommandLineOption socketOpt(QStringLiteral("socket"),
+            Tr::tr("Listen on the Unix domain socket at the given path instead of a TCP port."),
+            QStringLiteral("path"));
+    const QCommandLineOption chunkedOpt(QStringLiteral("chunked"),
+            Tr::tr("Send entries in chunked transfer encoding, as many proxies do."));
+    QCommandLineParser parser;
+    parser.setApplicationDescription(Tr::tr("This tool serves a remote action cache for "
+                                            "the --remote-action-cache option of qbs build.\n"
+                                            "It is meant for testing and has no access "
+                                            "control."));
+    parser.addOption(directoryOpt);
+    parser.addOption(addressOpt);
+    parser.addOption(portOpt);
+    parser.addOption(socketOpt);
+    parser.addOption(chunkedOpt);
+    parser.addHelpOption();
+    parser.process(app);
+
+    const QString storageDir = QDir::current().absoluteFilePath(
+                parser.isSet(directoryOpt) ? parser.value(directoryOpt) : QStringLiteral("."));
+    ActionCacheServer server(QDir::cleanPath(storageDir));
+    server.setChunkedResponses(parser.isSet(chunkedOpt));
+    bool success;
+    if (parser.isSet(socketOpt)) {
+        success = server.listenOnSocket(parser.value(socketOpt));
+    } else {
+        bool portOk;
+        const uint port = parser.value(portOpt).toUInt(&portOk);
+        const QHostAddress address(parser.value(addressOpt));
+        if (!portOk || port > 65535 || address.isNull()) {
+            std::cerr << qPrintable(Tr::tr("Invalid address or port.")) << std::endl;
+            return 1;
+        }
+        success = server.listenOnPort(address, quint16(port));
+    }
+    if (!success) {
+        std::cerr << qPrintable(Tr::tr("Cannot start server: %1").arg(server.errorString()))
+                  << std::endl;
+        return 1;
+    }
+
+    // Scripts starting the server need to know where to find it.
+    std::cout << qPrintable(server.url()) << std::endl;
+    return app.exec();
+}
@@ -0,0 +1,188 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "actioncacheserver.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qregularexpression.h>
+#include <QtCore/qsavefile.h>
+#include <QtNetwork/qlocalserver.h>
+#include <QtNetwork/qlocalsocket.h>
+#include <QtNetwork/qtcpserver.h>
+#include <QtNetwork/qtcpsocket.h>
+
+#include <memory>
+
+static QByteArray httpResponse(int statusCode, const QByteArray &reason,
+                               const QByteArray &body = QByteArray(), bool chunked = false)
+{
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(statusCode) + ' ' + reason + "\r\n";
+    if (!chunked) {
+        return response + "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                + "Connection: close\r\n\r\n"
+                + body;
+    }
+    response += "Transfer-Encoding: chunked\r\nConnection: close\r\n\r\n";
+    static const int chunkSize = 4096;
+    for (int pos = 0; pos < body.size(); pos += chunkSize) {
+        const QByteArray chunk = body.mid(pos, chunkSize);
+        response += QByteArray::number(chunk.size(), 16) + "\r\n" + chunk + "\r\n";
+    }
+    return response + "0\r\n\r\n";
+}
+
+ActionCacheServer::ActionCacheServer(QString storageDir, QObject *parent)
+    : QObject(parent), m_storageDir(std::move(storageDir))
+{
+}
+
+bool ActionCacheServer::listenOnPort(const QHostAddress &address, quint16 port)
+{
+    m_tcpServer = new QTcpServer(this);
+    connect(m_tcpServer, &QTcpServer::newConnection, this, [this] {
+        while (QTcpSocket * const socket = m_tcpServer->nextPendingConnection())
+            handleConnection(socket);
+    });
+    if (!m_tcpServer->listen(address, port)) {
+        m_errorString = m_tcpServer->errorString();
+        return false;
+    }
+    return true;
+}
+
+bool ActionCacheServer::listenOnSocket(const QString &socketPath)
+{
+    m_localServer = new QLocalServer(this);
+    connect(m_localServer, &QLocalServer::newConnection, this, [this] {
+        while (QLocalSocket * const socket = m_localServer->nextPendingConnection())
+            handleConnection(socket);
+    });
+    QLocalServer::removeServer(socketPath);
+    if (!m_localServer->listen(socketPath)) {
+        m_errorString = m_localServer->errorString();
+        return false;
+    }
+    return true;
+}
+
+QString ActionCacheServer::url() const
+{
+    if (m_localServer)
+        return QLatin1String("unix:") + m_localServer->fullServerName();
+    if (m_tcpServer) {
+        return QStringLiteral("http://%1:%2").arg(m_tcpServer->serverAddress().toString())
+                .arg(m_tcpServer->serverPort());
+    }
+    return {};
+}
+
+void ActionCacheServer::handleConnection(QIODevice *socket)
+{
+    const auto buffer = std::make_shared<QByteArray>();
+    const auto closeConnection = [socket] {
+        if (const auto tcpSocket = qobject_cast<QTcpSocket *>(socket))
+            tcpSocket->disconnectFromHost();
+        else
+            static_cast<QLocalSocket *>(socket)->disconnectFromServer();
+    };
+    connect(socket, &QIODevice::readyRead, socket, [this, socket, buffer, closeConnection] {
+        *buffer += socket->readAll();
+        const auto headerEnd = buffer->indexOf("\r\n\r\n");
+        if (headerEnd == -1)
+            return;
+        const QList<QByteArray> headerLines = buffer->left(headerEnd).split('\n');
+        const QList<QByteArray> requestLine = headerLines.first().trimmed().split(' ');
+        qint64 contentLength = 0;
+        for (int i = 1; i < headerLines.size(); ++i) {
+            const QByteArray line = headerLines.at(i).trimmed();
+            const auto colonPos = line.indexOf(':');
+            if (colonPos != -1 && line.left(colonPos).trimmed().toLower() == "content-length")
+                contentLength = line.mid(colonPos + 1).trimmed().toLongLong();
+        }
+        const QByteArray body = buffer->mid(headerEnd + 4);
+        if (body.size() < contentLength)
+            return;
+        disconnect(socket, &QIODevice::readyRead, nullptr, nullptr);
+        socket->write(requestLine.size() == 3
+                      ? handleRequest(requestLine.at(0), requestLine.at(1),
+                                      body.left(contentLength))
+                      : httpResponse(400, "Bad Request"));
+        closeConnection();
+    });
+    if (const auto tcpSocket = qobject_cast<QTcpSocket *>(socket)) {
+        connect(tcpSocket, &QTcpSocket::disconnected, tcpSocket, &QObject::deleteLater);
+    } else {
+        const auto localSocket = static_cast<QLocalSocket *>(socket);
+        connect(localSocket, &QLocalSocket::disconnected, localSocket, &QObject::deleteLater);
+    }
+}
+
+QByteArray ActionCacheServer::handleRequest(const QByteArray &method, const QByteArray &path,
+                                            const QByteArray &body)
+{
+    // Clients may put a prefix in front of the key. Only the last path component matters.
+    const QByteArray key = path.mid(path.lastIndexOf('/') + 1);
+    static const QRegularExpression keyPattern(QStringLiteral("^[0-9A-Za-z_-]{1,128}$"));
+    if (!keyPattern.match(QString::fromLatin1(key)).hasMatch())
+        return httpResponse(400, "Bad Request");
+
+    if (method == "GET") {
+        QFile file(entryFilePath(key));
+        if (!file.open(QIODevice::ReadOnly))
+            return httpResponse(404, "Not Found");
+        return httpResponse(200, "OK", file.readAll(), m_chunkedResponses);
+    }
+    if (method == "PUT") {
+        if (!QDir::root().mkpath(m_storageDir))
+            return httpResponse(500, "Internal Server Error");
+        QSaveFile file(entryFilePath(key));
+        if (!file.open(QIODevice::WriteOnly) || file.write(body) != body.size()
+                || !file.commit()) {
+            return httpResponse(500, "Internal Server Error");
+        }
+        return httpResponse(201, "Created");
+    }
+    return httpResponse(405, "Method Not Allowed");
+}
+
+QString ActionCacheServer::entryFilePath(const QByteArray &key) const
+{
+    return m_storageDir + QLatin1Char('/') + QString::fromLatin1(key);
+}
@@ -0,0 +1,82 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_ACTIONCACHESERVER_H
+#define QBS_ACTIONCACHESERVER_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+
+QT_BEGIN_NAMESPACE
+class QHostAddress;
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+QT_END_NAMESPACE
+
+// Serves the files in a directory via "GET /<key>" and stores new ones via "PUT /<key>",
+// which is the protocol that qbs uses to talk to a remote action cache.
+// Only meant for testing and small setups: There is no authentication and no eviction.
+class ActionCacheServer : public QObject
+{
+public:
+    explicit ActionCacheServer(QString storageDir, QObject *parent = nullptr);
+
+    bool listenOnPort(const QHostAddress &address, quint16 port);
+    bool listenOnSocket(const QString &socketPath);
+    void setChunkedResponses(bool chunked) { m_chunkedResponses = chunked; }
+
+    QString url() const;
+    QString errorString() const { return m_errorString; }
+
+private:
+    void handleConnection(QIODevice *socket);
+    QByteArray handleRequest(const QByteArray &method, const QByteArray &path,
+                             const QByteArray &body);
+    QString entryFilePath(const QByteArray &key) const;
+
+    const QString m_storageDir;
+    QTcpServer *m_tcpServer = nullptr;
+    QLocalServer *m_localServer = nullptr;
+    QString m_errorString;
+    bool m_chunkedResponses = false;
+};
+
+#endif // QBS_ACTIONCACHESERVER_H
@@ -42,7 +42,9 @@
 #include "application.h"
 #include "consoleprogressobserver.h"
 #include "parser/commandlineoption.h"
+#include "resolveserverclient.h"
 #include "session.h"
+#include "sourcewatcher.h"
 #include "status.h"
 
 #include <api/runenvironment.h>
@@ -62,6 +64,7 @@
 #include <algorithm>
 #include <cstdio>
 #include <cstdlib>
+#include <functional>
 
 namespace qbs {
 using namespace Internal;
@@ -97,8 +100,13 @@ void CommandLineFrontend::checkCancelStatus()
     case CancelStatusRequested:
         m_cancelStatus = CancelStatusCanceling;
         m_cancelTimer->stop();
-        if (m_resolveJobs.empty() && m_buildJobs.empty())
+        if (m_resolveJobs.empty() && m_buildJobs.empty()) {
+            if (m_watchStarted) { // Quitting is the normal way to end watch mode.
+                qApp->exit(EXIT_SUCCESS);
+                return;
+            }
             std::exit(EXIT_FAILURE);
+        }
         for (AbstractJob * const job : std::as_const(m_resolveJobs))
             job->cancel();
         for (AbstractJob * const job : std::as_const(m_buildJobs))
@@ -134,7 +142,11 @@ void CommandLineFrontend::start()
             }
             break;
         case SessionCommandType: {
-            startSession();
+            const QString resolveServerName = m_parser.resolveServerName();
+            if (resolveServerName.isEmpty())
+                startSession();
+            else
+                startResolveServer(resolveServerName);
             return;
         }
         default:
@@ -155,12 +167,36 @@ void CommandLineFrontend::start()
         params.setForceProbeExecution(m_parser.forceProbesExecution());
         params.setWaitLockBuildGraph(m_parser.waitLockBuildGraph());
         params.setLogElapsedTime(m_parser.logTime());
+        params.setTraceFilePath(m_parser.traceFilePath());
         params.setSettingsDirectory(m_settings->baseDirectory());
         params.setOverrideBuildGraphData(m_parser.command() == ResolveCommandType);
         params.setPropertyCheckingMode(ErrorHandlingMode::Strict);
         params.setDeprecationWarningMode(m_parser.deprecationWarningMode());
         if (!m_parser.buildBeforeInstalling() || !m_parser.commandCanResolve())
             params.setRestoreBehavior(SetupProjectParameters::RestoreOnly);
+        const QString serverName = params.restoreBehavior() != SetupProjectParameters::RestoreOnly
+                && !params.dryRun() && !watchMode() ? resolveServerName() : QString();
+
+        // The server briefly takes the lock when it reloads a build graph that we have changed.
+        if (!serverName.isEmpty())
+            params.setWaitLockBuildGraph(true);
+
+        // Commands working on a few products do not need the build data of the other ones.
+        switch (m_parser.command()) {
+        case ListProductsCommandType:
+            params.setRestoreBuildDataOnDemand(true);
+            break;
+        case BuildCommandType:
+        case CleanCommandType:
+        case InstallCommandType:
+        case RunCommandType:
+        case UpdateTimestampsCommandType:
+        case DumpNodesTreeCommandType:
+            params.setRestoreBuildDataOnDemand(!m_parser.products().empty());
+            break;
+        default:
+            break;
+        }
         const auto buildConfigs = m_parser.buildConfigurations();
         for (const QVariantMap &buildConfig : buildConfigs) {
             QVariantMap userConfig = buildConfig;
@@ -186,10 +222,39 @@ void CommandLineFrontend::start()
             params.setBuildRoot(buildDirectory(profileName));
             params.setOverriddenValues(userConfig);
             params.setMaxJobCount(m_parser.jobCount(profileName));
+            if (canSkipBuild(params)) {
+                qbsDebug() << "Build state fingerprint matches, not setting up project.";
+                qbsInfo() << Tr::tr("Build done for configuration %1.").arg(configurationName);
+                continue;
+            }
+            if (!serverName.isEmpty()) {
+                const RemoteResolveResult result = resolveOnServer(serverName, params,
+                        [this] { return m_cancelStatus != CancelStatusNone; });
+                if (result == RemoteResolveResult::Failed) {
+                    throw ErrorInfo(Tr::tr("Resolving configuration %1 on the resolve server "
+                                           "failed.").arg(configurationName));
+                }
+                // The build graph is up to date now, so only commands that work on the
+                // project need to load it.
+                if (result == RemoteResolveResult::Resolved
+                        && m_parser.command() == ResolveCommandType) {
+                    continue;
+                }
+            }
             SetupProjectJob * const job = Project().setupProject(params,
                     ConsoleLogger::instance().logSink(), this);
             connectJob(job);
             m_resolveJobs.push_back(job);
+            if (watchMode()) {
+                m_configurationIndexes.insert(job, int(m_setupParameters.size()));
+                m_setupParameters.push_back(params);
+            }
+        }
+        m_configuredProjects.resize(m_setupParameters.size());
+        m_buildSystemFiles.resize(m_setupParameters.size());
+        if (m_resolveJobs.empty()) {
+            qApp->exit(EXIT_SUCCESS);
+            return;
         }
 
         /*
@@ -234,6 +299,17 @@ void CommandLineFrontend::handleJobFinished(bool success, AbstractJob *job)
             qbsError() << job->error().toString();
             m_resolveJobs.removeOne(job);
             m_buildJobs.removeOne(job);
+            const bool isSetupJob = qobject_cast<SetupProjectJob *>(job);
+            if (m_cancelStatus == CancelStatusNone && watchMode()
+                    && (m_watchStarted || !isSetupJob)) {
+                // In watch mode, errors get fixed by the next change.
+                if (isSetupJob)
+                    m_configurationsToResolve.insert(m_configurationIndexes.take(job));
+                m_watchRoundFailed = true;
+                if (m_resolveJobs.empty() && m_buildJobs.empty())
+                    waitForChanges();
+                return;
+            }
             if (m_resolveJobs.empty() && m_buildJobs.empty()) {
                 qApp->exit(EXIT_FAILURE);
                 return;
@@ -242,10 +318,20 @@ void CommandLineFrontend::handleJobFinished(bool success, AbstractJob *job)
         } else if (const auto setupJob = qobject_cast<SetupProjectJob * const>(job)) {
             m_resolveJobs.removeOne(job);
             m_projects.push_back(setupJob->project());
+            if (watchMode()) {
+                const int index = m_configurationIndexes.take(job);
+                m_configuredProjects.at(index) = setupJob->project();
+                m_buildSystemFiles.at(index) = setupJob->project().buildSystemFiles();
+                m_configurationsToResolve.remove(index);
+            }
             if (m_observer && resolvingMultipleProjects())
                 m_observer->incrementProgressValue();
-            if (m_resolveJobs.empty())
-                handleProjectsResolved();
+            if (m_resolveJobs.empty()) {
+                if (m_watchRoundFailed)
+                    waitForChanges();
+                else
+                    handleProjectsResolved();
+            }
         } else if (qobject_cast<InstallJob *>(job)) {
             if (m_parser.command() == RunCommandType)
                 qApp->exit(runTarget());
@@ -254,6 +340,8 @@ void CommandLineFrontend::handleJobFinished(bool success, AbstractJob *job)
         } else { // Build or clean.
             m_buildJobs.removeOne(job);
             if (m_buildJobs.empty()) {
+                if (m_parser.showCommandStats())
+                    printCommandStats();
                 switch (m_parser.command()) {
                 case RunCommandType:
                 case InstallCommandType:
@@ -263,6 +351,11 @@ void CommandLineFrontend::handleJobFinished(bool success, AbstractJob *job)
                     generate();
                     // fall through
                 case BuildCommandType:
+                    if (watchMode()) {
+                        waitForChanges();
+                        break;
+                    }
+                    Q_FALLTHROUGH();
                 case CleanCommandType:
                     qApp->exit(m_cancelStatus == CancelStatusNone ? EXIT_SUCCESS : EXIT_FAILURE);
                     break;
@@ -319,6 +412,9 @@ void CommandLineFrontend::handleTaskProgress(int value, AbstractJob *job)
 
 void CommandLineFrontend::handleProcessResultReport(const qbs::ProcessResult &result)
 {
+    if (m_parser.showCommandStats())
+        m_processResults.push_back(result);
+
     bool hasOutput = !result.stdOut().empty() || !result.stdErr().empty();
     if (!hasOutput && result.success())
         return;
@@ -331,6 +427,54 @@ void CommandLineFrontend::handleProcessResultReport(const qbs::ProcessResult &re
         w << result.stdErr().join(QLatin1Char('\n')) << MessageTag(QStringLiteral("stdErr"));
 }
 
+void CommandLineFrontend::printCommandStats()
+{
+    const int maxCommandCount = 10;
+    const int maxCommandLineLength = 120;
+    const auto printTopCommands = [this](const QString &title,
+            const std::function<qint64(const ProcessResult &)> &getValue,
+            const std::function<QString(qint64)> &formatValue) {
+        std::vector<std::pair<qint64, const ProcessResult *>> values;
+        for (const ProcessResult &result : m_processResults) {
+            const qint64 value = getValue(result);
+            if (value >= 0)
+                values.emplace_back(value, &result);
+        }
+        if (values.empty())
+            return;
+        const auto end = values.begin() + std::min<int>(maxCommandCount, int(values.size()));
+        std::partial_sort(values.begin(), end, values.end(),
+                          [](const auto &v1, const auto &v2) { return v1.first > v2.first; });
+        qbsInfo() << title;
+        for (auto it = values.begin(); it != end; ++it) {
+            const ProcessResult &result = *it->second;
+            QString commandLine = shellQuote(
+                        QDir::toNativeSeparators(result.executableFilePath()), result.arguments());
+            if (commandLine.size() > maxCommandLineLength)
+                commandLine = commandLine.left(maxCommandLineLength - 3) + QLatin1String("...");
+            qbsInfo() << QStringLiteral("  %1  %2").arg(formatValue(it->first), 10)
+                         .arg(commandLine);
+        }
+    };
+    const auto formatTime = [](qint64 ms) {
+        return Tr::tr("%1 s").arg(double(ms) / 1000, 0, 'f', 2);
+    };
+    const auto formatMemory = [](qint64 bytes) {
+        return Tr::tr("%1 MiB").arg(double(bytes) / (1024 * 1024), 0, 'f', 1);
+    };
+
+    qbsInfo() << Tr::tr("%n command(s) were run.", nullptr, int(m_processResults.size()));
+    printTopCommands(Tr::tr("Commands that took the longest:"),
+                     [](const ProcessResult &r) { return r.elapsedTime(); }, formatTime);
+    printTopCommands(Tr::tr("Commands that used the most CPU time:"),
+                     [](const ProcessResult &r) {
+        return r.userTime() >= 0 && r.systemTime() >= 0 ? r.userTime() + r.systemTime() : -1;
+    }, formatTime);
+    printTopCommands(Tr::tr("Commands that used the most memory:"),
+                     [](const ProcessResult &r) { return r.maxResidentSetSize(); }, formatMemory);
+    m_processResults.clear();
+}
+
 bool CommandLineFrontend::resolvingMultipleProjects() const
 {
     return isResolving() && m_resolveJobs.size() + m_projects.size() > 1;
@@ -475,9 +619,29 @@ BuildOptions CommandLineFrontend::buildOptions(const Project &project) const
         QBS_CHECK(!profileName.isEmpty());
         options.setMaxJobCount(Preferences(m_settings, profileName).jobs());
     }
+    if (!m_changedFiles.isEmpty())
+        options.setChangedFiles(m_changedFiles);
     return options;
 }
 
+// A null build of everything can be detected without setting up the project.
+bool CommandLineFrontend::canSkipBuild(const SetupProjectParameters &params) const
+{
+    if (m_parser.command() != BuildCommandType || watchMode() || !m_parser.products().empty())
+        return false;
+
+    // The user asked for output that only a real build produces.
+    if (!m_parser.traceFilePath().isEmpty() || m_parser.showCommandStats())
+        return false;
+    BuildOptions options = m_parser.buildOptions(params.topLevelProfile());
+    if (options.maxJobCount() <= 0)
+        options.setMaxJobCount(params.maxJobCount());
+    const Project::ProductSelection productSelection = m_parser.withNonDefaultProducts()
+            ? Project::ProductSelectionWithNonDefault : Project::ProductSelectionDefaultOnly;
+    return Project::isKnownToBeUpToDate(params, options, productSelection,
+                                        ConsoleLogger::instance().logSink());
+}
+
 QString CommandLineFrontend::buildDirectory(const QString &profileName) const
 {
     QString buildDir = m_parser.projectBuildDirectory();
@@ -514,6 +678,99 @@ QString CommandLineFrontend::buildDirectory(const QString &profileName) const
     return buildDir;
 }
 
+QString CommandLineFrontend::resolveServerName() const
+{
+    const QString name = m_parser.resolveServerName();
+    if (!name.isEmpty())
+        return name;
+    return QProcessEnvironment::systemEnvironment().value(QStringLiteral("QBS_RESOLVE_SERVER"));
+}
+
+bool CommandLineFrontend::watchMode() const
+{
+    return m_parser.command() == BuildCommandType && m_parser.watchForChanges();
+}
+
+void CommandLineFrontend::waitForChanges()
+{
+    m_watchStarted = true;
+    m_watchRoundFailed = false;
+    std::set<QString> filePaths;
+    for (size_t i = 0; i < m_configuredProjects.size(); ++i) {
+        // If resolving failed, the build system files from the last successful attempt
+        // are still of interest.
+        filePaths.insert(m_buildSystemFiles.at(i).cbegin(), m_buildSystemFiles.at(i).cend());
+        if (m_configuredProjects.at(i).isValid()) {
+            const std::set<QString> inputFiles = m_configuredProjects.at(i).buildInputFiles();
+            filePaths.insert(inputFiles.cbegin(), inputFiles.cend());
+        }
+    }
+    if (!m_sourceWatcher) {
+        m_sourceWatcher = new SourceWatcher(this);
+        connect(m_sourceWatcher, &SourceWatcher::filesChanged,
+                this, &CommandLineFrontend::handleWatchedFilesChanged);
+    }
+    m_sourceWatcher->setFiles(filePaths);
+    if (!m_pendingChanges.isEmpty()) { // Files were changed during the build.
+        rebuildAfterChanges();
+        return;
+    }
+    qbsInfo() << Tr::tr("Watching %1 file(s) for changes. Press Ctrl+C to quit.")
+                 .arg(filePaths.size());
+}
+
+void CommandLineFrontend::handleWatchedFilesChanged(const QStringList &filePaths)
+{
+    for (const QString &filePath : filePaths) {
+        if (!m_pendingChanges.contains(filePath))
+            m_pendingChanges << filePath;
+    }
+    if (isResolving() || isBuilding())
+        return; // The changes are picked up when the current build is done.
+    rebuildAfterChanges();
+}
+
+// The projects stay in memory, so in the common case of only source files having changed,
+// neither the build graph needs to be loaded nor do the timestamps of all files need to be
+// checked. Changes to build system files cause the respective project to be re-resolved.
+void CommandLineFrontend::rebuildAfterChanges()
+{
+    try {
+        m_changedFiles = m_pendingChanges;
+        m_pendingChanges.clear();
+        qbsInfo() << Tr::tr("Change detected in %1.")
+                     .arg(m_changedFiles.size() == 1
+                          ? QDir::toNativeSeparators(m_changedFiles.first())
+                          : Tr::tr("%1 files").arg(m_changedFiles.size()));
+        m_projects.clear();
+        for (size_t i = 0; i < m_configuredProjects.size(); ++i) {
+            const Project &project = m_configuredProjects.at(i);
+            const std::set<QString> &buildSystemFiles = m_buildSystemFiles.at(i);
+            const bool needsResolve = !project.isValid()
+                    || m_configurationsToResolve.contains(int(i))
+                    || std::any_of(m_changedFiles.cbegin(), m_changedFiles.cend(),
+                                   [&buildSystemFiles](const QString &filePath) {
+                return buildSystemFiles.find(filePath) != buildSystemFiles.cend();
+            });
+            if (!needsResolve) {
+                m_projects.push_back(project);
+                continue;
+            }
+            SetupProjectJob * const job = (project.isValid() ? project : Project())
+                    .setupProject(m_setupParameters.at(int(i)),
+                                  ConsoleLogger::instance().logSink(), this);
+            connectJob(job);
+            m_resolveJobs.push_back(job);
+            m_configurationIndexes.insert(job, int(i));
+        }
+        if (m_resolveJobs.empty())
+            handleProjectsResolved();
+    } catch (const ErrorInfo &error) {
+        qbsError() << error.toString();
+        qApp->exit(EXIT_FAILURE);
+    }
+}
+
 void CommandLineFrontend::build()
 {
     if (m_parser.products().empty()) {
@@ -42,12 +42,16 @@
 #include "parser/commandlineparser.h"
 #include <api/project.h>
 #include <api/projectdata.h>
+#include <tools/setupprojectparameters.h>
 
 #include <QtCore/qhash.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qobject.h>
+#include <QtCore/qset.h>
 
 #include <memory>
+#include <set>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 class QTimer;
@@ -60,6 +64,7 @@ class ErrorInfo;
 class ProcessResult;
 class ProjectGenerator;
 class Settings;
+namespace Internal { class SourceWatcher; }
 
 class CommandLineFrontend : public QObject
 {
@@ -79,6 +84,7 @@ private:
     void handleTotalEffortChanged(int totalEffort);
     void handleTaskProgress(int value, qbs::AbstractJob *job);
     void handleProcessResultReport(const qbs::ProcessResult &result);
+    void printCommandStats();
     void checkCancelStatus();
 
     using ProductMap = QHash<Project, QList<ProductData>>;
@@ -104,6 +110,12 @@ private:
     void install();
     BuildOptions buildOptions(const Project &project) const;
     QString buildDirectory(const QString &profileName) const;
+    QString resolveServerName() const;
+    bool watchMode() const;
+    bool canSkipBuild(const SetupProjectParameters &params) const;
+    void waitForChanges();
+    void handleWatchedFilesChanged(const QStringList &filePaths);
+    void rebuildAfterChanges();
 
     const CommandLineParser &m_parser;
     Settings * const m_settings;
@@ -122,7 +134,20 @@ private:
     int m_totalBuildEffort = 0;
     int m_currentBuildEffort = 0;
     QHash<AbstractJob *, int> m_buildEfforts;
+    std::vector<ProcessResult> m_processResults; // For --stats.
     std::shared_ptr<ProjectGenerator> m_generator;
+
+    // For watch mode. The configurations are indexed in the order of the command line.
+    Internal::SourceWatcher *m_sourceWatcher = nullptr;
+    QList<SetupProjectParameters> m_setupParameters;
+    QHash<AbstractJob *, int> m_configurationIndexes;
+    std::vector<Project> m_configuredProjects;
+    std::vector<std::set<QString>> m_buildSystemFiles;
+    QSet<int> m_configurationsToResolve;
+    QStringList m_pendingChanges;
+    QStringList m_changedFiles;
+    bool m_watchStarted = false;
+    bool m_watchRoundFailed = false;
 };
 
 } // namespace qbs
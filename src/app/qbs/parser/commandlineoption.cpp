@@ -44,6 +44,8 @@
 #include <tools/installoptions.h>
 #include <tools/qttools.h>
 
+#include <QtCore/qdir.h>
+
 namespace qbs {
 using namespace Internal;
 
@@ -461,6 +463,19 @@ QString ForceOutputCheckOption::longRepresentation() const
     return QStringLiteral("--check-outputs");
 }
 
+QString CheckContentsOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1\n\tCompare the contents of re-generated files with the previous build.\n"
+                  "\tArtifacts depending only on files whose content did not change\n"
+                  "\tare not rebuilt.\n").arg(longRepresentation());
+}
+
+QString CheckContentsOption::longRepresentation() const
+{
+    return QStringLiteral("--check-contents");
+}
+
 QString BuildNonDefaultOption::description(CommandType command) const
 {
     Q_UNUSED(command);
@@ -584,6 +599,219 @@ void SettingsDirOption::doParse(const QString &representation, QStringList &inpu
     m_settingsDir = input.takeFirst();
 }
 
+QString TraceFileOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <file>\n"
+                  "\tWrite a timeline of the operations involved in this command to the given file.\n"
+                  "\tThe file can be viewed with chrome://tracing or Perfetto.\n")
+            .arg(longRepresentation());
+}
+
+QString TraceFileOption::longRepresentation() const
+{
+    return QStringLiteral("--trace-file");
+}
+
+void TraceFileOption::doParse(const QString &representation, QStringList &input)
+{
+    if (input.empty()) {
+        throw ErrorInfo(Tr::tr("Invalid use of option '%1: Argument expected.\n"
+                           "Usage: %2").arg(representation, description(command())));
+    }
+    const QString filePath = input.takeFirst();
+    m_traceFilePath = QDir::fromNativeSeparators(QDir::current().absoluteFilePath(filePath));
+}
+
+QString ActionCacheOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <directory>\n"
+                  "\tRe-use the results of commands stored in the given directory instead of\n"
+                  "\trunning the commands again, and store the results of new commands there.\n"
+                  "\tThe directory can be shared between build directories.\n")
+            .arg(longRepresentation());
+}
+
+QString ActionCacheOption::longRepresentation() const
+{
+    return QStringLiteral("--action-cache");
+}
+
+void ActionCacheOption::doParse(const QString &representation, QStringList &input)
+{
+    const QString dirPath = getArgument(representation, input);
+    m_directory = QDir::fromNativeSeparators(QDir::current().absoluteFilePath(dirPath));
+}
+
+QString ActionCacheMaxSizeOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <size>\n"
+                  "\tLimit the size of the action cache to <size> MiB.\n"
+                  "\tThe default is 5120.\n").arg(longRepresentation());
+}
+
+QString ActionCacheMaxSizeOption::longRepresentation() const
+{
+    return QStringLiteral("--action-cache-max-size");
+}
+
+void ActionCacheMaxSizeOption::doParse(const QString &representation, QStringList &input)
+{
+    const QString sizeString = getArgument(representation, input);
+    bool stringOk;
+    m_maxSize = sizeString.toInt(&stringOk);
+    if (!stringOk || m_maxSize < 0) {
+        throw ErrorInfo(Tr::tr("Invalid use of option '%1': Illegal size '%2'.\nUsage: %3")
+                        .arg(representation, sizeString, description(command())));
+    }
+}
+
+QString WatchOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1\n\tAfter building, keep running and rebuild whenever a source file,\n"
+                  "\ta dependency found by a scanner or a project file changes.\n")
+            .arg(longRepresentation());
+}
+
+QString WatchOption::longRepresentation() const
+{
+    return QStringLiteral("--watch");
+}
+
+QString StatsOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1\n\tAfter building, list the commands that took the most time,\n"
+                  "\tCPU time and memory.\n").arg(longRepresentation());
+}
+
+QString StatsOption::longRepresentation() const
+{
+    return QStringLiteral("--stats");
+}
+
+QString ResolveServerOption::description(CommandType command) const
+{
+    if (command == SessionCommandType) {
+        return Tr::tr("%1 <name>\n"
+                      "\tInstead of communicating via stdin and stdout, accept connections\n"
+                      "\tfrom qbs command line invocations on the local socket <name> and\n"
+                      "\tkeep the projects they resolve in memory.\n")
+                .arg(longRepresentation());
+    }
+    return Tr::tr("%1 <name>\n"
+                  "\tLet the session listening on the local socket <name> resolve the project.\n"
+                  "\tThe default is the value of the QBS_RESOLVE_SERVER environment variable.\n"
+                  "\tIf no server can be reached, the project is resolved as usual.\n")
+            .arg(longRepresentation());
+}
+
+QString ResolveServerOption::longRepresentation() const
+{
+    return QStringLiteral("--resolve-server");
+}
+
+void ResolveServerOption::doParse(const QString &representation, QStringList &input)
+{
+    m_serverName = getArgument(representation, input);
+}
+
+QString RemoteActionCacheOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <url>\n"
+                  "\tLook up results missing from the local action cache in the remote cache\n"
+                  "\tat <url> and upload new results to it. <url> is either of the form\n"
+                  "\t'http://host[:port][/path]' or 'unix:/path/to/socket'.\n")
+            .arg(longRepresentation());
+}
+
+QString RemoteActionCacheOption::longRepresentation() const
+{
+    return QStringLiteral("--remote-action-cache");
+}
+
+void RemoteActionCacheOption::doParse(const QString &representation, QStringList &input)
+{
+    m_url = getArgument(representation, input);
+}
+
+QString MinAvailableMemoryOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <size>\n"
+                  "\tDo not start new jobs while less than <size> MiB of memory are available.\n"
+                  "\tThe default is 0, which disables the check.\n").arg(longRepresentation());
+}
+
+QString MinAvailableMemoryOption::longRepresentation() const
+{
+    return QStringLiteral("--min-available-memory");
+}
+
+void MinAvailableMemoryOption::doParse(const QString &representation, QStringList &input)
+{
+    const QString sizeString = getArgument(representation, input);
+    bool stringOk;
+    m_minAvailableMemory = sizeString.toInt(&stringOk);
+    if (!stringOk || m_minAvailableMemory < 0) {
+        throw ErrorInfo(Tr::tr("Invalid use of option '%1': Illegal size '%2'.\nUsage: %3")
+                        .arg(representation, sizeString, description(command())));
+    }
+}
+
+QString MaxMemoryPressureOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <percentage>\n"
+                  "\tDo not start new jobs while the system's memory pressure is higher than\n"
+                  "\t<percentage>. Only supported on Linux.\n"
+                  "\tThe default is 0, which disables the check.\n").arg(longRepresentation());
+}
+
+QString MaxMemoryPressureOption::longRepresentation() const
+{
+    return QStringLiteral("--max-memory-pressure");
+}
+
+void MaxMemoryPressureOption::doParse(const QString &representation, QStringList &input)
+{
+    const QString pressureString = getArgument(representation, input);
+    bool stringOk;
+    m_maxMemoryPressure = pressureString.toInt(&stringOk);
+    if (!stringOk || m_maxMemoryPressure < 0 || m_maxMemoryPressure > 100) {
+        throw ErrorInfo(Tr::tr("Invalid use of option '%1': Illegal percentage '%2'.\n"
+                               "Usage: %3")
+                        .arg(representation, pressureString, description(command())));
+    }
+}
+
+QString MemoryHeavyJobPoolsOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <pool1>[,<pool2>...]\n"
+                  "\tOnly hold back jobs from the given job pools when memory is low.\n"
+                  "\tBy default, all jobs are held back.\n").arg(longRepresentation());
+}
+
+QString MemoryHeavyJobPoolsOption::longRepresentation() const
+{
+    return QStringLiteral("--memory-heavy-job-pools");
+}
+
+void MemoryHeavyJobPoolsOption::doParse(const QString &representation, QStringList &input)
+{
+    m_jobPools = getArgument(representation, input).split(QLatin1Char(','),
+                                                          Qt::SkipEmptyParts);
+    if (m_jobPools.empty()) {
+        throw ErrorInfo(Tr::tr("Invalid use of option '%1': No job pools given.\nUsage: %2")
+                        .arg(representation, description(command())));
+    }
+}
+
 QString JobLimitsOption::description(CommandType command) const
 {
     Q_UNUSED(command);
@@ -72,6 +72,7 @@ public:
         NoBuildOptionType,
         ForceTimestampCheckOptionType,
         ForceOutputCheckOptionType,
+        CheckContentsOptionType,
         BuildNonDefaultOptionType,
         LogTimeOptionType,
         CommandEchoModeOptionType,
@@ -82,6 +83,16 @@ public:
         WaitLockOptionType,
         RunEnvConfigOptionType,
         DeprecationWarningsOptionType,
+        TraceFileOptionType,
+        ActionCacheOptionType,
+        ActionCacheMaxSizeOptionType,
+        RemoteActionCacheOptionType,
+        WatchOptionType,
+        MinAvailableMemoryOptionType,
+        MaxMemoryPressureOptionType,
+        MemoryHeavyJobPoolsOptionType,
+        StatsOptionType,
+        ResolveServerOptionType,
     };
 
     virtual ~CommandLineOption();
@@ -258,6 +269,13 @@ class ForceOutputCheckOption : public OnOffOption
     QString longRepresentation() const override;
 };
 
+class CheckContentsOption : public OnOffOption
+{
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+};
+
 class BuildNonDefaultOption : public OnOffOption
 {
     QString description(CommandType command) const override;
@@ -411,6 +429,140 @@ private:
     QString m_settingsDir;
 };
 
+class TraceFileOption : public CommandLineOption
+{
+public:
+    QString traceFilePath() const { return m_traceFilePath; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    QString m_traceFilePath;
+};
+
+class ActionCacheOption : public CommandLineOption
+{
+public:
+    QString directory() const { return m_directory; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    QString m_directory;
+};
+
+class ActionCacheMaxSizeOption : public CommandLineOption
+{
+public:
+    int maxSize() const { return m_maxSize; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    int m_maxSize = -1;
+};
+
+class WatchOption : public OnOffOption
+{
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+};
+
+class StatsOption : public OnOffOption
+{
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+};
+
+class ResolveServerOption : public CommandLineOption
+{
+public:
+    QString serverName() const { return m_serverName; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    QString m_serverName;
+};
+
+class RemoteActionCacheOption : public CommandLineOption
+{
+public:
+    QString url() const { return m_url; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    QString m_url;
+};
+
+class MinAvailableMemoryOption : public CommandLineOption
+{
+public:
+    int minAvailableMemory() const { return m_minAvailableMemory; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    int m_minAvailableMemory = 0;
+};
+
+class MaxMemoryPressureOption : public CommandLineOption
+{
+public:
+    int maxMemoryPressure() const { return m_maxMemoryPressure; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    int m_maxMemoryPressure = 0;
+};
+
+class MemoryHeavyJobPoolsOption : public CommandLineOption
+{
+public:
+    QStringList jobPools() const { return m_jobPools; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    QStringList m_jobPools;
+};
+
 class JobLimitsOption : public CommandLineOption
 {
 public:
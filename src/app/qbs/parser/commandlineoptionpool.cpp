@@ -107,6 +107,9 @@ CommandLineOption *CommandLineOptionPool::getOption(CommandLineOption::Type type
         case CommandLineOption::ForceOutputCheckOptionType:
             option = new ForceOutputCheckOption;
             break;
+        case CommandLineOption::CheckContentsOptionType:
+            option = new CheckContentsOption;
+            break;
         case CommandLineOption::BuildNonDefaultOptionType:
             option = new BuildNonDefaultOption;
             break;
@@ -137,6 +140,36 @@ CommandLineOption *CommandLineOptionPool::getOption(CommandLineOption::Type type
         case CommandLineOption::DeprecationWarningsOptionType:
             option = new DeprecationWarningsOption;
             break;
+        case CommandLineOption::TraceFileOptionType:
+            option = new TraceFileOption;
+            break;
+        case CommandLineOption::ActionCacheOptionType:
+            option = new ActionCacheOption;
+            break;
+        case CommandLineOption::ActionCacheMaxSizeOptionType:
+            option = new ActionCacheMaxSizeOption;
+            break;
+        case CommandLineOption::RemoteActionCacheOptionType:
+            option = new RemoteActionCacheOption;
+            break;
+        case CommandLineOption::WatchOptionType:
+            option = new WatchOption;
+            break;
+        case CommandLineOption::MinAvailableMemoryOptionType:
+            option = new MinAvailableMemoryOption;
+            break;
+        case CommandLineOption::MaxMemoryPressureOptionType:
+            option = new MaxMemoryPressureOption;
+            break;
+        case CommandLineOption::MemoryHeavyJobPoolsOptionType:
+            option = new MemoryHeavyJobPoolsOption;
+            break;
+        case CommandLineOption::StatsOptionType:
+            option = new StatsOption;
+            break;
+        case CommandLineOption::ResolveServerOptionType:
+            option = new ResolveServerOption;
+            break;
         default:
             qFatal("Unknown option type %d", type);
         }
@@ -241,6 +274,12 @@ ForceOutputCheckOption *CommandLineOptionPool::forceOutputCheckOption() const
                 getOption(CommandLineOption::ForceOutputCheckOptionType));
 }
 
+CheckContentsOption *CommandLineOptionPool::checkContentsOption() const
+{
+    return static_cast<CheckContentsOption *>(
+                getOption(CommandLineOption::CheckContentsOptionType));
+}
+
 BuildNonDefaultOption *CommandLineOptionPool::buildNonDefaultOption() const
 {
     return static_cast<BuildNonDefaultOption *>(
@@ -295,4 +334,60 @@ DeprecationWarningsOption *CommandLineOptionPool::deprecationWarningsOption() co
             (getOption(CommandLineOption::DeprecationWarningsOptionType));
 }
 
+TraceFileOption *CommandLineOptionPool::traceFileOption() const
+{
+    return static_cast<TraceFileOption *>(getOption(CommandLineOption::TraceFileOptionType));
+}
+
+ActionCacheOption *CommandLineOptionPool::actionCacheOption() const
+{
+    return static_cast<ActionCacheOption *>(getOption(CommandLineOption::ActionCacheOptionType));
+}
+
+ActionCacheMaxSizeOption *CommandLineOptionPool::actionCacheMaxSizeOption() const
+{
+    return static_cast<ActionCacheMaxSizeOption *>(
+                getOption(CommandLineOption::ActionCacheMaxSizeOptionType));
+}
+
+RemoteActionCacheOption *CommandLineOptionPool::remoteActionCacheOption() const
+{
+    return static_cast<RemoteActionCacheOption *>(
+                getOption(CommandLineOption::RemoteActionCacheOptionType));
+}
+
+WatchOption *CommandLineOptionPool::watchOption() const
+{
+    return static_cast<WatchOption *>(getOption(CommandLineOption::WatchOptionType));
+}
+
+MinAvailableMemoryOption *CommandLineOptionPool::minAvailableMemoryOption() const
+{
+    return static_cast<MinAvailableMemoryOption *>(
+                getOption(CommandLineOption::MinAvailableMemoryOptionType));
+}
+
+MaxMemoryPressureOption *CommandLineOptionPool::maxMemoryPressureOption() const
+{
+    return static_cast<MaxMemoryPressureOption *>(
+                getOption(CommandLineOption::MaxMemoryPressureOptionType));
+}
+
+MemoryHeavyJobPoolsOption *CommandLineOptionPool::memoryHeavyJobPoolsOption() const
+{
+    return static_cast<MemoryHeavyJobPoolsOption *>(
+                getOption(CommandLineOption::MemoryHeavyJobPoolsOptionType));
+}
+
+StatsOption *CommandLineOptionPool::statsOption() const
+{
+    return static_cast<StatsOption *>(getOption(CommandLineOption::StatsOptionType));
+}
+
+ResolveServerOption *CommandLineOptionPool::resolveServerOption() const
+{
+    return static_cast<ResolveServerOption *>(
+                getOption(CommandLineOption::ResolveServerOptionType));
+}
+
 } // namespace qbs
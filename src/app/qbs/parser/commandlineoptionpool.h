@@ -70,6 +70,7 @@ public:
     NoBuildOption *noBuildOption() const;
     ForceTimeStampCheckOption *forceTimestampCheckOption() const;
     ForceOutputCheckOption *forceOutputCheckOption() const;
+    CheckContentsOption *checkContentsOption() const;
     BuildNonDefaultOption *buildNonDefaultOption() const;
     LogTimeOption *logTimeOption() const;
     CommandEchoModeOption *commandEchoModeOption() const;
@@ -80,6 +81,16 @@ public:
     WaitLockOption *waitLockOption() const;
     RunEnvConfigOption *runEnvConfigOption() const;
     DeprecationWarningsOption *deprecationWarningsOption() const;
+    TraceFileOption *traceFileOption() const;
+    ActionCacheOption *actionCacheOption() const;
+    ActionCacheMaxSizeOption *actionCacheMaxSizeOption() const;
+    RemoteActionCacheOption *remoteActionCacheOption() const;
+    WatchOption *watchOption() const;
+    MinAvailableMemoryOption *minAvailableMemoryOption() const;
+    MaxMemoryPressureOption *maxMemoryPressureOption() const;
+    MemoryHeavyJobPoolsOption *memoryHeavyJobPoolsOption() const;
+    StatsOption *statsOption() const;
+    ResolveServerOption *resolveServerOption() const;
 
 private:
     mutable QHash<CommandLineOption::Type, CommandLineOption *> m_options;
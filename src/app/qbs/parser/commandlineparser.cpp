@@ -236,6 +236,11 @@ bool CommandLineParser::logTime() const
     return d->logTime;
 }
 
+QString CommandLineParser::traceFilePath() const
+{
+    return d->optionPool.traceFileOption()->traceFilePath();
+}
+
 bool CommandLineParser::withNonDefaultProducts() const
 {
     return d->withNonDefaultProducts();
@@ -246,6 +251,21 @@ bool CommandLineParser::buildBeforeInstalling() const
     return !d->optionPool.noBuildOption()->enabled();
 }
 
+bool CommandLineParser::watchForChanges() const
+{
+    return d->optionPool.watchOption()->enabled();
+}
+
+bool CommandLineParser::showCommandStats() const
+{
+    return d->optionPool.statsOption()->enabled();
+}
+
+QString CommandLineParser::resolveServerName() const
+{
+    return d->optionPool.resolveServerOption()->serverName();
+}
+
 QStringList CommandLineParser::runArgs() const
 {
     Q_ASSERT(d->command->type() == RunCommandType);
@@ -477,9 +497,18 @@ void CommandLineParser::CommandLineParserPrivate::setupBuildOptions()
     buildOptions.setKeepGoing(optionPool.keepGoingOption()->enabled());
     buildOptions.setForceTimestampCheck(optionPool.forceTimestampCheckOption()->enabled());
     buildOptions.setForceOutputCheck(optionPool.forceOutputCheckOption()->enabled());
+    buildOptions.setCheckContents(optionPool.checkContentsOption()->enabled());
     const JobsOption * jobsOption = optionPool.jobsOption();
     buildOptions.setMaxJobCount(jobsOption->jobCount());
     buildOptions.setLogElapsedTime(logTime);
+    buildOptions.setTraceFilePath(optionPool.traceFileOption()->traceFilePath());
+    buildOptions.setActionCacheDirectory(optionPool.actionCacheOption()->directory());
+    if (optionPool.actionCacheMaxSizeOption()->maxSize() >= 0)
+        buildOptions.setActionCacheMaxSize(optionPool.actionCacheMaxSizeOption()->maxSize());
+    buildOptions.setRemoteActionCacheUrl(optionPool.remoteActionCacheOption()->url());
+    buildOptions.setMinAvailableMemory(optionPool.minAvailableMemoryOption()->minAvailableMemory());
+    buildOptions.setMaxMemoryPressure(optionPool.maxMemoryPressureOption()->maxMemoryPressure());
+    buildOptions.setMemoryHeavyJobPools(optionPool.memoryHeavyJobPoolsOption()->jobPools());
     buildOptions.setEchoMode(echoMode());
     buildOptions.setInstall(!optionPool.noInstallOption()->enabled());
     buildOptions.setRemoveExistingInstallation(optionPool.removeFirstoption()->enabled());
@@ -82,8 +82,12 @@ public:
     bool forceProbesExecution() const;
     bool waitLockBuildGraph() const;
     bool logTime() const;
+    QString traceFilePath() const;
     bool withNonDefaultProducts() const;
     bool buildBeforeInstalling() const;
+    bool watchForChanges() const;
+    bool showCommandStats() const;
+    QString resolveServerName() const;
     QStringList runArgs() const;
     QStringList products() const;
     QStringList tags() const;
@@ -210,7 +210,9 @@ static QList<CommandLineOption::Type> resolveOptions()
         CommandLineOption::ForceProbesOptionType,
         CommandLineOption::LogTimeOptionType,
         CommandLineOption::DeprecationWarningsOptionType,
-        CommandLineOption::JobsOptionType};
+        CommandLineOption::JobsOptionType,
+        CommandLineOption::TraceFileOptionType,
+        CommandLineOption::ResolveServerOptionType};
 }
 
 QList<CommandLineOption::Type> ResolveCommand::supportedOptions() const
@@ -279,18 +281,26 @@ static QList<CommandLineOption::Type> buildOptions()
             << CommandLineOption::ChangedFilesOptionType
             << CommandLineOption::ForceTimestampCheckOptionType
             << CommandLineOption::ForceOutputCheckOptionType
+            << CommandLineOption::CheckContentsOptionType
             << CommandLineOption::BuildNonDefaultOptionType
             << CommandLineOption::CommandEchoModeOptionType
             << CommandLineOption::NoInstallOptionType
             << CommandLineOption::RemoveFirstOptionType
             << CommandLineOption::JobLimitsOptionType
             << CommandLineOption::RespectProjectJobLimitsOptionType
-            << CommandLineOption::WaitLockOptionType;
+            << CommandLineOption::WaitLockOptionType
+            << CommandLineOption::ActionCacheOptionType
+            << CommandLineOption::ActionCacheMaxSizeOptionType
+            << CommandLineOption::RemoteActionCacheOptionType
+            << CommandLineOption::MinAvailableMemoryOptionType
+            << CommandLineOption::MaxMemoryPressureOptionType
+            << CommandLineOption::MemoryHeavyJobPoolsOptionType;
 }
 
 QList<CommandLineOption::Type> BuildCommand::supportedOptions() const
 {
-    return buildOptions();
+    return buildOptions() << CommandLineOption::WatchOptionType
+                          << CommandLineOption::StatsOptionType;
 }
 
 QString CleanCommand::shortDescription() const
@@ -601,9 +611,10 @@ QString SessionCommand::shortDescription() const
 
 QString SessionCommand::longDescription() const
 {
-    QString description = Tr::tr("qbs %1\n").arg(representation());
-    return description += Tr::tr("Communicates on stdin and stdout via a JSON-based API.\n"
-                                 "Intended for use with other tools, such as IDEs.\n");
+    QString description = Tr::tr("qbs %1 [options]\n").arg(representation());
+    description += Tr::tr("Communicates on stdin and stdout via a JSON-based API.\n"
+                          "Intended for use with other tools, such as IDEs.\n");
+    return description += supportedOptionsDescription();
 }
 
 QString SessionCommand::representation() const
@@ -611,10 +622,17 @@ QString SessionCommand::representation() const
     return QLatin1String("session");
 }
 
+QList<CommandLineOption::Type> SessionCommand::supportedOptions() const
+{
+    return {CommandLineOption::ResolveServerOptionType};
+}
+
 void SessionCommand::parseNext(QStringList &input)
 {
     QBS_CHECK(!input.empty());
-    throwError(Tr::tr("This command takes no arguments."));
+    if (!input.front().startsWith(QLatin1Char('-')))
+        throwError(Tr::tr("This command takes no arguments."));
+    Command::parseNext(input);
 }
 
 } // namespace qbs
@@ -272,7 +272,7 @@ private:
     QString shortDescription() const override;
     QString longDescription() const override;
     QString representation() const override;
-    QList<CommandLineOption::Type> supportedOptions() const override { return {}; }
+    QList<CommandLineOption::Type> supportedOptions() const override;
     void parseNext(QStringList &input) override;
 };
 
@@ -0,0 +1,208 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include "resolveserverclient.h"
+
+#include "../shared/logging/consolelogger.h"
+#include "sessionpacket.h"
+#include "sessionpacketreader.h"
+
+#include <logging/translator.h>
+#include <tools/codelocation.h>
+#include <tools/error.h>
+#include <tools/setupprojectparameters.h>
+#include <tools/stringconstants.h>
+
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsonobject.h>
+#include <QtCore/qlist.h>
+
+#include <QLocalSocket>
+
+namespace qbs {
+namespace Internal {
+
+static ErrorInfo errorFromJson(const QJsonObject &data)
+{
+    ErrorInfo error;
+    const QJsonArray items = data.value(QLatin1String("items")).toArray();
+    for (const QJsonValue &v : items) {
+        const QJsonObject item = v.toObject();
+        const QJsonObject location = item.value(StringConstants::locationKey()).toObject();
+        error.append(item.value(StringConstants::descriptionProperty()).toString(),
+                     CodeLocation(location.value(StringConstants::filePathKey()).toString(),
+                                  location.value(QLatin1String("line")).toInt(-1),
+                                  location.value(QLatin1String("column")).toInt(-1)));
+    }
+    return error;
+}
+
+namespace {
+class ResolveServerConnection
+{
+public:
+    explicit ResolveServerConnection(std::function<bool()> cancelRequested)
+        : m_cancelRequested(std::move(cancelRequested))
+    {
+        QObject::connect(&m_reader, &SessionPacketReader::packetReceived,
+                         [this](const QJsonObject &packet) { m_packets << packet; });
+        QObject::connect(&m_reader, &SessionPacketReader::errorOccurred,
+                         [this](const QString &msg) { m_errorString = msg; });
+    }
+
+    bool connectToServer(const QString &name)
+    {
+        m_socket.connectToServer(name);
+        if (!m_socket.waitForConnected(1000)) {
+            m_errorString = m_socket.errorString();
+            return false;
+        }
+        m_reader.start(&m_socket);
+        return true;
+    }
+
+    void send(const QJsonObject &packet)
+    {
+        m_socket.write(SessionPacket::createPacket(packet));
+        m_socket.flush();
+    }
+
+    // Relays the messages arriving in the meantime.
+    bool waitForReply(const QString &replyType, QJsonObject &reply)
+    {
+        bool cancelSent = false;
+        while (true) {
+            while (!m_packets.empty()) {
+                const QJsonObject packet = m_packets.takeFirst();
+                const QString type = packet.value(StringConstants::type()).toString();
+                if (type == replyType) {
+                    reply = packet;
+                    return true;
+                }
+                relayMessage(type, packet);
+            }
+            if (!m_errorString.isEmpty())
+                return false;
+            if (!cancelSent && m_cancelRequested()) {
+                send(QJsonObject{{StringConstants::type(), QLatin1String("cancel-job")}});
+                cancelSent = true;
+            }
+            if (!m_socket.waitForReadyRead(500)
+                    && m_socket.state() != QLocalSocket::ConnectedState) {
+                m_errorString = m_socket.errorString();
+                return false;
+            }
+        }
+    }
+
+    QString errorString() const { return m_errorString; }
+
+private:
+    static void relayMessage(const QString &type, const QJsonObject &packet)
+    {
+        if (type == QLatin1String("log-data")) {
+            qbsInfo() << packet.value(StringConstants::messageKey()).toString();
+        } else if (type == QLatin1String("warning")) {
+            const QJsonValue error = packet.value(QLatin1String("error"));
+            if (error.isObject())
+                ConsoleLogger::instance().printError(errorFromJson(error.toObject()));
+            else
+                ConsoleLogger::instance().printWarning(
+                        errorFromJson(packet.value(QLatin1String("warning")).toObject()));
+        }
+    }
+
+    const std::function<bool()> m_cancelRequested;
+    QLocalSocket m_socket;
+    SessionPacketReader m_reader;
+    QList<QJsonObject> m_packets;
+    QString m_errorString;
+};
+} // namespace
+
+RemoteResolveResult resolveOnServer(const QString &serverName,
+                                    const SetupProjectParameters &parameters,
+                                    const std::function<bool()> &cancelRequested)
+{
+    ResolveServerConnection connection(cancelRequested);
+    if (!connection.connectToServer(serverName)) {
+        qbsDebug() << QStringLiteral("Cannot reach resolve server '%1': %2")
+                      .arg(serverName, connection.errorString());
+        return RemoteResolveResult::ServerUnavailable;
+    }
+    QJsonObject reply;
+    if (!connection.waitForReply(QLatin1String("hello"), reply))
+        return RemoteResolveResult::ServerUnavailable;
+
+    // The server writes the build graph that we are going to load, so it must not just be
+    // compatible, but speak exactly our protocol version.
+    const int serverApiLevel = reply.value(QLatin1String("api-level")).toInt();
+    if (serverApiLevel != SessionPacket::apiLevel) {
+        qbsWarning() << Tr::tr("Resolve server '%1' uses API level %2 instead of %3, "
+                               "resolving locally.")
+                        .arg(serverName).arg(serverApiLevel).arg(SessionPacket::apiLevel);
+        return RemoteResolveResult::ServerUnavailable;
+    }
+
+    QJsonObject request = parameters.toJson();
+    request.insert(StringConstants::type(), QLatin1String("resolve-project"));
+    request.insert(QLatin1String("override-build-graph-data"),
+                   parameters.overrideBuildGraphData());
+    request.insert(QLatin1String("log-level"),
+                   logLevelName(ConsoleLogger::instance().logSink()->logLevel()));
+    connection.send(request);
+    if (!connection.waitForReply(QLatin1String("project-resolved"), reply)) {
+        qbsWarning() << Tr::tr("Lost connection to resolve server '%1' (%2), "
+                               "resolving locally.").arg(serverName, connection.errorString());
+        return RemoteResolveResult::ServerUnavailable;
+    }
+    const QJsonValue error = reply.value(QLatin1String("error"));
+    if (error.isObject()) {
+        ConsoleLogger::instance().printError(errorFromJson(error.toObject()));
+        return RemoteResolveResult::Failed;
+    }
+
+    // The server must give up the build graph lock before we can use the build graph.
+    connection.send(QJsonObject{{StringConstants::type(), QLatin1String("release-project")}});
+    if (!connection.waitForReply(QLatin1String("project-released"), reply))
+        return RemoteResolveResult::ServerUnavailable;
+    return RemoteResolveResult::Resolved;
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,63 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#ifndef QBS_RESOLVESERVERCLIENT_H
+#define QBS_RESOLVESERVERCLIENT_H
+
+#include <QtCore/qstring.h>
+
+#include <functional>
+
+namespace qbs {
+class SetupProjectParameters;
+
+namespace Internal {
+
+enum class RemoteResolveResult { Resolved, Failed, ServerUnavailable };
+
+// Lets the resolve server listening on the given socket resolve the project and store
+// its build graph. Messages from the server are forwarded to the console logger.
+// Blocks until the server is done; the cancel request is checked while waiting.
+RemoteResolveResult resolveOnServer(const QString &serverName,
+                                    const SetupProjectParameters &parameters,
+                                    const std::function<bool()> &cancelRequested);
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_RESOLVESERVERCLIENT_H
@@ -42,6 +42,7 @@
 #include "lspserver.h"
 #include "sessionpacket.h"
 #include "sessionpacketreader.h"
+#include "sourcewatcher.h"
 
 #include <api/jobs.h>
 #include <api/project.h>
@@ -67,12 +68,22 @@
 #include <QtCore/qjsonarray.h>
 #include <QtCore/qjsonobject.h>
 #include <QtCore/qobject.h>
+#include <QtCore/qpointer.h>
 #include <QtCore/qprocess.h>
+#include <QtCore/qtimer.h>
 
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include <algorithm>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <set>
 #include <utility>
+#include <vector>
 
 #ifdef Q_OS_WIN32
 #include <cerrno>
@@ -127,13 +138,71 @@ private:
     }
 };
 
+/*
+ * Serves qbs command line invocations, so the resolving of their projects can make use
+ * of the caches of a long-lived process and of the project state from the previous resolve.
+ * Each connection is handled by its own Session. When a connection ends, its project is kept
+ * here with the build graph lock released, until a new connection resolves a project
+ * in the same build directory. The build graph files of kept projects are watched: When
+ * another process, typically the client building the project, has changed them, the project
+ * is restored from disk again as soon as the build graph lock is available.
+ */
+class ResolveServer : public QObject
+{
+    Q_OBJECT
+public:
+    ResolveServer();
+
+    bool listen(const QString &name);
+
+    // The handler gets an invalid project if none is kept for the build directory.
+    // It is called later if the kept project needs to be refreshed first.
+    using ProjectHandler = std::function<void(const Project &)>;
+    void takeProject(const QString &buildDirectory, QObject *receiver,
+                     const ProjectHandler &handler);
+    void keepProject(Project project, const SetupProjectParameters &parameters);
+
+private:
+    struct KeptProject
+    {
+        Project project;
+        SetupProjectParameters parameters;
+        SetupProjectJob *refreshJob = nullptr;
+        std::vector<std::pair<QPointer<QObject>, ProjectHandler>> waitingHandlers;
+        int failedRefreshes = 0;
+        quint64 keptAt = 0;
+    };
+    using KeptProjects = std::map<QString, KeptProject>;
+
+    void handleBuildGraphFilesChanged(const QStringList &filePaths);
+    void refreshProject(KeptProjects::iterator it);
+    void handleRefreshFinished(const QString &buildDirectory, bool success);
+    void handOutProject(KeptProjects::iterator it);
+    void dropProject(KeptProjects::iterator it);
+    void removeLeastRecentlyKeptProjects();
+    void updateWatchedFiles();
+
+    static const int maxKeptProjects = 8;
+    static const int maxFailedRefreshes = 5;
+
+    QLocalServer m_server;
+    SourceWatcher m_buildGraphWatcher;
+    SessionLogSink m_refreshLogSink;
+    KeptProjects m_projects;
+    quint64 m_keepCount = 0;
+};
+
 class Session : public QObject
 {
     Q_OBJECT
 public:
     Session();
+    Session(ResolveServer &server, QLocalSocket *socket);
 
 private:
+    void setupPacketHandling();
+    void handleDisconnected();
+
     enum class ProjectDataMode { Never, Always, OnlyIfChanged };
     ProjectDataMode dataModeFromRequest(const QJsonObject &request);
     QStringList modulePropertiesFromRequest(const QJsonObject &request);
@@ -148,6 +217,7 @@ private:
 
     void sendPacket(const QJsonObject &message);
     void setupProject(const QJsonObject &request);
+    void startSetupJob(const SetupProjectParameters &params, ProjectDataMode dataMode);
     void buildProject(const QJsonObject &request);
     void cleanProject(const QJsonObject &request);
     void installProject(const QJsonObject &request);
@@ -191,15 +261,19 @@ private:
     template<typename ArgType>
     FileUpdateData<ArgType> prepareFileUpdate(const QJsonObject &request, const QString &paramKey);
 
+    ResolveServer * const m_resolveServer = nullptr;
+    QLocalSocket * const m_socket = nullptr;
     SessionPacketReader m_packetReader;
-    LspServer m_lspServer;
+    std::unique_ptr<LspServer> m_lspServer; // Only for sessions on stdin/stdout.
     SessionLogSink m_logSink;
     Project m_project;
+    SetupProjectParameters m_projectParameters;
     ProjectData m_projectData;
     std::unique_ptr<Settings> m_settings;
     QJsonObject m_resolveRequest;
     QStringList m_moduleProperties;
     AbstractJob *m_currentJob = nullptr;
+    bool m_waitingForKeptProject = false;
 };
 
 void startSession()
@@ -208,6 +282,210 @@ void startSession()
     QObject::connect(qApp, &QCoreApplication::aboutToQuit, session, [session] { delete session; });
 }
 
+void startResolveServer(const QString &name)
+{
+    const auto server = new ResolveServer;
+    QObject::connect(qApp, &QCoreApplication::aboutToQuit, server, [server] { delete server; });
+    if (!server->listen(name))
+        qApp->exit(EXIT_FAILURE);
+}
+
+bool ResolveServer::listen(const QString &name)
+{
+    m_server.setSocketOptions(QLocalServer::UserAccessOption);
+    if (!m_server.listen(name)) {
+        // A socket file can be left over from a server that did not shut down properly.
+        QLocalSocket probe;
+        probe.connectToServer(name);
+        if (probe.waitForConnected(1000)) {
+            std::cerr << qPrintable(tr("Error: A resolve server is already listening on '%1'.")
+                                    .arg(name)) << std::endl;
+            return false;
+        }
+        QLocalServer::removeServer(name);
+        if (!m_server.listen(name)) {
+            std::cerr << qPrintable(tr("Error: Cannot listen on '%1': %2")
+                                    .arg(name, m_server.errorString())) << std::endl;
+            return false;
+        }
+    }
+    connect(&m_server, &QLocalServer::newConnection, this, [this] {
+        while (QLocalSocket * const socket = m_server.nextPendingConnection())
+            new Session(*this, socket);
+    });
+    return true;
+}
+
+ResolveServer::ResolveServer()
+{
+    connect(&m_buildGraphWatcher, &SourceWatcher::filesChanged,
+            this, &ResolveServer::handleBuildGraphFilesChanged);
+}
+
+void ResolveServer::takeProject(const QString &buildDirectory, QObject *receiver,
+                                const ProjectHandler &handler)
+{
+    const auto it = m_projects.find(QDir::cleanPath(buildDirectory));
+    if (it == m_projects.end()) {
+        handler(Project());
+        return;
+    }
+    it->second.waitingHandlers.emplace_back(receiver, handler);
+    if (it->second.refreshJob)
+        return;
+    if (it->second.project.buildGraphChangedSinceLockRelease())
+        refreshProject(it);
+    else
+        handOutProject(it);
+}
+
+void ResolveServer::keepProject(Project project, const SetupProjectParameters &parameters)
+{
+    if (!project.isValid())
+        return;
+    const QString buildDirectory = QDir::cleanPath(project.projectData().buildDirectory());
+    project.releaseBuildGraphLock();
+    KeptProject &kept = m_projects[buildDirectory];
+    if (kept.refreshJob) // Another session's project for the same directory is still in use.
+        return;
+    kept.project = project;
+    kept.parameters = parameters;
+    kept.failedRefreshes = 0;
+    kept.keptAt = ++m_keepCount;
+    removeLeastRecentlyKeptProjects();
+    updateWatchedFiles();
+}
+
+void ResolveServer::handleBuildGraphFilesChanged(const QStringList &filePaths)
+{
+    for (auto it = m_projects.begin(); it != m_projects.end(); ++it) {
+        KeptProject &kept = it->second;
+        if (kept.refreshJob)
+            continue;
+        const std::set<QString> buildGraphFiles = kept.project.buildGraphFiles();
+        const bool affected = std::any_of(filePaths.cbegin(), filePaths.cend(),
+                                          [&buildGraphFiles](const QString &filePath) {
+            return buildGraphFiles.find(filePath) != buildGraphFiles.cend();
+        });
+        if (affected && kept.project.buildGraphChangedSinceLockRelease()) {
+            kept.failedRefreshes = 0;
+            refreshProject(it);
+        }
+    }
+}
+
+// Restores the project from disk, so the next resolve does not have to.
+void ResolveServer::refreshProject(KeptProjects::iterator it)
+{
+    KeptProject &kept = it->second;
+    SetupProjectParameters params = kept.parameters;
+    params.setRestoreBehavior(SetupProjectParameters::RestoreOnly);
+    params.setRestoreBuildDataOnDemand(true);
+    params.setOverrideBuildGraphData(false);
+    params.setWaitLockBuildGraph(false);
+    params.setLogElapsedTime(false);
+    params.setTraceFilePath(QString());
+    kept.refreshJob = kept.project.setupProject(params, &m_refreshLogSink, this);
+    const QString buildDirectory = it->first;
+    if (kept.refreshJob->state() == AbstractJob::StateFinished) { // Failed right away.
+        handleRefreshFinished(buildDirectory, false);
+        return;
+    }
+    connect(kept.refreshJob, &AbstractJob::finished, this, [this, buildDirectory](bool success) {
+        handleRefreshFinished(buildDirectory, success);
+    });
+}
+
+void ResolveServer::handleRefreshFinished(const QString &buildDirectory, bool success)
+{
+    const auto it = m_projects.find(buildDirectory);
+    QBS_ASSERT(it != m_projects.end(), return);
+    KeptProject &kept = it->second;
+    SetupProjectJob * const job = std::exchange(kept.refreshJob, nullptr);
+    job->deleteLater();
+    if (success) {
+        kept.project = job->project();
+        kept.project.releaseBuildGraphLock();
+        kept.failedRefreshes = 0;
+        if (!kept.waitingHandlers.empty())
+            handOutProject(it);
+        return;
+    }
+
+    // Usually, the process that changed the build graph still holds the lock. A client that
+    // is waiting for the project can do better by restoring the build graph itself.
+    if (!kept.project.isValid() || !kept.waitingHandlers.empty()
+            || ++kept.failedRefreshes >= maxFailedRefreshes) {
+        dropProject(it);
+        return;
+    }
+    QTimer::singleShot(1000, this, [this, buildDirectory] {
+        const auto keptIt = m_projects.find(buildDirectory);
+        if (keptIt != m_projects.end() && !keptIt->second.refreshJob
+                && keptIt->second.project.buildGraphChangedSinceLockRelease()) {
+            refreshProject(keptIt);
+        }
+    });
+}
+
+void ResolveServer::handOutProject(KeptProjects::iterator it)
+{
+    const Project project = it->second.project;
+    const auto handlers = std::move(it->second.waitingHandlers);
+    it->second.waitingHandlers.clear();
+    auto handler = handlers.cbegin();
+    while (handler != handlers.cend() && !handler->first)
+        ++handler;
+    if (handler == handlers.cend()) // The sessions went away in the meantime.
+        return;
+    m_projects.erase(it);
+    updateWatchedFiles();
+    handler->second(project);
+
+    // Only one session can use the project, the other ones start from disk.
+    for (++handler; handler != handlers.cend(); ++handler) {
+        if (handler->first)
+            handler->second(Project());
+    }
+}
+
+void ResolveServer::dropProject(KeptProjects::iterator it)
+{
+    const auto handlers = std::move(it->second.waitingHandlers);
+    m_projects.erase(it);
+    updateWatchedFiles();
+    for (const auto &handler : handlers) {
+        if (handler.first)
+            handler.second(Project());
+    }
+}
+
+void ResolveServer::removeLeastRecentlyKeptProjects()
+{
+    while (int(m_projects.size()) > maxKeptProjects) {
+        auto oldest = m_projects.end();
+        for (auto it = m_projects.begin(); it != m_projects.end(); ++it) {
+            if (it->second.refreshJob || !it->second.waitingHandlers.empty())
+                continue;
+            if (oldest == m_projects.end() || it->second.keptAt < oldest->second.keptAt)
+                oldest = it;
+        }
+        if (oldest == m_projects.end())
+            return;
+        m_projects.erase(oldest);
+    }
+}
+
+void ResolveServer::updateWatchedFiles()
+{
+    std::set<QString> filePaths;
+    for (const auto &kept : m_projects) {
+        const std::set<QString> buildGraphFiles = kept.second.project.buildGraphFiles();
+        filePaths.insert(buildGraphFiles.cbegin(), buildGraphFiles.cend());
+    }
+    m_buildGraphWatcher.setFiles(filePaths);
+}
+
 Session::Session()
 {
 #ifdef Q_OS_WIN32
@@ -220,13 +498,31 @@ Session::Session()
         qApp->exit(EXIT_FAILURE);
     }
 #endif
-    sendPacket(SessionPacket::helloMessage(m_lspServer.socketPath()));
-    connect(&m_logSink, &SessionLogSink::newMessage, this, &Session::sendPacket);
+    m_lspServer = std::make_unique<LspServer>();
     connect(&m_packetReader, &SessionPacketReader::errorOccurred,
             this, [](const QString &msg) {
         std::cerr << qPrintable(tr("Error: %1").arg(msg));
         qApp->exit(EXIT_FAILURE);
     });
+    setupPacketHandling();
+    m_packetReader.start();
+}
+
+Session::Session(ResolveServer &server, QLocalSocket *socket)
+    : m_resolveServer(&server), m_socket(socket)
+{
+    socket->setParent(this);
+    connect(&m_packetReader, &SessionPacketReader::errorOccurred, socket,
+            &QLocalSocket::disconnectFromServer);
+    connect(socket, &QLocalSocket::disconnected, this, &Session::handleDisconnected);
+    setupPacketHandling();
+    m_packetReader.start(socket);
+}
+
+void Session::setupPacketHandling()
+{
+    sendPacket(SessionPacket::helloMessage(m_lspServer ? m_lspServer->socketPath() : QString()));
+    connect(&m_logSink, &SessionLogSink::newMessage, this, &Session::sendPacket);
     connect(&m_packetReader, &SessionPacketReader::packetReceived, this, [this](const QJsonObject &packet) {
         // qDebug() << "got packet:" << packet; // Uncomment for debugging.
         const QString type = packet.value(StringConstants::type()).toString();
@@ -259,7 +555,21 @@ Session::Session()
         else
             sendErrorReply("protocol-error", tr("Unknown request type '%1'.").arg(type));
     });
-    m_packetReader.start();
+}
+
+void Session::handleDisconnected()
+{
+    if (m_currentJob) {
+        // The job cannot be deleted while it is running, so it must outlive the session.
+        m_currentJob->disconnect(this);
+        m_currentJob->setParent(nullptr);
+        connect(m_currentJob, &AbstractJob::finished, m_currentJob, &QObject::deleteLater);
+        m_currentJob->cancel();
+        m_currentJob = nullptr;
+    } else {
+        m_resolveServer->keepProject(m_project, m_projectParameters);
+    }
+    deleteLater();
 }
 
 Session::ProjectDataMode Session::dataModeFromRequest(const QJsonObject &request)
@@ -274,11 +584,20 @@ Session::ProjectDataMode Session::dataModeFromRequest(const QJsonObject &request
 
 void Session::sendPacket(const QJsonObject &message)
 {
+    if (m_socket) {
+        m_socket->write(SessionPacket::createPacket(message));
+        return;
+    }
     std::cout << SessionPacket::createPacket(message).constData() << std::flush;
 }
 
 void Session::setupProject(const QJsonObject &request)
 {
+    if (m_waitingForKeptProject) {
+        sendErrorReply("project-resolved",
+                       tr("Cannot start resolving while another job is still running."));
+        return;
+    }
     if (m_currentJob) {
         if (qobject_cast<SetupProjectJob *>(m_currentJob)
                 && m_currentJob->state() == AbstractJob::StateCanceling) {
@@ -300,13 +619,34 @@ void Session::setupProject(const QJsonObject &request)
     params.setPluginPaths(prefs.pluginPaths(appDir + QLatin1String(
                                                 "/" QBS_RELATIVE_PLUGINS_PATH)));
     params.setLibexecPath(appDir + QLatin1String("/" QBS_RELATIVE_LIBEXEC_PATH));
-    params.setOverrideBuildGraphData(true);
+    // Command line invocations only override the stored properties when resolving explicitly.
+    params.setOverrideBuildGraphData(!m_resolveServer || request.value(
+            QLatin1String("override-build-graph-data")).toBool(true));
     setLogLevelFromRequest(request);
+    if (m_resolveServer) {
+        params.setReuseScriptEngines(true);
+        if (!m_project.isValid()) {
+            m_waitingForKeptProject = true;
+            m_resolveServer->takeProject(
+                        params.buildRoot() + QLatin1Char('/') + params.configurationName(), this,
+                        [this, params, dataMode](const Project &project) {
+                m_waitingForKeptProject = false;
+                m_project = project;
+                startSetupJob(params, dataMode);
+            });
+            return;
+        }
+    }
+    startSetupJob(params, dataMode);
+}
+
+void Session::startSetupJob(const SetupProjectParameters &params, ProjectDataMode dataMode)
+{
     SetupProjectJob * const setupJob = m_project.setupProject(params, &m_logSink, this);
     m_currentJob = setupJob;
     connectProgressSignals(setupJob);
     connect(setupJob, &AbstractJob::finished, this,
-            [this, setupJob, dataMode](bool success) {
+            [this, setupJob, params, dataMode](bool success) {
         if (!m_resolveRequest.isEmpty()) { // Canceled job was superseded.
             const QJsonObject newRequest = std::move(m_resolveRequest);
             m_resolveRequest = QJsonObject();
@@ -317,8 +657,10 @@ void Session::setupProject(const QJsonObject &request)
         }
         const ProjectData oldProjectData = m_projectData;
         m_project = setupJob->project();
+        m_projectParameters = params;
         m_projectData = m_project.projectData();
-        m_lspServer.updateProjectData(m_projectData, m_project.codeLinks());
+        if (m_lspServer)
+            m_lspServer->updateProjectData(m_projectData, m_project.codeLinks());
         QJsonObject reply;
         reply.insert(StringConstants::type(), QLatin1String("project-resolved"));
         if (success)
@@ -692,6 +1034,8 @@ void Session::releaseProject()
         m_currentJob->disconnect(this);
         m_currentJob->cancel();
         m_currentJob = nullptr;
+    } else if (m_resolveServer) {
+        m_resolveServer->keepProject(m_project, m_projectParameters);
     }
     m_project = Project();
     m_projectData = ProjectData();
@@ -834,6 +1178,10 @@ void Session::insertErrorInfoIfNecessary(QJsonObject &reply, const ErrorInfo &er
 
 void Session::quitSession()
 {
+    if (m_socket) {
+        m_socket->disconnectFromServer();
+        return;
+    }
     m_logSink.disconnect(this);
     m_packetReader.disconnect(this);
     if (m_currentJob) {
@@ -40,10 +40,13 @@
 #ifndef QBS_SESSION_H
 #define QBS_SESSION_H
 
+#include <QtCore/qstring.h>
+
 namespace qbs {
 namespace Internal {
 
 void startSession();
+void startResolveServer(const QString &name);
 
 } // namespace Internal
 } // namespace qbs
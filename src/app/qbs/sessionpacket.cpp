@@ -99,8 +99,8 @@ QJsonObject SessionPacket::helloMessage(const QString &lspSocket)
 {
     return QJsonObject{
         {StringConstants::type(), QLatin1String("hello")},
-        {QLatin1String("api-level"), 9},
-        {QLatin1String("api-compat-level"), 2},
+        {QLatin1String("api-level"), apiLevel},
+        {QLatin1String("api-compat-level"), apiCompatLevel},
         {QLatin1String("lsp-socket"), lspSocket}};
 }
 
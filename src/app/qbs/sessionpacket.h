@@ -57,6 +57,9 @@ public:
     static QByteArray createPacket(const QJsonObject &packet);
     static QJsonObject helloMessage(const QString &lspSocket);
 
+    static constexpr int apiLevel = 9;
+    static constexpr int apiCompatLevel = 2;
+
 private:
     bool isComplete() const;
 
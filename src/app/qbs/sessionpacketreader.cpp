@@ -42,6 +42,7 @@
 #include "sessionpacket.h"
 #include "stdinreader.h"
 
+#include <QIODevice>
 #include <QPointer>
 
 namespace qbs {
@@ -65,28 +66,40 @@ void SessionPacketReader::start()
 {
     StdinReader * const stdinReader = StdinReader::create(this);
     connect(stdinReader, &StdinReader::errorOccurred, this, &SessionPacketReader::errorOccurred);
-    connect(stdinReader, &StdinReader::dataAvailable, this, [this](const QByteArray &data) {
-        /* Because this SessionPacketReader can be destroyed in the emit packetReceived,
-         * use a `QPointer self(this)` to check whether this instance still exists.
-         * When self evaluates to false, this instance should no longer be referenced,
-         * so the parent QObject and d should no longer be used in any way. */
-        QPointer self(this);
-        d->incomingData += data;
-        while (self && !d->incomingData.isEmpty()) {
-            switch (d->currentPacket.parseInput(d->incomingData)) {
-            case SessionPacket::Status::Invalid:
-                emit errorOccurred(tr("Received invalid input."));
-                return;
-            case SessionPacket::Status::Complete:
-                emit packetReceived(d->currentPacket.retrievePacket());
-                break;
-            case SessionPacket::Status::Incomplete:
-                return;
-            }
-        }
-    });
+    connect(stdinReader, &StdinReader::dataAvailable, this, &SessionPacketReader::handleData);
     stdinReader->start();
 }
 
+void SessionPacketReader::start(QIODevice *device)
+{
+    connect(device, &QIODevice::readyRead, this, [this, device] {
+        handleData(device->readAll());
+    });
+    if (device->bytesAvailable() > 0)
+        handleData(device->readAll());
+}
+
+void SessionPacketReader::handleData(const QByteArray &data)
+{
+    /* Because this SessionPacketReader can be destroyed in the emit packetReceived,
+     * use a `QPointer self(this)` to check whether this instance still exists.
+     * When self evaluates to false, this instance should no longer be referenced,
+     * so the parent QObject and d should no longer be used in any way. */
+    QPointer self(this);
+    d->incomingData += data;
+    while (self && !d->incomingData.isEmpty()) {
+        switch (d->currentPacket.parseInput(d->incomingData)) {
+        case SessionPacket::Status::Invalid:
+            emit errorOccurred(tr("Received invalid input."));
+            return;
+        case SessionPacket::Status::Complete:
+            emit packetReceived(d->currentPacket.retrievePacket());
+            break;
+        case SessionPacket::Status::Incomplete:
+            return;
+        }
+    }
+}
+
 } // namespace Internal
 } // namespace qbs
@@ -45,6 +45,10 @@
 
 #include <memory>
 
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
 namespace qbs {
 namespace Internal {
 
@@ -55,13 +59,16 @@ public:
     explicit SessionPacketReader(QObject *parent = nullptr);
     ~SessionPacketReader() override;
 
-    void start();
+    void start(); // Reads from stdin.
+    void start(QIODevice *device);
 
 signals:
     void packetReceived(const QJsonObject &packet);
     void errorOccurred(const QString &msg);
 
 private:
+    void handleData(const QByteArray &data);
+
     class Private;
     const std::unique_ptr<Private> d;
 };
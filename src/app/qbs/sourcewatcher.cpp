@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include "sourcewatcher.h"
+
+#include <tools/fileinfo.h>
+
+namespace qbs {
+namespace Internal {
+
+SourceWatcher::SourceWatcher(QObject *parent) : QObject(parent)
+{
+    m_notificationTimer.setSingleShot(true);
+    m_notificationTimer.setInterval(200);
+    connect(&m_notificationTimer, &QTimer::timeout, this, [this] {
+        QStringList changedFiles(m_changedFiles.cbegin(), m_changedFiles.cend());
+        m_changedFiles.clear();
+        changedFiles.sort();
+        emit filesChanged(changedFiles);
+    });
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged,
+            this, &SourceWatcher::handleFileChanged);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &SourceWatcher::handleDirectoryChanged);
+}
+
+// Only the difference to the current set is applied, as re-registering all files
+// after every build would be expensive for large projects.
+void SourceWatcher::setFiles(const std::set<QString> &filePaths)
+{
+    QStringList obsoleteFiles;
+    for (const QString &filePath : std::as_const(m_watchedFiles)) {
+        if (filePaths.find(filePath) == filePaths.cend())
+            obsoleteFiles << filePath;
+    }
+    for (const QString &filePath : std::as_const(obsoleteFiles))
+        m_watchedFiles.remove(filePath);
+    if (!obsoleteFiles.isEmpty())
+        m_watcher.removePaths(obsoleteFiles);
+
+    QHash<QString, QStringList> filesPerDirectory;
+    for (const QString &filePath : filePaths) {
+        filesPerDirectory[FileInfo::path(filePath)] << filePath;
+        if (!m_watchedFiles.contains(filePath))
+            watchFile(filePath);
+    }
+
+    // The directories are watched too, so that files can be picked up again after
+    // an editor has replaced them or they have been removed and re-created.
+    QStringList obsoleteDirs;
+    QStringList newDirs;
+    for (auto it = m_filesPerDirectory.cbegin(); it != m_filesPerDirectory.cend(); ++it) {
+        if (!filesPerDirectory.contains(it.key()))
+            obsoleteDirs << it.key();
+    }
+    for (auto it = filesPerDirectory.cbegin(); it != filesPerDirectory.cend(); ++it) {
+        if (!m_filesPerDirectory.contains(it.key()))
+            newDirs << it.key();
+    }
+    if (!obsoleteDirs.isEmpty())
+        m_watcher.removePaths(obsoleteDirs);
+    if (!newDirs.isEmpty())
+        m_watcher.addPaths(newDirs);
+    m_filesPerDirectory = std::move(filesPerDirectory);
+}
+
+void SourceWatcher::watchFile(const QString &filePath)
+{
+    if (FileInfo::exists(filePath) && m_watcher.addPath(filePath))
+        m_watchedFiles.insert(filePath);
+}
+
+void SourceWatcher::handleFileChanged(const QString &filePath)
+{
+    // If the file was replaced, the watch refers to the old one.
+    m_watcher.removePath(filePath);
+    m_watchedFiles.remove(filePath);
+    watchFile(filePath);
+    reportChange(filePath);
+}
+
+void SourceWatcher::handleDirectoryChanged(const QString &dirPath)
+{
+    const QStringList filePaths = m_filesPerDirectory.value(dirPath);
+    for (const QString &filePath : filePaths) {
+        if (m_watchedFiles.contains(filePath))
+            continue;
+        watchFile(filePath);
+        if (m_watchedFiles.contains(filePath))
+            reportChange(filePath);
+    }
+}
+
+void SourceWatcher::reportChange(const QString &filePath)
+{
+    m_changedFiles.insert(filePath);
+    m_notificationTimer.start();
+}
+
+} // namespace Internal
+} // namespace qbs
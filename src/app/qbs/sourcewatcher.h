@@ -0,0 +1,84 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#ifndef QBS_SOURCEWATCHER_H
+#define QBS_SOURCEWATCHER_H
+
+#include <QtCore/qfilesystemwatcher.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qset.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qtimer.h>
+
+#include <set>
+
+namespace qbs {
+namespace Internal {
+
+// Reports modifications of a set of files. Changes happening in quick succession are
+// combined into one notification. On Linux, QFileSystemWatcher is backed by inotify,
+// so no polling is involved.
+class SourceWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SourceWatcher(QObject *parent = nullptr);
+
+    void setFiles(const std::set<QString> &filePaths);
+
+signals:
+    void filesChanged(const QStringList &filePaths);
+
+private:
+    void watchFile(const QString &filePath);
+    void handleFileChanged(const QString &filePath);
+    void handleDirectoryChanged(const QString &dirPath);
+    void reportChange(const QString &filePath);
+
+    QFileSystemWatcher m_watcher;
+    QTimer m_notificationTimer;
+    QHash<QString, QStringList> m_filesPerDirectory;
+    QSet<QString> m_watchedFiles;
+    QSet<QString> m_changedFiles;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // Include guard
@@ -43,6 +43,7 @@
 #include <buildgraph/artifactcleaner.h>
 #include <buildgraph/buildgraph.h>
 #include <buildgraph/buildgraphloader.h>
+#include <buildgraph/buildstatefingerprint.h>
 #include <buildgraph/productbuilddata.h>
 #include <buildgraph/projectbuilddata.h>
 #include <buildgraph/executor.h>
@@ -51,6 +52,7 @@
 #include <language/language.h>
 #include <language/scriptengine.h>
 #include <loader/projectresolver.h>
+#include <logging/categories.h>
 #include <logging/logger.h>
 #include <logging/translator.h>
 #include <tools/buildgraphlocker.h>
@@ -60,6 +62,7 @@
 #include <tools/preferences.h>
 #include <tools/qbsassert.h>
 
+#include <QtCore/qdir.h>
 #include <QtCore/qtimer.h>
 
 #include <mutex>
@@ -138,6 +141,8 @@ InternalJob::InternalJob(Logger logger, QObject *parent)
 
 InternalJob::~InternalJob()
 {
+    if (m_recordingTrace)
+        TraceRecorder::instance().stopRecording();
     if (m_ownsObserver)
         delete m_observer;
 }
@@ -156,21 +161,92 @@ void InternalJob::shareObserverWith(InternalJob *otherJob)
     m_observer = otherJob->m_observer;
 }
 
+void InternalJob::setTraceFilePath(const QString &filePath, TraceRecorder::StartMode startMode)
+{
+    QBS_CHECK(!m_recordingTrace);
+    m_traceFilePath = filePath;
+    if (filePath.isEmpty())
+        return;
+    TraceRecorder::instance().startRecording(startMode);
+    m_recordingTrace = true;
+}
+
+// The recorder accumulates the events of all jobs running in parallel, so the file written by
+// the last of them contains the complete timeline.
+void InternalJob::writeTraceFile()
+{
+    if (!m_recordingTrace)
+        return;
+    TraceRecorder &recorder = TraceRecorder::instance();
+    recorder.stopRecording();
+    m_recordingTrace = false;
+    QString errorMessage;
+    if (!recorder.writeToFile(m_traceFilePath, &errorMessage)) {
+        m_logger.qbsWarning() << Tr::tr("Failed to write trace file '%1': %2")
+                                 .arg(QDir::toNativeSeparators(m_traceFilePath), errorMessage);
+    }
+}
+
+static void storeProject(TopLevelProject *project, const Logger &logger, bool timed)
+{
+    TimedActivityLogger storeTimer(logger, Tr::tr("Storing build graph"), timed);
+    TraceSpan storeSpan(Tr::tr("Storing build graph"), "buildgraph");
+    project->store(logger);
+}
+
 void InternalJob::storeBuildGraph(const TopLevelProjectPtr &project)
 {
     try {
         doSanityChecks(project, logger());
-        TimedActivityLogger storeTimer(m_logger, Tr::tr("Storing build graph"), timed());
-        project->store(logger());
+        storeProject(project.get(), logger(), timed());
     } catch (const ErrorInfo &error) {
-        ErrorInfo fullError = this->error();
-        const auto items = error.items();
-        for (const ErrorItem &item : items)
-            fullError.append(item);
-        setError(fullError);
+        appendError(error);
     }
 }
 
+// The job does not wait for the store, so its errors are printed instead of becoming part
+// of the job's result. The project waits for the store before it gets touched again
+// and before it releases the build graph lock. The parameter of afterStoring tells whether
+// the store has succeeded.
+void InternalJob::startStoringBuildGraph(const TopLevelProjectPtr &project,
+                                         const std::function<void(bool)> &afterStoring)
+{
+    ErrorInfo sanityCheckError;
+    try {
+        doSanityChecks(project, logger());
+    } catch (const ErrorInfo &error) {
+        sanityCheckError = error;
+    }
+
+    // The project owns the pending operation, so it must not be kept alive by it.
+    TopLevelProject * const rawProject = project.get();
+    Logger storeLogger = logger(); // Printing errors is not const.
+    const bool storeTimed = timed();
+    project->storeInBackground([rawProject, sanityCheckError, storeLogger, storeTimed,
+                                afterStoring]() mutable {
+        bool stored = false;
+        try {
+            if (sanityCheckError.hasError())
+                throw sanityCheckError;
+            storeProject(rawProject, storeLogger, storeTimed);
+            stored = true;
+        } catch (const ErrorInfo &error) {
+            storeLogger.printError(error);
+        }
+        if (afterStoring)
+            afterStoring(stored);
+    });
+}
+
+void InternalJob::appendError(const ErrorInfo &error)
+{
+    ErrorInfo fullError = this->error();
+    const auto items = error.items();
+    for (const ErrorItem &item : items)
+        fullError.append(item);
+    setError(fullError);
+}
+
 
 /**
  * Construct a new thread wrapper for a synchronous job.
@@ -235,6 +311,7 @@ void InternalSetupProjectJob::init(const TopLevelProjectPtr &existingProject,
     m_existingProject = existingProject;
     m_parameters = parameters;
     setTimed(parameters.logElapsedTime());
+    setTraceFilePath(parameters.traceFilePath(), TraceRecorder::StartMode::NewTrace);
 }
 
 void InternalSetupProjectJob::reportError(const ErrorInfo &error)
@@ -250,6 +327,9 @@ TopLevelProjectPtr InternalSetupProjectJob::project() const
 
 void InternalSetupProjectJob::start()
 {
+    // A build job might still be storing the existing project.
+    if (m_existingProject)
+        m_existingProject->waitForPendingStore();
     BuildGraphLocker *bgLocker = m_existingProject ? m_existingProject->bgLocker : nullptr;
     bool deleteLocker = false;
     try {
@@ -262,11 +342,18 @@ void InternalSetupProjectJob::start()
                 = TopLevelProject::deriveBuildDirectory(m_parameters.buildRoot(), projectId);
         if (m_existingProject && m_existingProject->buildDirectory != buildDir)
             m_existingProject.reset();
-        if (!m_existingProject) {
+        if (!m_existingProject || !bgLocker) {
             bgLocker = new BuildGraphLocker(ProjectBuildData::deriveBuildGraphFilePath(buildDir,
                                                                                        projectId),
                                            logger(), m_parameters.waitLockBuildGraph(), observer());
             deleteLocker = true;
+            if (m_existingProject && m_existingProject->buildGraphChangedSinceLockRelease()) {
+                qCDebug(lcBuildGraph) << "build graph was changed by another process, "
+                                         "not using the project in memory";
+                m_existingProject.reset();
+            } else if (m_existingProject) {
+                qCDebug(lcBuildGraph) << "build graph is unchanged, using the project in memory";
+            }
         }
         execute();
         if (m_existingProject) {
@@ -284,11 +371,14 @@ void InternalSetupProjectJob::start()
         if (deleteLocker)
             delete bgLocker;
     }
+    writeTraceFile();
     emit finished(this);
 }
 
 void InternalSetupProjectJob::execute()
 {
+    TraceSpan setupSpan(Tr::tr("Setting up project"), "resolve");
+    setupSpan.addArgument(QStringLiteral("configuration"), m_parameters.configurationName());
     RulesEvaluationContextPtr evalContext(new RulesEvaluationContext(logger()));
     evalContext->setObserver(observer());
 
@@ -375,6 +465,9 @@ void InternalBuildJob::build(const TopLevelProjectPtr &project,
 {
     setup(project, products, buildOptions.dryRun());
     setTimed(buildOptions.logElapsedTime());
+    setTraceFilePath(buildOptions.traceFilePath(), TraceRecorder::StartMode::ContinueTrace);
+
+    m_buildOptions = buildOptions;
 
     m_executor = new Executor(logger());
     m_executor->setProject(project);
@@ -390,25 +483,77 @@ void InternalBuildJob::build(const TopLevelProjectPtr &project,
             this, &BuildGraphTouchingJob::reportProcessResult);
 
     connect(executorThread, &QThread::started, m_executor, &Executor::build);
+    connect(m_executor, &Executor::buildGraphComplete,
+            this, &InternalBuildJob::startStoringBuildGraph, Qt::DirectConnection);
     connect(m_executor, &Executor::finished, this, &InternalBuildJob::handleFinished);
     connect(m_executor, &QObject::destroyed, executorThread, &QThread::quit);
     connect(executorThread, &QThread::finished, this, &InternalBuildJob::emitFinished);
     executorThread->start();
 }
 
+// Called in the executor thread. Storing the build graph then happens concurrently with
+// what the executor does after building, e.g. waiting for remote cache uploads, and with
+// the reporting of the build result.
+void InternalBuildJob::startStoringBuildGraph()
+{
+    if (dryRun() || m_executor->error().isInternalError())
+        return;
+
+    // The executor keeps its own reference until it gets deleted.
+    project()->buildData->evaluationContext.reset();
+
+    // Collecting the data for the fingerprint involves looking at lots of files, so it
+    // happens in the background as well. The job might be gone by the time it does.
+    const bool success = !m_executor->error().hasError();
+    InternalJob::startStoringBuildGraph(project(), [project = project().get(),
+                                                    products = products(),
+                                                    options = m_buildOptions,
+                                                    logger = logger(), success](bool stored) {
+        if (success && stored)
+            writeBuildStateFingerprint(*project, products, options, logger);
+        else
+            BuildStateFingerprint::remove(project->buildGraphFilePath());
+    });
+    m_storingStarted = true;
+}
+
 void InternalBuildJob::handleFinished()
 {
     setError(m_executor->error());
-    project()->buildData->evaluationContext.reset();
-    storeBuildGraph();
+    if (!m_storingStarted) {
+        project()->buildData->evaluationContext.reset();
+        storeBuildGraph();
+    }
     m_executor->deleteLater();
 }
 
+// If the build graph is being stored, the result is reported right away. The store
+// has taken care of the fingerprint then.
 void InternalBuildJob::emitFinished()
 {
+    if (!m_storingStarted)
+        BuildStateFingerprint::remove(project()->buildGraphFilePath());
+    writeTraceFile();
+
+    // A build concludes a trace, so its events are not needed anymore.
+    TraceRecorder::instance().clearEvents();
     emit finished(this);
 }
 
+// Must happen after the build graph was stored, as storing it removes the fingerprint.
+void InternalBuildJob::writeBuildStateFingerprint(const TopLevelProject &project,
+                                                  const QVector<ResolvedProductPtr> &products,
+                                                  const BuildOptions &options,
+                                                  const Logger &logger)
+{
+    try {
+        BuildStateFingerprint::write(project, products, options, logger);
+    } catch (const ErrorInfo &error) {
+        qCDebug(lcBuildGraph) << "failed to write build state fingerprint:" << error.toString();
+        BuildStateFingerprint::remove(project.buildGraphFilePath());
+    }
+}
+
 InternalCleanJob::InternalCleanJob(const Logger &logger, QObject *parent)
     : BuildGraphTouchingJob(logger, parent)
 {
@@ -46,12 +46,15 @@
 #include <tools/cleanoptions.h>
 #include <tools/installoptions.h>
 #include <tools/error.h>
+#include <tools/profiling.h>
 #include <tools/setupprojectparameters.h>
 
 #include <QtCore/qlist.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qthread.h>
 
+#include <functional>
+
 namespace qbs {
 class ProcessResult;
 class Settings;
@@ -84,7 +87,11 @@ protected:
 
     JobObserver *observer() const { return m_observer; }
     void setTimed(bool timed) { m_timed = timed; }
+    void setTraceFilePath(const QString &filePath, TraceRecorder::StartMode startMode);
+    void writeTraceFile();
     void storeBuildGraph(const TopLevelProjectPtr &project);
+    void startStoringBuildGraph(const TopLevelProjectPtr &project,
+                                const std::function<void(bool)> &afterStoring = {});
 
 signals:
     void finished(Internal::InternalJob *job);
@@ -94,10 +101,14 @@ signals:
     void reportCommandDescription(const QString &highlight, const QString &message);
 
 private:
+    void appendError(const ErrorInfo &error);
+
     ErrorInfo m_error;
     JobObserver *m_observer;
     bool m_ownsObserver;
     Logger m_logger;
+    QString m_traceFilePath;
+    bool m_recordingTrace = false;
     bool m_timed;
 };
 
@@ -165,6 +176,7 @@ protected:
     void setup(const TopLevelProjectPtr &project, const QVector<ResolvedProductPtr> &products,
                bool dryRun);
     void storeBuildGraph();
+    bool dryRun() const { return m_dryRun; }
 
 private:
     TopLevelProjectPtr m_project;
@@ -183,10 +195,16 @@ public:
                const BuildOptions &buildOptions);
 
 private:
+    void startStoringBuildGraph();
     void handleFinished();
     void emitFinished();
+    static void writeBuildStateFingerprint(const TopLevelProject &project,
+                                           const QVector<ResolvedProductPtr> &products,
+                                           const BuildOptions &options, const Logger &logger);
 
     Executor *m_executor;
+    BuildOptions m_buildOptions;
+    bool m_storingStarted = false;
 };
 
 
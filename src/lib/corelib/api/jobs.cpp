@@ -138,6 +138,9 @@ bool AbstractJob::lockProject(const TopLevelProjectPtr &project)
     }
     project->locked = true;
     m_project = project;
+
+    // The previous build job might have finished before its build graph was stored.
+    project->waitForPendingStore();
     return true;
 }
 
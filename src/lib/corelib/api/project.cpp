@@ -50,6 +50,7 @@
 #include <buildgraph/artifact.h>
 #include <buildgraph/buildgraph.h>
 #include <buildgraph/buildgraphloader.h>
+#include <buildgraph/buildstatefingerprint.h>
 #include <buildgraph/emptydirectoriesremover.h>
 #include <buildgraph/nodetreedumper.h>
 #include <buildgraph/productbuilddata.h>
@@ -68,6 +69,7 @@
 #include <tools/error.h>
 #include <tools/fileinfo.h>
 #include <tools/installoptions.h>
+#include <tools/persistence.h>
 #include <tools/preferences.h>
 #include <tools/processresult.h>
 #include <tools/qbspluginmanager.h>
@@ -130,6 +132,7 @@ ProjectData ProjectPrivate::projectData()
 BuildJob *ProjectPrivate::buildProducts(
     const QVector<ResolvedProductPtr> &products, const BuildOptions &options, QObject *jobOwner)
 {
+    internalProject->restoreBuildData(rangeTo<std::vector<ResolvedProductPtr>>(products));
     const auto job = new BuildJob(logger, jobOwner);
     job->build(internalProject, products, options);
     QBS_ASSERT(job->state() == AbstractJob::StateRunning,);
@@ -139,6 +142,7 @@ BuildJob *ProjectPrivate::buildProducts(
 CleanJob *ProjectPrivate::cleanProducts(const QVector<ResolvedProductPtr> &products,
         const CleanOptions &options, QObject *jobOwner)
 {
+    internalProject->restoreBuildData(rangeTo<std::vector<ResolvedProductPtr>>(products));
     const auto job = new CleanJob(logger, jobOwner);
     job->clean(internalProject, products, options);
     QBS_ASSERT(job->state() == AbstractJob::StateRunning,);
@@ -148,6 +152,7 @@ CleanJob *ProjectPrivate::cleanProducts(const QVector<ResolvedProductPtr> &produ
 InstallJob *ProjectPrivate::installProducts(
     const QVector<ResolvedProductPtr> &products, const InstallOptions &options, QObject *jobOwner)
 {
+    internalProject->restoreBuildData(rangeTo<std::vector<ResolvedProductPtr>>(products));
     const auto job = new InstallJob(logger, jobOwner);
     job->install(internalProject, products, options);
     QBS_ASSERT(job->state() == AbstractJob::StateRunning,);
@@ -525,6 +530,7 @@ void ProjectPrivate::prepareChangeToProject()
 {
     if (internalProject->locked)
         throw ErrorInfo(Tr::tr("A job is currently in progress."));
+    internalProject->waitForPendingStore();
     if (!m_projectData.isValid())
         retrieveProjectData(m_projectData, internalProject);
 }
@@ -565,11 +571,12 @@ RuleCommandList ProjectPrivate::ruleCommands(const ProductData &product,
 {
     if (internalProject->locked)
         throw ErrorInfo(Tr::tr("A job is currently in progress."));
-    const ResolvedProductConstPtr resolvedProduct = internalProduct(product);
+    const ResolvedProductPtr resolvedProduct = internalProduct(product);
     if (!resolvedProduct)
         throw ErrorInfo(Tr::tr("No such product '%1'.").arg(product.name()));
     if (!resolvedProduct->enabled)
         throw ErrorInfo(Tr::tr("Product '%1' is disabled.").arg(product.name()));
+    internalProject->restoreBuildData({resolvedProduct});
     QBS_CHECK(resolvedProduct->buildData);
     const ArtifactSet &outputArtifacts = resolvedProduct->buildData->artifactsByFileTag()
             .value(FileTag(outputFileTag.toLocal8Bit()));
@@ -589,6 +596,7 @@ RuleCommandList ProjectPrivate::ruleCommands(const ProductData &product,
 
 ProjectTransformerData ProjectPrivate::transformerData()
 {
+    internalProject->restoreAllBuildData();
     if (!m_projectData.isValid())
         retrieveProjectData(m_projectData, internalProject);
     ProjectTransformerData projectTransformerData;
@@ -949,8 +957,45 @@ InstallJob *Project::installOneProduct(const ProductData &product, const Install
 void Project::updateTimestamps(const QList<ProductData> &products)
 {
     QBS_ASSERT(isValid(), return);
-    TimestampsUpdater().updateTimestamps(d->internalProject, d->internalProducts(products),
-                                         d->logger);
+    const QVector<ResolvedProductPtr> internalProducts = d->internalProducts(products);
+    d->internalProject->restoreBuildData(
+                rangeTo<std::vector<ResolvedProductPtr>>(internalProducts));
+    TimestampsUpdater().updateTimestamps(d->internalProject, internalProducts, d->logger);
+}
+
+/*!
+ * \brief Lets other processes use the build directory, while keeping the project in memory.
+ * Passing this project to a later call of setupProject() acquires the lock again. If the
+ * build graph was changed on disk in the meantime, the project in memory is not used then.
+ * No other operations must be done on a project whose lock has been released.
+ */
+void Project::releaseBuildGraphLock()
+{
+    QBS_ASSERT(isValid(), return);
+    QBS_ASSERT(!d->internalProject->locked, return);
+    d->internalProject->releaseBuildGraphLock();
+}
+
+/*!
+ * \brief Returns true if another process has changed the stored build graph since
+ * releaseBuildGraphLock() was called. The project in memory is outdated then.
+ */
+bool Project::buildGraphChangedSinceLockRelease() const
+{
+    QBS_ASSERT(isValid(), return true);
+    return d->internalProject->buildGraphChangedSinceLockRelease();
+}
+
+/*!
+ * \brief Returns the files in which the build graph of this project is stored.
+ * These are the files to watch in order to find out whether another process has changed
+ * the build graph.
+ */
+std::set<QString> Project::buildGraphFiles() const
+{
+    QBS_ASSERT(isValid(), return {});
+    const QString filePath = d->internalProject->buildGraphFilePath();
+    return {filePath, PersistentPool::journalFilePath(filePath)};
 }
 
 /*!
@@ -964,7 +1009,8 @@ QStringList Project::generatedFiles(const ProductData &product, const QString &f
                                     bool recursive, const QStringList &tags) const
 {
     QBS_ASSERT(isValid(), return {});
-    const ResolvedProductConstPtr internalProduct = d->internalProduct(product);
+    const ResolvedProductPtr internalProduct = d->internalProduct(product);
+    d->internalProject->restoreBuildData({internalProduct});
     return internalProduct->generatedFiles(file, recursive, FileTags::fromStringList(tags));
 }
 
@@ -980,6 +1026,32 @@ std::set<QString> Project::buildSystemFiles() const
     return rangeTo<std::set<QString>>(d->internalProject->buildSystemFiles);
 }
 
+/*!
+ * \brief Returns the files that a build of this project reads, apart from the build system files.
+ * These are the source files of all products and the files found by dependency scanners,
+ * i.e. the files whose timestamps are checked at the start of a build.
+ */
+std::set<QString> Project::buildInputFiles() const
+{
+    QBS_ASSERT(isValid(), return {});
+    d->internalProject->restoreAllBuildData();
+    std::set<QString> filePaths;
+    for (const ResolvedProductPtr &product : d->internalProject->allProducts()) {
+        if (!product->buildData)
+            continue;
+        for (const Artifact * const artifact
+             : filterByType<Artifact>(product->buildData->allNodes())) {
+            if (artifact->artifactType == Artifact::SourceFile)
+                filePaths.insert(artifact->filePath());
+        }
+    }
+    if (d->internalProject->buildData) {
+        for (const FileDependency * const dep : d->internalProject->buildData->fileDependencies)
+            filePaths.insert(dep->filePath());
+    }
+    return filePaths;
+}
+
 CodeLinks Project::codeLinks() const
 {
     QBS_ASSERT(isValid(), return {});
@@ -1016,7 +1088,10 @@ ProjectTransformerData Project::transformerData(ErrorInfo *error) const
 ErrorInfo Project::dumpNodesTree(QIODevice &outDevice, const QList<ProductData> &products)
 {
     try {
-        NodeTreeDumper(outDevice).start(d->internalProducts(products));
+        const QVector<ResolvedProductPtr> internalProducts = d->internalProducts(products);
+        d->internalProject->restoreBuildData(
+                    rangeTo<std::vector<ResolvedProductPtr>>(internalProducts));
+        NodeTreeDumper(outDevice).start(internalProducts);
     } catch (const ErrorInfo &e) {
         return e;
     }
@@ -1061,6 +1136,36 @@ Project::BuildGraphInfo Project::getBuildGraphInfo(const QString &bgFilePath,
     return info;
 }
 
+/*!
+ * \brief Returns true if building all products of the project described by \c parameters
+ *        is known to have nothing to do, without setting up the project.
+ * This is the case if the last build of these products succeeded and nothing it depended on
+ * has changed since then. A return value of \c false does not mean that anything needs to be
+ * done, only that the project has to be set up and built to find out.
+ */
+bool Project::isKnownToBeUpToDate(const SetupProjectParameters &parameters,
+                                  const BuildOptions &options, ProductSelection productSelection,
+                                  ILogSink *logSink)
+{
+    SetupProjectParameters params = parameters;
+    if (params.restoreBehavior() != SetupProjectParameters::RestoreAndTrackChanges
+            || params.overrideBuildGraphData() || params.forceProbeExecution()
+            || params.dryRun()) {
+        return false;
+    }
+    try {
+        if (params.expandBuildConfiguration().hasError())
+            return false;
+        if (!params.projectFilePath().isEmpty())
+            params.finalizeProjectFilePath();
+        return BuildStateFingerprint::matches(params, options,
+                                              productSelection == ProductSelectionWithNonDefault,
+                                              Logger(logSink));
+    } catch (const ErrorInfo &) {
+        return false;
+    }
+}
+
 Project::BuildGraphInfo Project::getBuildGraphInfo() const
 {
     QBS_ASSERT(isValid(), return {});
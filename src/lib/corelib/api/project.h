@@ -127,6 +127,9 @@ public:
                                   QObject *jobOwner = nullptr) const;
 
     void updateTimestamps(const QList<ProductData> &products);
+    void releaseBuildGraphLock();
+    bool buildGraphChangedSinceLockRelease() const;
+    std::set<QString> buildGraphFiles() const;
 
     bool operator==(const Project &other) const { return d.data() == other.d.data(); }
 
@@ -136,6 +139,7 @@ public:
     QVariantMap projectConfiguration() const;
 
     std::set<QString> buildSystemFiles() const;
+    std::set<QString> buildInputFiles() const;
     CodeLinks codeLinks() const;
 
     RuleCommandList ruleCommands(const ProductData &product, const QString &inputFilePath,
@@ -160,6 +164,11 @@ public:
     // Use with loaded project. Does not set requestedProperties.
     BuildGraphInfo getBuildGraphInfo() const;
 
+    static bool isKnownToBeUpToDate(const SetupProjectParameters &parameters,
+                                    const BuildOptions &options,
+                                    ProductSelection productSelection,
+                                    ILogSink *logSink);
+
 
     ErrorInfo addGroup(const ProductData &product, const QString &groupName);
     ErrorInfo addFiles(const ProductData &product, const GroupData &group,
@@ -0,0 +1,608 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "actioncache.h"
+
+#include "artifact.h"
+#include "remoteactioncache.h"
+#include "rulecommands.h"
+#include "transformer.h"
+
+#include <language/language.h>
+#include <logging/categories.h>
+#include <logging/translator.h>
+#include <tools/executablefinder.h>
+#include <tools/fileinfo.h>
+#include <tools/persistence.h>
+#include <tools/processresult.h>
+#include <tools/processresult_p.h>
+#include <tools/stringconstants.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qdiriterator.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qtemporarydir.h>
+
+#include <algorithm>
+
+#if defined(Q_OS_UNIX)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(Q_OS_LINUX)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace qbs {
+namespace Internal {
+
+static const char actionCacheMagic[] = "QBSACTIONCACHE-2";
+static const char actionCacheBlobMagic[] = "QBSACTIONCACHEBLOB-1";
+
+// Replaces the build and source directories with placeholders, so that the same action
+// in a different build directory or checkout maps to the same cache entry.
+class PathNormalizer
+{
+public:
+    explicit PathNormalizer(const ActionCache::Action &action)
+    {
+        m_replacements.emplace_back(action.buildDirectory, QStringLiteral("<build-dir>"));
+        m_replacements.emplace_back(action.sourceDirectory, QStringLiteral("<source-dir>"));
+    }
+
+    // Only whole paths are replaced, so that e.g. a sibling directory of the build directory
+    // whose name starts with that of the build directory is left alone.
+    QString normalize(QString s) const
+    {
+        for (const auto &[path, placeholder] : m_replacements) {
+            if (path.isEmpty())
+                continue;
+            for (qsizetype pos = s.indexOf(path); pos != -1; pos = s.indexOf(path, pos)) {
+                if (endsPath(s, pos + path.size())) {
+                    s.replace(pos, path.size(), placeholder);
+                    pos += placeholder.size();
+                } else {
+                    pos += path.size();
+                }
+            }
+        }
+        return s;
+    }
+
+    QStringList normalize(QStringList list) const
+    {
+        for (QString &s : list)
+            s = normalize(s);
+        return list;
+    }
+
+    QString denormalize(QString s) const
+    {
+        for (auto it = m_replacements.crbegin(); it != m_replacements.crend(); ++it) {
+            if (!it->first.isEmpty())
+                s.replace(it->second, it->first);
+        }
+        return s;
+    }
+
+    QStringList denormalize(QStringList list) const
+    {
+        for (QString &s : list)
+            s = denormalize(s);
+        return list;
+    }
+
+private:
+    // Whether a path ending at the given position of a command line string is complete.
+    static bool endsPath(const QString &s, qsizetype pos)
+    {
+        if (pos == s.size())
+            return true;
+        const QChar c = s.at(pos);
+        return c == QLatin1Char('/') || c == QLatin1Char('\\') || c == QLatin1Char(':')
+                || c == QLatin1Char(';') || c == QLatin1Char(',') || c == QLatin1Char('"')
+                || c == QLatin1Char('\'') || c.isSpace();
+    }
+
+    std::vector<std::pair<QString, QString>> m_replacements;
+};
+
+static QStringList sortedOutputFilePaths(const Transformer *transformer)
+{
+    QStringList filePaths;
+    for (const Artifact * const output : std::as_const(transformer->outputs))
+        filePaths << output->filePath();
+    filePaths.sort();
+    return filePaths;
+}
+
+static bool reflinkFile(const QString &sourceFilePath, const QString &targetFilePath)
+{
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+    const int sourceFd = ::open(QFile::encodeName(sourceFilePath).constData(),
+                                O_RDONLY | O_CLOEXEC);
+    if (sourceFd == -1)
+        return false;
+    bool success = false;
+    struct stat sourceStat;
+    if (::fstat(sourceFd, &sourceStat) == 0) {
+        const int targetFd = ::open(QFile::encodeName(targetFilePath).constData(),
+                                    O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                                    sourceStat.st_mode & 07777);
+        if (targetFd != -1) {
+            success = ::ioctl(targetFd, FICLONE, sourceFd) == 0;
+            ::close(targetFd);
+            if (!success)
+                QFile::remove(targetFilePath);
+        }
+    }
+    ::close(sourceFd);
+    return success;
+#else
+    Q_UNUSED(sourceFilePath)
+    Q_UNUSED(targetFilePath)
+    return false;
+#endif
+}
+
+static bool copyFile(const QString &sourceFilePath, const QString &targetFilePath)
+{
+    return reflinkFile(sourceFilePath, targetFilePath)
+            || QFile::copy(sourceFilePath, targetFilePath);
+}
+
+static const QFileDevice::Permissions writePermissions = QFileDevice::WriteOwner
+        | QFileDevice::WriteUser | QFileDevice::WriteGroup | QFileDevice::WriteOther;
+
+// Cached files are shared between build directories, so a tool that mistakenly writes to
+// one of them must fail rather than silently change the results of other builds.
+static bool makeReadOnly(const QString &filePath)
+{
+    return QFile::setPermissions(filePath, QFile::permissions(filePath) & ~writePermissions);
+}
+
+// Output files must never share their data with the cache entry, as commands of later
+// builds, which might not use the cache, are free to write to them. Copy-on-write clones
+// are fine, because they get their own data on the first write.
+static bool materializeFile(const QString &cachedFilePath, const QString &targetFilePath)
+{
+    QFile::remove(targetFilePath);
+    if (!copyFile(cachedFilePath, targetFilePath))
+        return false;
+    if (!QFile::setPermissions(targetFilePath, QFile::permissions(targetFilePath)
+                               | QFileDevice::WriteOwner | QFileDevice::WriteUser)) {
+        return false;
+    }
+
+    // To artifacts depending on it, the file must look as if it had just been created.
+#if defined(Q_OS_UNIX)
+    return ::utimensat(AT_FDCWD, QFile::encodeName(targetFilePath).constData(),
+                       nullptr, 0) == 0;
+#else
+    QFile file(targetFilePath);
+    return file.open(QIODevice::ReadWrite)
+            && file.setFileTime(QDateTime::currentDateTimeUtc(),
+                                QFileDevice::FileModificationTime);
+#endif
+}
+
+ActionCache::ActionCache(QString directory, qint64 maxSize, Logger logger)
+    : m_directory(std::move(directory)), m_maxSize(maxSize), m_logger(std::move(logger))
+{
+}
+
+ActionCache::~ActionCache() = default;
+
+void ActionCache::setRemoteCache(std::unique_ptr<RemoteActionCache> remoteCache)
+{
+    m_remoteCache = std::move(remoteCache);
+}
+
+std::optional<ActionCache::Action> ActionCache::actionForTransformer(
+        const Transformer *transformer)
+{
+    if (transformer->alwaysRun || transformer->commands.empty())
+        return {};
+    for (const Artifact * const output : std::as_const(transformer->outputs)) {
+        // Outputs that a transformer does not always create cannot be restored reliably.
+        if (!output->alwaysUpdated)
+            return {};
+    }
+
+    Action action;
+    const ResolvedProductPtr product = transformer->product();
+    const TopLevelProject * const project = product->topLevelProject();
+    action.buildDirectory = project->buildDirectory;
+    action.sourceDirectory = FileInfo::path(project->location.filePath());
+    action.outputFilePaths = sortedOutputFilePaths(transformer);
+    action.product = product;
+    action.environment = product->buildEnvironment;
+    const PathNormalizer normalizer(action);
+    QDataStream stream(&action.commandData, QIODevice::WriteOnly);
+    stream.setVersion(dataStreamVersion);
+    stream << QByteArray(actionCacheMagic) << QByteArray(QBS_VERSION)
+           << normalizer.normalize(action.outputFilePaths);
+
+    for (const AbstractCommandPtr &command : transformer->commands.commands()) {
+        // JavaScript commands can access arbitrary parts of the build graph while running,
+        // so their inputs cannot be known in advance.
+        if (command->type() != AbstractCommand::ProcessCommandType)
+            return {};
+        const auto cmd = static_cast<const ProcessCommand *>(command.get());
+        for (const QString &redirectionTarget : {cmd->stdoutFilePath(), cmd->stderrFilePath()}) {
+            if (!redirectionTarget.isEmpty()
+                    && !action.outputFilePaths.contains(redirectionTarget)) {
+                return {};
+            }
+        }
+        action.programs.emplace_back(cmd->program(), cmd->workingDir());
+        QStringList environment = cmd->environment().toStringList();
+        environment.sort();
+        stream << normalizer.normalize(cmd->program())
+               << normalizer.normalize(cmd->arguments())
+               << normalizer.normalize(cmd->workingDir()) << normalizer.normalize(environment)
+               << cmd->maxExitCode() << cmd->stdoutFilterFunction()
+               << cmd->stderrFilterFunction() << normalizer.normalize(cmd->stdoutFilePath())
+               << normalizer.normalize(cmd->stderrFilePath());
+        if (!cmd->stdoutFilterFunction().isEmpty() || !cmd->stderrFilterFunction().isEmpty())
+            stream << cmd->properties();
+        const QStringList relevantEnvVars = cmd->relevantEnvVars();
+        for (const QString &key : relevantEnvVars)
+            stream << key << normalizer.normalize(product->buildEnvironment.value(key));
+    }
+    stream << normalizer.normalize(
+                  product->buildEnvironment.value(StringConstants::pathEnvVar()));
+
+    for (const Artifact * const output : std::as_const(transformer->outputs)) {
+        for (const Artifact * const child : output->childArtifacts())
+            action.inputFilePaths << child->filePath();
+        for (const FileDependency * const fileDependency : output->fileDependencies)
+            action.inputFilePaths << fileDependency->filePath();
+    }
+    action.inputFilePaths.sort();
+    action.inputFilePaths.removeDuplicates();
+    return action;
+}
+
+QByteArray ActionCache::computeKey(const Action &action)
+{
+    const PathNormalizer normalizer(action);
+    QByteArray data = action.commandData;
+    QDataStream stream(&data, QIODevice::WriteOnly | QIODevice::Append);
+    stream.setVersion(dataStreamVersion);
+
+    // A tool that was updated in place must not hit entries created by its old version.
+    ExecutableFinder executableFinder(action.product, action.environment);
+    for (const auto &[program, workingDir] : action.programs) {
+        const QByteArray executableDigest
+                = fileDigest(executableFinder.findExecutable(program, workingDir));
+        if (executableDigest.isEmpty())
+            return {};
+        stream << executableDigest;
+    }
+
+    for (const QString &inputFilePath : action.inputFilePaths) {
+        const QByteArray digest = fileDigest(inputFilePath);
+        if (digest.isEmpty())
+            return {};
+        stream << normalizer.normalize(inputFilePath) << digest;
+    }
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex();
+}
+
+bool ActionCache::retrieve(const QByteArray &key, const Action &action,
+                           std::vector<ProcessResult> &results)
+{
+    const QString entryDir = entryDirPath(key);
+    QFile resultFile(entryDir + QLatin1String("/result"));
+    if (!resultFile.open(QIODevice::ReadOnly))
+        return false;
+
+    const PathNormalizer normalizer(action);
+    const QStringList &outputFilePaths = action.outputFilePaths;
+    QDataStream stream(&resultFile);
+    stream.setVersion(dataStreamVersion);
+    QByteArray magic;
+    QStringList storedOutputFilePaths;
+    qint32 resultCount = 0;
+    stream >> magic >> storedOutputFilePaths >> resultCount;
+    std::vector<ProcessResult> storedResults;
+    for (qint32 i = 0; i < resultCount && stream.status() == QDataStream::Ok; ++i) {
+        ProcessResult result;
+        result.d->success = true;
+        stream >> result.d->executableFilePath >> result.d->arguments
+               >> result.d->workingDirectory >> result.d->exitCode
+               >> result.d->stdOut >> result.d->stdErr;
+        result.d->executableFilePath = normalizer.denormalize(result.d->executableFilePath);
+        result.d->arguments = normalizer.denormalize(result.d->arguments);
+        result.d->workingDirectory = normalizer.denormalize(result.d->workingDirectory);
+        storedResults.push_back(result);
+    }
+    if (stream.status() != QDataStream::Ok || magic != actionCacheMagic
+            || storedOutputFilePaths != normalizer.normalize(outputFilePaths)) {
+        qCDebug(lcExec) << "ignoring invalid action cache entry" << entryDir;
+        return false;
+    }
+
+    for (int i = 0; i < outputFilePaths.size(); ++i) {
+        const QString cachedFilePath = entryDir + QLatin1String("/outputs/") + QString::number(i);
+        if (!materializeFile(cachedFilePath, outputFilePaths.at(i))) {
+            qCDebug(lcExec) << "failed to restore" << outputFilePaths.at(i)
+                            << "from action cache";
+            return false;
+        }
+    }
+
+    // The modification time of the result file is the basis for the LRU eviction.
+    resultFile.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+    results = std::move(storedResults);
+    ++m_hitCount;
+    return true;
+}
+
+ActionCache::PendingEntry ActionCache::prepareEntry(
+        const QByteArray &key, const Action &action, const std::vector<ProcessResult> &results)
+{
+    PendingEntry entry;
+    entry.key = key;
+    entry.outputFilePaths = action.outputFilePaths;
+    const PathNormalizer normalizer(action);
+    QDataStream stream(&entry.resultData, QIODevice::WriteOnly);
+    stream.setVersion(dataStreamVersion);
+    stream << QByteArray(actionCacheMagic) << normalizer.normalize(entry.outputFilePaths)
+           << qint32(results.size());
+    for (const ProcessResult &result : results) {
+        stream << normalizer.normalize(result.executableFilePath())
+               << normalizer.normalize(result.arguments())
+               << normalizer.normalize(result.workingDirectory()) << result.exitCode()
+               << result.stdOut() << result.stdErr();
+    }
+    return entry;
+}
+
+bool ActionCache::storeEntry(const PendingEntry &entry)
+{
+    const QString entryDir = entryDirPath(entry.key);
+    if (FileInfo::exists(entryDir))
+        return false; // Another build got there first.
+
+    const std::unique_ptr<QTemporaryDir> tempDir = createTemporaryEntryDir();
+    if (!tempDir)
+        return false;
+
+    for (int i = 0; i < entry.outputFilePaths.size(); ++i) {
+        const QString &outputFilePath = entry.outputFilePaths.at(i);
+        const QString cachedFilePath
+                = tempDir->path() + QLatin1String("/outputs/") + QString::number(i);
+        if (!copyFile(outputFilePath, cachedFilePath) || !makeReadOnly(cachedFilePath)) {
+            qCDebug(lcExec) << "cannot store" << outputFilePath << "in action cache";
+            return false;
+        }
+    }
+
+    QFile resultFile(tempDir->path() + QLatin1String("/result"));
+    if (!resultFile.open(QIODevice::WriteOnly) || resultFile.write(entry.resultData) == -1)
+        return false;
+    resultFile.close();
+    if (resultFile.error() != QFileDevice::NoError)
+        return false;
+
+    if (!commitEntry(*tempDir, entryDir))
+        return false;
+    ++m_storeCount;
+    return true;
+}
+
+void ActionCache::uploadEntry(const QByteArray &key, const QByteArray &data)
+{
+    if (m_remoteCache && !data.isEmpty() && m_remoteCache->store(key, data))
+        ++m_uploadCount;
+}
+
+QByteArray ActionCache::exportEntry(const QByteArray &key) const
+{
+    const QString entryDir = entryDirPath(key);
+    QFile resultFile(entryDir + QLatin1String("/result"));
+    if (!resultFile.open(QIODevice::ReadOnly))
+        return {};
+    const QDir outputsDir(entryDir + QLatin1String("/outputs"));
+    const qint32 outputCount = outputsDir.entryList(QDir::Files).size();
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(dataStreamVersion);
+    stream << QByteArray(actionCacheBlobMagic) << resultFile.readAll() << outputCount;
+    for (qint32 i = 0; i < outputCount; ++i) {
+        QFile outputFile(outputsDir.filePath(QString::number(i)));
+        if (!outputFile.open(QIODevice::ReadOnly))
+            return {};
+        stream << qint32(outputFile.permissions()) << outputFile.readAll();
+    }
+    return data;
+}
+
+bool ActionCache::importEntry(const QByteArray &key, const QByteArray &data)
+{
+    const QString entryDir = entryDirPath(key);
+    if (FileInfo::exists(entryDir))
+        return true;
+
+    QDataStream stream(data);
+    stream.setVersion(dataStreamVersion);
+    QByteArray magic;
+    QByteArray resultData;
+    qint32 outputCount = 0;
+    stream >> magic >> resultData >> outputCount;
+    if (stream.status() != QDataStream::Ok || magic != actionCacheBlobMagic) {
+        qCDebug(lcExec) << "ignoring invalid entry" << key << "from remote action cache";
+        return false;
+    }
+
+    const std::unique_ptr<QTemporaryDir> tempDir = createTemporaryEntryDir();
+    if (!tempDir)
+        return false;
+    QFile resultFile(tempDir->path() + QLatin1String("/result"));
+    if (!resultFile.open(QIODevice::WriteOnly) || resultFile.write(resultData) == -1)
+        return false;
+    resultFile.close();
+    for (qint32 i = 0; i < outputCount; ++i) {
+        qint32 permissions = 0;
+        QByteArray content;
+        stream >> permissions >> content;
+        if (stream.status() != QDataStream::Ok)
+            return false;
+        QFile outputFile(tempDir->path() + QLatin1String("/outputs/") + QString::number(i));
+        if (!outputFile.open(QIODevice::WriteOnly) || outputFile.write(content) == -1
+                || !outputFile.setPermissions(QFileDevice::Permissions(permissions)
+                                              & ~writePermissions)) {
+            return false;
+        }
+    }
+    return commitEntry(*tempDir, entryDir);
+}
+
+void ActionCache::trim()
+{
+    struct Entry
+    {
+        QString dirPath;
+        QDateTime lastUsed;
+        qint64 size = 0;
+    };
+    std::vector<Entry> entries;
+    qint64 totalSize = 0;
+    QDirIterator bucketIt(m_directory, QDir::Dirs | QDir::NoDotAndDotDot);
+    while (bucketIt.hasNext()) {
+        const QString bucketPath = bucketIt.next();
+        if (bucketIt.fileName().startsWith(QLatin1String("tmp-")))
+            continue;
+        QDirIterator entryIt(bucketPath, QDir::Dirs | QDir::NoDotAndDotDot);
+        while (entryIt.hasNext()) {
+            Entry entry;
+            entry.dirPath = entryIt.next();
+            const QFileInfo resultInfo(entry.dirPath + QLatin1String("/result"));
+            entry.lastUsed = resultInfo.lastModified();
+            entry.size = resultInfo.size();
+            QDirIterator outputIt(entry.dirPath + QLatin1String("/outputs"), QDir::Files);
+            while (outputIt.hasNext()) {
+                outputIt.next();
+                entry.size += outputIt.fileInfo().size();
+            }
+            totalSize += entry.size;
+            entries.push_back(std::move(entry));
+        }
+    }
+    if (totalSize <= m_maxSize)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &e1, const Entry &e2) {
+        return e1.lastUsed < e2.lastUsed;
+    });
+    for (const Entry &entry : entries) {
+        QString errorMessage;
+        if (!removeDirectoryWithContents(entry.dirPath, &errorMessage)) {
+            m_logger.qbsWarning() << Tr::tr("Cannot remove action cache entry: %1")
+                                     .arg(errorMessage);
+            continue;
+        }
+        totalSize -= entry.size;
+        if (totalSize <= m_maxSize)
+            break;
+    }
+}
+
+QString ActionCache::entryDirPath(const QByteArray &key) const
+{
+    return m_directory + QLatin1Char('/') + QString::fromLatin1(key.left(2)) + QLatin1Char('/')
+            + QString::fromLatin1(key);
+}
+
+// The entry is assembled in a temporary location and then renamed, so that concurrent
+// builds never see an incomplete entry.
+std::unique_ptr<QTemporaryDir> ActionCache::createTemporaryEntryDir() const
+{
+    if (!QDir::root().mkpath(m_directory))
+        return {};
+    auto tempDir = std::make_unique<QTemporaryDir>(m_directory + QLatin1String("/tmp-XXXXXX"));
+    if (!tempDir->isValid() || !QDir(tempDir->path()).mkdir(QStringLiteral("outputs")))
+        return {};
+    return tempDir;
+}
+
+bool ActionCache::commitEntry(QTemporaryDir &tempDir, const QString &entryDir)
+{
+    if (!QDir::root().mkpath(FileInfo::path(entryDir))
+            || !QDir::root().rename(tempDir.path(), entryDir)) {
+        return false;
+    }
+    tempDir.setAutoRemove(false);
+    return true;
+}
+
+QByteArray ActionCache::fileDigest(const QString &filePath)
+{
+    const FileTime lastModified = FileInfo(filePath).lastModified();
+    {
+        std::lock_guard<std::mutex> lock(m_digestsMutex);
+        const auto it = m_digests.constFind(filePath);
+        if (it != m_digests.constEnd() && it->first == lastModified)
+            return it->second;
+    }
+
+    QByteArray digest;
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadOnly)) {
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        if (hash.addData(&file))
+            digest = hash.result();
+    }
+    std::lock_guard<std::mutex> lock(m_digestsMutex);
+    m_digests.insert(filePath, std::make_pair(lastModified, digest));
+    return digest;
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,164 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_ACTIONCACHE_H
+#define QBS_ACTIONCACHE_H
+
+#include <language/forward_decls.h>
+#include <logging/logger.h>
+#include <tools/filetime.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QTemporaryDir;
+QT_END_NAMESPACE
+
+namespace qbs {
+class ProcessResult;
+
+namespace Internal {
+class RemoteActionCache;
+class Transformer;
+
+// A per-user store that maps a fingerprint of a transformer's commands and inputs to the
+// output files and process output it produced. The cache lives outside of the build directory
+// and paths inside the build and source directories are stored in a relocatable form,
+// so entries can be shared between build directories and checkouts.
+// Optionally, a remote backend serves as a second level that is consulted on local misses
+// and receives all newly created entries.
+class ActionCache
+{
+public:
+    ActionCache(QString directory, qint64 maxSize, Logger logger);
+    ~ActionCache();
+
+    void setRemoteCache(std::unique_ptr<RemoteActionCache> remoteCache);
+    RemoteActionCache *remoteCache() const { return m_remoteCache.get(); }
+
+    // What the cache needs to know about a transformer. Collecting it requires access to the
+    // build graph and must happen in the executor thread. Everything that accesses the file
+    // system, i.e. computeKey(), retrieve(), storeEntry(), exportEntry() and importEntry(),
+    // only uses this information and may be called from other threads.
+    struct Action
+    {
+        QString buildDirectory;
+        QString sourceDirectory;
+        QStringList outputFilePaths; // Sorted.
+        QByteArray commandData;
+        ResolvedProductPtr product;
+        QProcessEnvironment environment;
+        std::vector<std::pair<QString, QString>> programs; // With their working directories.
+        QStringList inputFilePaths; // Sorted.
+    };
+
+    // Returns no value if the transformer's results must not be cached.
+    static std::optional<Action> actionForTransformer(const Transformer *transformer);
+
+    // Returns an empty key if one of the action's files cannot be read.
+    QByteArray computeKey(const Action &action);
+
+    // On success, the action's outputs have been re-created from the cache
+    // and the results of its commands are returned in the last parameter.
+    bool retrieve(const QByteArray &key, const Action &action,
+                  std::vector<ProcessResult> &results);
+
+    // Storing is split into steps, so that copying the outputs can happen outside of
+    // the executor thread.
+    struct PendingEntry
+    {
+        QByteArray key;
+        QStringList outputFilePaths;
+        QByteArray resultData;
+    };
+    static PendingEntry prepareEntry(const QByteArray &key, const Action &action,
+                                     const std::vector<ProcessResult> &results);
+    bool storeEntry(const PendingEntry &entry);
+    void uploadEntry(const QByteArray &key, const QByteArray &data);
+
+    // Entries travel to and from the remote cache as a single blob.
+    QByteArray exportEntry(const QByteArray &key) const;
+    bool importEntry(const QByteArray &key, const QByteArray &data);
+
+    // Removes the least recently used entries until the cache fits into its size limit.
+    void trim();
+
+    void recordMiss() { ++m_missCount; }
+    void recordRemoteHit() { ++m_remoteHitCount; }
+
+    int hitCount() const { return m_hitCount; }
+    int missCount() const { return m_missCount; }
+    int storeCount() const { return m_storeCount; }
+    int remoteHitCount() const { return m_remoteHitCount; }
+    int uploadCount() const { return m_uploadCount; }
+
+private:
+    QString entryDirPath(const QByteArray &key) const;
+    std::unique_ptr<QTemporaryDir> createTemporaryEntryDir() const;
+    static bool commitEntry(QTemporaryDir &tempDir, const QString &entryDir);
+    QByteArray fileDigest(const QString &filePath);
+
+    const QString m_directory;
+    const qint64 m_maxSize;
+    Logger m_logger;
+    std::unique_ptr<RemoteActionCache> m_remoteCache;
+    QHash<QString, std::pair<FileTime, QByteArray>> m_digests;
+    std::mutex m_digestsMutex;
+    std::atomic_int m_hitCount = 0;
+    int m_missCount = 0;
+    std::atomic_int m_storeCount = 0;
+    int m_remoteHitCount = 0;
+    int m_uploadCount = 0;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_ACTIONCACHE_H
@@ -136,6 +136,12 @@ void Artifact::onChildDisconnected(BuildGraphNode *child)
     childrenAddedByScanner.remove(static_cast<Artifact *>(child));
 }
 
+void Artifact::clearContentInfo()
+{
+    contentDigest.clear();
+    contentTimestamp.clear();
+}
+
 void Artifact::load(PersistentPool &pool)
 {
     FileResourceBase::load(pool);
@@ -156,6 +162,8 @@ void Artifact::load(PersistentPool &pool)
     pool.load(pureProperties);
     artifactType = static_cast<ArtifactType>(pool.load<quint8>());
     alwaysUpdated = pool.load<bool>();
+    pool.load(contentDigest);
+    pool.load(contentTimestamp);
 }
 
 void Artifact::store(PersistentPool &pool)
@@ -174,6 +182,8 @@ void Artifact::store(PersistentPool &pool)
     pool.store(pureProperties);
     pool.store(static_cast<quint8>(artifactType));
     pool.store(alwaysUpdated);
+    pool.store(contentDigest);
+    pool.store(contentTimestamp);
 }
 
 } // namespace Internal
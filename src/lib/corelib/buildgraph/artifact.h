@@ -48,6 +48,7 @@
 #include <tools/filetime.h>
 #include <tools/set.h>
 
+#include <QtCore/qbytearray.h>
 #include <QtCore/qstring.h>
 
 #include <functional>
@@ -109,6 +110,18 @@ public:
         Generated = 4
     };
 
+    // Only set for generated artifacts that were built with content checking enabled.
+    QByteArray contentDigest;
+
+    // The time of the last build in which the artifact's content actually changed.
+    // Differs from timestamp() only if the artifact was re-generated with identical content.
+    FileTime contentTimestamp;
+    const FileTime &effectiveTimestamp() const
+    {
+        return contentTimestamp.isValid() ? contentTimestamp : timestamp();
+    }
+    void clearContentInfo();
+
     ArtifactType artifactType = ArtifactType::Unknown;
     bool timestampRetrieved : 1 = false; // Do not serialize. Will be refreshed for every build.
     bool alwaysUpdated : 1 = false;
@@ -76,6 +76,7 @@ static void invalidateArtifactTimestamp(Artifact *artifact)
 {
     if (artifact->timestamp().isValid()) {
         artifact->clearTimestamp();
+        artifact->product->buildData->setDirty();
         artifact->product->topLevelProject()->buildData->setDirty();
     }
 }
@@ -549,8 +549,10 @@ void connect(BuildGraphNode *p, BuildGraphNode *c)
             }
         }
     }
-    p->children.insert(c);
+    if (p->children.insert(c).second)
+        p->onChildAdded(c);
     c->parents.insert(p);
+    setBuildDataDirty(p);
     p->product->topLevelProject()->buildData->setDirty();
 }
 
@@ -601,9 +603,21 @@ bool safeConnect(Artifact *u, Artifact *v)
 void disconnect(BuildGraphNode *u, BuildGraphNode *v)
 {
     qCDebug(lcBuildGraph).noquote() << "disconnect:" << u->toString() << v->toString();
-    u->children.remove(v);
+    if (u->children.remove(v))
+        u->onChildRemoved(v);
     v->parents.remove(u);
     u->onChildDisconnected(v);
+    setBuildDataDirty(u);
+}
+
+/*
+ * Marks the build data of the node's product as changed. This must be done for every
+ * modification of persistent node data, as otherwise the modification might not get stored.
+ */
+void setBuildDataDirty(const BuildGraphNode *node)
+{
+    if (!node->product.expired() && node->product->buildData)
+        node->product->buildData->setDirty();
 }
 
 void removeGeneratedArtifactFromDisk(Artifact *artifact, const Logger &logger)
@@ -634,11 +648,11 @@ QString relativeArtifactFileName(const Artifact *artifact)
     return str;
 }
 
-Artifact *lookupArtifact(const ResolvedProductConstPtr &product,
-        const ProjectBuildData *projectBuildData, const QString &dirPath, const QString &fileName,
-        bool compareByName)
+static Artifact *findArtifact(const ResolvedProductConstPtr &product,
+                              const std::vector<FileResourceBase *> &candidates,
+                              bool compareByName)
 {
-    for (const auto &fileResource : projectBuildData->lookupFiles(dirPath, fileName)) {
+    for (const auto &fileResource : candidates) {
         if (fileResource->fileType() != FileResourceBase::FileTypeArtifact)
             continue;
         const auto artifact = static_cast<Artifact *>(fileResource);
@@ -651,6 +665,13 @@ Artifact *lookupArtifact(const ResolvedProductConstPtr &product,
     return nullptr;
 }
 
+Artifact *lookupArtifact(const ResolvedProductConstPtr &product,
+        const ProjectBuildData *projectBuildData, const QString &dirPath, const QString &fileName,
+        bool compareByName)
+{
+    return findArtifact(product, projectBuildData->lookupFiles(dirPath, fileName), compareByName);
+}
+
 Artifact *lookupArtifact(const ResolvedProductConstPtr &product, const QString &dirPath,
                          const QString &fileName, bool compareByName)
 {
@@ -661,23 +682,21 @@ Artifact *lookupArtifact(const ResolvedProductConstPtr &product, const QString &
 Artifact *lookupArtifact(const ResolvedProductConstPtr &product, const QString &filePath,
                          bool compareByName)
 {
-    QString dirPath, fileName;
-    FileInfo::splitIntoDirectoryAndFileName(filePath, &dirPath, &fileName);
-    return lookupArtifact(product, dirPath, fileName, compareByName);
+    return lookupArtifact(product, product->topLevelProject()->buildData.get(), filePath,
+                          compareByName);
 }
 
 Artifact *lookupArtifact(const ResolvedProductConstPtr &product, const ProjectBuildData *buildData,
                          const QString &filePath, bool compareByName)
 {
-    QString dirPath, fileName;
-    FileInfo::splitIntoDirectoryAndFileName(filePath, &dirPath, &fileName);
-    return lookupArtifact(product, buildData, dirPath, fileName, compareByName);
+    return findArtifact(product, buildData->lookupFiles(filePath), compareByName);
 }
 
 Artifact *lookupArtifact(const ResolvedProductConstPtr &product, const Artifact *artifact,
                          bool compareByName)
 {
-    return lookupArtifact(product, artifact->dirPath(), artifact->fileName(), compareByName);
+    return findArtifact(product, product->topLevelProject()->buildData->lookupFiles(artifact),
+                        compareByName);
 }
 
 Artifact *createArtifact(const ResolvedProductPtr &product,
@@ -87,6 +87,7 @@ void removeGeneratedArtifactFromDisk(Artifact *artifact, const Logger &logger);
 void removeGeneratedArtifactFromDisk(const QString &filePath, const Logger &logger);
 
 void disconnect(BuildGraphNode *u, BuildGraphNode *v);
+void setBuildDataDirty(const BuildGraphNode *node);
 
 void setupScriptEngineForFile(ScriptEngine *engine, const FileContextBaseConstPtr &fileContext,
         JSValue targetObject, const ObserveMode &observeMode);
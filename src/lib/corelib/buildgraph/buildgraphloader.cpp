@@ -52,7 +52,6 @@
 #include <logging/categories.h>
 #include <logging/translator.h>
 #include <tools/buildgraphlocker.h>
-#include <tools/fileinfo.h>
 #include <tools/jsliterals.h>
 #include <tools/persistence.h>
 #include <tools/profile.h>
@@ -87,17 +86,8 @@ BuildGraphLoader::~BuildGraphLoader()
 
 static void restoreBackPointers(const ResolvedProjectPtr &project)
 {
-    for (const ResolvedProductPtr &product : project->products) {
+    for (const ResolvedProductPtr &product : project->products)
         product->project = project;
-        if (!product->buildData)
-            continue;
-        for (BuildGraphNode * const n : std::as_const(product->buildData->allNodes())) {
-            if (n->type() == BuildGraphNode::ArtifactNodeType) {
-                project->topLevelProject()->buildData
-                        ->insertIntoLookupTable(static_cast<Artifact *>(n));
-            }
-        }
-    }
 
     for (const ResolvedProjectPtr &subProject : std::as_const(project->subProjects)) {
         subProject->parentProject = project;
@@ -118,6 +108,8 @@ BuildGraphLoadResult BuildGraphLoader::load(const TopLevelProjectPtr &existingPr
         existingProject->buildData->evaluationContext = evalContext;
         if (!checkBuildGraphCompatibility(existingProject))
             return m_result;
+        if (!parameters.restoreBuildDataOnDemand())
+            existingProject->restoreAllBuildData();
         m_result.loadedProject = existingProject;
     } else {
         loadBuildGraphFromDisk();
@@ -158,11 +150,12 @@ TopLevelProjectConstPtr BuildGraphLoader::loadProject(const QString &bgFilePath)
     } dummySink;
     Logger dummyLogger(&dummySink);
     BuildGraphLocker bgLocker(bgFilePath, dummyLogger, false, nullptr);
-    PersistentPool pool(dummyLogger);
-    pool.load(bgFilePath);
+    auto pool = std::make_unique<PersistentPool>(dummyLogger);
+    pool->load(bgFilePath);
+    const QVariantMap projectConfig = pool->headData().projectConfig;
     const TopLevelProjectPtr project = TopLevelProject::create();
-    project->load(pool);
-    project->setBuildConfiguration(pool.headData().projectConfig);
+    project->loadBuildGraph(std::move(pool));
+    project->setBuildConfiguration(projectConfig);
     return project;
 }
 
@@ -174,10 +167,11 @@ void BuildGraphLoader::loadBuildGraphFromDisk()
     const QString buildGraphFilePath
             = ProjectBuildData::deriveBuildGraphFilePath(buildDir, projectId);
 
-    PersistentPool pool(m_logger);
+    TraceSpan loadSpan(Tr::tr("Loading build graph"), "buildgraph");
+    auto pool = std::make_unique<PersistentPool>(m_logger);
     qCDebug(lcBuildGraph) << "trying to load:" << buildGraphFilePath;
     try {
-        pool.load(buildGraphFilePath);
+        pool->load(buildGraphFilePath);
     } catch (const NoBuildGraphError &) {
         if (m_parameters.restoreBehavior() == SetupProjectParameters::RestoreOnly)
             throw;
@@ -200,13 +194,16 @@ void BuildGraphLoader::loadBuildGraphFromDisk()
     // TODO: Store some meta data that will enable us to show actual progress (e.g. number of products).
     m_evalContext->initializeObserver(Tr::tr("Restoring build graph from disk"), 1);
 
-    project->load(pool);
+    const QVariantMap projectConfig = pool->headData().projectConfig;
+    project->loadBuildGraph(std::move(pool));
     project->buildData->evaluationContext = m_evalContext;
-    project->setBuildConfiguration(pool.headData().projectConfig);
+    project->setBuildConfiguration(projectConfig);
     project->buildDirectory = buildDir;
     if (!checkBuildGraphCompatibility(project))
         return;
     restoreBackPointers(project);
+    if (!m_parameters.restoreBuildDataOnDemand())
+        project->restoreAllBuildData();
     project->buildData->setClean();
     project->location = CodeLocation(m_parameters.projectFilePath(), project->location.line(),
                                      project->location.column());
@@ -303,38 +300,47 @@ void BuildGraphLoader::trackProjectChanges()
 {
     TimedActivityLogger trackingTimer(m_logger, Tr::tr("Change tracking"),
                                       m_parameters.logElapsedTime());
+    TraceSpan trackingSpan(Tr::tr("Change tracking"), "buildgraph");
     const TopLevelProjectPtr &restoredProject = m_result.loadedProject;
     Set<QString> buildSystemFiles = restoredProject->buildSystemFiles;
     std::vector<ResolvedProductPtr> allRestoredProducts = restoredProject->allProducts();
     std::vector<ResolvedProductPtr> changedProducts;
     bool reResolvingNecessary = false;
+    bool onlyProjectFilesChanged = true;
     if (!checkConfigCompatibility()) {
         m_logger.qbsInfo() << Tr::tr("One or more properties have changed.");
         reResolvingNecessary = true;
+        onlyProjectFilesChanged = false;
     }
+    prefetchFileStatuses(restoredProject, allRestoredProducts);
     if (hasProductFileChanged(allRestoredProducts, restoredProject->lastStartResolveTime,
                               buildSystemFiles, changedProducts)) {
         reResolvingNecessary = true;
     }
+    if (hasBuildSystemFileChanged(buildSystemFiles, restoredProject.get()))
+        reResolvingNecessary = true;
 
     // "External" changes, e.g. in the environment or in a JavaScript file,
     // can make the list of source files in a product change without the respective file
     // having been touched. In such a case, the build data for that product will have to be set up
     // anew.
     if (probeExecutionForced(restoredProject, allRestoredProducts)
-            || hasBuildSystemFileChanged(buildSystemFiles, restoredProject.get())
             || hasEnvironmentChanged(restoredProject)
             || hasCanonicalFilePathResultChanged(restoredProject)
             || hasFileExistsResultChanged(restoredProject)
             || hasDirectoryEntriesResultChanged(restoredProject)
             || hasFileLastModifiedResultChanged(restoredProject)) {
         reResolvingNecessary = true;
+        onlyProjectFilesChanged = false;
     }
 
+    m_fileStatuses.clear();
+
     if (!reResolvingNecessary
         && m_parameters.restoreBehavior() == SetupProjectParameters::RestoreAndResolve) {
         m_logger.qbsInfo() << Tr::tr("No changes detected, but re-resolve was forced.");
         reResolvingNecessary = true;
+        onlyProjectFilesChanged = false;
     }
 
     if (!reResolvingNecessary) {
@@ -354,6 +360,7 @@ void BuildGraphLoader::trackProjectChanges()
                                   .arg(QDir::toNativeSeparators(file));
     }
 
+    restoredProject->restoreAllBuildData();
     restoredProject->buildData->setDirty();
     markTransformersForChangeTracking(allRestoredProducts);
     if (!m_parameters.overrideBuildGraphData())
@@ -370,12 +377,39 @@ void BuildGraphLoader::trackProjectChanges()
     resolver.setOldProductProbes(restoredProbes);
     if (!m_parameters.overrideBuildGraphData())
         resolver.setStoredProfiles(restoredProject->profileConfigs);
-    m_result.newlyResolvedProject = resolver.resolve();
+    QHash<QString, ResolvedProductPtr> reusableProducts;
+    if (onlyProjectFilesChanged)
+        reusableProducts = productsUnaffectedByProjectFileChanges(allRestoredProducts,
+                                                                  changedProducts);
+    resolver.setReusableProducts(reusableProducts);
+    QHash<ResolvedProductPtr, WeakPointer<ResolvedProject>> projectsOfReusableProducts;
+    for (const ResolvedProductPtr &product : std::as_const(reusableProducts))
+        projectsOfReusableProducts.insert(product, product->project);
+    try {
+        m_result.newlyResolvedProject = resolver.resolve();
+    } catch (const ErrorInfo &) {
+        // The resolver re-parents the products it takes over.
+        for (auto it = projectsOfReusableProducts.cbegin();
+             it != projectsOfReusableProducts.cend(); ++it) {
+            it.key()->project = it.value();
+        }
+        throw;
+    }
 
     std::vector<ResolvedProductPtr> allNewlyResolvedProducts
             = m_result.newlyResolvedProject->allProducts();
-    for (const ResolvedProductPtr &cp : std::as_const(allNewlyResolvedProducts))
+    int takenOverProductCount = 0;
+    for (const ResolvedProductPtr &cp : std::as_const(allNewlyResolvedProducts)) {
         m_freshProductsByName.insert(cp->uniqueName(), cp);
+        if (projectsOfReusableProducts.contains(cp))
+            ++takenOverProductCount;
+    }
+    if (takenOverProductCount > 0) {
+        m_logger.qbsDebug() << Tr::tr("Took over %1 of %2 products from the previous resolve.")
+                                   .arg(takenOverProductCount)
+                                   .arg(allNewlyResolvedProducts.size());
+        takeOverEngineResults(restoredProject);
+    }
 
     checkAllProductsForChanges(allRestoredProducts, changedProducts);
 
@@ -493,6 +527,27 @@ void BuildGraphLoader::trackProjectChanges()
     doSanityChecks(m_result.newlyResolvedProject, m_logger);
 }
 
+void BuildGraphLoader::prefetchFileStatuses(const TopLevelProjectConstPtr &restoredProject,
+        const std::vector<ResolvedProductPtr> &restoredProducts)
+{
+    for (const ResolvedProductPtr &product : restoredProducts) {
+        m_fileStatuses.addFile(product->location.filePath());
+        for (const QString &file : std::as_const(product->missingSourceFiles))
+            m_fileStatuses.addFile(file);
+    }
+    for (const QString &file : std::as_const(restoredProject->buildSystemFiles))
+        m_fileStatuses.addFile(file);
+    for (auto it = restoredProject->fileExistsResults.constBegin();
+         it != restoredProject->fileExistsResults.constEnd(); ++it) {
+        m_fileStatuses.addFile(it.key());
+    }
+    for (auto it = restoredProject->fileLastModifiedResults.constBegin();
+         it != restoredProject->fileLastModifiedResults.constEnd(); ++it) {
+        m_fileStatuses.addFile(it.key());
+    }
+    m_fileStatuses.run(m_parameters.maxJobCount());
+}
+
 bool BuildGraphLoader::probeExecutionForced(
         const TopLevelProjectConstPtr &restoredProject,
         const std::vector<ResolvedProductPtr> &restoredProducts) const
@@ -550,7 +605,7 @@ bool BuildGraphLoader::hasFileExistsResultChanged(const TopLevelProjectConstPtr
 {
     for (QHash<QString, bool>::ConstIterator it = restoredProject->fileExistsResults.constBegin();
          it != restoredProject->fileExistsResults.constEnd(); ++it) {
-        if (FileInfo(it.key()).exists() != it.value()) {
+        if (m_fileStatuses.exists(it.key()) != it.value()) {
             m_logger.qbsInfo() << Tr::tr("Existence check for file '%1' changed.")
                                       .arg(QDir::toNativeSeparators(it.key()));
             return true;
@@ -580,7 +635,7 @@ bool BuildGraphLoader::hasFileLastModifiedResultChanged(const TopLevelProjectCon
     for (QHash<QString, FileTime>::ConstIterator it
          = restoredProject->fileLastModifiedResults.constBegin();
          it != restoredProject->fileLastModifiedResults.constEnd(); ++it) {
-        if (FileInfo(it.key()).lastModified() != it.value()) {
+        if (m_fileStatuses.lastModified(it.key()) != it.value()) {
             m_logger.qbsInfo() << Tr::tr("Timestamp for file '%1' has changed.")
                                       .arg(QDir::toNativeSeparators(it.key()));
             return true;
@@ -597,18 +652,18 @@ bool BuildGraphLoader::hasProductFileChanged(const std::vector<ResolvedProductPt
     bool hasChanged = false;
     for (const ResolvedProductPtr &product : restoredProducts) {
         const QString filePath = product->location.filePath();
-        const FileInfo pfi(filePath);
+        const FileStatusPrefetcher::FileStatus fileStatus = m_fileStatuses.status(filePath);
         remainingBuildSystemFiles.remove(filePath);
-        if (!pfi.exists()) {
+        if (!fileStatus.exists) {
             m_removedProjectFiles << filePath;
             hasChanged = true;
-        } else if (referenceTime < pfi.lastModified()) {
+        } else if (referenceTime < fileStatus.lastModified) {
             m_changedProjectFiles << filePath;
             hasChanged = true;
         } else if (!contains(changedProducts, product)) {
             bool foundMissingSourceFile = false;
             for (const QString &file : std::as_const(product->missingSourceFiles)) {
-                if (FileInfo(file).exists()) {
+                if (m_fileStatuses.exists(file)) {
                     m_logger.qbsInfo()
                         << Tr::tr("Formerly missing file '%1' in product '%2' exists now.")
                                .arg(QDir::toNativeSeparators(filePath), product->fullDisplayName());
@@ -643,11 +698,13 @@ bool BuildGraphLoader::hasProductFileChanged(const std::vector<ResolvedProductPt
 bool BuildGraphLoader::hasBuildSystemFileChanged(const Set<QString> &buildSystemFiles,
                                                  const TopLevelProject *restoredProject)
 {
+    bool hasChanged = false;
     for (const QString &file : buildSystemFiles) {
-        const FileInfo fi(file);
-        if (!fi.exists()) {
+        const FileStatusPrefetcher::FileStatus fileStatus = m_fileStatuses.status(file);
+        if (!fileStatus.exists) {
             m_removedProjectFiles << file;
-            return true;
+            hasChanged = true;
+            continue;
         }
         const auto generatedChecker = [&file, restoredProject](const auto &item) {
             const ModuleProviderInfo &mpi = item.second;
@@ -657,12 +714,74 @@ bool BuildGraphLoader::hasBuildSystemFileChanged(const Set<QString> &buildSystem
                 any_of(restoredProject->moduleProviderInfo.providers, generatedChecker);
         const FileTime referenceTime = fileWasCreatedByModuleProvider
                 ? restoredProject->lastEndResolveTime : restoredProject->lastStartResolveTime;
-        if (referenceTime < fi.lastModified()) {
+        if (referenceTime < fileStatus.lastModified) {
             m_changedProjectFiles << file;
-            return true;
+            hasChanged = true;
         }
     }
-    return false;
+    return hasChanged;
+}
+
+// A product that was not set up from any of the changed project files can be taken over
+// by the resolver, provided its dependencies can be taken over as well.
+// This is only safe if all changes are attributable to products; for instance,
+// a JavaScript file could be used from anywhere.
+QHash<QString, ResolvedProductPtr> BuildGraphLoader::productsUnaffectedByProjectFileChanges(
+        const std::vector<ResolvedProductPtr> &restoredProducts,
+        const std::vector<ResolvedProductPtr> &changedProducts) const
+{
+    Set<QString> changedFiles = m_changedProjectFiles;
+    changedFiles.unite(m_removedProjectFiles);
+    Set<QString> filesUsedByProducts;
+    for (const ResolvedProductPtr &product : restoredProducts)
+        filesUsedByProducts.unite(product->buildSystemFiles);
+    for (const QString &file : std::as_const(changedFiles)) {
+        if (!file.endsWith(QLatin1String(".qbs")) || !filesUsedByProducts.contains(file)) {
+            qCDebug(lcBuildGraph) << "change in" << file
+                                  << "potentially affects all products, resolving from scratch";
+            return {};
+        }
+    }
+
+    QHash<QString, ResolvedProductPtr> products;
+    for (const ResolvedProductPtr &product : restoredProducts) {
+        if (product->buildSystemFiles.empty() || product->buildSystemFiles.intersects(changedFiles)
+                || contains(changedProducts, product)) {
+            continue;
+        }
+        products.insert(product->uniqueName(), product);
+    }
+    return products;
+}
+
+// The resolver does not evaluate anything in products it takes over, so the results
+// recorded for them last time need to be kept around for the next change check.
+// Values that were looked up again take precedence.
+void BuildGraphLoader::takeOverEngineResults(const TopLevelProjectConstPtr &restoredProject)
+{
+    const auto takeOver = [](auto &newResults, const auto &oldResults) {
+        for (auto it = oldResults.cbegin(); it != oldResults.cend(); ++it) {
+            if (!newResults.contains(it.key()))
+                newResults.insert(it.key(), it.value());
+        }
+    };
+    const TopLevelProjectPtr &newProject = m_result.newlyResolvedProject;
+    takeOver(newProject->canonicalFilePathResults, restoredProject->canonicalFilePathResults);
+    takeOver(newProject->fileExistsResults, restoredProject->fileExistsResults);
+    takeOver(newProject->directoryEntriesResults, restoredProject->directoryEntriesResults);
+    takeOver(newProject->fileLastModifiedResults, restoredProject->fileLastModifiedResults);
+    const QStringList envKeys = restoredProject->environment.keys();
+    for (const QString &key : envKeys) {
+        if (!newProject->environment.contains(key))
+            newProject->environment.insert(key, restoredProject->environment.value(key));
+    }
+
+    // The project files are read anew in any case, but JavaScript files might only be
+    // imported from the product parts that were not evaluated.
+    for (const QString &file : std::as_const(restoredProject->buildSystemFiles)) {
+        if (!file.endsWith(QLatin1String(".qbs")))
+            newProject->buildSystemFiles << file;
+    }
 }
 
 void BuildGraphLoader::markTransformersForChangeTracking(
@@ -687,7 +806,7 @@ void BuildGraphLoader::checkAllProductsForChanges(
     for (const ResolvedProductPtr &restoredProduct : restoredProducts) {
         const ResolvedProductPtr newlyResolvedProduct
                 = m_freshProductsByName.value(restoredProduct->uniqueName());
-        if (!newlyResolvedProduct)
+        if (!newlyResolvedProduct || newlyResolvedProduct == restoredProduct)
             continue;
         if (newlyResolvedProduct->enabled != restoredProduct->enabled) {
             qCDebug(lcBuildGraph) << "Condition of product" << restoredProduct->uniqueName()
@@ -46,6 +46,7 @@
 
 #include <language/forward_decls.h>
 #include <logging/logger.h>
+#include <tools/filestatusprefetcher.h>
 #include <tools/set.h>
 #include <tools/setupprojectparameters.h>
 
@@ -86,6 +87,8 @@ private:
     void loadBuildGraphFromDisk();
     bool checkBuildGraphCompatibility(const TopLevelProjectConstPtr &project);
     void trackProjectChanges();
+    void prefetchFileStatuses(const TopLevelProjectConstPtr &restoredProject,
+                              const std::vector<ResolvedProductPtr> &restoredProducts);
     bool probeExecutionForced(const TopLevelProjectConstPtr &restoredProject,
                               const std::vector<ResolvedProductPtr> &restoredProducts) const;
     bool hasEnvironmentChanged(const TopLevelProjectConstPtr &restoredProject) const;
@@ -99,6 +102,10 @@ private:
                                std::vector<ResolvedProductPtr> &productsWithChangedFiles);
     bool hasBuildSystemFileChanged(const Set<QString> &buildSystemFiles,
                                    const TopLevelProject *restoredProject);
+    QHash<QString, ResolvedProductPtr> productsUnaffectedByProjectFileChanges(
+            const std::vector<ResolvedProductPtr> &restoredProducts,
+            const std::vector<ResolvedProductPtr> &changedProducts) const;
+    void takeOverEngineResults(const TopLevelProjectConstPtr &restoredProject);
     void markTransformersForChangeTracking(const std::vector<ResolvedProductPtr> &restoredProducts);
     void checkAllProductsForChanges(const std::vector<ResolvedProductPtr> &restoredProducts,
             std::vector<ResolvedProductPtr> &changedProducts);
@@ -147,6 +154,7 @@ private:
     Set<QString> m_removedProjectFiles;
     Set<QString> m_productsWhoseArtifactsNeedUpdate;
     Set<QString> m_scannersToInvalidate;
+    FileStatusPrefetcher m_fileStatuses;
     qint64 m_wildcardExpansionEffort = 0;
     qint64 m_propertyComparisonEffort = 0;
 
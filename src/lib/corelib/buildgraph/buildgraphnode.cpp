@@ -56,8 +56,10 @@ BuildGraphNode::BuildGraphNode() : buildState(Untouched)
 
 BuildGraphNode::~BuildGraphNode()
 {
-    for (BuildGraphNode *p : std::as_const(parents))
-        p->children.remove(this);
+    for (BuildGraphNode *p : std::as_const(parents)) {
+        if (p->children.remove(this))
+            p->onChildRemoved(this);
+    }
     for (BuildGraphNode *c : std::as_const(children))
         c->parents.remove(this);
 }
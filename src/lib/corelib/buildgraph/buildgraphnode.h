@@ -70,6 +70,18 @@ public:
 
     BuildState buildState;                  // Do not serialize. Will be refreshed for every build.
 
+    // Estimated duration in milliseconds of the longest path from this node to a root,
+    // including the node itself. Negative if not yet calculated. Do not serialize.
+    qint64 criticalPathCost = -1;
+
+    // Whether the cost above is based on at least one recorded command duration. If not,
+    // the cost is meaningless. Do not serialize.
+    bool criticalPathCostKnown = false;
+
+    // The number of children that are not built yet. Only valid while the node is buildable,
+    // which is when the executor calculates it. Do not serialize.
+    int pendingChildCount = 0;
+
     enum Type
     {
         ArtifactNodeType,
@@ -83,6 +95,18 @@ public:
 
     bool isBuilt() const { return buildState == Built; }
 
+    // To be called whenever a child gets added or removed, respectively.
+    void onChildAdded(const BuildGraphNode *child)
+    {
+        if (buildState == Buildable && !child->isBuilt())
+            ++pendingChildCount;
+    }
+    void onChildRemoved(const BuildGraphNode *child)
+    {
+        if (buildState == Buildable && !child->isBuilt())
+            --pendingChildCount;
+    }
+
     virtual void load(PersistentPool &pool);
     virtual void store(PersistentPool &pool);
 
@@ -0,0 +1,401 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "buildstatefingerprint.h"
+
+#include "artifact.h"
+#include "filedependency.h"
+#include "productbuilddata.h"
+#include "productinstaller.h"
+#include "projectbuilddata.h"
+#include "transformer.h"
+
+#include <language/language.h>
+#include <logging/categories.h>
+#include <logging/logger.h>
+#include <tools/buildgraphlocker.h>
+#include <tools/buildoptions.h>
+#include <tools/filestatusprefetcher.h>
+#include <tools/installoptions.h>
+#include <tools/qttools.h>
+#include <tools/setupprojectparameters.h>
+#include <tools/stlutils.h>
+#include <tools/stringconstants.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qprocess.h>
+
+#include <algorithm>
+#include <functional>
+
+namespace qbs {
+namespace Internal {
+
+// Builds that are restricted to parts of the project or that do something regardless of
+// the state of the files are not covered.
+static bool isCompleteBuild(const BuildOptions &options)
+{
+    return !options.dryRun() && !options.executeRulesOnly()
+            && !options.removeExistingInstallation() && options.changedFiles().empty()
+            && options.filesToConsider().empty() && options.activeFileTags().empty();
+}
+
+// The build graph loader does not look at the environment unless re-resolving was requested,
+// but a changed environment is a strong hint that the user expects something to happen.
+static QByteArray environmentDigest(QProcessEnvironment environment)
+{
+    environment.remove(QStringLiteral("LD_PRELOAD")); // See BuildGraphLoader.
+    QStringList variables = environment.toStringList();
+    variables.sort();
+    return QCryptographicHash::hash(variables.join(QLatin1Char('\n')).toUtf8(),
+                                    QCryptographicHash::Sha1);
+}
+
+QString BuildStateFingerprint::filePath(const QString &buildGraphFilePath)
+{
+    return buildGraphFilePath + QStringLiteral(".fingerprint");
+}
+
+void BuildStateFingerprint::remove(const QString &buildGraphFilePath)
+{
+    QFile::remove(filePath(buildGraphFilePath));
+}
+
+void BuildStateFingerprint::write(const TopLevelProject &project,
+        const QVector<ResolvedProductPtr> &builtProducts, const BuildOptions &options,
+        const Logger &logger)
+{
+    const QString buildGraphFilePath = project.buildGraphFilePath();
+    BuildStateFingerprint fingerprint;
+    if (!fingerprint.collect(project, builtProducts, options)) {
+        qCDebug(lcBuildGraph) << "build does not qualify for a build state fingerprint";
+        remove(buildGraphFilePath);
+        return;
+    }
+    qCDebug(lcBuildGraph) << "storing build state fingerprint";
+    PersistentPool pool(logger);
+    pool.setupWriteStream(filePath(buildGraphFilePath));
+    pool.storeSection(QString(), [&pool, &fingerprint] { pool.store(fingerprint); });
+    pool.finalizeWriteStream();
+}
+
+bool BuildStateFingerprint::matches(const SetupProjectParameters &parameters,
+        const BuildOptions &options, bool includingNonDefaultProducts, const Logger &logger)
+{
+    const QString projectId = TopLevelProject::deriveId(parameters.finalBuildConfigurationTree());
+    const QString buildGraphFilePath = ProjectBuildData::deriveBuildGraphFilePath(
+                TopLevelProject::deriveBuildDirectory(parameters.buildRoot(), projectId),
+                projectId);
+    const QString fingerprintFilePath = filePath(buildGraphFilePath);
+    if (!QFileInfo::exists(fingerprintFilePath))
+        return false;
+
+    // The build graph must not be in the process of getting changed by someone else.
+    const BuildGraphLocker locker(buildGraphFilePath, logger, parameters.waitLockBuildGraph(),
+                                  nullptr);
+    BuildStateFingerprint fingerprint;
+    PersistentPool pool(logger);
+    pool.load(fingerprintFilePath);
+    if (pool.sectionCount() != 1)
+        return false;
+    pool.loadSection(0, [&pool, &fingerprint] { pool.load(fingerprint); });
+
+    if (fingerprint.m_qbsVersion != QLatin1String(QBS_VERSION))
+        return false;
+    if (!isCompleteBuild(options))
+        return false;
+    const int selection = includingNonDefaultProducts ? AllProducts : DefaultProducts;
+    if (!(fingerprint.m_productSelections & selection))
+        return false;
+    if (options.forceTimestampCheck() && !fingerprint.m_generatedFilesRecorded)
+        return false;
+    if (options.install() && !fingerprint.m_installed)
+        return false;
+    if (environmentDigest(parameters.adjustedEnvironment()) != fingerprint.m_environmentDigest)
+        return false;
+
+    // Mismatches here are errors, which the normal code path reports.
+    if (!parameters.projectFilePath().isEmpty()
+            && QFileInfo(parameters.projectFilePath())
+               != QFileInfo(fingerprint.m_projectFilePath)) {
+        return false;
+    }
+    if (!parameters.topLevelProfile().isEmpty()
+            && parameters.topLevelProfile() != fingerprint.m_profile) {
+        return false;
+    }
+    if (!parameters.overriddenValues().empty()
+            && !qVariantMapsEqual(parameters.overriddenValues(), fingerprint.m_overriddenValues)) {
+        return false;
+    }
+
+    return fingerprint.isUpToDate(parameters.maxJobCount());
+}
+
+// Everything that BuildGraphLoader::trackProjectChanges() and the executor would look at
+// in a build that has nothing to do gets recorded here. If any of it indicates that
+// there is something to do already now, e.g. because a timestamp is invalid, there is no point
+// in writing a fingerprint.
+bool BuildStateFingerprint::collect(const TopLevelProject &project,
+        const QVector<ResolvedProductPtr> &builtProducts, const BuildOptions &options)
+{
+    if (!isCompleteBuild(options))
+        return false;
+
+    // The normal code path prints these on every build.
+    if (!project.warningsEncountered.empty() || !project.errorsEncountered.empty())
+        return false;
+
+    const std::vector<ResolvedProductPtr> allProducts = project.allProducts();
+    Set<QString> builtProductNames;
+    for (const ResolvedProductPtr &product : builtProducts)
+        builtProductNames.insert(product->uniqueName());
+    Set<QString> defaultProductNames;
+    Set<QString> enabledProductNames;
+    for (const ResolvedProductPtr &product : allProducts) {
+        if (!product->enabled)
+            continue;
+        enabledProductNames.insert(product->uniqueName());
+        if (product->builtByDefault())
+            defaultProductNames.insert(product->uniqueName());
+    }
+    if (builtProductNames == enabledProductNames)
+        m_productSelections = DefaultProducts | AllProducts;
+    else if (builtProductNames == defaultProductNames)
+        m_productSelections = DefaultProducts;
+    else
+        return false;
+
+    m_qbsVersion = QLatin1String(QBS_VERSION);
+    m_projectFilePath = project.location.filePath();
+    m_profile = project.profile();
+    m_overriddenValues = project.overriddenValues;
+    m_environmentDigest = environmentDigest(project.environment);
+    m_fileExistsResults = project.fileExistsResults;
+    m_canonicalFilePathResults = project.canonicalFilePathResults;
+    m_directoryEntriesResults = project.directoryEntriesResults;
+    for (auto it = project.fileLastModifiedResults.cbegin();
+         it != project.fileLastModifiedResults.cend(); ++it) {
+        m_lastModifiedTimes.emplace_back(it.key(), it.value());
+    }
+
+    // The project files only need to be older than the last resolve, so their current
+    // timestamps have to be retrieved.
+    const QString buildGraphFilePath = project.buildGraphFilePath();
+    const QString journalFilePath = PersistentPool::journalFilePath(buildGraphFilePath);
+    FileStatusPrefetcher fileStatuses;
+    fileStatuses.addFile(buildGraphFilePath);
+    fileStatuses.addFile(journalFilePath);
+    for (const QString &file : project.buildSystemFiles)
+        fileStatuses.addFile(file);
+    for (const ResolvedProductPtr &product : allProducts) {
+        fileStatuses.addFile(product->location.filePath());
+        for (const QString &file : std::as_const(product->missingSourceFiles))
+            fileStatuses.addFile(file);
+    }
+    fileStatuses.run(options.maxJobCount());
+    const auto addProjectFile = [this, &fileStatuses](const QString &filePath,
+                                                      const FileTime &referenceTime) {
+        const FileStatusPrefetcher::FileStatus fileStatus = fileStatuses.status(filePath);
+        if (!fileStatus.exists || referenceTime < fileStatus.lastModified)
+            return false;
+        m_lastModifiedTimes.emplace_back(filePath, fileStatus.lastModified);
+        return true;
+    };
+    for (const QString &file : project.buildSystemFiles) {
+        const bool fileWasCreatedByModuleProvider = any_of(project.moduleProviderInfo.providers,
+                [&file, &project](const auto &item) {
+            return file.startsWith(item.second.outputDirPath(project.buildDirectory));
+        });
+        if (!addProjectFile(file, fileWasCreatedByModuleProvider
+                            ? project.lastEndResolveTime : project.lastStartResolveTime)) {
+            return false;
+        }
+    }
+    for (const ResolvedProductPtr &product : allProducts) {
+        if (!addProjectFile(product->location.filePath(), project.lastStartResolveTime))
+            return false;
+        for (const QString &file : std::as_const(product->missingSourceFiles)) {
+            if (fileStatuses.exists(file))
+                return false;
+            m_fileExistsResults.insert(file, false);
+        }
+
+        // Checking the directory timestamps is cheaper than expanding the patterns again.
+        for (const GroupPtr &group : product->groups) {
+            if (!group->wildcards)
+                continue;
+            for (const auto &dirTimeStamp : group->wildcards->dirTimeStamps)
+                m_lastModifiedTimes.push_back(dirTimeStamp);
+        }
+    }
+
+    // Any later store of the build graph invalidates the fingerprint, but other parties
+    // could still replace the file.
+    const FileStatusPrefetcher::FileStatus buildGraphFileStatus
+            = fileStatuses.status(buildGraphFilePath);
+    if (!buildGraphFileStatus.exists)
+        return false;
+    m_lastModifiedTimes.emplace_back(buildGraphFilePath, buildGraphFileStatus.lastModified);
+    const FileStatusPrefetcher::FileStatus journalFileStatus
+            = fileStatuses.status(journalFilePath);
+    if (journalFileStatus.exists)
+        m_lastModifiedTimes.emplace_back(journalFilePath, journalFileStatus.lastModified);
+    else
+        m_fileExistsResults.insert(journalFilePath, false);
+
+    for (const FileDependency * const dep : std::as_const(project.buildData->fileDependencies)) {
+        if (!dep->timestamp().isValid())
+            return false;
+        m_lastModifiedTimes.emplace_back(dep->filePath(), dep->timestamp());
+    }
+
+    // The executor also looks at the dependencies of the products it was asked to build.
+    Set<const ResolvedProduct *> buildableProducts;
+    const std::function<void(const ResolvedProduct *)> addBuildableProduct
+            = [&](const ResolvedProduct *product) {
+        if (!buildableProducts.insert(product).second)
+            return;
+        for (const ProductDependency &dep : product->dependencies)
+            addBuildableProduct(dep.product.get());
+    };
+    for (const ResolvedProductPtr &product : builtProducts)
+        addBuildableProduct(product.get());
+    m_generatedFilesRecorded = options.forceTimestampCheck();
+
+    // Like in the executor, the install root is the one of the first product.
+    m_installed = options.install();
+    InstallOptions installOptions;
+    if (m_installed && !builtProducts.empty()) {
+        installOptions.setInstallRoot(builtProducts.front()->moduleProperties->qbsPropertyValue(
+                                          StringConstants::installRootProperty()).toString());
+    }
+    const auto addInstalledFile = [this, &project, &installOptions](const Artifact *artifact) {
+        if (!m_installed)
+            return;
+        const QString targetFilePath = ProductInstaller::targetFilePath(&project,
+                artifact->product->sourceDirectory, artifact->filePath(), artifact->properties,
+                installOptions);
+        if (!targetFilePath.isEmpty())
+            m_fileExistsResults.insert(targetFilePath, true);
+    };
+    for (const ResolvedProduct * const product : buildableProducts) {
+        if (!product->buildData)
+            return false;
+        for (const Artifact * const artifact
+             : filterByType<Artifact>(product->buildData->allNodes())) {
+            if (artifact->artifactType == Artifact::SourceFile) {
+                if (!artifact->timestamp().isValid())
+                    return false;
+                m_sourceFileTimes.emplace_back(artifact->filePath(), artifact->timestamp());
+                addInstalledFile(artifact);
+                continue;
+            }
+
+            // Artifacts that were not needed in this build will not be needed in the next one.
+            if (!artifact->isBuilt())
+                continue;
+            if (!artifact->timestamp().isValid() || !artifact->transformer
+                    || artifact->transformer->alwaysRun || artifact->transformer->markedForRerun) {
+                return false;
+            }
+            if (m_generatedFilesRecorded)
+                m_lastModifiedTimes.emplace_back(artifact->filePath(), artifact->timestamp());
+            addInstalledFile(artifact);
+        }
+    }
+    return true;
+}
+
+bool BuildStateFingerprint::isUpToDate(int maxJobCount) const
+{
+    FileStatusPrefetcher fileStatuses;
+    for (const auto &[filePath, fileTime] : m_lastModifiedTimes)
+        fileStatuses.addFile(filePath);
+    for (const auto &[filePath, fileTime] : m_sourceFileTimes)
+        fileStatuses.addFile(filePath);
+    for (auto it = m_fileExistsResults.cbegin(); it != m_fileExistsResults.cend(); ++it)
+        fileStatuses.addFile(it.key());
+    fileStatuses.run(maxJobCount);
+
+    for (const auto &[filePath, fileTime] : m_lastModifiedTimes) {
+        if (fileStatuses.lastModified(filePath) != fileTime) {
+            qCDebug(lcBuildGraph) << "build state fingerprint: timestamp changed:" << filePath;
+            return false;
+        }
+    }
+    for (const auto &[filePath, fileTime] : m_sourceFileTimes) {
+        const FileStatusPrefetcher::FileStatus fileStatus = fileStatuses.status(filePath);
+        if (!fileStatus.exists || fileStatus.isDir
+                || std::max(fileStatus.lastModified, fileStatus.lastStatusChange) != fileTime) {
+            qCDebug(lcBuildGraph) << "build state fingerprint: source file changed:" << filePath;
+            return false;
+        }
+    }
+    for (auto it = m_fileExistsResults.cbegin(); it != m_fileExistsResults.cend(); ++it) {
+        if (fileStatuses.exists(it.key()) != it.value()) {
+            qCDebug(lcBuildGraph) << "build state fingerprint: existence changed:" << it.key();
+            return false;
+        }
+    }
+    for (auto it = m_canonicalFilePathResults.cbegin();
+         it != m_canonicalFilePathResults.cend(); ++it) {
+        if (QFileInfo(it.key()).canonicalFilePath() != it.value()) {
+            qCDebug(lcBuildGraph) << "build state fingerprint: canonical path changed:"
+                                  << it.key();
+            return false;
+        }
+    }
+    for (auto it = m_directoryEntriesResults.cbegin();
+         it != m_directoryEntriesResults.cend(); ++it) {
+        if (QDir(it.key().first).entryList(static_cast<QDir::Filters>(it.key().second),
+                                           QDir::Name) != it.value()) {
+            qCDebug(lcBuildGraph) << "build state fingerprint: directory entries changed:"
+                                  << it.key().first;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace Internal
+} // namespace qbs
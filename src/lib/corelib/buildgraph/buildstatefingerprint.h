@@ -0,0 +1,128 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_BUILDSTATEFINGERPRINT_H
+#define QBS_BUILDSTATEFINGERPRINT_H
+
+#include <language/forward_decls.h>
+#include <tools/filetime.h>
+#include <tools/persistence.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qvector.h>
+
+#include <utility>
+#include <vector>
+
+namespace qbs {
+class BuildOptions;
+class SetupProjectParameters;
+
+namespace Internal {
+class Logger;
+
+/*!
+ * Records what the outcome of a successful build depends on, next to the build graph file.
+ * As long as all of it is unchanged, building the same products again is known to do nothing,
+ * which can then be found out without loading the build graph at all.
+ */
+class BuildStateFingerprint
+{
+public:
+    static QString filePath(const QString &buildGraphFilePath);
+    static void remove(const QString &buildGraphFilePath);
+
+    // Only builds of all default products or all enabled products that did not do anything
+    // unconditionally get a fingerprint.
+    static void write(const TopLevelProject &project,
+                      const QVector<ResolvedProductPtr> &builtProducts,
+                      const BuildOptions &options, const Logger &logger);
+
+    // The parameters must have been expanded.
+    static bool matches(const SetupProjectParameters &parameters, const BuildOptions &options,
+                        bool includingNonDefaultProducts, const Logger &logger);
+
+    template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
+    {
+        pool.serializationOp<opType>(m_qbsVersion, m_projectFilePath, m_profile,
+                                     m_overriddenValues, m_environmentDigest,
+                                     m_productSelections, m_installed,
+                                     m_generatedFilesRecorded, m_lastModifiedTimes,
+                                     m_sourceFileTimes, m_fileExistsResults,
+                                     m_canonicalFilePathResults, m_directoryEntriesResults);
+    }
+
+private:
+    enum ProductSelection { DefaultProducts = 0x1, AllProducts = 0x2 };
+
+    bool collect(const TopLevelProject &project, const QVector<ResolvedProductPtr> &builtProducts,
+                 const BuildOptions &options);
+    bool isUpToDate(int maxJobCount) const;
+
+    QString m_qbsVersion;
+    QString m_projectFilePath;
+    QString m_profile;
+    QVariantMap m_overriddenValues;
+    QByteArray m_environmentDigest;
+    int m_productSelections = 0;
+
+    // A build that did not install does not cover one that does. The installed files
+    // are recorded as existing, which also covers changes of the install root.
+    bool m_installed = false;
+    bool m_generatedFilesRecorded = false;
+
+    // Compared against the last modification time, like the build graph loader does it.
+    std::vector<std::pair<QString, FileTime>> m_lastModifiedTimes;
+
+    // Compared like the executor does it for source artifacts.
+    std::vector<std::pair<QString, FileTime>> m_sourceFileTimes;
+
+    QHash<QString, bool> m_fileExistsResults;
+    QHash<QString, QString> m_canonicalFilePathResults;
+    QHash<std::pair<QString, quint32>, QStringList> m_directoryEntriesResults;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_BUILDSTATEFINGERPRINT_H
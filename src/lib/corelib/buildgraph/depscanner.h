@@ -80,6 +80,7 @@ public:
     bool areModulePropertiesCompatible(
         const PropertyMapConstPtr &m1, const PropertyMapConstPtr &m2) const;
     bool cacheIsPerFile() const;
+    const ScannerPlugin *plugin() const { return m_plugin; }
 
 private:
     QString createId() const;
@@ -38,15 +38,18 @@
 ****************************************************************************/
 #include "executor.h"
 
+#include "actioncache.h"
 #include "buildgraph.h"
 #include "cycledetector.h"
 #include "emptydirectoriesremover.h"
 #include "environmentscriptrunner.h"
 #include "executorjob.h"
 #include "inputartifactscanner.h"
+#include "jobbudget.h"
 #include "productbuilddata.h"
 #include "productinstaller.h"
 #include "projectbuilddata.h"
+#include "remoteactioncache.h"
 #include "rulecommands.h"
 #include "rulenode.h"
 #include "rulesevaluationcontext.h"
@@ -68,12 +71,15 @@
 #include <tools/stringconstants.h>
 
 #include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qstandardpaths.h>
 #include <QtCore/qtimer.h>
 
 #include <algorithm>
 #include <climits>
 #include <iterator>
+#include <thread>
 #include <utility>
 
 namespace qbs {
@@ -81,6 +87,12 @@ namespace Internal {
 
 bool Executor::ComparePriority::operator() (const BuildGraphNode *x, const BuildGraphNode *y) const
 {
+    // Nodes on the longest remaining path go first. If a node's duration is not known from
+    // earlier builds, there is nothing to compare, and the product order decides.
+    if (x->criticalPathCostKnown && y->criticalPathCostKnown
+            && x->criticalPathCost != y->criticalPathCost) {
+        return x->criticalPathCost < y->criticalPathCost;
+    }
     return x->product->buildData->buildPriority() < y->product->buildData->buildPriority();
 }
 
@@ -92,17 +104,23 @@ Executor::Executor(Logger logger, QObject *parent)
     , m_progressObserver(nullptr)
     , m_state(ExecutorIdle)
     , m_cancelationTimer(new QTimer(this))
+    , m_memoryPollTimer(new QTimer(this))
 {
     m_inputArtifactScanContext = new InputArtifactScannerContext;
     m_cancelationTimer->setSingleShot(false);
     m_cancelationTimer->setInterval(1000);
     connect(m_cancelationTimer, &QTimer::timeout, this, &Executor::checkForCancellation);
+    m_memoryPollTimer->setSingleShot(true);
+    m_memoryPollTimer->setInterval(250);
+    connect(m_memoryPollTimer, &QTimer::timeout, this, &Executor::retryThrottledJobs);
 }
 
 Executor::~Executor()
 {
-    // jobs must be destroyed before deleting the m_inputArtifactScanContext
+    JobBudget::instance().unregisterClient(this);
+    // jobs and worker threads must be destroyed before deleting the m_inputArtifactScanContext
     m_allJobs.clear();
+    m_prescanner.reset();
     delete m_inputArtifactScanContext;
     delete m_productInstaller;
 }
@@ -110,14 +128,14 @@ Executor::~Executor()
 FileTime Executor::recursiveFileTime(const QString &filePath) const
 {
     FileTime newest;
-    FileInfo fileInfo(filePath);
-    if (!fileInfo.exists()) {
+    const FileStatusPrefetcher::FileStatus fileStatus = m_fileStatuses.status(filePath);
+    if (!fileStatus.exists) {
         const QString nativeFilePath = QDir::toNativeSeparators(filePath);
         m_logger.qbsWarning() << Tr::tr("File '%1' not found.").arg(nativeFilePath);
         return newest;
     }
-    newest = std::max(fileInfo.lastModified(), fileInfo.lastStatusChange());
-    if (!fileInfo.isDir())
+    newest = std::max(fileStatus.lastModified, fileStatus.lastStatusChange);
+    if (!fileStatus.isDir)
         return newest;
     const QStringList dirContents = QDir(filePath)
             .entryList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
@@ -133,10 +151,13 @@ void Executor::retrieveSourceFileTimestamp(Artifact *artifact) const
 {
     QBS_CHECK(artifact->artifactType == Artifact::SourceFile);
 
+    const FileTime previousTimestamp = artifact->timestamp();
     if (m_buildOptions.changedFiles().contains(artifact->filePath()))
         artifact->setTimestamp(FileTime::currentTime());
     else if (m_buildOptions.changedFiles().empty() || !artifact->timestamp().isValid())
         artifact->setTimestamp(recursiveFileTime(artifact->filePath()));
+    if (artifact->timestamp() != previousTimestamp)
+        setBuildDataDirty(artifact);
 
     artifact->timestampRetrieved = true;
     if (!artifact->timestamp().isValid())
@@ -257,7 +278,13 @@ void Executor::doBuild()
     m_tagsNeededForFilesToConsider.clear();
     m_productsOfFilesToConsider.clear();
     m_artifactsRemovedFromDisk.clear();
-    m_jobCountPerPool.clear();
+    m_prescanner.reset();
+    m_inputArtifactScanContext->scanRegistry.reset();
+    m_pendingPrescanCount = 0;
+    m_memoryMonitor = MemoryMonitor(qint64(m_buildOptions.minAvailableMemory()) * 1024 * 1024,
+                                    m_buildOptions.maxMemoryPressure());
+    m_memoryThrottleCount = 0;
+    m_memoryThrottled = false;
 
     setupJobLimits();
 
@@ -317,9 +344,31 @@ void Executor::doBuild()
     if (m_buildOptions.removeExistingInstallation())
         m_productInstaller->removeInstallRoot();
 
+    if ((!m_buildOptions.actionCacheDirectory().isEmpty()
+            || !m_buildOptions.remoteActionCacheUrl().isEmpty()) && !m_buildOptions.dryRun()) {
+        QString actionCacheDirectory = m_buildOptions.actionCacheDirectory();
+        if (actionCacheDirectory.isEmpty()) {
+            // Remote entries are always materialized via the local cache.
+            actionCacheDirectory = QStandardPaths::writableLocation(
+                        QStandardPaths::GenericCacheLocation) + QLatin1String("/qbs/action-cache");
+        }
+        m_actionCache = std::make_unique<ActionCache>(
+                    actionCacheDirectory,
+                    qint64(m_buildOptions.actionCacheMaxSize()) * 1024 * 1024, m_logger);
+        if (!m_buildOptions.remoteActionCacheUrl().isEmpty()) {
+            m_actionCache->setRemoteCache(RemoteActionCache::create(
+                                              m_buildOptions.remoteActionCacheUrl(), m_logger));
+        }
+    }
+
     addExecutorJobs();
+    prefetchFileStatuses();
     syncFileDependencies();
     prepareAllNodes();
+
+    // From here on, files can change on disk, so we must not use the prefetched data anymore.
+    m_fileStatuses.clear();
+
     prepareProducts();
     setupRootNodes();
     prepareReachableNodes();
@@ -359,7 +408,7 @@ void Executor::updateLeaves(BuildGraphNode *node, NodeSet &seenNodes)
     // Artifacts that appear in the build graph after
     // prepareBuildGraph() has been called, must be initialized.
     if (node->buildState == BuildGraphNode::Untouched) {
-        node->buildState = BuildGraphNode::Buildable;
+        setBuildable(node);
         if (node->type() == BuildGraphNode::ArtifactNodeType) {
             auto const artifact = static_cast<Artifact *>(node);
             if (artifact->artifactType == Artifact::SourceFile)
@@ -367,24 +416,68 @@ void Executor::updateLeaves(BuildGraphNode *node, NodeSet &seenNodes)
         }
     }
 
-    bool isLeaf = true;
     for (BuildGraphNode *child : std::as_const(node->children)) {
-        if (child->buildState != BuildGraphNode::Built) {
-            isLeaf = false;
+        if (child->buildState != BuildGraphNode::Built)
             updateLeaves(child, seenNodes);
-        }
     }
 
-    if (isLeaf) {
+    if (node->buildState == BuildGraphNode::Buildable && node->pendingChildCount == 0) {
         qCDebug(lcExec).noquote() << "adding leaf" << node->toString();
-        m_leaves.push(node);
+        addLeaf(node);
+    }
+}
+
+void Executor::setBuildable(BuildGraphNode *node)
+{
+    node->buildState = BuildGraphNode::Buildable;
+    node->pendingChildCount = int(std::count_if(node->children.cbegin(), node->children.cend(),
+                                                [](const BuildGraphNode *child) {
+        return !child->isBuilt();
+    }));
+}
+
+void Executor::addLeaf(BuildGraphNode *node)
+{
+    criticalPathCost(node);
+    m_leaves.push(node);
+}
+
+qint64 Executor::criticalPathCost(BuildGraphNode *node)
+{
+    if (node->criticalPathCost >= 0)
+        return node->criticalPathCost;
+    node->criticalPathCost = 0; // Protects against cycles, which are reported elsewhere.
+    node->criticalPathCostKnown = false;
+
+    qint64 maxParentCost = 0;
+    bool known = false;
+    for (BuildGraphNode * const parent : std::as_const(node->parents)) {
+        if (parent->buildState == BuildGraphNode::Untouched
+                || parent->buildState == BuildGraphNode::Built) {
+            continue;
+        }
+        maxParentCost = std::max(maxParentCost, criticalPathCost(parent));
+        known = known || parent->criticalPathCostKnown;
+    }
+
+    qint64 ownCost = 0;
+    if (node->type() == BuildGraphNode::ArtifactNodeType) {
+        const auto artifact = static_cast<const Artifact *>(node);
+        if (artifact->transformer && artifact->transformer->lastCommandExecutionDuration >= 0) {
+            ownCost = artifact->transformer->lastCommandExecutionDuration;
+            known = true;
+        }
     }
+    node->criticalPathCost = ownCost + maxParentCost;
+    node->criticalPathCostKnown = known;
+    return node->criticalPathCost;
 }
 
 // Returns true if some artifacts are still waiting to be built or currently building.
 bool Executor::scheduleJobs()
 {
     QBS_CHECK(m_state == ExecutorRunning);
+    m_outOfJobTokens = false;
     std::vector<BuildGraphNode *> delayedLeaves;
     while (!m_leaves.empty() && !m_availableJobs.empty()) {
         BuildGraphNode * const nodeToBuild = m_leaves.top();
@@ -395,18 +488,17 @@ bool Executor::scheduleJobs()
             QBS_ASSERT(!"untouched node in leaves list",
                        qDebug("%s", qPrintable(nodeToBuild->toString())));
             break;
-        case BuildGraphNode::Buildable: // This is the only state in which we want to build a node.
-            // TODO: It's a bit annoying that we have to check this here already, when we
-            //       don't know whether the transformer needs to run at all. Investigate
-            //       moving the whole job allocation logic to runTransformer().
-            if (schedulingBlockedByJobLimit(nodeToBuild)) {
-                qCDebug(lcExec).noquote() << "node delayed due to occupied job pool:"
-                                          << nodeToBuild->toString();
+        case BuildGraphNode::Buildable: { // This is the only state in which we want to build a node.
+            // A job token is only acquired once it is clear that a command has to run,
+            // so nodes that are up to date do not have to go through the job budget.
+            m_nodeBeingScheduled = nodeToBuild;
+            m_nodeBeingScheduledDelayed = false;
+            nodeToBuild->accept(this);
+            m_nodeBeingScheduled = nullptr;
+            if (m_nodeBeingScheduledDelayed)
                 delayedLeaves.push_back(nodeToBuild);
-            } else {
-                nodeToBuild->accept(this);
-            }
             break;
+        }
         case BuildGraphNode::Building:
             qCDebug(lcExec).noquote() << nodeToBuild->toString();
             qCDebug(lcExec) << "node is currently being built. Skipping.";
@@ -419,49 +511,130 @@ bool Executor::scheduleJobs()
     }
     for (BuildGraphNode * const delayedLeaf : delayedLeaves)
         m_leaves.push(delayedLeaf);
-    return !m_leaves.empty() || !m_processingJobs.empty();
+    JobBudget::instance().returnUnusedTokens(this);
+    return !m_leaves.empty() || !m_processingJobs.empty() || m_pendingPrescanCount > 0;
 }
 
-bool Executor::schedulingBlockedByJobLimit(const BuildGraphNode *node)
+// Called when the commands of the transformer have to run. If no job token can be had,
+// the node that scheduleJobs() is visiting stays buildable and gets scheduled again later.
+bool Executor::acquireJobToken(const Transformer *transformer)
 {
-    if (node->type() != BuildGraphNode::ArtifactNodeType)
+    BuildGraphNode * const node = m_nodeBeingScheduled;
+    QBS_CHECK(node);
+    if (m_outOfJobTokens) {
+        m_nodeBeingScheduledDelayed = true;
         return false;
-    const auto artifact = static_cast<const Artifact *>(node);
-    if (artifact->artifactType == Artifact::SourceFile)
+    }
+    JobBudget &jobBudget = JobBudget::instance();
+    switch (jobBudget.tryAcquire(this, node->criticalPathCost, jobPoolLimits(transformer))) {
+    case JobBudget::AcquireResult::BlockedByJobLimit:
+        qCDebug(lcExec).noquote() << "node delayed due to occupied job pool:" << node->toString();
+        m_nodeBeingScheduledDelayed = true;
+        return false;
+    case JobBudget::AcquireResult::BlockedByBudget:
+        qCDebug(lcExec).noquote() << "node delayed due to jobs of other builds:"
+                                  << node->toString();
+        m_outOfJobTokens = true;
+        m_nodeBeingScheduledDelayed = true;
+        return false;
+    case JobBudget::AcquireResult::Acquired:
+        break;
+    }
+    if (schedulingBlockedByMemory(node)) {
+        qCDebug(lcExec).noquote() << "node delayed due to low memory:" << node->toString();
+        jobBudget.release(this, transformer->jobPools());
+        m_nodeBeingScheduledDelayed = true;
         return false;
+    }
+    return true;
+}
 
-    const Transformer * const transformer = artifact->transformer.get();
-    for (const QString &jobPool : transformer->jobPools()) {
-        const int currentJobCount = m_jobCountPerPool[jobPool];
-        if (currentJobCount == 0)
-            continue;
-        const auto jobLimitIsExceeded = [currentJobCount, jobPool, this](const Transformer *t) {
-            const auto it = m_jobLimitsPerProduct.find(t->product().get());
-            if (it == m_jobLimitsPerProduct.cend())
-                return false; // See checkNodeProduct() for why this is possible
-            const int maxJobCount = it->second.getLimit(jobPool);
-            return maxJobCount > 0 && currentJobCount >= maxJobCount;
-        };
+JobBudget::PoolLimits Executor::jobPoolLimits(const Transformer *transformer) const
+{
+    const auto jobLimit = [this](const Transformer *t, const QString &jobPool) {
+        const auto it = m_jobLimitsPerProduct.find(t->product().get());
+        if (it == m_jobLimitsPerProduct.cend())
+            return -1; // See checkNodeProduct() for why this is possible
+        return it->second.getLimit(jobPool);
+    };
 
+    JobBudget::PoolLimits poolLimits;
+    for (const QString &jobPool : transformer->jobPools()) {
         // Different products can set different limits. The effective limit is the minimum of what
         // is set in this transformer's product and in the products of all currently
         // running transformers.
-        if (jobLimitIsExceeded(transformer))
-            return true;
-        const auto runningJobs = m_processingJobs.keys();
-        for (const ExecutorJob * const runningJob : runningJobs) {
-            if (!runningJob->jobPools().contains(jobPool))
+        int effectiveLimit = jobLimit(transformer, jobPool);
+        for (auto it = m_processingJobs.cbegin(); it != m_processingJobs.cend(); ++it) {
+            if (!it.key()->jobPools().contains(jobPool))
                 continue;
-            const Transformer * const runningTransformer = runningJob->transformer();
+            const Transformer * const runningTransformer = it.key()->transformer();
             if (!runningTransformer)
                 continue; // This can happen if the ExecutorJob has already finished.
             if (runningTransformer->product() == transformer->product())
                 continue; // We have already checked this product's job limit.
-            if (jobLimitIsExceeded(runningTransformer))
-                return true;
+            const int limit = jobLimit(runningTransformer, jobPool);
+            if (limit > 0 && (effectiveLimit <= 0 || limit < effectiveLimit))
+                effectiveLimit = limit;
         }
+        poolLimits.emplace_back(jobPool, effectiveLimit);
+    }
+    return poolLimits;
+}
+
+// Holds back jobs while the system is low on memory, so that memory-hungry commands
+// such as linkers running in parallel do not exhaust it. There is always at least one job
+// running in that case, and its completion or the poll timer make us re-check.
+bool Executor::schedulingBlockedByMemory(const BuildGraphNode *node)
+{
+    if (!m_memoryMonitor.isEnabled() || m_processingJobs.empty())
+        return false;
+    if (node->type() != BuildGraphNode::ArtifactNodeType)
+        return false;
+    const auto artifact = static_cast<const Artifact *>(node);
+    if (artifact->artifactType == Artifact::SourceFile)
+        return false;
+    const QStringList heavyJobPools = m_buildOptions.memoryHeavyJobPools();
+    if (!heavyJobPools.empty() && none_of(artifact->transformer->jobPools(),
+                                          [&heavyJobPools](const QString &jobPool) {
+                                              return heavyJobPools.contains(jobPool); })) {
+        return false;
+    }
+
+    if (!m_memoryMonitor.isMemoryLow()) {
+        if (m_memoryThrottled) {
+            qCDebug(lcExec) << "memory is available again, resuming job scheduling";
+            m_memoryThrottled = false;
+        }
+        return false;
+    }
+    if (!m_memoryThrottled) {
+        qCDebug(lcExec) << "low memory, holding back jobs; available memory:"
+                        << m_memoryMonitor.availableMemory() << "bytes, memory pressure:"
+                        << m_memoryMonitor.memoryPressure();
+        m_memoryThrottled = true;
+        ++m_memoryThrottleCount;
+    }
+    if (!m_memoryPollTimer->isActive())
+        m_memoryPollTimer->start();
+    return true;
+}
+
+void Executor::retryThrottledJobs()
+{
+    if (m_state != ExecutorRunning)
+        return;
+    if (m_evalContext->engine()->isActive()) {
+        m_memoryPollTimer->start();
+        return;
+    }
+    try {
+        if (!scheduleJobs()) {
+            qCDebug(lcExec) << "Nothing left to build; finishing.";
+            finish();
+        }
+    } catch (const ErrorInfo &error) {
+        handleError(error);
     }
-    return false;
 }
 
 bool Executor::isUpToDate(Artifact *artifact) const
@@ -472,7 +645,12 @@ bool Executor::isUpToDate(Artifact *artifact) const
                              << artifact->timestamp().toString();
 
     if (m_buildOptions.forceTimestampCheck()) {
-        artifact->setTimestamp(FileInfo(artifact->filePath()).lastModified());
+        const FileTime fileTime = FileInfo(artifact->filePath()).lastModified();
+        if (fileTime != artifact->timestamp()) {
+            artifact->clearContentInfo(); // Modified outside of qbs.
+            setBuildDataDirty(artifact);
+        }
+        artifact->setTimestamp(fileTime);
         qCDebug(lcUpToDateCheck) << "timestamp retrieved from filesystem:"
                                  << artifact->timestamp().toString();
     }
@@ -485,9 +663,9 @@ bool Executor::isUpToDate(Artifact *artifact) const
     for (Artifact *childArtifact : filterByType<Artifact>(artifact->children)) {
         QBS_CHECK(!childArtifact->alwaysUpdated || childArtifact->timestamp().isValid());
         qCDebug(lcUpToDateCheck) << "child timestamp"
-                                 << childArtifact->timestamp().toString()
+                                 << childArtifact->effectiveTimestamp().toString()
                                  << childArtifact->filePath();
-        if (artifact->timestamp() < childArtifact->timestamp())
+        if (artifact->timestamp() < childArtifact->effectiveTimestamp())
             return false;
     }
 
@@ -507,6 +685,28 @@ bool Executor::isUpToDate(Artifact *artifact) const
     return true;
 }
 
+// Returns true if the artifact was re-generated with the same content it had before,
+// in which case its parents do not need to be rebuilt because of it.
+// The digest was calculated by the executor job, outside of this thread.
+bool Executor::updateContentInfo(Artifact *artifact, const QByteArray &digest,
+                                 const FileTime &previousContentTimestamp) const
+{
+    if (m_buildOptions.dryRun())
+        return false;
+    if (!m_buildOptions.checkContents()) {
+        artifact->clearContentInfo();
+        return false;
+    }
+
+    const bool contentUnchanged = !digest.isEmpty() && digest == artifact->contentDigest
+            && previousContentTimestamp.isValid();
+    artifact->contentDigest = digest;
+    artifact->contentTimestamp = contentUnchanged ? previousContentTimestamp : FileTime();
+    if (contentUnchanged)
+        qCDebug(lcExec) << "content unchanged:" << relativeArtifactFileName(artifact);
+    return contentUnchanged;
+}
+
 bool Executor::mustExecuteTransformer(const TransformerPtr &transformer) const
 {
     if (transformer->alwaysRun)
@@ -568,11 +768,75 @@ void Executor::buildArtifact(Artifact *artifact)
 
 void Executor::executeRuleNode(RuleNode *ruleNode)
 {
-    AccumulatingTimer rulesTimer(m_buildOptions.logElapsedTime() ? &m_elapsedTimeRules : nullptr);
-
     if (!checkNodeProduct(ruleNode))
         return;
 
+    // Scanning the inputs with plugins can take a long time, e.g. for C++ sources that
+    // include large headers, so we do it in worker threads and apply the rule afterwards.
+    // Meanwhile, the executor keeps scheduling other nodes.
+    if (m_buildOptions.maxJobCount() > 1) {
+        std::vector<InputArtifactPrescanner::Job> jobs
+                = ruleNode->prescanJobs(m_logger, m_inputArtifactScanContext);
+        if (!jobs.empty()) {
+            if (!m_prescanner) {
+                int threadCount = m_buildOptions.maxJobCount();
+                const int maxConcurrency = std::thread::hardware_concurrency();
+                if (maxConcurrency > 0 && maxConcurrency < threadCount)
+                    threadCount = maxConcurrency;
+                m_inputArtifactScanContext->scanRegistry = std::make_unique<ScanRegistry>(
+                            m_project->buildData->rawScanResults);
+                m_prescanner = std::make_unique<InputArtifactPrescanner>(
+                            threadCount, m_inputArtifactScanContext->scanRegistry.get());
+            }
+            qCDebug(lcExec).noquote() << "prescanning" << jobs.size() << "inputs of"
+                                      << ruleNode->toString();
+            ruleNode->buildState = BuildGraphNode::Building;
+            ++m_pendingPrescanCount;
+            m_prescanner->scan(std::move(jobs), [this, ruleNode] {
+                onInputsPrescanned(ruleNode);
+            });
+            return;
+        }
+    }
+
+    applyRuleNode(ruleNode);
+}
+
+void Executor::onInputsPrescanned(RuleNode *ruleNode)
+{
+    try {
+        if (m_evalContext->engine()->isActive()) {
+            qCDebug(lcExec) << "Prescan finished while rule execution is pausing. "
+                               "Delaying slot execution.";
+            QTimer::singleShot(0, this, [this, ruleNode] { onInputsPrescanned(ruleNode); });
+            return;
+        }
+
+        --m_pendingPrescanCount;
+        if (m_state == ExecutorCanceling) {
+            if (m_processingJobs.empty() && m_pendingPrescanCount == 0) {
+                qCDebug(lcExec) << "All pending jobs are done, finishing.";
+                finish();
+            }
+            return;
+        }
+
+        m_inputArtifactScanContext->mergePrescanResults(m_project->buildData.get());
+        applyRuleNode(ruleNode);
+        if (!scheduleJobs()) {
+            qCDebug(lcExec) << "Nothing left to build; finishing.";
+            finish();
+        }
+    } catch (const ErrorInfo &error) {
+        handleError(error);
+    }
+}
+
+void Executor::applyRuleNode(RuleNode *ruleNode)
+{
+    AccumulatingTimer rulesTimer(m_buildOptions.logElapsedTime() ? &m_elapsedTimeRules : nullptr);
+    TraceSpan ruleSpan([ruleNode] { return ruleNode->toString(); }, "rule");
+
     QBS_CHECK(!m_evalContext->engine()->isActive());
 
     const RuleNode::ApplicationResult result = ruleNode->apply(
@@ -603,16 +867,17 @@ void Executor::finishJob(ExecutorJob *job, bool success)
     const JobMap::Iterator it = m_processingJobs.find(job);
     QBS_CHECK(it != m_processingJobs.end());
     const TransformerPtr transformer = it.value();
+    const QHash<QString, QByteArray> outputDigests = job->takeOutputDigests();
     m_processingJobs.erase(it);
     m_availableJobs.push_back(job);
-    updateJobCounts(transformer.get(), -1);
+    JobBudget::instance().release(this, transformer->jobPools());
     if (success) {
         m_project->buildData->setDirty();
+        transformer->product()->buildData->setDirty();
         for (Artifact * const artifact : std::as_const(transformer->outputs)) {
+            const FileTime previousContentTimestamp = artifact->effectiveTimestamp();
             if (artifact->alwaysUpdated) {
                 artifact->setTimestamp(FileTime::currentTime());
-                for (Artifact * const parent : artifact->parentArtifacts())
-                    parent->transformer->markedForRerun = true;
                 if (m_buildOptions.forceOutputCheck()
                         && !m_buildOptions.dryRun() && !FileInfo(artifact->filePath()).exists()) {
                     if (transformer->rule) {
@@ -632,6 +897,14 @@ void Executor::finishJob(ExecutorJob *job, bool success)
             } else {
                 artifact->setTimestamp(FileInfo(artifact->filePath()).lastModified());
             }
+            if (!updateContentInfo(artifact, outputDigests.value(artifact->filePath()),
+                                   previousContentTimestamp)
+                    && artifact->alwaysUpdated) {
+                for (Artifact * const parent : artifact->parentArtifacts()) {
+                    parent->transformer->markedForRerun = true;
+                    setBuildDataDirty(parent);
+                }
+            }
         }
         finishTransformer(transformer);
     }
@@ -646,7 +919,7 @@ void Executor::finishJob(ExecutorJob *job, bool success)
     }
 
     if (m_state == ExecutorCanceling) {
-        if (m_processingJobs.empty()) {
+        if (m_processingJobs.empty() && m_pendingPrescanCount == 0) {
             qCDebug(lcExec) << "All pending jobs are done, finishing.";
             finish();
         }
@@ -659,13 +932,10 @@ void Executor::finishJob(ExecutorJob *job, bool success)
     }
 }
 
-static bool allChildrenBuilt(BuildGraphNode *node)
-{
-    return Internal::all_of(node->children, std::mem_fn(&BuildGraphNode::isBuilt));
-}
-
 void Executor::finishNode(BuildGraphNode *leaf)
 {
+    if (leaf->buildState == BuildGraphNode::Built)
+        return;
     leaf->buildState = BuildGraphNode::Built;
     for (BuildGraphNode * const parent : std::as_const(leaf->parents)) {
         if (parent->buildState != BuildGraphNode::Buildable) {
@@ -674,8 +944,9 @@ void Executor::finishNode(BuildGraphNode *leaf)
             continue;
         }
 
-        if (allChildrenBuilt(parent)) {
-            m_leaves.push(parent);
+        QBS_CHECK(parent->pendingChildCount > 0);
+        if (--parent->pendingChildCount == 0) {
+            addLeaf(parent);
             qCDebug(lcExec).noquote() << "finishNode adds leaf"
                                       << parent->toString() << toString(parent->buildState);
         } else {
@@ -751,12 +1022,6 @@ void Executor::setupJobLimits()
     }
 }
 
-void Executor::updateJobCounts(const Transformer *transformer, int diff)
-{
-    for (const QString &jobPool : transformer->jobPools())
-        m_jobCountPerPool[jobPool] += diff;
-}
-
 void Executor::cancelJobs()
 {
     if (m_state == ExecutorCanceling)
@@ -797,7 +1062,7 @@ void Executor::handleError(const ErrorInfo &error)
     const auto items = error.items();
     for (const ErrorItem &ei : items)
         m_error.append(ei);
-    if (m_processingJobs.empty())
+    if (m_processingJobs.empty() && m_pendingPrescanCount == 0)
         finish();
     else
         cancelJobs();
@@ -809,13 +1074,21 @@ void Executor::addExecutorJobs()
     qCDebug(lcExec) << "preparing executor for" << count << "jobs in parallel";
     m_allJobs.reserve(count);
     m_availableJobs.reserve(count);
+    const int firstTraceLane = TraceRecorder::instance().isEnabled()
+            ? TraceRecorder::instance().reserveLanes(count, Tr::tr("Job slot (%1)")
+                                                     .arg(m_project->id()))
+            : -1;
     for (int i = 1; i <= count; i++) {
         m_allJobs.push_back(std::make_unique<ExecutorJob>(m_logger));
         const auto job = m_allJobs.back().get();
         job->setMainThreadScriptEngine(m_evalContext->engine());
         job->setObjectName(QStringLiteral("J%1").arg(i));
+        if (firstTraceLane != -1)
+            job->setTraceLane(firstTraceLane + i - 1);
         job->setDryRun(m_buildOptions.dryRun());
+        job->setCheckContents(m_buildOptions.checkContents());
         job->setEchoMode(m_buildOptions.echoMode());
+        job->setActionCache(m_actionCache.get());
         m_availableJobs.push_back(job);
         connect(job, &ExecutorJob::reportCommandDescription,
                 this, &Executor::reportCommandDescription);
@@ -823,6 +1096,11 @@ void Executor::addExecutorJobs()
         connect(job, &ExecutorJob::finished,
                 this, &Executor::onJobFinished, Qt::QueuedConnection);
     }
+
+    // Called from the thread of whichever executor released the token.
+    JobBudget::instance().registerClient(this, count, [this] {
+        QMetaObject::invokeMethod(this, &Executor::retryThrottledJobs, Qt::QueuedConnection);
+    });
 }
 
 void Executor::potentiallyRunTransformer(const TransformerPtr &transformer)
@@ -848,7 +1126,7 @@ void Executor::potentiallyRunTransformer(const TransformerPtr &transformer)
 
     if (m_buildOptions.executeRulesOnly())
         finishTransformer(transformer);
-    else
+    else if (acquireJobToken(transformer.get()))
         runTransformer(transformer);
 }
 
@@ -872,13 +1150,16 @@ void Executor::runTransformer(const TransformerPtr &transformer)
     for (Artifact * const artifact : std::as_const(transformer->outputs))
         artifact->buildState = BuildGraphNode::Building;
     m_processingJobs.insert(job, transformer);
-    updateJobCounts(transformer.get(), 1);
+    transformer->product()->buildData->setDirty();
     job->run(transformer.get());
 }
 
 void Executor::finishTransformer(const TransformerPtr &transformer)
 {
-    transformer->markedForRerun = false;
+    if (transformer->markedForRerun) {
+        transformer->markedForRerun = false;
+        transformer->product()->buildData->setDirty();
+    }
     for (Artifact * const artifact : std::as_const(transformer->outputs)) {
         possiblyInstallArtifact(artifact);
         finishArtifact(artifact);
@@ -999,10 +1280,13 @@ void Executor::finish()
         m_error.append(Tr::tr("%1%2.").arg(message, configString()));
     }
     setState(ExecutorIdle);
+    m_memoryPollTimer->stop();
+    JobBudget::instance().unregisterClient(this);
     if (m_progressObserver) {
         m_progressObserver->setFinished();
         m_cancelationTimer->stop();
     }
+    emit buildGraphComplete();
 
     EmptyDirectoriesRemover(m_project.get(), m_logger)
             .removeEmptyParentDirectories(m_artifactsRemovedFromDisk);
@@ -1016,6 +1300,29 @@ void Executor::finish()
                                              .arg(elapsedTimeString(m_elapsedTimeInstalling));
     }
 
+    if (m_memoryThrottleCount > 0) {
+        m_logger.qbsInfo() << Tr::tr("Starting jobs was held back %n time(s) due to low memory.",
+                                     nullptr, m_memoryThrottleCount);
+    }
+
+    if (m_actionCache) {
+        if (m_actionCache->hitCount() > 0 || m_actionCache->missCount() > 0) {
+            m_logger.qbsInfo() << Tr::tr("Action cache: %1 hit(s), %2 miss(es).")
+                                  .arg(m_actionCache->hitCount())
+                                  .arg(m_actionCache->missCount());
+        }
+        if (RemoteActionCache * const remoteCache = m_actionCache->remoteCache()) {
+            remoteCache->waitForPendingOperations(30000);
+            if (m_actionCache->remoteHitCount() > 0 || m_actionCache->uploadCount() > 0) {
+                m_logger.qbsInfo() << Tr::tr("Remote action cache: %1 hit(s), %2 upload(s).")
+                                      .arg(m_actionCache->remoteHitCount())
+                                      .arg(m_actionCache->uploadCount());
+            }
+        }
+        if (m_actionCache->storeCount() > 0)
+            m_actionCache->trim();
+    }
+
     emit finished();
 }
 
@@ -1043,6 +1350,34 @@ bool Executor::visit(RuleNode *ruleNode)
     return false;
 }
 
+/**
+  * Retrieves the status of all source files and file dependencies whose timestamps
+  * are needed by syncFileDependencies() and prepareAllNodes() in one parallel batch,
+  * rather than one by one during graph traversal.
+  */
+void Executor::prefetchFileStatuses()
+{
+    TraceSpan prefetchSpan(Tr::tr("Retrieving file timestamps"), "buildgraph");
+    const QStringList &changedFiles = m_buildOptions.changedFiles();
+    const auto addIfNeeded = [&](const FileResourceBase *file) {
+        if (changedFiles.empty() || !file->timestamp().isValid()
+                || changedFiles.contains(file->filePath())) {
+            m_fileStatuses.addFile(file->filePath());
+        }
+    };
+    for (const FileDependency * const dep : std::as_const(m_project->buildData->fileDependencies))
+        addIfNeeded(dep);
+    for (const ResolvedProductPtr &product : std::as_const(m_buildableProducts)) {
+        for (const Artifact * const artifact
+             : filterByType<Artifact>(product->buildData->allNodes())) {
+            if (artifact->artifactType == Artifact::SourceFile)
+                addIfNeeded(artifact);
+        }
+    }
+    m_fileStatuses.run(m_buildOptions.maxJobCount());
+    qCDebug(lcExec) << "retrieved status of" << m_fileStatuses.fileCount() << "files";
+}
+
 /**
   * Sets the state of all artifacts in the graph to "untouched".
   * This must be done before doing a build.
@@ -1056,8 +1391,10 @@ void Executor::prepareAllNodes()
     for (const ResolvedProductPtr &product : m_allProducts) {
         if (product->enabled) {
             QBS_CHECK(product->buildData);
-            for (BuildGraphNode * const node : std::as_const(product->buildData->allNodes()))
+            for (BuildGraphNode * const node : std::as_const(product->buildData->allNodes())) {
                 node->buildState = BuildGraphNode::Untouched;
+                node->criticalPathCost = -1;
+            }
         }
     }
     for (const ResolvedProductPtr &product : std::as_const(m_buildableProducts)) {
@@ -1072,15 +1409,21 @@ void Executor::syncFileDependencies()
     Set<FileDependency *> &globalFileDepList = m_project->buildData->fileDependencies;
     for (auto it = globalFileDepList.begin(); it != globalFileDepList.end(); ) {
         FileDependency * const dep = *it;
-        FileInfo fi(dep->filePath());
-        if (fi.exists()) {
-            dep->setTimestamp(fi.lastModified());
+        if (!m_buildOptions.changedFiles().empty() && dep->timestamp().isValid()
+                && !m_buildOptions.changedFiles().contains(dep->filePath())) {
+            ++it;
+            continue;
+        }
+        const FileStatusPrefetcher::FileStatus fileStatus = m_fileStatuses.status(dep->filePath());
+        if (fileStatus.exists) {
+            dep->setTimestamp(fileStatus.lastModified);
             ++it;
             continue;
         }
         qCDebug(lcBuildGraph()) << "file dependency" << dep->filePath() << "no longer exists; "
                                    "removing from lookup table";
         m_project->buildData->removeFromLookupTable(dep);
+        m_project->restoreBuildDataReferringTo(dep);
         bool isReferencedByArtifact = false;
         for (const auto &product : m_allProducts) {
             if (!product->buildData)
@@ -1154,7 +1497,7 @@ void Executor::prepareReachableNodes_impl(BuildGraphNode *node)
     if (node->buildState != BuildGraphNode::Untouched)
         return;
 
-    node->buildState = BuildGraphNode::Buildable;
+    setBuildable(node);
     for (BuildGraphNode *child : std::as_const(node->children))
         prepareReachableNodes_impl(child);
 }
@@ -1187,6 +1530,7 @@ void Executor::prepareProducts()
                 }
             }
             product->buildData->markRescuableArtifactsOutOfDate();
+            product->buildData->setDirty();
         }
     }
     for (const QString &scannerId : scannersToInvalidate)
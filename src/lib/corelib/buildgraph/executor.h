@@ -42,12 +42,16 @@
 
 #include "forward_decls.h"
 #include "buildgraphvisitor.h"
+#include "inputartifactprescanner.h"
+#include "jobbudget.h"
 #include <buildgraph/artifact.h>
 #include <language/forward_decls.h>
 
 #include <logging/logger.h>
 #include <tools/buildoptions.h>
 #include <tools/error.h>
+#include <tools/filestatusprefetcher.h>
+#include <tools/memorymonitor.h>
 #include <tools/qttools.h>
 
 #include <QtCore/qobject.h>
@@ -63,6 +67,7 @@ namespace qbs {
 class ProcessResult;
 
 namespace Internal {
+class ActionCache;
 class ExecutorJob;
 class FileTime;
 class InputArtifactScannerContext;
@@ -91,6 +96,9 @@ signals:
     void reportCommandDescription(const QString &highlight, const QString &message);
     void reportProcessResult(const qbs::ProcessResult &result);
 
+    // Emitted from finish() once the build graph does not change anymore, so it can be
+    // stored while the remaining work is done. Receivers must use a direct connection.
+    void buildGraphComplete();
     void finished();
 
 private:
@@ -114,6 +122,7 @@ private:
                                        ComparePriority>;
 
     void doBuild();
+    void prefetchFileStatuses();
     void prepareAllNodes();
     void syncFileDependencies();
     void prepareArtifact(Artifact *artifact);
@@ -125,9 +134,14 @@ private:
     void initLeaves();
     void updateLeaves(const NodeSet &nodes);
     void updateLeaves(BuildGraphNode *node, NodeSet &seenNodes);
+    void addLeaf(BuildGraphNode *node);
+    void setBuildable(BuildGraphNode *node);
+    qint64 criticalPathCost(BuildGraphNode *node);
     bool scheduleJobs();
     void buildArtifact(Artifact *artifact);
     void executeRuleNode(RuleNode *ruleNode);
+    void applyRuleNode(RuleNode *ruleNode);
+    void onInputsPrescanned(RuleNode *ruleNode);
     void finishJob(ExecutorJob *job, bool success);
     void finishNode(BuildGraphNode *leaf);
     void finishArtifact(Artifact *artifact);
@@ -146,6 +160,8 @@ private:
 
     bool mustExecuteTransformer(const TransformerPtr &transformer) const;
     bool isUpToDate(Artifact *artifact) const;
+    bool updateContentInfo(Artifact *artifact, const QByteArray &digest,
+                           const FileTime &previousContentTimestamp) const;
     void retrieveSourceFileTimestamp(Artifact *artifact) const;
     FileTime recursiveFileTime(const QString &filePath) const;
     QString configString() const;
@@ -154,8 +170,10 @@ private:
     bool transformerHasMatchingInputFiles(const TransformerConstPtr &transformer) const;
 
     void setupJobLimits();
-    void updateJobCounts(const Transformer *transformer, int diff);
-    bool schedulingBlockedByJobLimit(const BuildGraphNode *node);
+    bool acquireJobToken(const Transformer *transformer);
+    JobBudget::PoolLimits jobPoolLimits(const Transformer *transformer) const;
+    bool schedulingBlockedByMemory(const BuildGraphNode *node);
+    void retryThrottledJobs();
 
     using JobMap = QHash<ExecutorJob *, TransformerPtr>;
     JobMap m_processingJobs;
@@ -166,6 +184,17 @@ private:
     Logger m_logger;
     ProgressObserver *m_progressObserver;
     std::vector<std::unique_ptr<ExecutorJob>> m_allJobs;
+    std::unique_ptr<ActionCache> m_actionCache;
+    std::unique_ptr<InputArtifactPrescanner> m_prescanner;
+    int m_pendingPrescanCount = 0;
+
+    // The node scheduleJobs() is visiting. It gets delayed if it needs a job,
+    // but no job token can be acquired for it.
+    BuildGraphNode *m_nodeBeingScheduled = nullptr;
+    bool m_nodeBeingScheduledDelayed = false;
+    bool m_outOfJobTokens = false;
+
+    FileStatusPrefetcher m_fileStatuses;
     QList<ExecutorJob*> m_availableJobs;
     ExecutorState m_state;
     TopLevelProjectPtr m_project;
@@ -174,7 +203,6 @@ private:
     std::vector<ResolvedProductPtr> m_allProducts;
     std::unordered_map<QString, const ResolvedProduct *> m_productsByName;
     std::unordered_map<QString, const ResolvedProject *> m_projectsByName;
-    std::unordered_map<QString, int> m_jobCountPerPool;
     std::unordered_map<const ResolvedProduct *, JobLimits> m_jobLimitsPerProduct;
     std::unordered_map<const Rule *, int> m_pendingTransformersPerRule;
     NodeSet m_roots;
@@ -187,6 +215,10 @@ private:
     FileTags m_tagsNeededForFilesToConsider;
     QList<ResolvedProductPtr> m_productsOfFilesToConsider;
     QTimer * const m_cancelationTimer;
+    QTimer * const m_memoryPollTimer;
+    MemoryMonitor m_memoryMonitor;
+    int m_memoryThrottleCount = 0;
+    bool m_memoryThrottled = false;
     QStringList m_artifactsRemovedFromDisk;
     bool m_partialBuild = false;
     qint64 m_elapsedTimeRules = 0;
@@ -39,20 +39,37 @@
 
 #include "executorjob.h"
 
+#include "actioncache.h"
 #include "artifact.h"
 #include "jscommandexecutor.h"
 #include "processcommandexecutor.h"
+#include "remoteactioncache.h"
 #include "rulecommands.h"
 #include "transformer.h"
 #include <language/language.h>
+#include <logging/translator.h>
 #include <tools/error.h>
+#include <tools/processresult.h>
+#include <tools/profiling.h>
 #include <tools/qbsassert.h>
 
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qpointer.h>
 #include <QtCore/qthread.h>
 
 namespace qbs {
 namespace Internal {
 
+static QByteArray contentDigest(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    return hash.addData(&file) ? hash.result() : QByteArray();
+}
+
 ExecutorJob::ExecutorJob(const Logger &logger, QObject *parent)
     : QObject(parent)
     , m_processCommandExecutor(new ProcessCommandExecutor(logger, this))
@@ -62,6 +79,11 @@ ExecutorJob::ExecutorJob(const Logger &logger, QObject *parent)
             this, &ExecutorJob::reportCommandDescription);
     connect(m_processCommandExecutor, &ProcessCommandExecutor::reportProcessResult,
             this, &ExecutorJob::reportProcessResult);
+    connect(m_processCommandExecutor, &ProcessCommandExecutor::reportProcessResult,
+            this, [this](const ProcessResult &result) {
+        if (!m_actionCacheKey.isEmpty())
+            m_processResults.push_back(result);
+    });
     connect(m_processCommandExecutor, &AbstractCommandExecutor::finished,
             this, &ExecutorJob::onCommandFinished);
     connect(m_jsCommandExecutor, &AbstractCommandExecutor::reportCommandDescription,
@@ -71,7 +93,12 @@ ExecutorJob::ExecutorJob(const Logger &logger, QObject *parent)
     reset();
 }
 
-ExecutorJob::~ExecutorJob() = default;
+// A pending background operation refers to this object.
+ExecutorJob::~ExecutorJob()
+{
+    if (m_backgroundWork.valid())
+        m_backgroundWork.wait();
+}
 
 void ExecutorJob::setMainThreadScriptEngine(ScriptEngine *engine)
 {
@@ -81,12 +108,14 @@ void ExecutorJob::setMainThreadScriptEngine(ScriptEngine *engine)
 
 void ExecutorJob::setDryRun(bool enabled)
 {
+    m_dryRun = enabled;
     m_processCommandExecutor->setDryRunEnabled(enabled);
     m_jsCommandExecutor->setDryRunEnabled(enabled);
 }
 
 void ExecutorJob::setEchoMode(CommandEchoMode echoMode)
 {
+    m_echoMode = echoMode;
     m_processCommandExecutor->setEchoMode(echoMode);
     m_jsCommandExecutor->setEchoMode(echoMode);
 }
@@ -107,11 +136,134 @@ void ExecutorJob::run(Transformer *t)
                 (*t->outputs.cbegin())->product->buildEnvironment);
     m_transformer = t;
     m_jobPools = t->jobPools();
+    m_elapsedTimer.start();
+    if (TraceRecorder::instance().isEnabled())
+        startTraceSpan();
+    if (m_actionCache && !m_dryRun) {
+        m_actionCacheAction = ActionCache::actionForTransformer(t);
+        if (m_actionCacheAction) {
+            lookUpInActionCache();
+            return;
+        }
+    }
+    runNextCommand();
+}
+
+// Computing the key means hashing the inputs, and a hit means copying the outputs, so both
+// happen outside of the executor thread. Until the commands start, there is nothing to cancel.
+void ExecutorJob::lookUpInActionCache()
+{
+    m_waitingForActionCache = true;
+    runInBackground([this] {
+        m_actionCacheKey = m_actionCache->computeKey(*m_actionCacheAction);
+        m_restoredFromActionCache = !m_actionCacheKey.isEmpty()
+                && m_actionCache->retrieve(m_actionCacheKey, *m_actionCacheAction,
+                                           m_cachedProcessResults);
+    }, [this] { onLocalActionCacheLookupFinished(); });
+}
+
+void ExecutorJob::onLocalActionCacheLookupFinished()
+{
+    if (m_error.hasError()) { // Canceled?
+        setFinished();
+        return;
+    }
+    if (m_restoredFromActionCache) {
+        m_waitingForActionCache = false;
+        reportRestoredFromActionCache();
+        return;
+    }
+    if (!m_actionCacheKey.isEmpty()) {
+        if (RemoteActionCache * const remoteCache = m_actionCache->remoteCache()) {
+            QPointer<ExecutorJob> self(this);
+            remoteCache->fetch(m_actionCacheKey, [self](const QByteArray &entryData) {
+                if (self)
+                    self->onRemoteActionCacheReply(entryData);
+            });
+            return;
+        }
+        m_actionCache->recordMiss();
+    }
+    m_waitingForActionCache = false;
     runNextCommand();
 }
 
+void ExecutorJob::onRemoteActionCacheReply(const QByteArray &entryData)
+{
+    QBS_ASSERT(m_waitingForActionCache, return);
+    if (entryData.isEmpty() || m_error.hasError()) {
+        onRemoteActionCacheLookupFinished();
+        return;
+    }
+
+    runInBackground([this, entryData] {
+        m_restoredFromActionCache = m_actionCache->importEntry(m_actionCacheKey, entryData)
+                && m_actionCache->retrieve(m_actionCacheKey, *m_actionCacheAction,
+                                           m_cachedProcessResults);
+    }, [this] { onRemoteActionCacheLookupFinished(); });
+}
+
+void ExecutorJob::onRemoteActionCacheLookupFinished()
+{
+    m_waitingForActionCache = false;
+    if (m_error.hasError()) { // Canceled?
+        setFinished();
+        return;
+    }
+    if (m_restoredFromActionCache) {
+        m_actionCache->recordRemoteHit();
+        reportRestoredFromActionCache();
+        return;
+    }
+    m_actionCache->recordMiss();
+    runNextCommand();
+}
+
+void ExecutorJob::reportRestoredFromActionCache()
+{
+    const QString productName = m_transformer->product()->fullDisplayName();
+    for (const AbstractCommandPtr &command : m_transformer->commands.commands()) {
+        if (command->isSilent() || m_echoMode == CommandEchoModeSilent
+                || command->description().isEmpty()) {
+            continue;
+        }
+        emit reportCommandDescription(command->highlight(),
+                                      Tr::tr("%1 (cached)")
+                                      .arg(command->fullDescription(productName)));
+    }
+    for (const ProcessResult &result : std::exchange(m_cachedProcessResults, {}))
+        emit reportProcessResult(result);
+    if (m_traceSpan)
+        m_traceSpan->addArgument(QStringLiteral("cached"), true);
+    setFinished();
+}
+
+void ExecutorJob::startTraceSpan()
+{
+    QStringList commandDescriptions;
+    for (const AbstractCommandPtr &command : m_transformer->commands.commands())
+        commandDescriptions << command->description();
+    QStringList outputs;
+    for (const Artifact * const output : std::as_const(m_transformer->outputs))
+        outputs << output->filePath();
+    const QString ruleName = m_transformer->rule ? m_transformer->rule->toString() : QString();
+    const QString name = commandDescriptions.first().isEmpty()
+            ? ruleName : commandDescriptions.first();
+    m_traceSpan = std::make_unique<TraceSpan>(name, "job", m_traceLane);
+    m_traceSpan->addArgument(QStringLiteral("product"),
+                             m_transformer->product()->fullDisplayName());
+    m_traceSpan->addArgument(QStringLiteral("rule"), ruleName);
+    m_traceSpan->addArgument(QStringLiteral("commands"), commandDescriptions);
+    m_traceSpan->addArgument(QStringLiteral("outputs"), outputs);
+    m_traceSpan->addArgument(QStringLiteral("job-pools"), m_jobPools.toStringList());
+}
+
 void ExecutorJob::cancel()
 {
+    if (m_waitingForActionCache) {
+        m_error = ErrorInfo(tr("Transformer execution canceled."));
+        return;
+    }
     if (!m_currentCommandExecutor)
         return;
     m_error = ErrorInfo(tr("Transformer execution canceled."));
@@ -155,8 +307,68 @@ void ExecutorJob::onCommandFinished(const ErrorInfo &err)
     }
 }
 
+// Runs blocking file operations outside of the executor thread, so that large files do not
+// hold up the scheduling of other jobs. The continuation is called in this object's thread.
+void ExecutorJob::runInBackground(std::function<void()> work, std::function<void()> continuation)
+{
+    QBS_CHECK(!m_backgroundWork.valid());
+    m_backgroundWork = std::async(std::launch::async,
+                                  [this, work = std::move(work),
+                                   continuation = std::move(continuation)]() mutable {
+        work();
+        QMetaObject::invokeMethod(this, [this, continuation = std::move(continuation)] {
+            m_backgroundWork.get();
+            continuation();
+        }, Qt::QueuedConnection);
+    });
+}
+
 void ExecutorJob::setFinished()
 {
+    m_outputDigests.clear();
+    if (!m_transformer || m_dryRun || m_error.hasError()) {
+        emitFinished();
+        return;
+    }
+    ActionCache::PendingEntry actionCacheEntry;
+    if (!m_restoredFromActionCache) {
+        // The duration is the basis for the critical path estimation in subsequent builds.
+        m_transformer->lastCommandExecutionDuration = m_elapsedTimer.elapsed();
+        if (!m_actionCacheKey.isEmpty()) {
+            actionCacheEntry = ActionCache::prepareEntry(m_actionCacheKey, *m_actionCacheAction,
+                                                         m_processResults);
+        }
+    }
+    if (actionCacheEntry.key.isEmpty() && !m_checkContents) {
+        emitFinished();
+        return;
+    }
+    QStringList outputFilePaths;
+    if (m_checkContents) {
+        for (const Artifact * const output : std::as_const(m_transformer->outputs))
+            outputFilePaths << output->filePath();
+    }
+    runInBackground([this, actionCacheEntry, outputFilePaths] {
+        if (!actionCacheEntry.key.isEmpty() && m_actionCache->storeEntry(actionCacheEntry)
+                && m_actionCache->remoteCache()) {
+            m_actionCacheUploadData = m_actionCache->exportEntry(actionCacheEntry.key);
+        }
+        for (const QString &filePath : outputFilePaths)
+            m_outputDigests.insert(filePath, contentDigest(filePath));
+    }, [this, key = actionCacheEntry.key] {
+        // Without an action cache, we get here only for content checking.
+        if (!key.isEmpty())
+            m_actionCache->uploadEntry(key, std::exchange(m_actionCacheUploadData, {}));
+        emitFinished();
+    });
+}
+
+void ExecutorJob::emitFinished()
+{
+    if (m_traceSpan) {
+        m_traceSpan->addArgument(QStringLiteral("success"), !m_error.hasError());
+        m_traceSpan.reset();
+    }
     const ErrorInfo err = m_error;
     reset();
     emit finished(err);
@@ -168,6 +380,12 @@ void ExecutorJob::reset()
     m_jobPools.clear();
     m_currentCommandExecutor = nullptr;
     m_currentCommandIdx = -1;
+    m_actionCacheAction.reset();
+    m_actionCacheKey.clear();
+    m_processResults.clear();
+    m_cachedProcessResults.clear();
+    m_restoredFromActionCache = false;
+    m_waitingForActionCache = false;
     m_error.clear();
 }
 
@@ -40,14 +40,25 @@
 #ifndef QBS_EXECUTORJOB_H
 #define QBS_EXECUTORJOB_H
 
+#include "actioncache.h"
+
 #include <language/forward_decls.h>
 #include <tools/commandechomode.h>
 #include <tools/error.h>
 #include <tools/set.h>
 
+#include <QtCore/qbytearray.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qstring.h>
 
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
+
 namespace qbs {
 class CodeLocation;
 class ProcessResult;
@@ -59,6 +70,7 @@ class JsCommandExecutor;
 class Logger;
 class ProcessCommandExecutor;
 class ScriptEngine;
+class TraceSpan;
 class Transformer;
 
 class ExecutorJob : public QObject
@@ -70,22 +82,36 @@ public:
 
     void setMainThreadScriptEngine(ScriptEngine *engine);
     void setDryRun(bool enabled);
+    void setCheckContents(bool enabled) { m_checkContents = enabled; }
     void setEchoMode(CommandEchoMode echoMode);
+    void setTraceLane(int lane) { m_traceLane = lane; }
+    void setActionCache(ActionCache *cache) { m_actionCache = cache; }
     void run(Transformer *t);
     void cancel();
     const Transformer *transformer() const { return m_transformer; }
     Set<QString> jobPools() const { return m_jobPools; }
 
+    // The content digests of the outputs of the last transformer, if content checking is on.
+    QHash<QString, QByteArray> takeOutputDigests() { return std::move(m_outputDigests); }
+
 signals:
     void reportCommandDescription(const QString &highlight, const QString &message);
     void reportProcessResult(const qbs::ProcessResult &result);
     void finished(const qbs::ErrorInfo &error = ErrorInfo()); // !hasError() <=> command successful
 
 private:
+    void startTraceSpan();
+    void lookUpInActionCache();
+    void onLocalActionCacheLookupFinished();
+    void onRemoteActionCacheReply(const QByteArray &entryData);
+    void onRemoteActionCacheLookupFinished();
+    void reportRestoredFromActionCache();
     void runNextCommand();
     void onCommandFinished(const qbs::ErrorInfo &err);
 
+    void runInBackground(std::function<void()> work, std::function<void()> continuation);
     void setFinished();
+    void emitFinished();
     void reset();
 
     AbstractCommandExecutor *m_currentCommandExecutor = nullptr;
@@ -94,6 +120,22 @@ private:
     Transformer *m_transformer = nullptr;
     Set<QString> m_jobPools;
     int m_currentCommandIdx = 0;
+    QElapsedTimer m_elapsedTimer;
+    std::unique_ptr<TraceSpan> m_traceSpan;
+    int m_traceLane = -1;
+    ActionCache *m_actionCache = nullptr;
+    std::optional<ActionCache::Action> m_actionCacheAction;
+    QByteArray m_actionCacheKey;
+    std::vector<ProcessResult> m_processResults;
+    std::vector<ProcessResult> m_cachedProcessResults;
+    bool m_restoredFromActionCache = false;
+    bool m_waitingForActionCache = false;
+    CommandEchoMode m_echoMode = defaultCommandEchoMode();
+    bool m_dryRun = false;
+    bool m_checkContents = false;
+    QHash<QString, QByteArray> m_outputDigests;
+    QByteArray m_actionCacheUploadData;
+    std::future<void> m_backgroundWork;
     ErrorInfo m_error;
 };
 
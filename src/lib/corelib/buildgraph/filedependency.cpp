@@ -61,27 +61,31 @@ const FileTime &FileResourceBase::timestamp() const
 
 void FileResourceBase::setFilePath(const QString &filePath)
 {
-    m_filePath = filePath;
-    FileInfo::splitIntoDirectoryAndFileName(m_filePath, &m_dirPath, &m_fileName);
+    QStringView dirPath;
+    QStringView fileName;
+    FileInfo::splitIntoDirectoryAndFileName(filePath, &dirPath, &fileName);
+    PathAtomTable &atoms = PathAtomTable::instance();
+    m_dirAtom = atoms.atom(dirPath);
+    m_fileNameAtom = atoms.atom(fileName);
+    m_hasDirectory = fileName.size() < filePath.size();
 }
 
-const QString &FileResourceBase::filePath() const
+QString FileResourceBase::filePath() const
 {
-    return m_filePath;
+    return m_hasDirectory ? dirPath() + QLatin1Char('/') + fileName() : fileName();
 }
 
 void FileResourceBase::load(PersistentPool &pool)
 {
-    serializationOp<PersistentPool::Load>(pool);
-    FileInfo::splitIntoDirectoryAndFileName(m_filePath, &m_dirPath, &m_fileName);
+    setFilePath(pool.load<QString>());
+    pool.load(m_timestamp);
 }
 
 void FileResourceBase::store(PersistentPool &pool)
 {
-    serializationOp<PersistentPool::Store>(pool);
+    pool.store(filePath(), m_timestamp);
 }
 
-
 FileDependency::FileDependency() = default;
 
 FileDependency::~FileDependency() = default;
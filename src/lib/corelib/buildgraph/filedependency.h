@@ -41,6 +41,7 @@
 #define QBS_FILEDEPENDENCY_H
 
 #include <tools/filetime.h>
+#include <tools/pathatomtable.h>
 #include <tools/persistence.h>
 
 namespace qbs {
@@ -61,24 +62,23 @@ public:
     const FileTime &timestamp() const;
     void clearTimestamp() { m_timestamp.clear(); }
 
+    // Only the interned components of the path are kept, so the path is put together on request.
     void setFilePath(const QString &filePath);
-    const QString &filePath() const;
-    QString dirPath() const { return m_dirPath.toString(); }
-    QString fileName() const { return m_fileName.toString(); }
+    QString filePath() const;
+    const QString &dirPath() const { return PathAtomTable::instance().string(m_dirAtom); }
+    const QString &fileName() const { return PathAtomTable::instance().string(m_fileNameAtom); }
+    PathAtom dirAtom() const { return m_dirAtom; }
+    PathAtom fileNameAtom() const { return m_fileNameAtom; }
 
     virtual void load(PersistentPool &pool);
     virtual void store(PersistentPool &pool);
 
 private:
-    template<PersistentPool::OpType opType> void serializationOp(PersistentPool &pool)
-    {
-        pool.serializationOp<opType>(m_filePath, m_timestamp);
-    }
-
+    PathAtomTable::Use m_atomTableUse;
     FileTime m_timestamp;
-    QString m_filePath;
-    QStringView m_dirPath;
-    QStringView m_fileName;
+    PathAtom m_dirAtom = PathAtomTable::emptyAtom;
+    PathAtom m_fileNameAtom = PathAtomTable::emptyAtom;
+    bool m_hasDirectory = false; // Distinguishes "/file" from "file".
 };
 
 class FileDependency : public FileResourceBase
@@ -0,0 +1,279 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "inputartifactprescanner.h"
+
+#include <logging/categories.h>
+#include <plugins/scanner/scanner.h>
+#include <tools/fileinfo.h>
+#include <tools/qbsassert.h>
+#include <tools/set.h>
+
+#include <QtCore/qdir.h>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace qbs {
+namespace Internal {
+
+ScanRegistry::ScanRegistry(const RawScanResults &rawScanResults)
+{
+    rawScanResults.forEachScanData([this](const QString &filePath,
+                                          const RawScanResults::ScanData &scanData) {
+        Entry &entry = m_entries[scanData.scannerId][filePath];
+        if (entry.scanTime < scanData.lastScanTime)
+            entry.scanTime = scanData.lastScanTime;
+    });
+}
+
+bool ScanRegistry::claim(const QString &scannerId, const QString &filePath,
+                         const FileTime *fileTime, QStringList *dependencies)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        Entry &entry = m_entries[scannerId][filePath];
+        if (entry.state == Entry::InProgress) {
+            m_scanFinished.wait(lock);
+            continue;
+        }
+        if (!entry.scanTime.isValid())
+            break;
+        if (fileTime) {
+            if (entry.scanTime < *fileTime)
+                break;
+        } else if (entry.state == Entry::Recorded) {
+            // Recorded in an earlier build, so we have to check whether the file has changed
+            // since then. Don't block the other threads while doing so.
+            const FileTime recordedScanTime = entry.scanTime;
+            lock.unlock();
+            const FileTime lastModified = FileInfo(filePath).lastModified();
+            lock.lock();
+            Entry &currentEntry = m_entries[scannerId][filePath];
+            if (currentEntry.state != Entry::Recorded || currentEntry.scanTime != recordedScanTime)
+                continue;
+            if (recordedScanTime < lastModified)
+                break;
+            currentEntry.state = Entry::Scanned;
+            return false;
+        }
+        if (dependencies && entry.dependenciesKnown)
+            *dependencies = entry.dependencies;
+        return false;
+    }
+    m_entries[scannerId][filePath].state = Entry::InProgress;
+    return true;
+}
+
+void ScanRegistry::finishScan(const QString &scannerId, const QString &filePath,
+                              const FileTime &scanTime)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry &entry = m_entries[scannerId][filePath];
+        entry.state = Entry::Scanned;
+        entry.scanTime = scanTime;
+        entry.dependencies.clear();
+        entry.dependenciesKnown = false;
+    }
+    m_scanFinished.notify_all();
+}
+
+void ScanRegistry::addPrescanResult(PrescanResult result, QStringList dependencies)
+{
+    {
+        // The result must be available before anyone can see that the file has been scanned.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry &entry = m_entries[result.scannerId][result.filePath];
+        entry.state = Entry::Scanned;
+        entry.scanTime = result.scanTime;
+        entry.dependencies = std::move(dependencies);
+        entry.dependenciesKnown = true;
+        m_prescanResults.push_back(std::move(result));
+    }
+    m_scanFinished.notify_all();
+}
+
+std::vector<ScanRegistry::PrescanResult> ScanRegistry::takePrescanResults()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::exchange(m_prescanResults, {});
+}
+
+struct InputArtifactPrescanner::Batch
+{
+    // Files already handled by one of the batch's jobs.
+    bool markVisited(const QString &scannerId, const QString &filePath)
+    {
+        std::lock_guard<std::mutex> lock(visitedFilesMutex);
+        return visitedFiles[scannerId].insert(filePath).second;
+    }
+
+    std::vector<Job> jobs;
+    Callback callback;
+    std::atomic<std::size_t> remainingJobs = 0;
+    std::mutex visitedFilesMutex;
+    QHash<QString /*scannerId*/, Set<QString>> visitedFiles;
+};
+
+InputArtifactPrescanner::InputArtifactPrescanner(int threadCount, ScanRegistry *registry)
+    : m_maxThreadCount(std::max(1, threadCount)), m_registry(registry)
+{
+}
+
+InputArtifactPrescanner::~InputArtifactPrescanner()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_shuttingDown = true;
+        m_queue.clear();
+    }
+    m_queueCondition.notify_all();
+    for (std::thread &thread : m_threads)
+        thread.join();
+}
+
+void InputArtifactPrescanner::scan(std::vector<Job> jobs, Callback callback)
+{
+    QBS_CHECK(!jobs.empty());
+    const auto batch = std::make_shared<Batch>();
+    batch->jobs = std::move(jobs);
+    batch->callback = std::move(callback);
+    batch->remainingJobs = batch->jobs.size();
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        for (std::size_t i = 0; i < batch->jobs.size(); ++i)
+            m_queue.push_back({batch, i});
+        while (int(m_threads.size()) < std::min(m_maxThreadCount, int(m_queue.size())))
+            m_threads.emplace_back([this] { runWorker(); });
+    }
+    m_queueCondition.notify_all();
+}
+
+void InputArtifactPrescanner::runWorker()
+{
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueCondition.wait(lock, [this] { return m_shuttingDown || !m_queue.empty(); });
+            if (m_shuttingDown)
+                return;
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        runTask(task);
+    }
+}
+
+// Unlike InputArtifactScanner, we cannot look into the build graph here,
+// so only files that exist on disk are found.
+static QString resolveDependency(const RawScannedDependency &dependency, const QString &baseDir)
+{
+    QString absDirPath = baseDir.isEmpty() ? dependency.dirPath()
+                         : dependency.dirPath().isEmpty()
+                             ? baseDir
+                             : FileInfo::resolvePath(baseDir, dependency.dirPath());
+    if (!dependency.isClean())
+        absDirPath = QDir::cleanPath(absDirPath);
+    const QString absFilePath = absDirPath + QLatin1Char('/') + dependency.fileName();
+    const FileInfo fi(absFilePath);
+    return fi.exists() && !fi.isDir() ? absFilePath : QString();
+}
+
+void InputArtifactPrescanner::runTask(const Task &task)
+{
+    Batch &batch = *task.batch;
+    const Job &job = batch.jobs.at(task.jobIndex);
+    std::deque<QString> filesToScan{job.filePath};
+    while (!filesToScan.empty()) {
+        const QString filePath = filesToScan.front();
+        filesToScan.pop_front();
+        if (!batch.markVisited(job.scannerId, filePath))
+            continue;
+
+        QStringList dependencies;
+        if (m_registry->claim(job.scannerId, filePath, nullptr, &dependencies)) {
+            qCDebug(lcDepScan) << "scanning" << FileInfo::fileName(filePath);
+            ScanRegistry::PrescanResult result;
+            result.scannerId = job.scannerId;
+            result.moduleProperties = job.moduleProperties;
+            result.filePath = filePath;
+            result.scanTime = FileTime::currentTime();
+            ScannerScanResult scanResult = job.plugin->scan(filePath, job.fileTags.constData(),
+                                                            job.properties);
+            scanResult.dependencies.removeDuplicates();
+            result.rawScanResult.scannerProperties = scanResult.scannerProperties;
+            for (const QString &dependency : std::as_const(scanResult.dependencies))
+                result.rawScanResult.deps.emplace_back(dependency);
+
+            for (const RawScannedDependency &dependency : result.rawScanResult.deps) {
+                if (!job.recursive)
+                    break;
+                QString dependencyFilePath;
+                if (FileInfo::isAbsolute(dependency.filePath())) {
+                    dependencyFilePath = resolveDependency(dependency, QString());
+                } else {
+                    for (const QString &searchPath : job.searchPaths) {
+                        dependencyFilePath = resolveDependency(dependency, searchPath);
+                        if (!dependencyFilePath.isEmpty())
+                            break;
+                    }
+                }
+                if (!dependencyFilePath.isEmpty())
+                    dependencies << dependencyFilePath;
+            }
+            m_registry->addPrescanResult(std::move(result), dependencies);
+        }
+
+        if (job.recursive) {
+            for (const QString &dependency : std::as_const(dependencies))
+                filesToScan.push_back(dependency);
+        }
+    }
+
+    if (--batch.remainingJobs == 0) {
+        QMetaObject::invokeMethod(this, [batch = task.batch] { batch->callback(); },
+                                  Qt::QueuedConnection);
+    }
+}
+
+} // namespace Internal
+} // namespace qbs
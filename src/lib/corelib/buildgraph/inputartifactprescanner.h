@@ -0,0 +1,166 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_INPUTARTIFACTPRESCANNER_H
+#define QBS_INPUTARTIFACTPRESCANNER_H
+
+#include "rawscanresults.h"
+
+#include <language/forward_decls.h>
+#include <tools/filetime.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvariant.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ScannerPlugin;
+
+namespace qbs {
+namespace Internal {
+
+/*!
+ * Keeps track of which files have been scanned with which scanner plugin, so that the
+ * executor thread and the worker threads of the InputArtifactPrescanner never scan the
+ * same file twice. All functions are thread-safe.
+ */
+class ScanRegistry
+{
+public:
+    struct PrescanResult
+    {
+        QString scannerId;
+        PropertyMapConstPtr moduleProperties;
+        QString filePath;
+        FileTime scanTime;
+        RawScanResult rawScanResult;
+    };
+
+    explicit ScanRegistry(const RawScanResults &rawScanResults);
+
+    // Returns true if the caller has to scan the file, in which case it must call one of the
+    // functions below afterwards. Otherwise, the file was scanned after it was last modified,
+    // and the paths of its dependencies are returned if they are known.
+    // If fileTime is null, the file's timestamp is retrieved from disk if needed.
+    bool claim(const QString &scannerId, const QString &filePath, const FileTime *fileTime,
+               QStringList *dependencies);
+    void finishScan(const QString &scannerId, const QString &filePath, const FileTime &scanTime);
+    void addPrescanResult(PrescanResult result, QStringList dependencies);
+
+    std::vector<PrescanResult> takePrescanResults();
+
+private:
+    struct Entry
+    {
+        enum State { Recorded, InProgress, Scanned };
+        State state = Recorded;
+        FileTime scanTime;
+        QStringList dependencies;
+        bool dependenciesKnown = false;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_scanFinished;
+    QHash<QString /*scannerId*/, QHash<QString /*filePath*/, Entry>> m_entries;
+    std::vector<PrescanResult> m_prescanResults;
+};
+
+/*!
+ * Runs scanner plugins on a bounded pool of worker threads, so that lexing large files
+ * does not block the executor thread. The results only pre-fill the raw scan results
+ * of the build graph; resolving the dependencies and updating the graph still happens
+ * on the executor thread. All data passed to the worker threads is copied; they never
+ * touch the build graph.
+ */
+class InputArtifactPrescanner : public QObject
+{
+public:
+    struct Job
+    {
+        const ScannerPlugin *plugin = nullptr;
+        QString scannerId;
+        QByteArray fileTags;
+        QVariantMap properties;
+        PropertyMapConstPtr moduleProperties; // Passed through to the result.
+        QStringList searchPaths;
+        bool recursive = false;
+        QString filePath;
+    };
+
+    // The callback is invoked in the thread that created the prescanner.
+    using Callback = std::function<void()>;
+
+    InputArtifactPrescanner(int threadCount, ScanRegistry *registry);
+    ~InputArtifactPrescanner() override;
+
+    void scan(std::vector<Job> jobs, Callback callback);
+
+private:
+    struct Batch;
+    struct Task
+    {
+        std::shared_ptr<Batch> batch;
+        std::size_t jobIndex = 0;
+    };
+
+    void runWorker();
+    void runTask(const Task &task);
+
+    const int m_maxThreadCount;
+    ScanRegistry * const m_registry;
+    std::vector<std::thread> m_threads;
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueCondition;
+    std::deque<Task> m_queue;
+    bool m_shuttingDown = false;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_INPUTARTIFACTPRESCANNER_H
@@ -52,8 +52,10 @@
 #include <logging/logger.h>
 #include <logging/translator.h>
 #include <tools/fileinfo.h>
+#include <tools/pathatomtable.h>
 #include <tools/scannerpluginmanager.h>
 #include <tools/scripttools.h>
+#include <tools/stlutils.h>
 #include <tools/stringconstants.h>
 
 #include <QtCore/QDir>
@@ -134,6 +136,41 @@ static void resolveDepencency(
         result->filePath = absFilePath;
 }
 
+/*
+    Moves the results of the worker threads into the raw scan results of the build graph.
+*/
+void InputArtifactScannerContext::mergePrescanResults(ProjectBuildData *buildData)
+{
+    if (!scanRegistry)
+        return;
+    for (const ScanRegistry::PrescanResult &result : scanRegistry->takePrescanResults()) {
+        // A generated file might have been written to while it was scanned.
+        const bool contentMightHaveChanged = Internal::any_of(
+            buildData->lookupFiles(result.filePath), [&result](const FileResourceBase *file) {
+                if (file->fileType() != FileResourceBase::FileTypeArtifact)
+                    return false;
+                const auto artifact = static_cast<const Artifact *>(file);
+                return artifact->artifactType == Artifact::Generated
+                       && (artifact->buildState != BuildGraphNode::Built
+                           || result.scanTime < artifact->timestamp());
+            });
+        if (contentMightHaveChanged)
+            continue;
+
+        // Scanner plugins do not depend on module properties,
+        // see DependencyScanner::areModulePropertiesCompatible().
+        RawScanResults::ScanData &scanData = buildData->rawScanResults.findScanData(
+            result.filePath,
+            result.scannerId,
+            result.moduleProperties,
+            [](const PropertyMapConstPtr &, const PropertyMapConstPtr &) { return true; });
+        if (scanData.lastScanTime < result.scanTime) {
+            scanData.rawScanResult = result.rawScanResult;
+            scanData.lastScanTime = result.scanTime;
+        }
+    }
+}
+
 InputArtifactScanner::InputArtifactScanner(
     Logger logger, InputArtifactScannerContext *ctx, Set<QString> excludedScanners)
     : m_logger(logger)
@@ -156,6 +193,62 @@ bool InputArtifactScanner::scan(const ArtifactSet &inputArtifacts)
     return wasScanned;
 }
 
+/*
+    Returns the jobs needed to bring the raw scan results of the given \a inputArtifacts
+    up to date using worker threads. Only scanners implemented by plugins can run there.
+*/
+std::vector<InputArtifactPrescanner::Job> InputArtifactScanner::prescanJobs(
+    const ArtifactSet &inputArtifacts)
+{
+    std::vector<InputArtifactPrescanner::Job> jobs;
+    for (Artifact * const inputArtifact : inputArtifacts) {
+        // Do not scan an artifact that is not built yet: Its contents might still change.
+        if (inputArtifact->artifactType == Artifact::Generated
+                && inputArtifact->buildState != BuildGraphNode::Built) {
+            continue;
+        }
+        const RawScanResults &rawScanResults
+            = inputArtifact->product->topLevelProject()->buildData->rawScanResults;
+        const QStringList fileTags = inputArtifact->fileTags().toStringList();
+        const InputArtifactScannerContext::PropertiesCacheKey propsKey{
+            inputArtifact->properties, fileTags};
+        for (DependencyScanner * const scanner : scannersForArtifact(inputArtifact)) {
+            if (!scanner->plugin())
+                continue;
+            const RawScanResults::ScanData * const scanData = rawScanResults.existingScanData(
+                inputArtifact,
+                scanner->id(),
+                inputArtifact->properties,
+                [scanner](const PropertyMapConstPtr &lhs, const PropertyMapConstPtr &rhs) {
+                    return scanner->areModulePropertiesCompatible(lhs, rhs);
+                });
+            if (scanData && !(scanData->lastScanTime < inputArtifact->timestamp()))
+                continue;
+
+            InputArtifactScannerContext::ScannerKeyCacheItem &cache
+                = (scanner->cacheIsPerFile() ? m_context->cachePerFile[inputArtifact]
+                                             : m_context->cachePerProperties[propsKey])
+                    [scanner->id()];
+            if (!cache) {
+                cache.emplace();
+                cache->searchPaths = scanner->collectSearchPaths(inputArtifact);
+            }
+
+            InputArtifactPrescanner::Job job;
+            job.plugin = scanner->plugin();
+            job.scannerId = scanner->id();
+            job.fileTags = fileTags.join(QLatin1Char(',')).toLatin1();
+            job.properties = inputArtifact->properties->value();
+            job.moduleProperties = inputArtifact->properties;
+            job.searchPaths = cache->searchPaths;
+            job.recursive = scanner->recursive();
+            job.filePath = inputArtifact->filePath();
+            jobs.push_back(std::move(job));
+        }
+    }
+    return jobs;
+}
+
 /*!
     Rebuilds the dependencies of a generated \a artifact.
 
@@ -185,6 +278,7 @@ bool InputArtifactScanner::updateDependencies(Artifact *artifact)
     // file moves from one include directory to another).
     if (oldFileDependencies != artifact->fileDependencies) {
         artifact->clearTimestamp();
+        setBuildDataDirty(artifact);
     }
 
     if (!artifact->childrenAddedByScanner.empty())
@@ -320,16 +414,30 @@ const RawScanResults::ScanData &InputArtifactScanner::scanForScannerFileDependen
         qCDebug(lcDepScan) << "    " << s;
 
     const QString &filePathToBeScanned = fileToBeScanned->filePath();
-    RawScanResults &rawScanResults
-        = inputArtifact->product->topLevelProject()->buildData->rawScanResults;
-    RawScanResults::ScanData &scanData = rawScanResults.findScanData(
+    ProjectBuildData * const buildData = inputArtifact->product->topLevelProject()->buildData.get();
+    ScanRegistry * const scanRegistry = scanner->plugin() ? m_context->scanRegistry.get()
+                                                          : nullptr;
+    if (scanRegistry)
+        m_context->mergePrescanResults(buildData);
+    RawScanResults &rawScanResults = buildData->rawScanResults;
+    RawScanResults::ScanData *scanData = &rawScanResults.findScanData(
         fileToBeScanned, scanner, inputArtifact->properties);
-    if (scanData.lastScanTime < fileToBeScanned->timestamp()) {
+    if (scanRegistry && scanData->lastScanTime < fileToBeScanned->timestamp()
+            && !scanRegistry->claim(scanner->id(), filePathToBeScanned,
+                                    &fileToBeScanned->timestamp(), nullptr)) {
+        // A worker thread has scanned the file in the meantime.
+        m_context->mergePrescanResults(buildData);
+        scanData = &rawScanResults.findScanData(fileToBeScanned, scanner,
+                                                 inputArtifact->properties);
+    }
+    if (scanData->lastScanTime < fileToBeScanned->timestamp()) {
         qCDebug(lcDepScan) << "scanning" << FileInfo::fileName(filePathToBeScanned);
-        scanWithScannerPlugin(scanner, inputArtifact, fileToBeScanned, &scanData.rawScanResult);
-        scanData.lastScanTime = FileTime::currentTime();
+        scanWithScannerPlugin(scanner, inputArtifact, fileToBeScanned, &scanData->rawScanResult);
+        scanData->lastScanTime = FileTime::currentTime();
+        if (scanRegistry)
+            scanRegistry->finishScan(scanner->id(), filePathToBeScanned, scanData->lastScanTime);
     }
-    return scanData;
+    return *scanData;
 }
 
 void InputArtifactScanner::resolveScanResultDependencies(
@@ -341,9 +449,8 @@ void InputArtifactScanner::resolveScanResultDependencies(
 {
     auto getResolvedDependency =
         [inputArtifact, &cache](const RawScannedDependency &dependency) -> ResolvedDependency * {
-        const QString &dependencyFilePath = dependency.filePath();
-        auto &dirCache = cache.resolvedDependenciesCache[dependency.dirPath()];
-        auto &cachedResolvedDependencyItem = dirCache[dependency.fileName()];
+        auto &cachedResolvedDependencyItem = cache.resolvedDependenciesCache[
+                PathAtomTable::pathKey(dependency.dirAtom(), dependency.fileNameAtom())];
         if (cachedResolvedDependencyItem) {
             ResolvedDependency &resolvedDependency = *cachedResolvedDependencyItem;
             if (resolvedDependency.filePath.isEmpty())
@@ -352,7 +459,7 @@ void InputArtifactScanner::resolveScanResultDependencies(
         }
         ResolvedDependency &resolvedDependency = cachedResolvedDependencyItem.emplace();
 
-        if (FileInfo::isAbsolute(dependencyFilePath)) {
+        if (FileInfo::isAbsolute(dependency.filePath())) {
             resolveDepencency(dependency, inputArtifact->product.get(), &resolvedDependency);
             if (resolvedDependency.filePath.isEmpty())
                 return nullptr;
@@ -42,6 +42,7 @@
 #define QBS_INPUTARTIFACTSCANNER_H
 
 #include <buildgraph/forward_decls.h>
+#include <buildgraph/inputartifactprescanner.h>
 #include <buildgraph/rawscanresults.h>
 #include <logging/logger.h>
 #include <tools/qttools.h>
@@ -69,9 +70,16 @@ public:
 
 class InputArtifactScannerContext
 {
+public:
+    // Only set while input artifacts are being scanned in worker threads.
+    std::unique_ptr<ScanRegistry> scanRegistry;
+
+    void mergePrescanResults(ProjectBuildData *buildData);
+
+private:
     using ResolvedDependencyCacheItem = std::optional<ResolvedDependency>;
     using ResolvedDependenciesCache
-        = QHash<QString /*dirName*/, QHash<QString /*fileName*/, ResolvedDependencyCacheItem>>;
+        = QHash<quint64 /*PathAtomTable::pathKey()*/, ResolvedDependencyCacheItem>;
 
     struct ScannerKeyCacheData
     {
@@ -103,6 +111,7 @@ public:
         Logger logger, InputArtifactScannerContext *ctx, Set<QString> excludedScanners = {});
 
     bool scan(const ArtifactSet &inputArtifacts);
+    std::vector<InputArtifactPrescanner::Job> prescanJobs(const ArtifactSet &inputArtifacts);
     bool updateDependencies(Artifact *artifact);
 
 private:
@@ -0,0 +1,252 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "jobbudget.h"
+
+#include <tools/qbsassert.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace qbs {
+namespace Internal {
+
+JobBudget &JobBudget::instance()
+{
+    static JobBudget budget;
+    return budget;
+}
+
+void JobBudget::registerClient(Client client, int maxJobCount,
+                               std::function<void()> tokenAvailable)
+{
+    std::vector<NotifierPtr> notifiers;
+    {
+        std::lock_guard lock(m_mutex);
+        ClientData &data = m_clients[client];
+        QBS_CHECK(data.heldTokens == 0);
+        data.maxJobCount = maxJobCount;
+        if (!data.notifier)
+            data.notifier = std::make_shared<Notifier>();
+        std::lock_guard notifierLock(data.notifier->mutex);
+        data.notifier->callback = std::move(tokenAvailable);
+        notifiers = distributeFreeTokens(); // The capacity might have grown.
+    }
+    notify(notifiers);
+}
+
+void JobBudget::unregisterClient(Client client)
+{
+    std::vector<NotifierPtr> notifiers;
+    NotifierPtr ownNotifier;
+    {
+        std::lock_guard lock(m_mutex);
+        const auto it = m_clients.find(client);
+        if (it == m_clients.end())
+            return;
+        ownNotifier = it->second.notifier;
+        for (auto poolIt = it->second.jobCountPerPool.cbegin();
+             poolIt != it->second.jobCountPerPool.cend(); ++poolIt) {
+            m_jobCountPerPool[poolIt.key()] -= poolIt.value();
+        }
+        m_clients.erase(it);
+        notifiers = distributeFreeTokens();
+    }
+    notify(notifiers);
+
+    // Another thread might have picked up the notifier before the client was removed.
+    if (ownNotifier) {
+        std::lock_guard lock(ownNotifier->mutex);
+        ownNotifier->callback = {};
+    }
+}
+
+JobBudget::AcquireResult JobBudget::tryAcquire(Client client, qint64 priority,
+                                               const PoolLimits &poolLimits)
+{
+    std::lock_guard lock(m_mutex);
+    const auto it = m_clients.find(client);
+    QBS_CHECK(it != m_clients.end());
+    ClientData &data = it->second;
+    for (const auto &[jobPool, limit] : poolLimits) {
+        if (limit > 0 && m_jobCountPerPool.value(jobPool) >= limit) {
+            data.waitingForJobPool = true;
+            return AcquireResult::BlockedByJobLimit;
+        }
+    }
+    if (data.reservedTokens > 0) {
+        --data.reservedTokens;
+    } else if (freeTokensLocked() <= 0) {
+        data.waitPriority = data.waiting ? std::max(data.waitPriority, priority) : priority;
+        data.waiting = true;
+        return AcquireResult::BlockedByBudget;
+    }
+    ++data.heldTokens;
+    QStringList jobPools;
+    for (const auto &poolLimit : poolLimits)
+        jobPools << poolLimit.first;
+    changeJobCounts(data, jobPools, 1);
+    return AcquireResult::Acquired;
+}
+
+void JobBudget::release(Client client, const QStringList &jobPools)
+{
+    std::vector<NotifierPtr> notifiers;
+    {
+        std::lock_guard lock(m_mutex);
+        const auto it = m_clients.find(client);
+        QBS_CHECK(it != m_clients.end());
+        QBS_CHECK(it->second.heldTokens > 0);
+        --it->second.heldTokens;
+        changeJobCounts(it->second, jobPools, -1);
+        notifiers = distributeFreeTokens();
+
+        // The pool might be occupied by jobs of other clients only, in which case
+        // the blocked clients would not notice otherwise.
+        if (!jobPools.empty()) {
+            for (auto &[otherClient, data] : m_clients) {
+                if (otherClient != client && std::exchange(data.waitingForJobPool, false)
+                        && data.notifier) {
+                    notifiers.push_back(data.notifier);
+                }
+            }
+        }
+    }
+    notify(notifiers);
+}
+
+// Tokens reserved for a client that it could not use after all go to the next waiting client.
+void JobBudget::returnUnusedTokens(Client client)
+{
+    std::vector<NotifierPtr> notifiers;
+    {
+        std::lock_guard lock(m_mutex);
+        const auto it = m_clients.find(client);
+        if (it == m_clients.end() || it->second.reservedTokens == 0)
+            return;
+        it->second.reservedTokens = 0;
+        notifiers = distributeFreeTokens();
+    }
+    notify(notifiers);
+}
+
+int JobBudget::capacity() const
+{
+    std::lock_guard lock(m_mutex);
+    return capacityLocked();
+}
+
+int JobBudget::freeTokens() const
+{
+    std::lock_guard lock(m_mutex);
+    return std::max(0, freeTokensLocked());
+}
+
+int JobBudget::jobCount(const QString &jobPool) const
+{
+    std::lock_guard lock(m_mutex);
+    return m_jobCountPerPool.value(jobPool);
+}
+
+int JobBudget::capacityLocked() const
+{
+    int capacity = 0;
+    for (const auto &client : m_clients)
+        capacity = std::max(capacity, client.second.maxJobCount);
+    return capacity;
+}
+
+// Can be negative for a while if a client with a high job count has just left.
+int JobBudget::freeTokensLocked() const
+{
+    int freeTokens = capacityLocked();
+    for (const auto &client : m_clients)
+        freeTokens -= client.second.heldTokens + client.second.reservedTokens;
+    return freeTokens;
+}
+
+void JobBudget::changeJobCounts(ClientData &client, const QStringList &jobPools, int diff)
+{
+    for (const QString &jobPool : jobPools) {
+        client.jobCountPerPool[jobPool] += diff;
+        m_jobCountPerPool[jobPool] += diff;
+    }
+}
+
+// Waiting clients are served in order of priority. Among clients with the same priority,
+// the one that was served least recently comes first.
+std::vector<JobBudget::NotifierPtr> JobBudget::distributeFreeTokens()
+{
+    std::vector<NotifierPtr> notifiers;
+    int freeTokens = freeTokensLocked();
+    while (freeTokens > 0) {
+        ClientData *next = nullptr;
+        for (auto &client : m_clients) {
+            ClientData &data = client.second;
+            if (!data.waiting)
+                continue;
+            if (!next || data.waitPriority > next->waitPriority
+                    || (data.waitPriority == next->waitPriority
+                        && data.lastServed < next->lastServed)) {
+                next = &data;
+            }
+        }
+        if (!next)
+            break;
+        next->waiting = false;
+        ++next->reservedTokens;
+        next->lastServed = ++m_serveCount;
+        if (next->notifier)
+            notifiers.push_back(next->notifier);
+        --freeTokens;
+    }
+    return notifiers;
+}
+
+void JobBudget::notify(const std::vector<NotifierPtr> &notifiers)
+{
+    for (const NotifierPtr &notifier : notifiers) {
+        std::lock_guard lock(notifier->mutex);
+        if (notifier->callback)
+            notifier->callback();
+    }
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,132 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_JOBBUDGET_H
+#define QBS_JOBBUDGET_H
+
+#include "qbs_export.h"
+
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+
+/*!
+ * The job tokens shared by all executors of the process.
+ * When several configurations are built at the same time, each of them has its own executor
+ * running in its own thread. Without coordination, "-j N" would then mean N jobs per
+ * configuration. Instead, every executor has to acquire a token before it starts a command,
+ * and the number of tokens is the highest job count any of the running executors asked for.
+ * Job pool limits are enforced on the process-wide number of jobs in the respective pool.
+ * When a token becomes free and several executors are waiting for one, it is handed to
+ * the one with the most expensive pending work, so priorities are interleaved
+ * across configurations.
+ */
+class QBS_AUTOTEST_EXPORT JobBudget
+{
+public:
+    using Client = const void *;
+    using PoolLimits = std::vector<std::pair<QString, int>>; // A limit <= 0 means unlimited.
+    enum class AcquireResult { Acquired, BlockedByJobLimit, BlockedByBudget };
+
+    static JobBudget &instance();
+
+    // The callback is invoked when a token was reserved for a waiting client or when a job
+    // pool that blocked the client might have become available. It is called from whatever
+    // thread released the token, without the budget being locked.
+    // Once unregisterClient() has returned, the callback is not running and will not be called
+    // anymore, so the client can go away. Also gives back all tokens the client holds.
+    void registerClient(Client client, int maxJobCount, std::function<void()> tokenAvailable);
+    void unregisterClient(Client client);
+
+    AcquireResult tryAcquire(Client client, qint64 priority, const PoolLimits &poolLimits);
+    void release(Client client, const QStringList &jobPools);
+    void returnUnusedTokens(Client client);
+
+    int capacity() const;
+    int freeTokens() const;
+    int jobCount(const QString &jobPool) const;
+
+private:
+    // Shared with callers of the callback, so the client can be unregistered concurrently.
+    struct Notifier
+    {
+        std::mutex mutex;
+        std::function<void()> callback;
+    };
+    using NotifierPtr = std::shared_ptr<Notifier>;
+
+    struct ClientData
+    {
+        int maxJobCount = 0;
+        NotifierPtr notifier;
+        int heldTokens = 0;
+        int reservedTokens = 0;
+        bool waiting = false;
+        bool waitingForJobPool = false;
+        qint64 waitPriority = 0;
+        quint64 lastServed = 0;
+        QHash<QString, int> jobCountPerPool;
+    };
+
+    int capacityLocked() const;
+    int freeTokensLocked() const;
+    void changeJobCounts(ClientData &client, const QStringList &jobPools, int diff);
+    std::vector<NotifierPtr> distributeFreeTokens();
+    static void notify(const std::vector<NotifierPtr> &notifiers);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<Client, ClientData> m_clients;
+    QHash<QString, int> m_jobCountPerPool;
+    quint64 m_serveCount = 0;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_JOBBUDGET_H
@@ -306,6 +306,13 @@ void ProcessCommandExecutor::sendProcessOutput()
         result.d->workingDirectory = QDir::currentPath();
     result.d->exitCode = m_process.exitCode();
     result.d->error = m_process.error();
+    const ProcessResourceUsage &resourceUsage = m_process.resourceUsage();
+    result.d->elapsedTime = resourceUsage.elapsedTime;
+    result.d->userTime = resourceUsage.userTime;
+    result.d->systemTime = resourceUsage.systemTime;
+    result.d->maxResidentSetSize = resourceUsage.maxResidentSetSize;
+    result.d->blockInputOperations = resourceUsage.blockInputOperations;
+    result.d->blockOutputOperations = resourceUsage.blockOutputOperations;
     QString errorString = m_process.errorString();
 
     getProcessOutput(true, result);
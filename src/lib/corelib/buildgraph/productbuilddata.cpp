@@ -72,6 +72,7 @@ void ProductBuildData::addArtifactToSet(Artifact *artifact)
         m_artifactsByFileTag[tag] += artifact;
         m_jsArtifactsMapUpToDate = false;
     }
+    m_isDirty = true;
 }
 
 void ProductBuildData::removeArtifact(Artifact *artifact)
@@ -79,6 +80,7 @@ void ProductBuildData::removeArtifact(Artifact *artifact)
     m_roots.remove(artifact);
     m_nodes.remove(artifact);
     removeArtifactFromSet(artifact);
+    setDirty();
 }
 
 void ProductBuildData::removeArtifactFromSetByFileTag(Artifact *artifact, const FileTag &fileTag)
@@ -91,6 +93,7 @@ void ProductBuildData::removeArtifactFromSetByFileTag(Artifact *artifact, const
     if (it->empty())
         m_artifactsByFileTag.erase(it);
     m_jsArtifactsMapUpToDate = false;
+    m_isDirty = true;
 }
 
 void ProductBuildData::addFileTagToArtifact(Artifact *artifact, const FileTag &tag)
@@ -98,6 +101,7 @@ void ProductBuildData::addFileTagToArtifact(Artifact *artifact, const FileTag &t
     std::lock_guard<std::mutex> l(m_artifactsMapMutex);
     m_artifactsByFileTag[tag] += artifact;
     m_jsArtifactsMapUpToDate = false;
+    m_isDirty = true;
 }
 
 ArtifactSetByFileTag ProductBuildData::artifactsByFileTag() const
@@ -108,10 +112,12 @@ ArtifactSetByFileTag ProductBuildData::artifactsByFileTag() const
 void ProductBuildData::setRescuableArtifactData(const AllRescuableArtifactData &rad)
 {
     m_rescuableArtifactData = rad;
+    setDirty();
 }
 
 RescuableArtifactData ProductBuildData::removeFromRescuableArtifactData(const QString &filePath)
 {
+    setDirty();
     return m_rescuableArtifactData.take(filePath);
 }
 
@@ -119,12 +125,14 @@ void ProductBuildData::addRescuableArtifactData(
     const QString &filePath, RescuableArtifactData &&rad)
 {
     m_rescuableArtifactData[filePath] = std::move(rad);
+    setDirty();
 }
 
 void ProductBuildData::markRescuableArtifactsOutOfDate()
 {
     for (RescuableArtifactData &rad : m_rescuableArtifactData)
         rad.knownOutOfDate = true;
+    setDirty();
 }
 
 bool ProductBuildData::checkAndSetJsArtifactsMapUpToDateFlag()
@@ -66,9 +66,9 @@ public:
     const NodeSet &allNodes() const { return m_nodes; }
     const NodeSet &rootNodes() const { return m_roots; }
 
-    void addNode(BuildGraphNode *node) { m_nodes.insert(node); }
-    void addRootNode(BuildGraphNode *node) { m_roots.insert(node); }
-    void removeFromRootNodes(BuildGraphNode *node) { m_roots.remove(node); }
+    void addNode(BuildGraphNode *node) { m_nodes.insert(node); setDirty(); }
+    void addRootNode(BuildGraphNode *node) { m_roots.insert(node); setDirty(); }
+    void removeFromRootNodes(BuildGraphNode *node) { m_roots.remove(node); setDirty(); }
     void addArtifact(Artifact *artifact);
     void addArtifactToSet(Artifact *artifact);
     void removeArtifact(Artifact *artifact);
@@ -83,6 +83,12 @@ public:
     void addRescuableArtifactData(const QString &filePath, RescuableArtifactData &&rad);
     void markRescuableArtifactsOutOfDate();
 
+    // Whether the data has changed since it was loaded or stored. Only the build data of
+    // dirty products is written to the build graph journal.
+    void setDirty() { m_isDirty = true; }
+    void setClean() { m_isDirty = false; }
+    bool isDirty() const { return m_isDirty; }
+
     unsigned int buildPriority() const { return m_buildPriority; }
     void setBuildPriority(unsigned int prio) { m_buildPriority = prio; }
 
@@ -116,6 +122,7 @@ private:
     mutable std::mutex m_artifactsMapMutex;
 
     bool m_jsArtifactsMapUpToDate = true;
+    bool m_isDirty = true;
 };
 
 } // namespace Internal
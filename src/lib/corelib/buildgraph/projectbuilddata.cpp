@@ -96,7 +96,8 @@ QString ProjectBuildData::deriveBuildGraphFilePath(const QString &buildDir, cons
 
 void ProjectBuildData::insertIntoLookupTable(FileResourceBase *fileres)
 {
-    auto &lst = m_artifactLookupTable[{fileres->fileName(), fileres->dirPath()}];
+    auto &lst = m_artifactLookupTable[PathAtomTable::pathKey(fileres->dirAtom(),
+                                                             fileres->fileNameAtom())];
     const auto * const artifact = fileres->fileType() == FileResourceBase::FileTypeArtifact
             ? static_cast<Artifact *>(fileres) : nullptr;
     if (artifact && artifact->artifactType == Artifact::Generated) {
@@ -123,27 +124,40 @@ void ProjectBuildData::insertIntoLookupTable(FileResourceBase *fileres)
 
 void ProjectBuildData::removeFromLookupTable(FileResourceBase *fileres)
 {
-    removeOne(m_artifactLookupTable[{fileres->fileName(), fileres->dirPath()}], fileres);
+    removeOne(m_artifactLookupTable[PathAtomTable::pathKey(fileres->dirAtom(),
+                                                           fileres->fileNameAtom())], fileres);
 }
 
 const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(const QString &filePath) const
 {
-    QString dirPath, fileName;
+    QStringView dirPath, fileName;
     FileInfo::splitIntoDirectoryAndFileName(filePath, &dirPath, &fileName);
-    return lookupFiles(dirPath, fileName);
+    const PathAtomTable &atoms = PathAtomTable::instance();
+    return lookupFiles(atoms.existingAtom(dirPath), atoms.existingAtom(fileName));
 }
 
 const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(const QString &dirPath,
         const QString &fileName) const
+{
+    // Strings that were never interned cannot be the path of any file in the table.
+    const PathAtomTable &atoms = PathAtomTable::instance();
+    return lookupFiles(atoms.existingAtom(dirPath), atoms.existingAtom(fileName));
+}
+
+const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(PathAtom dirAtom,
+        PathAtom fileNameAtom) const
 {
     static const std::vector<FileResourceBase *> emptyResult;
-    const auto it = m_artifactLookupTable.find({fileName, dirPath});
+    if (dirAtom == PathAtomTable::invalidAtom || fileNameAtom == PathAtomTable::invalidAtom)
+        return emptyResult;
+    const auto it = m_artifactLookupTable.find(PathAtomTable::pathKey(dirAtom, fileNameAtom));
     return it != m_artifactLookupTable.end() ? it->second : emptyResult;
 }
 
-const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(const Artifact *artifact) const
+const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(
+        const FileResourceBase *file) const
 {
-    return lookupFiles(artifact->dirPath(), artifact->fileName());
+    return lookupFiles(file->dirAtom(), file->fileNameAtom());
 }
 
 void ProjectBuildData::insertFileDependency(FileDependency *dependency)
@@ -159,13 +173,16 @@ static void disconnectArtifactChildren(Artifact *artifact)
         child->parents.remove(artifact);
     artifact->children.clear();
     artifact->childrenAddedByScanner.clear();
+    setBuildDataDirty(artifact);
 }
 
 static void disconnectArtifactParents(Artifact *artifact)
 {
     qCDebug(lcBuildGraph) << "disconnect parents of" << relativeArtifactFileName(artifact);
     for (BuildGraphNode * const parent : std::as_const(artifact->parents)) {
-        parent->children.remove(artifact);
+        if (parent->children.remove(artifact))
+            parent->onChildRemoved(artifact);
+        setBuildDataDirty(parent);
         if (parent->type() != BuildGraphNode::ArtifactNodeType)
             continue;
         auto const parentArtifact = static_cast<Artifact *>(parent);
@@ -193,6 +210,8 @@ void ProjectBuildData::removeArtifactAndExclusiveDependents(Artifact *artifact,
         const Logger &logger, bool removeFromProduct,
         ArtifactSet *removedArtifacts)
 {
+    // Dependents whose build data was not restored yet are not among the parents.
+    artifact->product->topLevelProject()->restoreBuildDataReferringTo(artifact);
     if (removedArtifacts)
         removedArtifacts->insert(artifact);
 
@@ -221,14 +240,17 @@ void ProjectBuildData::removeArtifactAndExclusiveDependents(Artifact *artifact,
 
 static void removeFromRuleNodes(Artifact *artifact)
 {
-    for (RuleNode * const ruleNode : filterByType<RuleNode>(artifact->parents))
+    for (RuleNode * const ruleNode : filterByType<RuleNode>(artifact->parents)) {
         ruleNode->removeOldInputArtifact(artifact);
+        setBuildDataDirty(ruleNode);
+    }
 }
 
 void ProjectBuildData::removeArtifact(Artifact *artifact,
         const Logger &logger, bool removeFromDisk, bool removeFromProduct)
 {
     qCDebug(lcBuildGraph) << "remove artifact" << relativeArtifactFileName(artifact);
+    artifact->product->topLevelProject()->restoreBuildDataReferringTo(artifact);
     if (removeFromDisk)
         removeGeneratedArtifactFromDisk(artifact, logger);
     removeFromLookupTable(artifact);
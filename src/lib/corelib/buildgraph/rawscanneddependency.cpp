@@ -48,34 +48,44 @@ RawScannedDependency::RawScannedDependency() : m_isClean(true) {}
 
 RawScannedDependency::RawScannedDependency(const QString &filePath)
 {
-    FileInfo::splitIntoDirectoryAndFileName(filePath, &m_dirPath, &m_fileName);
+    QStringView dirPath, fileName;
+    FileInfo::splitIntoDirectoryAndFileName(filePath, &dirPath, &fileName);
+    PathAtomTable &atoms = PathAtomTable::instance();
+    m_dirAtom = atoms.atom(dirPath);
+    m_fileNameAtom = atoms.atom(fileName);
     setClean();
 }
 
 QString RawScannedDependency::filePath() const
 {
-    return m_dirPath.isEmpty() ? m_fileName : m_dirPath + QLatin1Char('/') + m_fileName;
+    return m_dirAtom == PathAtomTable::emptyAtom
+            ? fileName() : dirPath() + QLatin1Char('/') + fileName();
 }
 
 void RawScannedDependency::setClean()
 {
-    m_isClean = !m_dirPath.contains(QLatin1Char('.')) && !m_dirPath.contains(QStringLiteral("//"));
+    const QString &dir = dirPath();
+    m_isClean = !dir.contains(QLatin1Char('.')) && !dir.contains(QStringLiteral("//"));
 }
 
 void RawScannedDependency::load(PersistentPool &pool)
 {
-    serializationOp<PersistentPool::Load>(pool);
+    QString dirPath, fileName;
+    pool.load(dirPath, fileName);
+    PathAtomTable &atoms = PathAtomTable::instance();
+    m_dirAtom = atoms.atom(dirPath);
+    m_fileNameAtom = atoms.atom(fileName);
     setClean();
 }
 
 void RawScannedDependency::store(PersistentPool &pool)
 {
-    serializationOp<PersistentPool::Store>(pool);
+    pool.store(dirPath(), fileName());
 }
 
 bool operator==(const RawScannedDependency &d1, const RawScannedDependency &d2)
 {
-    return d1.dirPath() == d2.dirPath() && d1.fileName() == d2.fileName();
+    return d1.dirAtom() == d2.dirAtom() && d1.fileNameAtom() == d2.fileNameAtom();
 }
 
 
@@ -40,6 +40,7 @@
 #ifndef QBS_RAWSCANNEDDEPENDENCY_H
 #define QBS_RAWSCANNEDDEPENDENCY_H
 
+#include <tools/pathatomtable.h>
 #include <tools/persistence.h>
 
 #include <QtCore/qstring.h>
@@ -55,23 +56,22 @@ public:
     RawScannedDependency(const QString &filePath);
 
     QString filePath() const;
-    const QString &dirPath() const { return m_dirPath; }
-    const QString &fileName() const { return m_fileName; }
+    const QString &dirPath() const { return PathAtomTable::instance().string(m_dirAtom); }
+    const QString &fileName() const { return PathAtomTable::instance().string(m_fileNameAtom); }
+    PathAtom dirAtom() const { return m_dirAtom; }
+    PathAtom fileNameAtom() const { return m_fileNameAtom; }
     bool isClean() const { return m_isClean; }
-    bool isValid() const { return !m_fileName.isEmpty(); }
+    bool isValid() const { return m_fileNameAtom != PathAtomTable::emptyAtom; }
 
     void load(PersistentPool &pool);
     void store(PersistentPool &pool);
 
 private:
     void setClean();
-    template<PersistentPool::OpType opType> void serializationOp(PersistentPool &pool)
-    {
-        pool.serializationOp<opType>(m_dirPath, m_fileName);
-    }
 
-    QString m_dirPath;
-    QString m_fileName;
+    PathAtomTable::Use m_atomTableUse;
+    PathAtom m_dirAtom = PathAtomTable::emptyAtom;
+    PathAtom m_fileNameAtom = PathAtomTable::emptyAtom;
     bool m_isClean = 0;
 };
 
@@ -53,7 +53,16 @@ RawScanResults::ScanData &RawScanResults::findScanData(
     const PropertyMapConstPtr &moduleProperties,
     const FilterFunction &filter)
 {
-    std::vector<ScanData> &scanDataForFile = m_rawScanData[file->filePath()];
+    return findScanData(file->filePath(), scannerId, moduleProperties, filter);
+}
+
+RawScanResults::ScanData &RawScanResults::findScanData(
+    const QString &filePath,
+    const QString &scannerId,
+    const PropertyMapConstPtr &moduleProperties,
+    const FilterFunction &filter)
+{
+    std::vector<ScanData> &scanDataForFile = m_rawScanData[filePath];
     for (auto &scanData : scanDataForFile) {
         if (scannerId != scanData.scannerId)
             continue;
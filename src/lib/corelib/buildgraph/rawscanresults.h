@@ -96,6 +96,12 @@ public:
         const PropertyMapConstPtr &moduleProperties,
         const FilterFunction &filter);
 
+    ScanData &findScanData(
+        const QString &filePath,
+        const QString &scannerId,
+        const PropertyMapConstPtr &moduleProperties,
+        const FilterFunction &filter);
+
     ScanData &findScanData(
         const FileResourceBase *file,
         const DependencyScanner *scanner,
@@ -109,6 +115,14 @@ public:
         const PropertyMapConstPtr &moduleProperties,
         const FilterFunction &filter) const;
 
+    template<typename Callback> void forEachScanData(const Callback &callback) const
+    {
+        for (const auto &scanDataForFile : m_rawScanData) {
+            for (const ScanData &scanData : scanDataForFile.second)
+                callback(scanDataForFile.first, scanData);
+        }
+    }
+
     template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
     {
         pool.serializationOp<opType>(m_rawScanData);
@@ -0,0 +1,360 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "remoteactioncache.h"
+
+#include <logging/categories.h>
+#include <logging/logger.h>
+#include <logging/translator.h>
+#include <tools/error.h>
+
+#include <QtCore/qeventloop.h>
+#include <QtCore/qtimer.h>
+#include <QtCore/qurl.h>
+#include <QtNetwork/qlocalsocket.h>
+#include <QtNetwork/qtcpsocket.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+
+static const int requestTimeoutMs = 10000;
+
+enum class ParseResult { NeedMoreData, Complete, Invalid };
+
+// Decodes a body sent with "Transfer-Encoding: chunked". Trailer fields are skipped.
+static ParseResult decodeChunkedBody(const QByteArray &data, QByteArray &body)
+{
+    body.clear();
+    qsizetype pos = 0;
+    while (true) {
+        const auto sizeLineEnd = data.indexOf("\r\n", pos);
+        if (sizeLineEnd == -1)
+            return ParseResult::NeedMoreData;
+        QByteArray sizeString = data.mid(pos, sizeLineEnd - pos);
+        const auto extensionPos = sizeString.indexOf(';');
+        if (extensionPos != -1)
+            sizeString.truncate(extensionPos);
+        bool ok;
+        const qint64 chunkSize = sizeString.trimmed().toLongLong(&ok, 16);
+        if (!ok || chunkSize < 0)
+            return ParseResult::Invalid;
+        pos = sizeLineEnd + 2;
+        if (chunkSize == 0) {
+            // The body ends with the first empty line after the optional trailer fields.
+            const auto trailerEnd = data.indexOf("\r\n", pos);
+            if (trailerEnd == -1)
+                return ParseResult::NeedMoreData;
+            if (trailerEnd == pos)
+                return ParseResult::Complete;
+            return data.indexOf("\r\n\r\n", pos) == -1 ? ParseResult::NeedMoreData
+                                                         : ParseResult::Complete;
+        }
+        if (data.size() - pos < chunkSize + 2)
+            return ParseResult::NeedMoreData;
+        if (data.mid(pos + chunkSize, 2) != "\r\n")
+            return ParseResult::Invalid;
+        body += data.mid(pos, chunkSize);
+        pos += chunkSize + 2;
+    }
+}
+
+static ParseResult parseHttpResponse(const QByteArray &response, bool atEnd, int &statusCode,
+                                     QByteArray &body, QString &errorMessage)
+{
+    const auto headerEnd = response.indexOf("\r\n\r\n");
+    if (headerEnd == -1)
+        return ParseResult::NeedMoreData;
+    const QList<QByteArray> headerLines = response.left(headerEnd).split('\n');
+    const QList<QByteArray> statusLine = headerLines.first().trimmed().split(' ');
+    statusCode = statusLine.size() >= 2 ? statusLine.at(1).toInt() : 0;
+    qint64 contentLength = -1;
+    QByteArray transferEncoding;
+    for (int i = 1; i < headerLines.size(); ++i) {
+        const QByteArray line = headerLines.at(i).trimmed();
+        const auto colonPos = line.indexOf(':');
+        if (colonPos == -1)
+            continue;
+        const QByteArray name = line.left(colonPos).trimmed().toLower();
+        if (name == "content-length")
+            contentLength = line.mid(colonPos + 1).trimmed().toLongLong();
+        else if (name == "transfer-encoding")
+            transferEncoding = line.mid(colonPos + 1).trimmed().toLower();
+    }
+    const QByteArray data = response.mid(headerEnd + 4);
+    if (!transferEncoding.isEmpty() && transferEncoding != "identity") {
+        if (transferEncoding != "chunked") {
+            errorMessage = Tr::tr("Unsupported transfer encoding '%1'.")
+                    .arg(QString::fromLatin1(transferEncoding));
+            return ParseResult::Invalid;
+        }
+        const ParseResult result = decodeChunkedBody(data, body);
+        if (result == ParseResult::Invalid)
+            errorMessage = Tr::tr("Invalid chunked response from server.");
+        return result;
+    }
+    body = data;
+    if (contentLength == -1)
+        return atEnd ? ParseResult::Complete : ParseResult::NeedMoreData;
+    if (body.size() < contentLength)
+        return ParseResult::NeedMoreData;
+    body.truncate(contentLength);
+    return ParseResult::Complete;
+}
+
+// Speaks the minimal subset of HTTP/1.1 that a content-addressed store needs: Entries are
+// read with "GET <prefix>/<key>" and written with "PUT <prefix>/<key>". Every request uses
+// its own connection, which the server closes after having sent the response.
+// The same protocol is used on top of a Unix domain socket for a cache server on the
+// local machine.
+class HttpActionCache : public RemoteActionCache
+{
+public:
+    HttpActionCache(const QUrl &url, Logger logger);
+    ~HttpActionCache() override;
+
+    void fetch(const QByteArray &key, const FetchCallback &callback) override;
+    bool store(const QByteArray &key, const QByteArray &entryData) override;
+    void waitForPendingOperations(int timeoutMs) override;
+
+private:
+    using ResponseHandler = std::function<void(int statusCode, const QByteArray &body)>;
+    struct Request
+    {
+        QIODevice *socket = nullptr;
+        QByteArray data;
+        QByteArray response;
+        ResponseHandler handler;
+        bool connected = false;
+        bool done = false;
+    };
+    using RequestPtr = std::shared_ptr<Request>;
+
+    void sendRequest(const QByteArray &method, const QByteArray &key, const QByteArray &body,
+                     ResponseHandler handler);
+    void handleResponseData(RequestPtr request, bool atEnd);
+    void finishRequest(RequestPtr request, int statusCode, const QByteArray &body);
+    void failRequest(RequestPtr request, const QString &reason);
+
+    const QString m_url;
+    QString m_host;
+    quint16 m_port = 0;
+    QString m_socketPath;
+    QByteArray m_hostHeader;
+    QByteArray m_pathPrefix;
+    Logger m_logger;
+    std::vector<RequestPtr> m_pendingRequests;
+    QEventLoop *m_waitLoop = nullptr;
+    bool m_unavailable = false;
+};
+
+HttpActionCache::HttpActionCache(const QUrl &url, Logger logger)
+    : m_url(url.toString()), m_logger(std::move(logger))
+{
+    if (url.scheme() == QLatin1String("unix")) {
+        m_socketPath = url.path();
+        m_hostHeader = "localhost";
+        return;
+    }
+    m_host = url.host();
+    m_port = url.port(80);
+    m_hostHeader = QUrl::toAce(m_host);
+    if (url.port() != -1)
+        m_hostHeader += ':' + QByteArray::number(m_port);
+    m_pathPrefix = url.path(QUrl::FullyEncoded).toUtf8();
+    while (m_pathPrefix.endsWith('/'))
+        m_pathPrefix.chop(1);
+}
+
+HttpActionCache::~HttpActionCache()
+{
+    // The sockets get deleted along with this object. Their handlers must not run anymore.
+    for (const RequestPtr &request : m_pendingRequests)
+        request->socket->disconnect();
+}
+
+void HttpActionCache::fetch(const QByteArray &key, const FetchCallback &callback)
+{
+    if (m_unavailable) {
+        callback(QByteArray());
+        return;
+    }
+    sendRequest("GET", key, QByteArray(), [callback](int statusCode, const QByteArray &body) {
+        callback(statusCode == 200 ? body : QByteArray());
+    });
+}
+
+bool HttpActionCache::store(const QByteArray &key, const QByteArray &entryData)
+{
+    if (m_unavailable)
+        return false;
+    sendRequest("PUT", key, entryData, [this, key](int statusCode, const QByteArray &) {
+        if (statusCode != 0 && statusCode / 100 != 2) {
+            qCDebug(lcExec) << "remote action cache rejected entry" << key
+                            << "with status" << statusCode;
+        }
+    });
+    return true;
+}
+
+void HttpActionCache::waitForPendingOperations(int timeoutMs)
+{
+    if (m_pendingRequests.empty())
+        return;
+    QEventLoop loop;
+    m_waitLoop = &loop;
+    QTimer::singleShot(timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec(QEventLoop::ExcludeUserInputEvents);
+    m_waitLoop = nullptr;
+}
+
+void HttpActionCache::sendRequest(const QByteArray &method, const QByteArray &key,
+                                  const QByteArray &body, ResponseHandler handler)
+{
+    const auto request = std::make_shared<Request>();
+    request->handler = std::move(handler);
+    request->data = method + ' ' + m_pathPrefix + '/' + key + " HTTP/1.1\r\n"
+            + "Host: " + m_hostHeader + "\r\n"
+            + "Connection: close\r\n"
+            + "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n"
+            + body;
+    m_pendingRequests.push_back(request);
+
+    const auto onConnected = [request] {
+        request->connected = true;
+        request->socket->write(request->data);
+        request->data.clear();
+    };
+    const auto onEnd = [this, request] { handleResponseData(request, true); };
+    if (m_socketPath.isEmpty()) {
+        const auto socket = new QTcpSocket(this);
+        request->socket = socket;
+        connect(socket, &QTcpSocket::connected, socket, onConnected);
+        connect(socket, &QTcpSocket::disconnected, socket, onEnd);
+        connect(socket, &QTcpSocket::errorOccurred, socket, onEnd);
+    } else {
+        const auto socket = new QLocalSocket(this);
+        request->socket = socket;
+        connect(socket, &QLocalSocket::connected, socket, onConnected);
+        connect(socket, &QLocalSocket::disconnected, socket, onEnd);
+        connect(socket, &QLocalSocket::errorOccurred, socket, onEnd);
+    }
+    connect(request->socket, &QIODevice::readyRead, request->socket, [this, request] {
+        handleResponseData(request, false);
+    });
+    QTimer::singleShot(requestTimeoutMs, request->socket, [this, request] {
+        failRequest(request, Tr::tr("The request timed out."));
+    });
+
+    if (m_socketPath.isEmpty())
+        static_cast<QTcpSocket *>(request->socket)->connectToHost(m_host, m_port);
+    else
+        static_cast<QLocalSocket *>(request->socket)->connectToServer(m_socketPath);
+}
+
+void HttpActionCache::handleResponseData(RequestPtr request, bool atEnd)
+{
+    if (request->done)
+        return;
+    request->response += request->socket->readAll();
+    int statusCode = 0;
+    QByteArray body;
+    QString errorMessage;
+    switch (parseHttpResponse(request->response, atEnd, statusCode, body, errorMessage)) {
+    case ParseResult::Complete:
+        finishRequest(request, statusCode, body);
+        break;
+    case ParseResult::Invalid:
+        failRequest(request, errorMessage);
+        break;
+    case ParseResult::NeedMoreData:
+        if (atEnd) {
+            failRequest(request, request->connected ? Tr::tr("Incomplete response from server.")
+                                                    : request->socket->errorString());
+        }
+        break;
+    }
+}
+
+void HttpActionCache::finishRequest(RequestPtr request, int statusCode, const QByteArray &body)
+{
+    if (request->done)
+        return;
+    request->done = true;
+    request->socket->disconnect();
+    request->socket->deleteLater();
+    m_pendingRequests.erase(std::find(m_pendingRequests.begin(), m_pendingRequests.end(),
+                                      request));
+    request->handler(statusCode, body);
+    if (m_pendingRequests.empty() && m_waitLoop)
+        m_waitLoop->quit();
+}
+
+// A server that fails once is likely to fail again, and waiting for timeouts over and over
+// would make the build slower than not having a remote cache at all.
+void HttpActionCache::failRequest(RequestPtr request, const QString &reason)
+{
+    if (request->done)
+        return;
+    if (!m_unavailable) {
+        m_unavailable = true;
+        m_logger.qbsWarning() << Tr::tr("Remote action cache '%1' is not available, "
+                                        "continuing without it: %2").arg(m_url, reason);
+    }
+    finishRequest(request, 0, QByteArray());
+}
+
+RemoteActionCache::~RemoteActionCache() = default;
+
+std::unique_ptr<RemoteActionCache> RemoteActionCache::create(const QString &url,
+                                                             const Logger &logger)
+{
+    const QUrl parsedUrl(url);
+    if ((parsedUrl.scheme() == QLatin1String("unix") && !parsedUrl.path().isEmpty())
+            || (parsedUrl.scheme() == QLatin1String("http") && !parsedUrl.host().isEmpty())) {
+        return std::make_unique<HttpActionCache>(parsedUrl, logger);
+    }
+    throw ErrorInfo(Tr::tr("Invalid remote action cache URL '%1'. Supported are "
+                           "'http://host[:port][/path]' and 'unix:/path/to/socket'.").arg(url));
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,84 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_REMOTEACTIONCACHE_H
+#define QBS_REMOTEACTIONCACHE_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+
+#include <functional>
+#include <memory>
+
+namespace qbs {
+namespace Internal {
+class Logger;
+
+// A backend that makes action cache entries available across machines, e.g. to share
+// the results of CI builds with developers. All operations are asynchronous, so they never
+// block the executor's event loop. A backend that cannot be reached behaves like an empty
+// cache that discards everything stored into it.
+class RemoteActionCache : public QObject
+{
+public:
+    // The callback receives an empty byte array if the entry is not available.
+    using FetchCallback = std::function<void(const QByteArray &entryData)>;
+
+    ~RemoteActionCache() override;
+
+    // Supported are "http://host[:port][/path]" and "unix:/path/to/socket".
+    // Throws ErrorInfo if the URL cannot be handled.
+    static std::unique_ptr<RemoteActionCache> create(const QString &url, const Logger &logger);
+
+    virtual void fetch(const QByteArray &key, const FetchCallback &callback) = 0;
+    // Returns false if the entry was not sent, because the backend is known to be unavailable.
+    virtual bool store(const QByteArray &key, const QByteArray &entryData) = 0;
+
+    // Blocks until all uploads are done or the timeout has expired.
+    virtual void waitForPendingOperations(int timeoutMs) = 0;
+
+protected:
+    RemoteActionCache() = default;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_REMOTEACTIONCACHE_H
@@ -71,6 +71,7 @@ public:
             commands,
             lastPrepareScriptExecutionTime,
             lastCommandExecutionTime,
+            lastCommandExecutionDuration,
             fileTags,
             properties);
     }
@@ -109,6 +110,7 @@ public:
     TrackedScriptAccesses trackedAccessesFromCommands;
     FileTime lastPrepareScriptExecutionTime;
     FileTime lastCommandExecutionTime;
+    qint64 lastCommandExecutionDuration = -1;
     bool knownOutOfDate = false;
 
     // Only needed for API purposes
@@ -162,10 +162,7 @@ RuleNode::ApplicationResult RuleNode::apply(
 
     const bool mustScan = mustApplyRule || !inputsToScan.empty();
 
-    Set<QString> excludedScanners;
-    for (const QString &scannerId : std::as_const(m_rule->excludedScanners))
-        excludedScanners.insert(scannerId);
-    InputArtifactScanner inputScanner(logger, inputArtifactScanContext, excludedScanners);
+    InputArtifactScanner inputScanner(logger, inputArtifactScanContext, excludedScanners());
 
     QElapsedTimer scanTimer;
     scanTimer.start();
@@ -240,10 +237,30 @@ RuleNode::ApplicationResult RuleNode::apply(
     result.invalidatedArtifacts.unite(updateOutputsDependencies(inputScanner, wasScanned));
     m_oldInputArtifacts = allCompatibleInputs;
     m_oldExplicitlyDependsOn = explicitlyDependsOn;
+    product->buildData->setDirty();
     product->topLevelProject()->buildData->setDirty();
     return result;
 }
 
+/*
+    Returns the jobs for scanning this rule's inputs in worker threads before the rule
+    gets applied.
+*/
+std::vector<InputArtifactPrescanner::Job> RuleNode::prescanJobs(
+    const Logger &logger, InputArtifactScannerContext *inputArtifactScanContext) const
+{
+    InputArtifactScanner inputScanner(logger, inputArtifactScanContext, excludedScanners());
+    return inputScanner.prescanJobs(currentInputArtifacts());
+}
+
+Set<QString> RuleNode::excludedScanners() const
+{
+    Set<QString> scannerIds;
+    for (const QString &scannerId : std::as_const(m_rule->excludedScanners))
+        scannerIds.insert(scannerId);
+    return scannerIds;
+}
+
 /*
     Updates the dependencies of the outputs of this rule.
     Returns the set of outputs that had their dependencies updated - those will be invalidated.
@@ -338,11 +355,11 @@ ArtifactSet RuleNode::changedInputArtifacts(
         return changedInputArtifacts;
 
     for (Artifact * const artifact : explicitlyDependsOn) {
-        if (artifact->timestamp() > m_lastApplicationTime)
+        if (artifact->effectiveTimestamp() > m_lastApplicationTime)
             return allCompatibleInputs;
     }
     for (Artifact * const artifact : allCompatibleInputs) {
-        if (artifact->timestamp() > m_lastApplicationTime)
+        if (artifact->effectiveTimestamp() > m_lastApplicationTime)
             changedInputArtifacts.insert(artifact);
     }
     return changedInputArtifacts;
@@ -362,7 +379,7 @@ ArtifactSet RuleNode::collectInputsForOutOfDateOutputs(const ArtifactSet &allCom
         bool outputUpToDate = output->timestamp().isValid() && !output->transformer->markedForRerun;
         if (outputUpToDate) {
             for (Artifact *childArtifact : filterByType<Artifact>(output->children)) {
-                if (output->timestamp() < childArtifact->timestamp()) {
+                if (output->timestamp() < childArtifact->effectiveTimestamp()) {
                     outputUpToDate = false;
                     break;
                 }
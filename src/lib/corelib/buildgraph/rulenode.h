@@ -82,6 +82,8 @@ public:
         const std::unordered_map<QString, const ResolvedProduct *> &productsByName,
         const std::unordered_map<QString, const ResolvedProject *> &projectsByName,
         InputArtifactScannerContext *inputArtifactScanContext);
+    std::vector<InputArtifactPrescanner::Job> prescanJobs(
+        const Logger &logger, InputArtifactScannerContext *inputArtifactScanContext) const;
     void removeOldInputArtifact(Artifact *artifact);
 
     void load(PersistentPool &pool) override;
@@ -101,6 +103,7 @@ private:
     }
 
     ArtifactSet currentInputArtifacts() const;
+    Set<QString> excludedScanners() const;
     ArtifactSet changedInputArtifacts(
         const ArtifactSet &allCompatibleInputs, const ArtifactSet &explicitlyDependsOn) const;
     ArtifactSet collectInputsForOutOfDateOutputs(const ArtifactSet &allCompatibleInputs) const;
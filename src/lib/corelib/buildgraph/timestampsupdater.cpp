@@ -76,8 +76,11 @@ public:
 private:
     void doVisit(Artifact *artifact) override
     {
-        if (FileInfo(artifact->filePath()).exists())
+        if (FileInfo(artifact->filePath()).exists()) {
             artifact->setTimestamp(m_now);
+            artifact->clearContentInfo();
+            artifact->product->buildData->setDirty();
+        }
     }
 
     FileTime m_now;
@@ -314,6 +314,7 @@ void Transformer::rescueChangeTrackingData(const TransformerConstPtr &other)
     trackedAccessesFromPrepareScript = other->trackedAccessesFromPrepareScript;
     trackedAccessesFromCommands = other->trackedAccessesFromCommands;
     lastCommandExecutionTime = other->lastCommandExecutionTime;
+    lastCommandExecutionDuration = other->lastCommandExecutionDuration;
     lastPrepareScriptExecutionTime = other->lastPrepareScriptExecutionTime;
     prepareScriptNeedsChangeTracking = other->prepareScriptNeedsChangeTracking;
     commandsNeedChangeTracking = other->commandsNeedChangeTracking;
@@ -328,6 +329,7 @@ void Transformer::rescueFromArtifactData(RescuableArtifactData &&rad)
     }
     trackedAccessesFromCommands = std::move(rad.trackedAccessesFromCommands);
     lastCommandExecutionTime = rad.lastCommandExecutionTime;
+    lastCommandExecutionDuration = rad.lastCommandExecutionDuration;
     commandsNeedChangeTracking = true;
     markedForRerun = markedForRerun || rad.knownOutOfDate;
 }
@@ -338,6 +340,7 @@ RescuableArtifactData Transformer::rescueToArtifactData() const
     result.trackedAccessesFromPrepareScript = trackedAccessesFromPrepareScript;
     result.trackedAccessesFromCommands = trackedAccessesFromCommands;
     result.lastCommandExecutionTime = lastCommandExecutionTime;
+    result.lastCommandExecutionDuration = lastCommandExecutionDuration;
     result.lastPrepareScriptExecutionTime = lastPrepareScriptExecutionTime;
     result.knownOutOfDate = markedForRerun;
     result.commands = commands;
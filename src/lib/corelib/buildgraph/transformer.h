@@ -81,6 +81,7 @@ public:
     TrackedScriptAccesses trackedAccessesFromCommands;
     FileTime lastPrepareScriptExecutionTime;
     FileTime lastCommandExecutionTime;
+    qint64 lastCommandExecutionDuration = -1; // In milliseconds, -1 if unknown. For scheduling.
     bool alwaysRun;
     bool prepareScriptNeedsChangeTracking = false;
     bool commandsNeedChangeTracking = false;
@@ -115,6 +116,7 @@ public:
             commands,
             lastPrepareScriptExecutionTime,
             lastCommandExecutionTime,
+            lastCommandExecutionDuration,
             alwaysRun,
             prepareScriptNeedsChangeTracking,
             commandsNeedChangeTracking,
@@ -27,6 +27,7 @@
 ****************************************************************************/
 #include "transformerchangetracking.h"
 
+#include "productbuilddata.h"
 #include "projectbuilddata.h"
 #include "requesteddependencies.h"
 #include "rulecommands.h"
@@ -343,6 +344,7 @@ bool prepareScriptNeedsRerun(
     if (!transformer->prepareScriptNeedsChangeTracking)
         return false;
     transformer->prepareScriptNeedsChangeTracking = false;
+    product->buildData->setDirty();
     return TrafoChangeTracker(transformer, nullptr, product, productsByName, projectsByName)
         .prepareScriptNeedsRerun();
 }
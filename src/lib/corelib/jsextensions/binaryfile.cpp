@@ -135,6 +135,8 @@ JSValue BinaryFile::ctor(JSContext *ctx, JSValueConst, JSValueConst,
         };
         se->checkContext(QStringLiteral("qbs.BinaryFile"), dubiousContexts);
         se->setUsesIo();
+        if (mode & ReadOnly)
+            se->addFileUsed(filePath);
         return obj;
     } catch (const QString &error) { return throwError(ctx, error); }
 }
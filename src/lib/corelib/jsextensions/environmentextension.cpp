@@ -89,8 +89,10 @@ JSValue EnvironmentExtension::jsGetEnv(JSContext *ctx, JSValueConst, int argc, J
         const QProcessEnvironment env = engine->environment();
         const QProcessEnvironment *procenv = getProcessEnvironment(engine, QStringLiteral("getEnv"),
                                                                    false);
-        if (!procenv)
+        if (!procenv) {
             procenv = &env;
+            engine->addEnvironmentVariableUsed(name);
+        }
         const QString value = procenv->value(name);
         return value.isNull() ? engine->undefinedValue() : makeJsString(ctx, value);
     } catch (const QString &error) { return throwError(ctx, error); }
@@ -127,6 +129,8 @@ JSValue EnvironmentExtension::jsCurrentEnv(JSContext *ctx, JSValue, int, JSValue
     JSValue envObject = engine->newObject();
     const auto keys = procenv->keys();
     for (const QString &key : keys) {
+        if (procenv == &env)
+            engine->addEnvironmentVariableUsed(key);
         const QString keyName = HostOsInfo::isWindowsHost() ? key.toUpper() : key;
         setJsProperty(ctx, envObject, keyName, procenv->value(key));
     }
@@ -143,6 +143,7 @@ public:
 private:
     QString findExecutable(const QString &filePath) const;
 
+    ScriptEngine * const m_engine;
     std::unique_ptr<QProcess> m_qProcess;
     QProcessEnvironment m_environment;
     QString m_workingDirectory;
@@ -205,7 +206,7 @@ void Process::setupMethods(JSContext *ctx, JSValue obj)
     setupMethod(ctx, obj, "errorString", &jsErrorString, 0);
 }
 
-Process::Process(JSContext *)
+Process::Process(JSContext *ctx) : m_engine(ScriptEngine::engineForContext(ctx))
 {
     m_qProcess = std::make_unique<QProcess>();
     m_codec = QTextCodec::codecForName("UTF-8");
@@ -217,7 +218,11 @@ bool Process::start(const QString &program, const QStringList &arguments)
         m_qProcess->setWorkingDirectory(m_workingDirectory);
 
     m_qProcess->setProcessEnvironment(m_environment);
-    m_qProcess->start(findExecutable(program), arguments, QIODevice::ReadWrite | QIODevice::Text);
+    const QString executable = findExecutable(program);
+    m_engine->addFileUsed(executable);
+    // The lookup was done in the process' own environment, which the script may have changed.
+    m_engine->addEnvironmentVariableUsed(m_environment, StringConstants::pathEnvVar());
+    m_qProcess->start(executable, arguments, QIODevice::ReadWrite | QIODevice::Text);
     return m_qProcess->waitForStarted();
 }
 
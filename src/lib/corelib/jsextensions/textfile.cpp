@@ -134,6 +134,8 @@ JSValue TextFile::ctor(JSContext *ctx, JSValueConst, JSValueConst,
         };
         se->checkContext(QStringLiteral("qbs.TextFile"), dubiousContexts);
         se->setUsesIo();
+        if (mode & ReadOnly)
+            se->addFileUsed(filePath);
         return obj.release();
     } catch (const QString &error) { return throwError(ctx, error); }
 }
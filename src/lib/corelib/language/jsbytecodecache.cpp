@@ -0,0 +1,165 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "jsbytecodecache.h"
+
+#include <logging/categories.h>
+
+#include <quickjs.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qsavefile.h>
+
+namespace qbs {
+namespace Internal {
+
+// An entry file consists of the magic, the size of the bytecode as a 32 bit big-endian value,
+// the SHA-1 of the bytecode and the bytecode itself.
+static const char bytecodeMagic[] = "QBSJSBC2";
+static const int magicSize = int(sizeof bytecodeMagic) - 1;
+static const int checksumSize = 20;
+static const int headerSize = magicSize + int(sizeof(quint32)) + checksumSize;
+
+static QByteArray checksum(const QByteArray &bytecode)
+{
+    return QCryptographicHash::hash(bytecode, QCryptographicHash::Sha1);
+}
+
+JsBytecodeCache &JsBytecodeCache::instance()
+{
+    static JsBytecodeCache cache(CacheDirectory::defaultPath(
+                                     "QBS_JS_BYTECODE_CACHE_DIR", QStringLiteral("js-bytecode")));
+    return cache;
+}
+
+JsBytecodeCache::JsBytecodeCache(const QString &directory, qint64 maxSize)
+    : m_directory(directory, maxSize)
+{
+}
+
+QByteArray JsBytecodeCache::key(const QByteArray &code, const QByteArray &filePath, int line)
+{
+    // The file path and line are part of the key, because they end up in the debug
+    // information of the bytecode.
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray(QBS_VERSION));
+    hash.addData(QByteArray(JS_GetVersion()));
+    hash.addData(filePath);
+    hash.addData(QByteArray::number(line));
+    hash.addData(code);
+    return hash.result();
+}
+
+QByteArray JsBytecodeCache::lookup(const QByteArray &key)
+{
+    {
+        const auto entries = m_entries.lock_shared();
+        const auto it = entries.get().constFind(key);
+        if (it != entries.get().constEnd()) {
+            ++m_memoryHitCount;
+            return it.value();
+        }
+    }
+    if (!m_directory.isEnabled())
+        return {};
+    QFile file(entryFilePath(key));
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    const QByteArray data = file.readAll();
+    const QByteArray bytecode = data.mid(headerSize);
+    if (data.size() < headerSize
+            || !data.startsWith(QByteArray::fromRawData(bytecodeMagic, magicSize))
+            || qFromBigEndian<quint32>(data.constData() + magicSize) != quint32(bytecode.size())
+            || data.mid(magicSize + int(sizeof(quint32)), checksumSize) != checksum(bytecode)) {
+        qCDebug(lcProjectResolver) << "ignoring invalid bytecode cache entry" << file.fileName();
+        return {};
+    }
+
+    m_directory.entryUsed(file);
+    ++m_diskHitCount;
+    m_entries.lock().get().insert(key, bytecode);
+    return bytecode;
+}
+
+void JsBytecodeCache::insert(const QByteArray &key, const QByteArray &bytecode)
+{
+    ++m_compiledCount;
+    m_entries.lock().get().insert(key, bytecode);
+    if (!m_directory.isEnabled())
+        return;
+
+    // Failing to store an entry only costs a compilation in the next run,
+    // so errors are not reported.
+    const QString filePath = entryFilePath(key);
+    if (!QDir().mkpath(QFileInfo(filePath).absolutePath()))
+        return;
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    char size[sizeof(quint32)];
+    qToBigEndian<quint32>(bytecode.size(), size);
+    file.write(bytecodeMagic, magicSize);
+    file.write(size, sizeof size);
+    file.write(checksum(bytecode));
+    file.write(bytecode);
+    if (!file.commit()) {
+        qCDebug(lcProjectResolver) << "failed to store bytecode cache entry" << filePath;
+        return;
+    }
+    m_directory.entryStored(headerSize + bytecode.size());
+}
+
+JsBytecodeCache::Stats JsBytecodeCache::stats() const
+{
+    return {m_compiledCount, m_memoryHitCount, m_diskHitCount};
+}
+
+// Two levels, so that a single directory does not get too many entries.
+QString JsBytecodeCache::entryFilePath(const QByteArray &key) const
+{
+    const QString hex = QString::fromLatin1(key.toHex());
+    return m_directory.path() + QLatin1Char('/') + hex.left(2) + QLatin1Char('/') + hex.mid(2);
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,106 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_JSBYTECODECACHE_H
+#define QBS_JSBYTECODECACHE_H
+
+#include "qbs_export.h"
+
+#include <tools/cachedirectory.h>
+#include <tools/mutexdata.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+
+#include <atomic>
+
+namespace qbs {
+namespace Internal {
+
+/*!
+ * Holds the compiled QuickJS bytecode of imported JavaScript files and rule scripts.
+ * The entries are shared by all script engines of the process and are also stored on disk,
+ * so they survive the process. An entry is keyed by the digest of the source code and
+ * its location, as well as the qbs and QuickJS versions, so stale entries are never used.
+ * The directory can be changed via the environment variable QBS_JS_BYTECODE_CACHE_DIR;
+ * setting it to an empty value keeps the cache in memory only.
+ * Entries on disk carry their length and checksum, so that truncated or otherwise corrupted
+ * files are never handed to QuickJS. If the directory grows beyond the size limit, the least
+ * recently used entries are removed.
+ */
+class QBS_AUTOTEST_EXPORT JsBytecodeCache
+{
+public:
+    struct Stats
+    {
+        int compiled = 0;
+        int memoryHits = 0;
+        int diskHits = 0;
+    };
+
+    static JsBytecodeCache &instance();
+
+    static const qint64 defaultMaxSize = 256 * 1024 * 1024;
+
+    // An empty directory means in-memory only.
+    explicit JsBytecodeCache(const QString &directory, qint64 maxSize = defaultMaxSize);
+
+    static QByteArray key(const QByteArray &code, const QByteArray &filePath, int line);
+    QByteArray lookup(const QByteArray &key); // Returns an empty array on a miss.
+    void insert(const QByteArray &key, const QByteArray &bytecode);
+
+    QString directory() const { return m_directory.path(); }
+    Stats stats() const;
+    void prune() { m_directory.prune(); }
+
+private:
+    QString entryFilePath(const QByteArray &key) const;
+
+    CacheDirectory m_directory;
+    MutexData<QHash<QByteArray, QByteArray>> m_entries;
+    std::atomic_int m_compiledCount = 0;
+    std::atomic_int m_memoryHitCount = 0;
+    std::atomic_int m_diskHitCount = 0;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_JSBYTECODECACHE_H
@@ -46,6 +46,7 @@
 
 #include <buildgraph/artifact.h>
 #include <buildgraph/buildgraph.h>
+#include <buildgraph/buildstatefingerprint.h>
 #include <buildgraph/productbuilddata.h>
 #include <buildgraph/projectbuilddata.h>
 #include <buildgraph/trackedscriptaccesses.h>
@@ -71,8 +72,10 @@
 #include <QtCore/qmap.h>
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <utility>
 
 namespace qbs {
 namespace Internal {
@@ -568,18 +571,6 @@ std::vector<ResolvedProductPtr> ResolvedProject::allProducts() const
 void ResolvedProject::load(PersistentPool &pool)
 {
     serializationOp<PersistentPool::Load>(pool);
-    std::for_each(products.cbegin(), products.cend(),
-                  [](const ResolvedProductPtr &p) {
-        if (!p->buildData)
-            return;
-        for (BuildGraphNode * const node : std::as_const(p->buildData->allNodes())) {
-            node->product = p;
-
-            // restore parent links
-            for (BuildGraphNode * const child : std::as_const(node->children))
-                child->parents.insert(node);
-        }
-    });
 }
 
 void ResolvedProject::store(PersistentPool &pool)
@@ -595,6 +586,8 @@ TopLevelProject::TopLevelProject()
 
 TopLevelProject::~TopLevelProject()
 {
+    if (m_pendingStore.valid())
+        m_pendingStore.wait();
     cleanupModuleProviderOutput();
     delete bgLocker;
 }
@@ -656,18 +649,288 @@ void TopLevelProject::store(Logger logger)
     }
 
     makeModuleProvidersNonTransient();
+#ifndef NDEBUG
+    if (m_buildGraphPool)
+        checkBuildDataSnapshots();
+#endif
 
     const QString fileName = buildGraphFilePath();
     qCDebug(lcBuildGraph) << "storing:" << fileName;
+    BuildStateFingerprint::remove(fileName);
     PersistentPool pool(logger);
     PersistentPool::HeadData headData;
     headData.projectConfig = buildConfiguration();
     pool.setHeadData(headData);
-    pool.setupWriteStream(fileName);
-    store(pool);
+    bool stored = false;
+    if (m_buildGraphPool && !m_buildGraphPool->journalNeedsCompaction()) {
+        // Only the build data of products that have changed is appended to the journal.
+        std::vector<bool> sectionsToCopy(m_buildGraphPool->sectionCount(), false);
+        for (int i = 1; i < m_buildGraphPool->sectionCount(); ++i) {
+            sectionsToCopy[i] = !m_buildGraphPool->isSectionLoaded(i)
+                    || !m_productsBySection.at(i)->buildData->isDirty();
+        }
+        pool.setupJournalWriteStream(m_buildGraphPool.get(), sectionsToCopy);
+        storeBuildGraph(pool, sectionsToCopy);
+        stored = pool.copiedSectionsAreConsistent();
+        if (!stored)
+            qCDebug(lcBuildGraph) << "cannot write journal, storing complete build graph";
+    }
+    if (!stored && m_buildGraphPool) {
+        // The build data that was not restored is copied from the old file. This only works
+        // as long as the objects it refers to were stored under their old IDs.
+        std::vector<bool> sectionsToCopy(m_buildGraphPool->sectionCount(), false);
+        for (int i = 1; i < m_buildGraphPool->sectionCount(); ++i)
+            sectionsToCopy[i] = !m_buildGraphPool->isSectionLoaded(i);
+        pool.setupWriteStream(fileName, m_buildGraphPool.get());
+        storeBuildGraph(pool, sectionsToCopy);
+        stored = pool.copiedSectionsAreConsistent();
+        if (!stored) {
+            qCDebug(lcBuildGraph) << "cannot copy unrestored build data, restoring all products";
+            restoreAllBuildData();
+            m_buildGraphPool.reset();
+        }
+    }
+    if (!stored) {
+        pool.setupWriteStream(fileName);
+        storeBuildGraph(pool, {});
+    }
     pool.finalizeWriteStream();
+
+    // The next store builds on what was just written.
+    if (!m_buildGraphPool) {
+        m_buildGraphPool = std::make_unique<PersistentPool>(logger);
+        m_buildGraphPool->adoptStoredData(pool);
+        setupProductSections(*m_buildGraphPool);
+    } else {
+        m_buildGraphPool->adoptStoredData(pool);
+    }
+    for (const ResolvedProductPtr &product : allProducts()) {
+        if (product->buildData)
+            product->buildData->setClean();
+    }
     buildData->setClean();
+#ifndef NDEBUG
+    m_sectionsToSnapshot.clear();
+    m_buildDataSnapshots.clear();
+    for (int i = 1; i < m_buildGraphPool->sectionCount(); ++i) {
+        if (m_buildGraphPool->isSectionLoaded(i))
+            m_sectionsToSnapshot.push_back(i);
+    }
+    takeBuildDataSnapshots();
+#endif
+}
+
+void TopLevelProject::storeInBackground(std::function<void()> storeFunction)
+{
+    QBS_CHECK(!m_pendingStore.valid());
+    m_pendingStore = std::async(std::launch::async, std::move(storeFunction));
+}
+
+void TopLevelProject::waitForPendingStore()
+{
+    if (m_pendingStore.valid())
+        std::future<void>(std::move(m_pendingStore)).get();
+}
+
+void TopLevelProject::releaseBuildGraphLock()
+{
+    waitForPendingStore();
+    m_buildGraphFileTimesAtLockRelease = buildGraphFileTimes();
+    delete bgLocker;
+    bgLocker = nullptr;
+}
+
+bool TopLevelProject::buildGraphChangedSinceLockRelease() const
+{
+    return buildGraphFileTimes() != m_buildGraphFileTimesAtLockRelease;
+}
+
+std::vector<FileTime> TopLevelProject::buildGraphFileTimes() const
+{
+    const QString filePath = buildGraphFilePath();
+    return {FileInfo(filePath).lastModified(),
+            FileInfo(PersistentPool::journalFilePath(filePath)).lastModified()};
+}
+
+void TopLevelProject::loadBuildGraph(std::unique_ptr<PersistentPool> pool)
+{
+    QBS_CHECK(pool->sectionCount() > 0);
+    pool->setKeepObjectIds(true);
+    pool->loadSection(0, [this, &pool] { load(*pool); });
+    setupProductSections(*pool);
+    for (int i = 1; i < pool->sectionCount(); ++i) {
+        // Stays empty until the actual build data gets restored.
+        m_productsBySection.at(i)->buildData = std::make_unique<ProductBuildData>();
+        m_productsBySection.at(i)->buildData->setClean();
+    }
+
+    // Artifacts can refer to artifacts of products that are not among the ones restored,
+    // e.g. if a product depends on another one via explicitlyDependsOnFromDependencies.
+    pool->setSectionLoader([this](int section) { loadProductBuildData(section); });
+    m_buildGraphPool = std::move(pool);
+}
+
+void TopLevelProject::setupProductSections(const PersistentPool &pool)
+{
+    QHash<QString, ResolvedProductPtr> productsByName;
+    for (const ResolvedProductPtr &product : allProducts())
+        productsByName.insert(product->uniqueName(), product);
+    m_productsBySection.clear();
+    m_productsBySection.resize(pool.sectionCount());
+    m_sectionsByProduct.clear();
+    for (int i = 1; i < pool.sectionCount(); ++i) {
+        const ResolvedProductPtr product
+                = productsByName.value(pool.headData().sections.at(i).key);
+        QBS_CHECK(product);
+        m_productsBySection[i] = product;
+        m_sectionsByProduct.insert(product.get(), i);
+    }
+}
+
+void TopLevelProject::restoreBuildData(const std::vector<ResolvedProductPtr> &products)
+{
+    waitForPendingStore();
+    if (!m_buildGraphPool)
+        return;
+    Set<const ResolvedProduct *> seenProducts;
+    const std::function<void(const ResolvedProductPtr &)> restore
+            = [&](const ResolvedProductPtr &product) {
+        if (!seenProducts.insert(product.get()).second)
+            return;
+        for (const ProductDependency &dep : std::as_const(product->dependencies))
+            restore(dep.product);
+        const int section = m_sectionsByProduct.value(product.get(), -1);
+        if (section > 0 && !m_buildGraphPool->isSectionLoaded(section))
+            loadProductBuildData(section);
+    };
+    for (const ResolvedProductPtr &product : products)
+        restore(product);
+#ifndef NDEBUG
+    takeBuildDataSnapshots();
+#endif
+}
+
+void TopLevelProject::restoreAllBuildData()
+{
+    waitForPendingStore();
+    if (!m_buildGraphPool)
+        return;
+    for (int i = 1; i < m_buildGraphPool->sectionCount(); ++i) {
+        if (!m_buildGraphPool->isSectionLoaded(i))
+            loadProductBuildData(i);
+    }
+#ifndef NDEBUG
+    takeBuildDataSnapshots();
+#endif
+}
+
+void TopLevelProject::restoreBuildDataReferringTo(const void *object)
+{
+    waitForPendingStore();
+    if (!m_buildGraphPool)
+        return;
+    for (const int section : m_buildGraphPool->unloadedSectionsReferringTo(object)) {
+        if (!m_buildGraphPool->isSectionLoaded(section))
+            loadProductBuildData(section);
+    }
+#ifndef NDEBUG
+    takeBuildDataSnapshots();
+#endif
+    m_buildGraphPool->forgetObject(object);
+}
+
+void TopLevelProject::loadProductBuildData(int section)
+{
+    const ResolvedProductPtr product = m_productsBySection.at(section);
+    qCDebug(lcBuildGraph) << "restoring build data of product" << product->uniqueName();
+    m_buildGraphPool->loadSection(section, [this, &product] {
+        m_buildGraphPool->load(product->buildData);
+    });
+    QBS_CHECK(product->buildData);
+    product->buildData->setClean();
+#ifndef NDEBUG
+    // Sections loaded on the way can refer to objects of sections that are not loaded
+    // completely yet, so the snapshot is taken once the restoring is done.
+    m_sectionsToSnapshot.push_back(section);
+#endif
+    for (BuildGraphNode * const node : std::as_const(product->buildData->allNodes())) {
+        node->product = product;
+
+        // restore parent links
+        for (BuildGraphNode * const child : std::as_const(node->children))
+            child->parents.insert(node);
+
+        if (node->type() == BuildGraphNode::ArtifactNodeType)
+            buildData->insertIntoLookupTable(static_cast<Artifact *>(node));
+    }
+}
+
+// If sectionsToCopy is not empty, the sections of the loaded build graph are written in their
+// original order, with the ones marked there being taken over from the loaded file.
+void TopLevelProject::storeBuildGraph(PersistentPool &pool, const std::vector<bool> &sectionsToCopy)
+{
+    pool.storeSection(QString(), [this, &pool] { store(pool); });
+    if (!sectionsToCopy.empty()) {
+        for (int i = 1; i < int(sectionsToCopy.size()); ++i) {
+            if (sectionsToCopy[i])
+                pool.copySection(i);
+            else
+                storeProductBuildData(pool, m_productsBySection.at(i));
+        }
+        return;
+    }
+
+    // Dependencies come first, so that artifacts referring to artifacts from other products
+    // usually refer back to sections that are already known when loading.
+    Set<const ResolvedProduct *> seenProducts;
+    const std::function<void(const ResolvedProductPtr &)> storeProduct
+            = [&](const ResolvedProductPtr &product) {
+        if (!seenProducts.insert(product.get()).second)
+            return;
+        for (const ProductDependency &dep : std::as_const(product->dependencies))
+            storeProduct(dep.product);
+        if (product->buildData)
+            storeProductBuildData(pool, product);
+    };
+    for (const ResolvedProductPtr &product : allProducts())
+        storeProduct(product);
+}
+
+void TopLevelProject::storeProductBuildData(PersistentPool &pool,
+                                            const ResolvedProductPtr &product)
+{
+    pool.storeSection(product->uniqueName(), [&pool, &product] {
+        pool.store(product->buildData);
+    });
+}
+
+#ifndef NDEBUG
+// Only the build data of dirty products is written to the journal, so build data that is not
+// marked as dirty must still serialize to what it was when it was restored or last stored.
+// This catches modifications that do not call ProductBuildData::setDirty().
+QByteArray TopLevelProject::buildDataSnapshot(int section) const
+{
+    const ResolvedProductPtr &product = m_productsBySection.at(section);
+    return m_buildGraphPool->sectionSnapshot(section, [&product](PersistentPool &pool) {
+        pool.store(product->buildData);
+    });
+}
+
+void TopLevelProject::takeBuildDataSnapshots()
+{
+    for (const int section : std::exchange(m_sectionsToSnapshot, {}))
+        m_buildDataSnapshots.insert(section, buildDataSnapshot(section));
+}
+
+void TopLevelProject::checkBuildDataSnapshots() const
+{
+    for (auto it = m_buildDataSnapshots.cbegin(); it != m_buildDataSnapshots.cend(); ++it) {
+        const ResolvedProductPtr &product = m_productsBySection.at(it.key());
+        if (product->buildData && !product->buildData->isDirty())
+            QBS_CHECK(buildDataSnapshot(it.key()) == it.value());
+    }
 }
+#endif
 
 void TopLevelProject::load(PersistentPool &pool)
 {
@@ -1023,8 +1286,8 @@ JSValue PrivateScriptFunction::getFunction(ScriptEngine *engine, const QString &
 {
     if (JS_IsUndefined(scriptFunction)) {
         ScopedJsValue val(engine->context(),
-                          engine->evaluate(JsValueOwner::Caller, sourceCode(),
-                                           location().filePath(), location().line()));
+                          engine->evaluateCached(JsValueOwner::Caller, sourceCode(),
+                                                 location().filePath(), location().line()));
         if (Q_UNLIKELY(!JS_IsFunction(engine->context(), val)))
             throw ErrorInfo(errorMessage, location());
         scriptFunction = val.release();
@@ -67,6 +67,8 @@
 
 #include <quickjs.h>
 
+#include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -666,6 +668,7 @@ public:
     std::vector<ProbeConstPtr> probes;
     std::vector<ArtifactPropertiesPtr> artifactProperties;
     QStringList missingSourceFiles;
+    Set<QString> buildSystemFiles; // The project and module files the product was set up from.
     std::unique_ptr<ProductBuildData> buildData;
 
     ExportedModule exportedModule;
@@ -718,8 +721,8 @@ private:
                                      missingSourceFiles, location, productProperties,
                                      moduleProperties, rules, dependencies, dependencyParameters,
                                      fileTaggers, modules, moduleParameters, scanners, groups,
-                                     artifactProperties, probes, exportedModule, buildData,
-                                     jobLimits);
+                                     artifactProperties, probes, exportedModule, jobLimits,
+                                     buildSystemFiles);
     }
 
     QHash<QString, QString> m_executablePathCache;
@@ -809,6 +812,27 @@ public:
     QString buildGraphFilePath() const;
     void store(Logger logger);
 
+    // Runs storeFunction, which is supposed to call store(), in a separate thread. The project
+    // must not be modified until waitForPendingStore() has returned, which also rethrows
+    // the errors that storeFunction did not handle. The build graph lock is held until then,
+    // even if the job that started the store has finished already.
+    void storeInBackground(std::function<void()> storeFunction);
+    void waitForPendingStore();
+
+    // For keeping the project in memory while other processes work with the build directory.
+    // A setup job that gets this project as the existing one re-acquires the lock, and it
+    // only uses the project if the build graph on disk was not changed in the meantime.
+    void releaseBuildGraphLock();
+    bool buildGraphChangedSinceLockRelease() const;
+
+    // The build data of products is stored in separate sections of the build graph file.
+    // Only the project data is read here; the pool is kept for restoring the build data
+    // of products via the functions below, and for storing only what has changed.
+    void loadBuildGraph(std::unique_ptr<PersistentPool> pool);
+    void restoreBuildData(const std::vector<ResolvedProductPtr> &products);
+    void restoreAllBuildData();
+    void restoreBuildDataReferringTo(const void *object); // Call before removing the object.
+
 private:
     TopLevelProject();
 
@@ -837,9 +861,31 @@ private:
     void store(PersistentPool &pool) override;
 
     void cleanupModuleProviderOutput();
+    void setupProductSections(const PersistentPool &pool);
+    void loadProductBuildData(int section);
+    void storeBuildGraph(PersistentPool &pool, const std::vector<bool> &sectionsToCopy);
+    void storeProductBuildData(PersistentPool &pool, const ResolvedProductPtr &product);
+    std::vector<FileTime> buildGraphFileTimes() const;
+#ifndef NDEBUG
+    QByteArray buildDataSnapshot(int section) const;
+    void takeBuildDataSnapshots();
+    void checkBuildDataSnapshots() const;
+#endif
 
     QString m_id;
     QVariantMap m_buildConfiguration;
+
+    // Represents the build graph file as it was last loaded or stored.
+    std::unique_ptr<PersistentPool> m_buildGraphPool;
+    std::vector<ResolvedProductPtr> m_productsBySection;
+    QHash<const ResolvedProduct *, int> m_sectionsByProduct;
+#ifndef NDEBUG
+    std::vector<int> m_sectionsToSnapshot;
+    QHash<int, QByteArray> m_buildDataSnapshots;
+#endif
+
+    std::future<void> m_pendingStore;
+    std::vector<FileTime> m_buildGraphFileTimesAtLockRelease;
 };
 
 bool artifactPropertyListsAreEqual(const std::vector<ArtifactPropertiesPtr> &l1,
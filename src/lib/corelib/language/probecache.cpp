@@ -0,0 +1,244 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "probecache.h"
+
+#include <logging/categories.h>
+#include <tools/fileinfo.h>
+#include <tools/persistence.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qsavefile.h>
+
+namespace qbs {
+namespace Internal {
+
+static const char probeCacheMagic[] = "QBSPROBE1";
+
+static QVariant environmentValue(const QProcessEnvironment &environment, const QString &name)
+{
+    return environment.contains(name) ? QVariant(environment.value(name)) : QVariant();
+}
+
+void ProbeInputs::addEnvironmentVariableUsed(const QProcessEnvironment &processEnvironment,
+                                             const QString &name)
+{
+    environment.insert(name, environmentValue(processEnvironment, name));
+}
+
+void ProbeInputs::addFileUsed(const QString &filePath)
+{
+    if (!fileTimestamps.contains(filePath))
+        fileTimestamps.insert(filePath, QFileInfo(filePath).lastModified());
+}
+
+bool ProbeInputs::isUpToDate(const QProcessEnvironment &processEnvironment) const
+{
+    for (auto it = environment.cbegin(); it != environment.cend(); ++it) {
+        if (environmentValue(processEnvironment, it.key()) != it.value()) {
+            qCDebug(lcModuleLoader) << "environment variable" << it.key() << "changed";
+            return false;
+        }
+    }
+    for (auto it = fileExistsResults.cbegin(); it != fileExistsResults.cend(); ++it) {
+        if (FileInfo::exists(it.key()) != it.value()) {
+            qCDebug(lcModuleLoader) << "existence of file" << it.key() << "changed";
+            return false;
+        }
+    }
+    for (auto it = directoryEntriesResults.cbegin(); it != directoryEntriesResults.cend(); ++it) {
+        if (QDir(it.key().first).entryList(static_cast<QDir::Filters>(it.key().second), QDir::Name)
+                != it.value()) {
+            qCDebug(lcModuleLoader) << "entries of directory" << it.key().first << "changed";
+            return false;
+        }
+    }
+    for (auto it = fileTimestamps.cbegin(); it != fileTimestamps.cend(); ++it) {
+        if (QFileInfo(it.key()).lastModified() != it.value()) {
+            qCDebug(lcModuleLoader) << "file" << it.key() << "changed";
+            return false;
+        }
+    }
+    return true;
+}
+
+void ProbeInputs::store(QDataStream &stream) const
+{
+    stream << environment << fileExistsResults << quint32(directoryEntriesResults.size());
+    for (auto it = directoryEntriesResults.cbegin(); it != directoryEntriesResults.cend(); ++it)
+        stream << it.key().first << it.key().second << it.value();
+    stream << fileTimestamps;
+}
+
+void ProbeInputs::load(QDataStream &stream)
+{
+    quint32 directoryCount = 0;
+    stream >> environment >> fileExistsResults >> directoryCount;
+    for (quint32 i = 0; i < directoryCount && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        quint32 filters = 0;
+        QStringList entries;
+        stream >> path >> filters >> entries;
+        directoryEntriesResults.insert({path, filters}, entries);
+    }
+    stream >> fileTimestamps;
+}
+
+ProbeCache &ProbeCache::instance()
+{
+    static ProbeCache cache(qEnvironmentVariable("QBS_PROBE_CACHE_DIR"));
+    return cache;
+}
+
+ProbeCache::ProbeCache(const QString &directory, qint64 maxSize)
+    : m_directory(directory, maxSize)
+{
+}
+
+QByteArray ProbeCache::key(const QString &filePath, const QString &configureScript,
+                           const QVariantMap &initialProperties)
+{
+    // The file is part of the key, because it determines what the script's imports refer to.
+    QByteArray serializedProperties;
+    {
+        QDataStream stream(&serializedProperties, QIODevice::WriteOnly);
+        stream.setVersion(dataStreamVersion);
+        stream << initialProperties;
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray(QBS_VERSION));
+    hash.addData(filePath.toUtf8());
+    hash.addData(configureScript.toUtf8());
+    hash.addData(serializedProperties);
+    return hash.result();
+}
+
+std::optional<ProbeCache::Entry> ProbeCache::lookup(
+        const QByteArray &key, const QProcessEnvironment &processEnvironment)
+{
+    if (!isEnabled())
+        return {};
+    std::optional<Entry> entry;
+    {
+        const auto entries = m_entries.lock_shared();
+        const auto it = entries.get().constFind(key);
+        if (it != entries.get().constEnd())
+            entry = it.value();
+    }
+    if (!entry) {
+        entry = load(key);
+        if (!entry)
+            return {};
+        m_entries.lock().get().insert(key, *entry);
+    }
+    if (!entry->inputs.isUpToDate(processEnvironment))
+        return {};
+    return entry;
+}
+
+void ProbeCache::insert(const QByteArray &key, const Entry &entry)
+{
+    if (!isEnabled())
+        return;
+    m_entries.lock().get().insert(key, entry);
+    store(key, entry);
+}
+
+// Two levels, so that a single directory does not get too many entries.
+QString ProbeCache::entryFilePath(const QByteArray &key) const
+{
+    const QString hex = QString::fromLatin1(key.toHex());
+    return m_directory.path() + QLatin1Char('/') + hex.left(2) + QLatin1Char('/') + hex.mid(2);
+}
+
+std::optional<ProbeCache::Entry> ProbeCache::load(const QByteArray &key) const
+{
+    QFile file(entryFilePath(key));
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    QDataStream stream(&file);
+    stream.setVersion(dataStreamVersion);
+    QByteArray magic;
+    QByteArray qbsVersion;
+    QByteArray storedKey;
+    stream >> magic >> qbsVersion >> storedKey;
+    if (stream.status() != QDataStream::Ok || magic != probeCacheMagic
+            || qbsVersion != QBS_VERSION || storedKey != key) {
+        qCDebug(lcModuleLoader) << "ignoring invalid probe cache entry" << file.fileName();
+        return {};
+    }
+    Entry entry;
+    stream >> entry.values >> entry.importedFiles;
+    entry.inputs.load(stream);
+    if (stream.status() != QDataStream::Ok) {
+        qCDebug(lcModuleLoader) << "ignoring invalid probe cache entry" << file.fileName();
+        return {};
+    }
+    m_directory.entryUsed(file);
+    return entry;
+}
+
+// Failing to store an entry only costs running the probe again, so errors are not reported.
+void ProbeCache::store(const QByteArray &key, const Entry &entry)
+{
+    const QString filePath = entryFilePath(key);
+    if (!QDir().mkpath(QFileInfo(filePath).absolutePath()))
+        return;
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    QDataStream stream(&file);
+    stream.setVersion(dataStreamVersion);
+    stream << QByteArray(probeCacheMagic) << QByteArray(QBS_VERSION) << key << entry.values
+           << entry.importedFiles;
+    entry.inputs.store(stream);
+    const qint64 size = file.pos();
+    if (!file.commit()) {
+        qCDebug(lcModuleLoader) << "failed to store probe cache entry" << filePath;
+        return;
+    }
+    m_directory.entryStored(size);
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PROBECACHE_H
+#define QBS_PROBECACHE_H
+
+#include "qbs_export.h"
+
+#include <tools/cachedirectory.h>
+#include <tools/mutexdata.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvariant.h>
+
+#include <optional>
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+class QDataStream;
+QT_END_NAMESPACE
+
+namespace qbs {
+namespace Internal {
+
+/*!
+ * What a Probe's configure script has read from outside the project. Filled by the script
+ * engine while the script runs. Programs started by the script are represented by their
+ * executable and the PATH variable; other inherited environment variables are not considered.
+ */
+class QBS_AUTOTEST_EXPORT ProbeInputs
+{
+public:
+    void addEnvironmentVariableUsed(const QProcessEnvironment &processEnvironment,
+                                    const QString &name);
+    void addFileUsed(const QString &filePath);
+    bool isUpToDate(const QProcessEnvironment &processEnvironment) const;
+
+    void store(QDataStream &stream) const;
+    void load(QDataStream &stream);
+
+    QHash<QString, QVariant> environment; // An invalid value means the variable was not set.
+    QHash<QString, bool> fileExistsResults;
+    QHash<std::pair<QString, quint32>, QStringList> directoryEntriesResults;
+    QHash<QString, QDateTime> fileTimestamps; // Files read or executed, and imported JS files.
+};
+
+/*!
+ * Holds the results of Probes across projects and build directories, in memory for the process
+ * and on disk. An entry is keyed by the configure script and its file as well as the
+ * Probe's input properties, and it is only used as long as its ProbeInputs are unchanged.
+ * Since a configure script can depend on things that cannot be tracked, the cache is opt-in:
+ * It is active only if the environment variable QBS_PROBE_CACHE_DIR is set to a directory.
+ * The directory is bounded in size like the other caches, see CacheDirectory.
+ */
+class QBS_AUTOTEST_EXPORT ProbeCache
+{
+public:
+    struct Entry
+    {
+        QVariantMap values;
+        QStringList importedFiles; // Also part of the inputs' files.
+        ProbeInputs inputs;
+    };
+    static ProbeCache &instance();
+
+    static const qint64 defaultMaxSize = 32 * 1024 * 1024;
+
+    // An empty directory means disabled.
+    explicit ProbeCache(const QString &directory, qint64 maxSize = defaultMaxSize);
+
+    bool isEnabled() const { return m_directory.isEnabled(); }
+    static QByteArray key(const QString &filePath, const QString &configureScript,
+                          const QVariantMap &initialProperties);
+    std::optional<Entry> lookup(const QByteArray &key,
+                                const QProcessEnvironment &processEnvironment);
+    void insert(const QByteArray &key, const Entry &entry);
+
+    QString directory() const { return m_directory.path(); }
+    void prune() { m_directory.prune(); }
+
+private:
+    QString entryFilePath(const QByteArray &key) const;
+    std::optional<Entry> load(const QByteArray &key) const;
+    void store(const QByteArray &key, const Entry &entry);
+
+    CacheDirectory m_directory;
+    MutexData<QHash<QByteArray, Entry>> m_entries;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PROBECACHE_H
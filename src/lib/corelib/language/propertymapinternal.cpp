@@ -43,6 +43,11 @@
 #include <tools/scripttools.h>
 #include <tools/stringconstants.h>
 
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+
+#include <algorithm>
+
 namespace qbs {
 namespace Internal {
 
@@ -81,6 +86,95 @@ QVariant PropertyMapInternal::property(const QStringList &name) const
 void PropertyMapInternal::setValue(const QVariantMap &map)
 {
     m_value = map;
+    m_digest.clear();
+}
+
+void PropertyMapInternal::setValue(const QVariantMap &value, const QByteArray &digest)
+{
+    m_value = value;
+    m_digest = digest;
+}
+
+/*!
+ * The digest of a property map is calculated from the digests of its top-level values, that is,
+ * of the values of the individual modules. This way, the resolver can share equal module
+ * values between different property maps without serializing them twice.
+ * Maps that are created at resolve time get their digest calculated when they are interned,
+ * which happens before they can be accessed from other threads. For all other maps,
+ * the digest is calculated on first access.
+ */
+const QByteArray &PropertyMapInternal::digest() const
+{
+    if (m_digest.isEmpty()) {
+        std::vector<std::pair<QString, QByteArray>> valueDigests;
+        valueDigests.reserve(m_value.size());
+        for (auto it = m_value.cbegin(); it != m_value.cend(); ++it)
+            valueDigests.emplace_back(it.key(), valueDigest(it.value()));
+        m_digest = mapDigest(valueDigests);
+    }
+    return m_digest;
+}
+
+static void serializeCanonically(QDataStream &stream, const QVariant &value)
+{
+    switch (value.userType()) {
+    case QMetaType::QVariantMap: {
+        const QVariantMap map = value.toMap();
+        stream << quint8(QMetaType::QVariantMap) << quint32(map.size());
+        for (auto it = map.cbegin(); it != map.cend(); ++it) {
+            stream << it.key();
+            serializeCanonically(stream, it.value());
+        }
+        break;
+    }
+    case QMetaType::QVariantHash: {
+        // The iteration order of a hash is unspecified.
+        const QVariantHash hash = value.toHash();
+        QStringList keys = hash.keys();
+        std::sort(keys.begin(), keys.end());
+        stream << quint8(QMetaType::QVariantHash) << quint32(keys.size());
+        for (const QString &key : std::as_const(keys)) {
+            stream << key;
+            serializeCanonically(stream, hash.value(key));
+        }
+        break;
+    }
+    case QMetaType::QVariantList: {
+        const QVariantList list = value.toList();
+        stream << quint8(QMetaType::QVariantList) << quint32(list.size());
+        for (const QVariant &v : list)
+            serializeCanonically(stream, v);
+        break;
+    }
+    default:
+        stream << quint8(0) << value;
+        break;
+    }
+}
+
+QByteArray PropertyMapInternal::valueDigest(const QVariant &value, qsizetype *serializedSize)
+{
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setVersion(dataStreamVersion);
+        serializeCanonically(stream, value);
+    }
+    if (serializedSize)
+        *serializedSize = data.size();
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+QByteArray PropertyMapInternal::mapDigest(
+        const std::vector<std::pair<QString, QByteArray>> &valueDigests)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const auto &valueDigest : valueDigests) {
+        hash.addData(valueDigest.first.toUtf8());
+        hash.addData(QByteArrayView("", 1));
+        hash.addData(valueDigest.second);
+    }
+    return hash.result();
 }
 
 QVariant moduleProperty(const QVariantMap &properties, const QString &moduleName,
@@ -45,6 +45,9 @@
 #include <tools/qbs_export.h>
 #include <QtCore/qvariant.h>
 
+#include <utility>
+#include <vector>
+
 namespace qbs {
 namespace Internal {
 
@@ -55,15 +58,22 @@ public:
     PropertyMapPtr clone() const { return PropertyMapPtr(new PropertyMapInternal(*this)); }
 
     const QVariantMap &value() const { return m_value; }
+    const QByteArray &digest() const;
     QVariant moduleProperty(const QString &moduleName,
                             const QString &key, bool *isPresent = nullptr) const;
     QVariant qbsPropertyValue(const QString &key) const; // Convenience function.
     QVariant property(const QStringList &name) const;
     void setValue(const QVariantMap &value);
 
+    // For values whose digest was already calculated via valueDigest() and mapDigest().
+    void setValue(const QVariantMap &value, const QByteArray &digest);
+
+    static QByteArray valueDigest(const QVariant &value, qsizetype *serializedSize = nullptr);
+    static QByteArray mapDigest(const std::vector<std::pair<QString, QByteArray>> &valueDigests);
+
     template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
     {
-        pool.serializationOp<opType>(m_value);
+        pool.serializationOp<opType>(m_value, m_digest);
     }
 
 private:
@@ -73,11 +83,15 @@ private:
     PropertyMapInternal(const PropertyMapInternal &other);
 
     QVariantMap m_value;
+    mutable QByteArray m_digest; // Calculated on demand.
 };
 
 inline bool operator==(const PropertyMapInternal &lhs, const PropertyMapInternal &rhs)
 {
-    return qVariantMapsEqual(lhs.m_value, rhs.m_value);
+    // Equal digests imply equal values. Differing digests do not imply differing values,
+    // as e.g. the integer 1 and the floating-point value 1.0 compare equal.
+    return &lhs == &rhs || lhs.digest() == rhs.digest()
+            || qVariantMapsEqual(lhs.m_value, rhs.m_value);
 }
 
 QVariant QBS_AUTOTEST_EXPORT moduleProperty(const QVariantMap &properties,
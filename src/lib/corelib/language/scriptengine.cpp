@@ -41,9 +41,11 @@
 
 #include "deprecationinfo.h"
 #include "filecontextbase.h"
+#include "jsbytecodecache.h"
 #include "jsimports.h"
 #include "language.h"
 #include "preparescriptobserver.h"
+#include "probecache.h"
 #include "scriptimporter.h"
 
 #include <buildgraph/artifact.h>
@@ -68,9 +70,11 @@
 #include <QtCore/qtextstream.h>
 #include <QtCore/qtimer.h>
 
+#include <algorithm>
 #include <cstring>
 #include <functional>
 #include <set>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -101,7 +105,7 @@ QHashValueType qHash(const ScriptEngine::PropertyCacheKey &k, QHashValueType see
 
 ScriptEngine::ScriptEngine(Logger &logger, EvalContext evalContext, PrivateTag)
     : m_scriptImporter(new ScriptImporter(this)),
-      m_logger(logger), m_evalContext(evalContext),
+      m_logger(&logger), m_evalContext(evalContext),
       m_observer(new PrepareScriptObserver(this, UnobserveMode::Disabled))
 {
     setMaxStackSize();
@@ -121,6 +125,60 @@ std::unique_ptr<ScriptEngine> ScriptEngine::create(Logger &logger, EvalContext e
     return std::make_unique<ScriptEngine>(logger, evalContext, PrivateTag());
 }
 
+using RecycledEngines = MutexData<std::vector<std::unique_ptr<ScriptEngine>>, std::mutex>;
+static RecycledEngines &recycledEngines()
+{
+    static RecycledEngines engines;
+    return engines;
+}
+
+std::unique_ptr<ScriptEngine> ScriptEngine::acquire(Logger &logger, EvalContext evalContext)
+{
+    std::unique_ptr<ScriptEngine> engine;
+    {
+        const auto enginesGuard = recycledEngines().lock();
+        auto &engines = enginesGuard.get();
+        if (!engines.empty()) {
+            engine = std::move(engines.back());
+            engines.pop_back();
+        }
+    }
+    if (!engine)
+        return create(logger, evalContext);
+    engine->m_logger = &logger;
+    engine->m_evalContext = evalContext;
+    engine->m_canceling = false;
+    return engine;
+}
+
+void ScriptEngine::recycle(std::unique_ptr<ScriptEngine> engine)
+{
+    QBS_ASSERT(!engine->m_evaluator, return);
+
+    // Everything that refers to the previous resolve or to its project must go.
+    engine->reset();
+    engine->releaseExternallyCachedValues();
+    engine->clearTrackedScriptAccesses();
+    engine->unobserveProperties();
+    engine->m_propertyCache.clear();
+    engine->m_canonicalFilePathResult.clear();
+    engine->m_fileExistsResult.clear();
+    engine->m_directoryEntriesResult.clear();
+    engine->m_fileLastModifiedResult.clear();
+    engine->m_jsError.clear();
+    engine->m_usesIo = false;
+    engine->m_probeInputs = nullptr;
+    engine->m_setupParams.reset();
+    engine->m_environment = QProcessEnvironment();
+    engine->m_logger = nullptr;
+
+    // One engine per hardware thread is what a resolve can make use of at most.
+    const auto enginesGuard = recycledEngines().lock();
+    auto &engines = enginesGuard.get();
+    if (engines.size() < std::max(1U, std::thread::hardware_concurrency()))
+        engines.push_back(std::move(engine));
+}
+
 ScriptEngine *ScriptEngine::engineForRuntime(const JSRuntime *runtime)
 {
     return static_cast<ScriptEngine *>(JS_GetRuntimeOpaque(const_cast<JSRuntime *>(runtime)));
@@ -180,18 +238,15 @@ ScriptEngine::~ScriptEngine()
 {
     reset();
     delete m_scriptImporter;
-    if (m_elapsedTimeImporting != -1) {
-        m_logger.qbsLog(LoggerInfo, true) << Tr::tr("Setting up imports took %1.")
-                                             .arg(elapsedTimeString(m_elapsedTimeImporting));
+    if (m_elapsedTimeImporting != -1 && m_logger) {
+        m_logger->qbsLog(LoggerInfo, true) << Tr::tr("Setting up imports took %1.")
+                                              .arg(elapsedTimeString(m_elapsedTimeImporting));
     }
     for (const auto &ext : std::as_const(m_internalExtensions))
         JS_FreeValue(m_context, ext);
     for (const JSValue &s : std::as_const(m_stringCache))
         JS_FreeValue(m_context, s);
-    for (JSValue * const externalRef : std::as_const(m_externallyCachedValues)) {
-        JS_FreeValue(m_context, *externalRef);
-        *externalRef = JS_UNDEFINED;
-    }
+    releaseExternallyCachedValues();
     setPropertyOnGlobalObject(QLatin1String("console"), JS_UNDEFINED);
     JS_FreeContext(m_context);
     JS_FreeRuntime(m_jsRuntime);
@@ -240,7 +295,17 @@ void ScriptEngine::reset()
         artifactsScriptValues.clear();
     }
     m_observer->clearTrackedObjectIds();
-    m_logger.clearWarnings();
+    if (m_logger)
+        m_logger->clearWarnings();
+}
+
+void ScriptEngine::releaseExternallyCachedValues()
+{
+    for (JSValue * const externalRef : std::as_const(m_externallyCachedValues)) {
+        JS_FreeValue(m_context, *externalRef);
+        *externalRef = JS_UNDEFINED;
+    }
+    m_externallyCachedValues.clear();
 }
 
 void ScriptEngine::import(const FileContextBaseConstPtr &fileCtx, JSValue &targetObject,
@@ -346,7 +411,7 @@ void ScriptEngine::checkContext(const QString &operation,
         }
         const JSValue exVal = JS_NewError(m_context);
         const JsException ex(m_context, exVal, JS_GetBacktrace(m_context), {});
-        m_logger.printWarning(ErrorInfo(warning, ex.stackTrace()));
+        m_logger->printWarning(ErrorInfo(warning, ex.stackTrace()));
         return;
     }
 }
@@ -364,7 +429,7 @@ void ScriptEngine::handleDeprecation(
             break;
         [[fallthrough]];
     case DeprecationWarningMode::On:
-        m_logger.printWarning(ErrorInfo(message, loc));
+        m_logger->printWarning(ErrorInfo(message, loc));
         break;
     case DeprecationWarningMode::Off:
         break;
@@ -648,8 +713,8 @@ JSValue ScriptEngine::js_require(JSContext *ctx, JSValueConst this_val,
         if (engine->m_extensionSearchPathsStack.empty())
             return engine->throwError(Tr::tr("require: internal error. No search paths."));
 
-        if (engine->m_logger.debugEnabled()) {
-            engine->m_logger.qbsDebug()
+        if (engine->m_logger->debugEnabled()) {
+            engine->m_logger->qbsDebug()
                     << "[require] loading extension " << moduleName;
         }
 
@@ -668,8 +733,8 @@ JSValue ScriptEngine::js_require(JSContext *ctx, JSValueConst this_val,
             try {
                 while (dit.hasNext()) {
                     const QString filePath = dit.next();
-                    if (engine->m_logger.debugEnabled()) {
-                        engine->m_logger.qbsDebug()
+                    if (engine->m_logger->debugEnabled()) {
+                        engine->m_logger->qbsDebug()
                                 << "[require] importing file " << filePath;
                     }
                     ScopedJsValue obj(engine->context(), engine->newObject());
@@ -777,6 +842,24 @@ JSValue ScriptEngine::getArtifactProperty(JSValue obj,
     return a ? propGetter(a) : JS_EXCEPTION;
 }
 
+void ScriptEngine::addEnvironmentVariableUsed(const QString &name)
+{
+    addEnvironmentVariableUsed(m_environment, name);
+}
+
+void ScriptEngine::addEnvironmentVariableUsed(const QProcessEnvironment &environment,
+                                              const QString &name)
+{
+    if (m_probeInputs)
+        m_probeInputs->addEnvironmentVariableUsed(environment, name);
+}
+
+void ScriptEngine::addFileUsed(const QString &filePath)
+{
+    if (m_probeInputs)
+        m_probeInputs->addFileUsed(filePath);
+}
+
 void ScriptEngine::addCanonicalFilePathResult(const QString &filePath,
                                               const QString &resultFilePath)
 {
@@ -786,6 +869,8 @@ void ScriptEngine::addCanonicalFilePathResult(const QString &filePath,
 
 void ScriptEngine::addFileExistsResult(const QString &filePath, bool exists)
 {
+    if (m_probeInputs)
+        m_probeInputs->fileExistsResults.insert(filePath, exists);
     if (gatherFileResults())
         m_fileExistsResult.insert(filePath, exists);
 }
@@ -793,6 +878,11 @@ void ScriptEngine::addFileExistsResult(const QString &filePath, bool exists)
 void ScriptEngine::addDirectoryEntriesResult(const QString &path, QDir::Filters filters,
                                              const QStringList &entries)
 {
+    if (m_probeInputs) {
+        m_probeInputs->directoryEntriesResults.insert(
+                    std::pair<QString, quint32>(path, static_cast<quint32>(filters)),
+                    entries);
+    }
     if (gatherFileResults()) {
         m_directoryEntriesResult.insert(
                     std::pair<QString, quint32>(path, static_cast<quint32>(filters)),
@@ -802,6 +892,7 @@ void ScriptEngine::addDirectoryEntriesResult(const QString &path, QDir::Filters
 
 void ScriptEngine::addFileLastModifiedResult(const QString &filePath, const FileTime &fileTime)
 {
+    addFileUsed(filePath);
     if (gatherFileResults())
         m_fileLastModifiedResult.insert(filePath, fileTime);
 }
@@ -857,6 +948,59 @@ JSValue ScriptEngine::evaluate(
     return v;
 }
 
+JSValue ScriptEngine::evaluateCached(
+    JsValueOwner resultOwner,
+    const QString &code,
+    const QString &filePath,
+    int line,
+    qbs::Internal::span<const JSValue> scopeChain)
+{
+    m_scopeChains.emplace_back(scopeChain);
+    const QByteArray &codeStr = code.toUtf8();
+    const QByteArray &filePathStr = filePath.toUtf8();
+
+    m_evalPositions.emplace(filePath, line);
+    JSValue v = compile(codeStr, filePathStr, line);
+    if (!JS_IsException(v))
+        v = evalFunctionWithThis(m_context, v, globalObject());
+    m_evalPositions.pop();
+    m_scopeChains.pop_back();
+    if (resultOwner == JsValueOwner::ScriptEngine && JS_VALUE_HAS_REF_COUNT(v))
+        ++m_evalResults[v];
+    return v;
+}
+
+// Returns the bytecode function for the code, or an exception if it does not compile.
+JSValue ScriptEngine::compile(const QByteArray &code, const QByteArray &filePath, int line)
+{
+    JsBytecodeCache &cache = JsBytecodeCache::instance();
+    const QByteArray key = JsBytecodeCache::key(code, filePath, line);
+    const QByteArray bytecode = cache.lookup(key);
+    if (!bytecode.isEmpty()) {
+        const JSValue function = JS_ReadObject(
+            m_context, reinterpret_cast<const uint8_t *>(bytecode.constData()), bytecode.size(),
+            JS_READ_OBJ_BYTECODE);
+        if (!JS_IsException(function))
+            return function;
+        JS_FreeValue(m_context, JS_GetException(m_context)); // Unusable entry, just recompile.
+    }
+
+    JSEvalOptions evalOptions{1, JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY,
+                              filePath.constData(), line};
+    const JSValue function = JS_EvalThis2(
+        m_context, globalObject(), code.constData(), code.length(), &evalOptions);
+    if (JS_IsException(function))
+        return function;
+    size_t size = 0;
+    if (uint8_t * const data = JS_WriteObject(m_context, &size, function, JS_WRITE_OBJ_BYTECODE)) {
+        cache.insert(key, QByteArray(reinterpret_cast<const char *>(data), int(size)));
+        js_free(m_context, data);
+    } else {
+        JS_FreeValue(m_context, JS_GetException(m_context));
+    }
+    return function;
+}
+
 void ScriptEngine::handleJsProperties(JSValue obj, const PropertyHandler &handler)
 {
     qbs::Internal::handleJsProperties(m_context, obj, handler);
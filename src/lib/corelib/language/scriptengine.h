@@ -79,6 +79,7 @@ class Artifact;
 class Evaluator;
 class JsImport;
 class PrepareScriptObserver;
+class ProbeInputs;
 class RuleNode;
 class ScriptImporter;
 class ScriptPropertyObserver;
@@ -108,13 +109,18 @@ public:
     ~ScriptEngine();
 
     static std::unique_ptr<ScriptEngine> create(Logger &logger, EvalContext evalContext);
+
+    // For processes that resolve repeatedly: Engines handed back via recycle() are cleaned up
+    // and kept, and acquire() returns one of them instead of setting up a new engine.
+    static std::unique_ptr<ScriptEngine> acquire(Logger &logger, EvalContext evalContext);
+    static void recycle(std::unique_ptr<ScriptEngine> engine);
     static ScriptEngine *engineForRuntime(const JSRuntime *runtime);
     static ScriptEngine *engineForContext(const JSContext *ctx);
     static LookupResult doExtraScopeLookup(JSContext *ctx, JSAtom prop);
 
     void reset();
 
-    Logger &logger() const { return m_logger; }
+    Logger &logger() const { return *m_logger; }
     void import(const FileContextBaseConstPtr &fileCtx, JSValue &targetObject,
                 ObserveMode observeMode);
     void clearImportsCache();
@@ -190,6 +196,12 @@ public:
     void addDirectoryEntriesResult(const QString &path, QDir::Filters filters,
                                    const QStringList &entries);
     void addFileLastModifiedResult(const QString &filePath, const FileTime &fileTime);
+
+    // While set, accesses to the environment and to files are recorded for the probe cache.
+    void setProbeInputs(ProbeInputs *inputs) { m_probeInputs = inputs; }
+    void addEnvironmentVariableUsed(const QString &name);
+    void addEnvironmentVariableUsed(const QProcessEnvironment &environment, const QString &name);
+    void addFileUsed(const QString &filePath);
     QHash<QString, QString> canonicalFilePathResults() const { return m_canonicalFilePathResult; }
     QHash<QString, bool> fileExistsResults() const { return m_fileExistsResult; }
     QHash<std::pair<QString, quint32>, QStringList> directoryEntriesResults() const
@@ -211,6 +223,16 @@ public:
         const QString &filePath = QString(),
         int line = 1,
         qbs::Internal::span<const JSValue> scopeChain = {});
+
+    // Like evaluate(), but takes the compiled code from the JsBytecodeCache, if possible.
+    // Meant for code that gets evaluated in many engines or runs, such as imported
+    // JavaScript files and rule scripts.
+    JSValue evaluateCached(
+        JsValueOwner resultOwner,
+        const QString &code,
+        const QString &filePath = QString(),
+        int line = 1,
+        qbs::Internal::span<const JSValue> scopeChain = {});
     void setLastLookupStatus(bool success) { m_lastLookupWasSuccess = success; }
     JSContext *context() const { return m_context; }
     JSValue globalObject() const { return m_globalObject; }
@@ -321,6 +343,7 @@ private:
     bool gatherFileResults() const;
 
     void setMaxStackSize();
+    void releaseExternallyCachedValues();
     void setPropertyOnGlobalObject(const QString &property, JSValue value);
     void installQbsBuiltins();
     void extendJavaScriptBuiltins();
@@ -330,6 +353,7 @@ private:
     void import(const JsImport &jsImport, JSValue &targetObject);
     void observeImport(JSValue &jsImport);
     void importFile(const QString &filePath, JSValue targetObject);
+    JSValue compile(const QByteArray &code, const QByteArray &filePath, int line);
     static JSValue js_require(JSContext *ctx, JSValueConst this_val,
                               int argc, JSValueConst *argv, int magic, JSValue *func_data);
     JSValue mergeExtensionObjects(const JSValueList &lst);
@@ -373,8 +397,9 @@ private:
     QHash<PropertyCacheKey, QVariant> m_propertyCache;
     PropertySet m_propertiesRequestedInScript;
     QHash<QString, PropertySet> m_propertiesRequestedFromArtifact;
-    Logger &m_logger;
+    Logger *m_logger;
     QProcessEnvironment m_environment;
+    ProbeInputs *m_probeInputs = nullptr;
     QHash<QString, QString> m_canonicalFilePathResult;
     QHash<QString, bool> m_fileExistsResult;
     QHash<std::pair<QString, quint32>, QStringList> m_directoryEntriesResult;
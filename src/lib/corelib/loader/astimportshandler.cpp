@@ -46,7 +46,6 @@
 #include <language/filecontext.h>
 #include <logging/logger.h>
 #include <logging/translator.h>
-#include <parser/qmljsast_p.h>
 #include <tools/error.h>
 #include <tools/fileinfo.h>
 #include <tools/qttools.h>
@@ -67,7 +66,7 @@ ASTImportsHandler::ASTImportsHandler(ItemReaderVisitorState &visitorState, Logge
 {
 }
 
-void ASTImportsHandler::handleImports(const QbsQmlJS::AST::UiImportList *uiImportList)
+void ASTImportsHandler::handleImports(const std::vector<ParsedQbsFile::Import> &imports)
 {
     const auto searchPaths = m_file->searchPaths();
     for (const QString &searchPath : searchPaths)
@@ -77,58 +76,55 @@ void ASTImportsHandler::handleImports(const QbsQmlJS::AST::UiImportList *uiImpor
     collectPrototypes(m_directory, QString());
 
     bool baseImported = false;
-    for (const auto *it = uiImportList; it; it = it->next)
-        handleImport(it->import, &baseImported);
+    for (const ParsedQbsFile::Import &import : imports)
+        handleImport(import, &baseImported);
     if (!baseImported) {
-        const QStringView qbsref{StringConstants::qbsModule()};
-        QbsQmlJS::AST::UiQualifiedId qbsURI(qbsref);
-        qbsURI.finish();
-        QbsQmlJS::AST::UiImport imp(&qbsURI);
-        handleImport(&imp, &baseImported);
+        ParsedQbsFile::Import imp;
+        imp.uri = QStringList(StringConstants::qbsModule());
+        handleImport(imp, &baseImported);
     }
 
     for (auto it = m_jsImports.constBegin(); it != m_jsImports.constEnd(); ++it)
         m_file->addJsImport(it.value());
 }
 
-void ASTImportsHandler::handleImport(const QbsQmlJS::AST::UiImport *import, bool *baseImported)
+void ASTImportsHandler::handleImport(const ParsedQbsFile::Import &import, bool *baseImported)
 {
-    QStringList importUri;
+    const QStringList &importUri = import.uri;
     bool isBase = false;
-    if (import->importUri) {
-        importUri = toStringList(import->importUri);
+    if (!importUri.empty()) {
         isBase = (importUri.size() == 1 && importUri.front() == StringConstants::qbsModule())
                 || (importUri.size() == 2 && importUri.front() == StringConstants::qbsModule()
                     && importUri.last() == StringConstants::baseVar());
         if (isBase) {
             *baseImported = true;
-            checkImportVersion(import->versionToken);
-        } else if (import->versionToken.length) {
+            checkImportVersion(import.versionToken);
+        } else if (import.versionToken.length) {
             m_logger.printWarning(ErrorInfo(Tr::tr("Superfluous version specification."),
-                    toCodeLocation(m_file->filePath(), import->versionToken)));
+                    toCodeLocation(m_file->filePath(), import.versionToken)));
         }
     }
 
     QString as;
     if (isBase) {
-        if (Q_UNLIKELY(!import->importId.isNull())) {
+        if (Q_UNLIKELY(!import.importId.isNull())) {
             throw ErrorInfo(Tr::tr("Import of qbs.base must have no 'as <Name>'"),
-                        toCodeLocation(m_file->filePath(), import->importIdToken));
+                        toCodeLocation(m_file->filePath(), import.importIdToken));
         }
     } else {
         if (importUri.size() == 2 && importUri.front() == StringConstants::qbsModule()) {
             const QString extensionName = importUri.last();
             if (JsExtensions::hasExtension(extensionName)) {
-                if (Q_UNLIKELY(!import->importId.isNull())) {
+                if (Q_UNLIKELY(!import.importId.isNull())) {
                     throw ErrorInfo(Tr::tr("Import of built-in extension '%1' "
                                            "must not have 'as' specifier.").arg(extensionName),
-                                    toCodeLocation(m_file->filePath(), import->asToken));
+                                    toCodeLocation(m_file->filePath(), import.asToken));
                 }
                 if (Q_UNLIKELY(m_file->jsExtensions().contains(extensionName))) {
                     m_logger.printWarning(ErrorInfo(Tr::tr("Built-in extension '%1' already "
                                                            "imported.").arg(extensionName),
                                                     toCodeLocation(m_file->filePath(),
-                                                                   import->importToken)));
+                                                                   import.importToken)));
                 } else {
                     m_file->addJsExtension(extensionName);
                 }
@@ -136,55 +132,55 @@ void ASTImportsHandler::handleImport(const QbsQmlJS::AST::UiImport *import, bool
             }
         }
 
-        if (import->importId.isNull()) {
-            if (!import->fileName.isNull()) {
+        if (import.importId.isNull()) {
+            if (!import.fileName.isNull()) {
                 throw ErrorInfo(Tr::tr("File imports require 'as <Name>'"),
-                                toCodeLocation(m_file->filePath(), import->importToken));
+                                toCodeLocation(m_file->filePath(), import.importToken));
             }
             if (importUri.empty()) {
                 throw ErrorInfo(Tr::tr("Invalid import URI."),
-                                toCodeLocation(m_file->filePath(), import->importToken));
+                                toCodeLocation(m_file->filePath(), import.importToken));
             }
             as = importUri.last();
         } else {
-            as = import->importId.toString();
+            as = import.importId;
         }
 
         if (Q_UNLIKELY(JsExtensions::hasExtension(as)))
             throw ErrorInfo(Tr::tr("Cannot reuse the name of built-in extension '%1'.").arg(as),
-                            toCodeLocation(m_file->filePath(), import->importIdToken));
+                            toCodeLocation(m_file->filePath(), import.importIdToken));
         if (Q_UNLIKELY(!m_importAsNames.insert(as).second)) {
             throw ErrorInfo(Tr::tr("Cannot import into the same name more than once."),
-                        toCodeLocation(m_file->filePath(), import->importIdToken));
+                        toCodeLocation(m_file->filePath(), import.importIdToken));
         }
     }
 
-    if (!import->fileName.isNull()) {
-        QString filePath = FileInfo::resolvePath(m_directory, import->fileName.toString());
+    if (!import.fileName.isNull()) {
+        QString filePath = FileInfo::resolvePath(m_directory, import.fileName);
 
         QFileInfo fi(filePath);
         if (Q_UNLIKELY(!fi.exists()))
             throw ErrorInfo(Tr::tr("Cannot find imported file %0.")
                             .arg(QDir::toNativeSeparators(filePath)),
-                            CodeLocation(m_file->filePath(), import->fileNameToken.startLine,
-                                         import->fileNameToken.startColumn));
+                            CodeLocation(m_file->filePath(), import.fileNameToken.startLine,
+                                         import.fileNameToken.startColumn));
         filePath = fi.canonicalFilePath();
         if (fi.isDir()) {
             collectPrototypesAndJsCollections(filePath, as,
-                    toCodeLocation(m_file->filePath(), import->fileNameToken));
+                    toCodeLocation(m_file->filePath(), import.fileNameToken));
         } else {
             if (filePath.endsWith(QStringLiteral(".js"), Qt::CaseInsensitive)) {
                 JsImport &jsImport = m_jsImports[as];
                 jsImport.scopeName = as;
                 jsImport.filePaths.push_back(filePath);
                 jsImport.location
-                        = toCodeLocation(m_file->filePath(), import->firstSourceLocation());
+                        = toCodeLocation(m_file->filePath(), import.importToken);
             } else if (filePath.endsWith(QStringLiteral(".qbs"), Qt::CaseInsensitive)) {
                 m_typeNameToFile.insert(QStringList(as), filePath);
             } else {
                 throw ErrorInfo(Tr::tr("Can only import .qbs and .js files"),
-                            CodeLocation(m_file->filePath(), import->fileNameToken.startLine,
-                                         import->fileNameToken.startColumn));
+                            CodeLocation(m_file->filePath(), import.fileNameToken.startLine,
+                                         import.fileNameToken.startColumn));
             }
         }
     } else if (!importUri.empty()) {
@@ -202,7 +198,7 @@ void ASTImportsHandler::handleImport(const QbsQmlJS::AST::UiImport *import, bool
                     // ### versioning, qbsdir file, etc.
                     const QString &resultPath = fi.absoluteFilePath();
                     collectPrototypesAndJsCollections(resultPath, as,
-                            toCodeLocation(m_file->filePath(), import->fileNameToken));
+                            toCodeLocation(m_file->filePath(), import.fileNameToken));
                     found = true;
                     break;
                 }
@@ -211,7 +207,7 @@ void ASTImportsHandler::handleImport(const QbsQmlJS::AST::UiImport *import, bool
         if (Q_UNLIKELY(!found)) {
             throw ErrorInfo(Tr::tr("import %1 not found")
                             .arg(importUri.join(QLatin1Char('.'))),
-                            toCodeLocation(m_file->filePath(), import->fileNameToken));
+                            toCodeLocation(m_file->filePath(), import.fileNameToken));
         }
     }
 }
@@ -249,7 +245,8 @@ bool ASTImportsHandler::addPrototype(const QString &fileName, const QString &fil
     return true;
 }
 
-void ASTImportsHandler::checkImportVersion(const QbsQmlJS::AST::SourceLocation &versionToken) const
+void ASTImportsHandler::checkImportVersion(
+        const ParsedQbsFile::SourceLocation &versionToken) const
 {
     if (!versionToken.length)
         return;
@@ -45,13 +45,10 @@
 
 #include <api/languageinfo.h>
 #include <jsextensions/jsextensions.h>
-#include <language/asttools.h>
 #include <language/builtindeclarations.h>
 #include <language/filecontext.h>
-#include <language/identifiersearch.h>
 #include <language/item.h>
 #include <language/value.h>
-#include <parser/qmljsast_p.h>
 #include <tools/codelocation.h>
 #include <tools/error.h>
 #include <tools/qbsassert.h>
@@ -59,9 +56,9 @@
 #include <tools/stringconstants.h>
 #include <logging/translator.h>
 
-#include <algorithm>
+#include <QtCore/qstringview.h>
 
-using namespace QbsQmlJS;
+#include <algorithm>
 
 namespace qbs {
 namespace Internal {
@@ -77,12 +74,29 @@ ItemReaderASTVisitor::ItemReaderASTVisitor(ItemReaderVisitorState &visitorState,
 
 ItemReaderASTVisitor::~ItemReaderASTVisitor() = default;
 
-bool ItemReaderASTVisitor::visit(AST::UiProgram *uiProgram)
+void ItemReaderASTVisitor::visit(const ParsedQbsFile &parsedFile)
 {
     ASTImportsHandler importsHandler(m_visitorState, m_logger, m_file);
-    importsHandler.handleImports(uiProgram->imports);
+    importsHandler.handleImports(parsedFile.imports);
     m_typeNameToFile = importsHandler.typeNameFileMap();
-    return true;
+    visitMembers(parsedFile.members);
+}
+
+void ItemReaderASTVisitor::visitMembers(const std::vector<ParsedQbsFile::Member> &members)
+{
+    for (const ParsedQbsFile::Member &member : members) {
+        switch (member.type) {
+        case ParsedQbsFile::Member::Type::ObjectDefinition:
+            visitObjectDefinition(member);
+            break;
+        case ParsedQbsFile::Member::Type::PublicMember:
+            visitPublicMember(member);
+            break;
+        case ParsedQbsFile::Member::Type::ScriptBinding:
+            visitScriptBinding(member);
+            break;
+        }
+    }
 }
 
 static ItemValuePtr findItemProperty(const Item *container, const Item *item)
@@ -98,22 +112,23 @@ static ItemValuePtr findItemProperty(const Item *container, const Item *item)
     return itemValue;
 }
 
-bool ItemReaderASTVisitor::visit(AST::UiObjectDefinition *ast)
+void ItemReaderASTVisitor::visitObjectDefinition(const ParsedQbsFile::Member &member)
 {
-    const QString typeName = ast->qualifiedTypeNameId->name.toString();
-    const CodeLocation itemLocation = toCodeLocation(ast->qualifiedTypeNameId->identifierToken);
+    const QStringList &fullTypeName = member.name;
+    QBS_CHECK(!fullTypeName.empty());
+    const QString &typeName = fullTypeName.front();
+    const CodeLocation itemLocation = toCodeLocation(member.nameToken);
     const Item *baseItem = nullptr;
     Item *mostDerivingItem = nullptr;
 
     Item *item = Item::create(m_itemPool, ItemType::Unknown);
     item->setFile(m_file);
     item->setLocation(itemLocation);
-    const AST::SourceLocation &endLoc = ast->lastSourceLocation();
+    const ParsedQbsFile::SourceLocation &endLoc = member.endToken;
     item->setEndPosition(CodePosition(endLoc.startLine, endLoc.startColumn));
 
     // Inheritance resolving, part 1: Find out our actual type name (needed for setting
     // up children and alternatives).
-    const QStringList fullTypeName = toStringList(ast->qualifiedTypeNameId);
     const QString baseTypeFileName = m_typeNameToFile.value(fullTypeName);
     ItemType itemType;
     if (!baseTypeFileName.isEmpty()) {
@@ -122,12 +137,13 @@ bool ItemReaderASTVisitor::visit(AST::UiObjectDefinition *ast)
             m_visitorState.setMostDerivingItem(item);
         mostDerivingItem = m_visitorState.mostDerivingItem();
         baseItem = m_visitorState.readFile(baseTypeFileName, m_file->searchPaths(), m_itemPool);
+        m_visitorState.addBaseFile(m_file->filePath(), baseTypeFileName);
         if (isMostDerivingItem)
             m_visitorState.setMostDerivingItem(nullptr);
         QBS_CHECK(baseItem->type() <= ItemType::LastActualItem);
         itemType = baseItem->type();
-        const AST::SourceLocation startLoc = ast->qualifiedTypeNameId->firstSourceLocation();
-        const AST::SourceLocation endLoc = ast->qualifiedTypeNameId->lastSourceLocation();
+        const ParsedQbsFile::SourceLocation &startLoc = member.nameToken;
+        const ParsedQbsFile::SourceLocation &endLoc = member.lastNameToken;
         const CodeRange sourceRange(
             CodePosition(startLoc.startLine, startLoc.startColumn),
             CodePosition(endLoc.startLine, endLoc.startColumn + endLoc.length));
@@ -155,14 +171,14 @@ bool ItemReaderASTVisitor::visit(AST::UiObjectDefinition *ast)
         }
     }
 
-    if (ast->initializer) {
+    if (!member.members.empty()) {
         Item *mdi = m_visitorState.mostDerivingItem();
         m_visitorState.setMostDerivingItem(nullptr);
         qSwap(m_item, item);
         const ItemType oldInstanceItemType = m_instanceItemType;
         if (itemType == ItemType::Parameters || itemType == ItemType::Depends)
             m_instanceItemType = ItemType::ModuleParameters;
-        ast->initializer->accept(this);
+        visitMembers(member.members);
         m_instanceItemType = oldInstanceItemType;
         qSwap(m_item, item);
         m_visitorState.setMostDerivingItem(mdi);
@@ -190,12 +206,10 @@ bool ItemReaderASTVisitor::visit(AST::UiObjectDefinition *ast)
         // bindings.
         item->setupForBuiltinType(m_visitorState.deprecationWarningMode(), m_logger);
     }
-
-    return false;
 }
 
 void ItemReaderASTVisitor::checkDuplicateBinding(Item *item, const QStringList &bindingName,
-                                                 const AST::SourceLocation &sourceLocation)
+        const ParsedQbsFile::SourceLocation &sourceLocation)
 {
     if (Q_UNLIKELY(item->hasOwnProperty(bindingName.last()))) {
         QString msg = Tr::tr("Duplicate binding for '%1'");
@@ -204,60 +218,55 @@ void ItemReaderASTVisitor::checkDuplicateBinding(Item *item, const QStringList &
     }
 }
 
-bool ItemReaderASTVisitor::visit(AST::UiPublicMember *ast)
+void ItemReaderASTVisitor::visitPublicMember(const ParsedQbsFile::Member &member)
 {
     PropertyDeclaration p;
-    if (Q_UNLIKELY(ast->name.isEmpty()))
+    if (Q_UNLIKELY(member.name.empty() || member.name.front().isEmpty()))
         throw ErrorInfo(Tr::tr("public member without name"));
-    if (Q_UNLIKELY(ast->memberType.isEmpty()))
+    if (Q_UNLIKELY(member.memberType.isEmpty()))
         throw ErrorInfo(Tr::tr("public member without type"));
-    if (Q_UNLIKELY(ast->type == AST::UiPublicMember::Signal))
+    if (Q_UNLIKELY(member.isSignal))
         throw ErrorInfo(Tr::tr("public member with signal type not supported"));
-    p.setName(ast->name.toString());
-    p.setLocation(toCodeLocation(ast->identifierToken));
-    p.setType(PropertyDeclaration::propertyTypeFromString(ast->memberType.toString()));
+    p.setName(member.name.front());
+    p.setLocation(toCodeLocation(member.nameToken));
+    p.setType(PropertyDeclaration::propertyTypeFromString(member.memberType));
     if (p.type() == PropertyDeclaration::UnknownType) {
         throw ErrorInfo(Tr::tr("Unknown type '%1' in property declaration.")
-                        .arg(ast->memberType.toString()), toCodeLocation(ast->typeToken));
+                        .arg(member.memberType), toCodeLocation(member.typeToken));
     }
-    if (Q_UNLIKELY(!ast->typeModifier.isEmpty())) {
+    if (Q_UNLIKELY(!member.typeModifier.isEmpty())) {
         throw ErrorInfo(Tr::tr("public member with type modifier '%1' not supported").arg(
-                        ast->typeModifier.toString()));
+                        member.typeModifier));
     }
-    if (ast->isReadonlyMember)
+    if (member.isReadOnly)
         p.setFlags(PropertyDeclaration::ReadOnlyFlag);
 
     m_item->m_propertyDeclarations.insert(p.name(), p);
 
     const JSSourceValuePtr value = JSSourceValue::create();
     value->setFile(m_file);
-    if (ast->statement) {
-        handleBindingRhs(ast->statement, value);
+    if (member.statement) {
+        handleBindingRhs(*member.statement, value);
         const QStringList bindingName(p.name());
-        checkDuplicateBinding(m_item, bindingName, ast->colonToken);
+        checkDuplicateBinding(m_item, bindingName, member.colonToken);
     }
 
     m_item->setProperty(p.name(), value);
-    return false;
 }
 
-bool ItemReaderASTVisitor::visit(AST::UiScriptBinding *ast)
+void ItemReaderASTVisitor::visitScriptBinding(const ParsedQbsFile::Member &member)
 {
-    QBS_CHECK(ast->qualifiedId);
-    QBS_CHECK(!ast->qualifiedId->name.isEmpty());
-
-    const QStringList bindingName = toStringList(ast->qualifiedId);
+    const QStringList &bindingName = member.name;
+    QBS_CHECK(!bindingName.empty());
+    QBS_CHECK(!bindingName.front().isEmpty());
+    QBS_CHECK(member.statement);
 
     if (bindingName.length() == 1 && bindingName.front() == QStringLiteral("id")) {
-        const auto * const expStmt = AST::cast<AST::ExpressionStatement *>(ast->statement);
-        if (Q_UNLIKELY(!expStmt))
-            throw ErrorInfo(Tr::tr("id: must be followed by identifier"));
-        const auto * const idExp = AST::cast<AST::IdentifierExpression *>(expStmt->expression);
-        if (Q_UNLIKELY(!idExp || idExp->name.isEmpty()))
+        if (Q_UNLIKELY(member.statement->identifier.isEmpty()))
             throw ErrorInfo(Tr::tr("id: must be followed by identifier"));
         if (m_item->type() == ItemType::Module)
             throw ErrorInfo(Tr::tr("Module items cannot have an id property."));
-        m_item->m_id = idExp->name.toString();
+        m_item->m_id = member.statement->identifier;
         m_file->ensureIdScope(m_itemPool);
         ItemValueConstPtr existingId = m_file->idScope()->itemProperty(m_item->id(), *m_itemPool);
         if (existingId) {
@@ -267,48 +276,40 @@ bool ItemReaderASTVisitor::visit(AST::UiScriptBinding *ast)
             throw e;
         }
         m_file->idScope()->setProperty(m_item->id(), ItemValue::create(m_item));
-        return false;
+        return;
     }
 
     const JSSourceValuePtr value = JSSourceValue::create();
-    handleBindingRhs(ast->statement, value);
+    handleBindingRhs(*member.statement, value);
 
     Item * const targetItem = targetItemForBinding(bindingName, value);
-    checkDuplicateBinding(targetItem, bindingName, ast->qualifiedId->identifierToken);
+    checkDuplicateBinding(targetItem, bindingName, member.nameToken);
     targetItem->setProperty(bindingName.last(), value);
-    return false;
 }
 
-bool ItemReaderASTVisitor::handleBindingRhs(AST::Statement *statement,
+void ItemReaderASTVisitor::handleBindingRhs(const ParsedQbsFile::Statement &statement,
                                             const JSSourceValuePtr &value)
 {
-    QBS_CHECK(statement);
     QBS_CHECK(value);
 
-    if (AST::cast<AST::Block *>(statement))
+    if (statement.isBlock)
         value->setHasFunctionForm();
 
     value->setFile(m_file);
-    value->setSourceCode(textViewOf(m_file->content(), statement));
-    value->setLocation(statement->firstSourceLocation().startLine,
-                       statement->firstSourceLocation().startColumn);
-
-    bool usesBase, usesOuter, usesOriginal;
-    IdentifierSearch idsearch;
-    idsearch.add(StringConstants::baseVar(), &usesBase);
-    idsearch.add(StringConstants::outerVar(), &usesOuter);
-    idsearch.add(StringConstants::originalVar(), &usesOriginal);
-    idsearch.start(statement);
-    if (usesBase)
+    value->setSourceCode(QStringView(m_file->content()).mid(statement.range.offset,
+                                                            statement.range.length));
+    value->setLocation(statement.range.startLine, statement.range.startColumn);
+
+    if (statement.usesBase)
         value->setSourceUsesBase();
-    if (usesOuter)
+    if (statement.usesOuter)
         value->setSourceUsesOuter();
-    if (usesOriginal)
+    if (statement.usesOriginal)
         value->setSourceUsesOriginal();
-    return false;
 }
 
-CodeLocation ItemReaderASTVisitor::toCodeLocation(const AST::SourceLocation &location) const
+CodeLocation ItemReaderASTVisitor::toCodeLocation(
+        const ParsedQbsFile::SourceLocation &location) const
 {
     return CodeLocation(m_file->filePath(), location.startLine, location.startColumn);
 }
@@ -40,11 +40,12 @@
 #ifndef QBS_ITEMREADERASTVISITOR_H
 #define QBS_ITEMREADERASTVISITOR_H
 
+#include "parsedqbsfile.h"
+
 #include <language/forward_decls.h>
 #include <language/itemtype.h>
 
 #include <logging/logger.h>
-#include <parser/qmljsastvisitor_p.h>
 
 #include <QtCore/qhash.h>
 #include <QtCore/qstringlist.h>
@@ -60,27 +61,29 @@ class ItemPool;
 class ItemReaderVisitorState;
 class ModuleItemLocker;
 
-class ItemReaderASTVisitor : public QbsQmlJS::AST::Visitor
+class ItemReaderASTVisitor
 {
 public:
     ItemReaderASTVisitor(ItemReaderVisitorState &visitorState, FileContextPtr file,
                          ItemPool *itemPool, Logger &logger);
     ~ItemReaderASTVisitor();
 
+    void visit(const ParsedQbsFile &parsedFile);
     void checkItemTypes() { doCheckItemTypes(rootItem()); }
 
     Item *rootItem() const { return m_item; }
 
 private:
-    bool visit(QbsQmlJS::AST::UiProgram *uiProgram) override;
-    bool visit(QbsQmlJS::AST::UiObjectDefinition *ast) override;
-    bool visit(QbsQmlJS::AST::UiPublicMember *ast) override;
-    bool visit(QbsQmlJS::AST::UiScriptBinding *ast) override;
+    void visitMembers(const std::vector<ParsedQbsFile::Member> &members);
+    void visitObjectDefinition(const ParsedQbsFile::Member &member);
+    void visitPublicMember(const ParsedQbsFile::Member &member);
+    void visitScriptBinding(const ParsedQbsFile::Member &member);
 
-    bool handleBindingRhs(QbsQmlJS::AST::Statement *statement, const JSSourceValuePtr &value);
-    CodeLocation toCodeLocation(const QbsQmlJS::AST::SourceLocation &location) const;
+    void handleBindingRhs(const ParsedQbsFile::Statement &statement,
+                          const JSSourceValuePtr &value);
+    CodeLocation toCodeLocation(const ParsedQbsFile::SourceLocation &location) const;
     void checkDuplicateBinding(Item *item, const QStringList &bindingName,
-            const QbsQmlJS::AST::SourceLocation &sourceLocation);
+            const ParsedQbsFile::SourceLocation &sourceLocation);
     Item *targetItemForBinding(const QStringList &binding, const JSSourceValueConstPtr &value);
     static void inheritItem(Item *dst, const Item *src);
     void checkDeprecationStatus(ItemType itemType, const QString &itemName,
@@ -41,12 +41,8 @@
 #include "itemreaderastvisitor.h"
 #include "loaderutils.h"
 
-#include <language/asttools.h>
 #include <language/filecontext.h>
 #include <logging/translator.h>
-#include <parser/qmljsengine_p.h>
-#include <parser/qmljslexer_p.h>
-#include <parser/qmljsparser_p.h>
 #include <tools/error.h>
 #include <tools/setupprojectparameters.h>
 #include <tools/stringconstants.h>
@@ -76,23 +72,9 @@ Item *ItemReaderVisitorState::readFile(const QString &filePath, const QStringLis
         QTextStream stream(&file);
         setupDefaultCodec(stream);
         const QString &code = stream.readAll();
-        QbsQmlJS::Lexer lexer(&entry.engine);
-        lexer.setCode(code, 1);
-        QbsQmlJS::Parser parser(&entry.engine);
-
         file.close();
-        if (!parser.parse()) {
-            const QList<QbsQmlJS::DiagnosticMessage> &parserMessages = parser.diagnosticMessages();
-            if (Q_UNLIKELY(!parserMessages.empty())) {
-                ErrorInfo err;
-                for (const QbsQmlJS::DiagnosticMessage &msg : parserMessages)
-                    err.append(msg.message, toCodeLocation(filePath, msg.loc));
-                throw err;
-            }
-        }
-
+        entry.parsedFile = ParsedQbsFileCache::instance().retrieveOrParse(filePath, code);
         entry.code = code;
-        entry.ast = parser.ast();
     };
 
     ItemReaderCache::AstCacheEntry &cacheEntry = m_cache.retrieveOrSetupCacheEntry(
@@ -117,7 +99,7 @@ Item *ItemReaderVisitorState::readFile(const QString &filePath, const QStringLis
         private:
             ItemReaderCache::AstCacheEntry &m_cacheEntry;
         } processingFlagManager(cacheEntry, filePath);
-        cacheEntry.ast->accept(&astVisitor);
+        astVisitor.visit(*cacheEntry.parsedFile);
     }
     astVisitor.checkItemTypes();
     return astVisitor.rootItem();
@@ -157,5 +139,10 @@ void ItemReaderVisitorState::addCodeLink(
     m_loaderState.topLevelProject().addCodeLink(sourceFile, sourceRange, targetLoc);
 }
 
+void ItemReaderVisitorState::addBaseFile(const QString &filePath, const QString &baseFilePath)
+{
+    m_cache.addBaseFile(filePath, baseFilePath);
+}
+
 } // namespace Internal
 } // namespace qbs
@@ -70,6 +70,7 @@ public:
 
     void addCodeLink(
         const QString &sourceFile, const CodeRange &sourceRange, const CodeLocation &targetLoc);
+    void addBaseFile(const QString &filePath, const QString &baseFilePath);
 
 private:
     LoaderState &m_loaderState;
@@ -45,6 +45,7 @@
 #include <language/filecontext.h>
 #include <language/itempool.h>
 #include <language/language.h>
+#include <language/propertymapinternal.h>
 #include <language/resolvedfilecontext.h>
 #include <language/scriptengine.h>
 #include <language/value.h>
@@ -499,6 +500,60 @@ void TopLevelProjectContext::checkForLocalProfileAsTopLevelProfile(const QString
     }
 }
 
+/*!
+ * Many products, groups and artifacts end up with the same module property values,
+ * which would otherwise be stored (and later persisted and compared) once per owner.
+ * Equal values of individual modules are shared as well, as they frequently appear
+ * in otherwise differing maps.
+ */
+PropertyMapPtr TopLevelProjectContext::internedPropertyMap(const QVariantMap &value)
+{
+    // Digest calculation is the expensive part, so do it without holding the lock.
+    struct ModuleValue {
+        QString name;
+        QByteArray digest;
+        qsizetype size = 0;
+    };
+    std::vector<ModuleValue> moduleValues;
+    moduleValues.reserve(value.size());
+    std::vector<std::pair<QString, QByteArray>> valueDigests;
+    valueDigests.reserve(value.size());
+    qint64 totalSize = 0;
+    for (auto it = value.cbegin(); it != value.cend(); ++it) {
+        ModuleValue moduleValue{it.key(), {}, 0};
+        moduleValue.digest = PropertyMapInternal::valueDigest(it.value(), &moduleValue.size);
+        totalSize += moduleValue.size;
+        valueDigests.emplace_back(it.key(), moduleValue.digest);
+        moduleValues.push_back(std::move(moduleValue));
+    }
+    const QByteArray digest = PropertyMapInternal::mapDigest(valueDigests);
+
+    const auto cacheGuard = m_propertyMaps.lock();
+    PropertyMapCache &cache = cacheGuard.get();
+    ++cache.stats.mapsRequested;
+    PropertyMapPtr &map = cache.maps[digest];
+    if (map) {
+        cache.stats.bytesSaved += totalSize;
+        return map;
+    }
+    ++cache.stats.uniqueMaps;
+    QVariantMap sharedValue = value;
+    for (const ModuleValue &moduleValue : moduleValues) {
+        ++cache.stats.moduleValuesRequested;
+        const auto it = cache.moduleValues.constFind(moduleValue.digest);
+        if (it == cache.moduleValues.constEnd()) {
+            ++cache.stats.uniqueModuleValues;
+            cache.moduleValues.insert(moduleValue.digest, value.value(moduleValue.name));
+        } else {
+            sharedValue.insert(moduleValue.name, it.value());
+            cache.stats.bytesSaved += moduleValue.size;
+        }
+    }
+    map = PropertyMapInternal::create();
+    map->setValue(sharedValue, digest);
+    return map;
+}
+
 std::lock_guard<std::mutex> TopLevelProjectContext::probesCacheLock()
 {
     return std::lock_guard<std::mutex>(m_probesMutex);
@@ -526,6 +581,17 @@ void TopLevelProjectContext::setOldProductProbes(
     m_probesInfo.oldProductProbes = oldProbes;
 }
 
+void TopLevelProjectContext::setReusableProducts(
+        const QHash<QString, ResolvedProductPtr> &products)
+{
+    m_reusableProducts = products;
+}
+
+ResolvedProductPtr TopLevelProjectContext::reusableProduct(const QString &uniqueName) const
+{
+    return m_reusableProducts.value(uniqueName);
+}
+
 ProbeConstPtr TopLevelProjectContext::findOldProductProbe(const QString &productName,
                                                           const ProbeFilter &filter) const
 {
@@ -861,7 +927,7 @@ ItemReaderCache::AstCacheEntry &ItemReaderCache::retrieveOrSetupCacheEntry(
     const QString cleanFilePath = QDir::cleanPath(filePath);
     const auto astCacheGuard = m_astCache.lock();
     AstCacheEntry &entry = astCacheGuard.get()[cleanFilePath];
-    if (!entry.ast) {
+    if (!entry.parsedFile) {
         setup(entry);
         m_filesRead << QDir::cleanPath(cleanFilePath);
     }
@@ -878,6 +944,28 @@ const QStringList &ItemReaderCache::retrieveOrSetDirectoryEntries(
     return *entries;
 }
 
+void ItemReaderCache::addBaseFile(const QString &filePath, const QString &baseFilePath)
+{
+    m_baseFiles.lock().get()[QDir::cleanPath(filePath)] << QDir::cleanPath(baseFilePath);
+}
+
+Set<QString> ItemReaderCache::withBaseFiles(const Set<QString> &filePaths) const
+{
+    Set<QString> result;
+    std::vector<QString> toCheck(filePaths.cbegin(), filePaths.cend());
+    const auto baseFilesGuard = m_baseFiles.lock();
+    while (!toCheck.empty()) {
+        const QString filePath = QDir::cleanPath(toCheck.back());
+        toCheck.pop_back();
+        if (!result.insert(filePath).second)
+            continue;
+        const auto it = baseFilesGuard.get().find(filePath);
+        if (it != baseFilesGuard.get().cend())
+            toCheck.insert(toCheck.end(), it->second.cbegin(), it->second.cend());
+    }
+    return result;
+}
+
 bool ItemReaderCache::AstCacheEntry::addProcessingThread()
 {
     return m_processingThreads.lock().get().insert(std::this_thread::get_id()).second;
@@ -39,13 +39,14 @@
 
 #pragma once
 
+#include "parsedqbsfile.h"
+
 #include <language/filetags.h>
 #include <language/forward_decls.h>
 #include <language/item.h>
 #include <language/moduleproviderinfo.h>
 #include <language/propertydeclaration.h>
 #include <language/qualifiedid.h>
-#include <parser/qmljsengine_p.h>
 #include <tools/codelocation.h>
 #include <tools/filetime.h>
 #include <tools/mutexdata.h>
@@ -120,8 +121,7 @@ public:
     {
     public:
         QString code;
-        QbsQmlJS::Engine engine;
-        QbsQmlJS::AST::UiProgram *ast = nullptr;
+        std::shared_ptr<const ParsedQbsFile> parsedFile;
 
         bool addProcessingThread();
         void removeProcessingThread();
@@ -136,8 +136,13 @@ public:
     const QStringList &retrieveOrSetDirectoryEntries(
         const QString &dir, const std::function<QStringList()> &findOnDisk);
 
+    // For finding out which files an item depends on via inheritance.
+    void addBaseFile(const QString &filePath, const QString &baseFilePath);
+    Set<QString> withBaseFiles(const Set<QString> &filePaths) const;
+
 private:
     Set<QString> m_filesRead;
+    MutexData<std::unordered_map<QString, Set<QString>>, std::mutex> m_baseFiles;
     MutexData<std::unordered_map<QString, std::optional<QStringList>>, std::mutex> m_directoryEntries; // TODO: Merge with module dir entries cache?
     MutexData<std::unordered_map<QString, AstCacheEntry>, std::mutex> m_astCache;
 };
@@ -179,6 +184,8 @@ public:
     QVariantMap defaultParameters; // In Export item.
     QStringList searchPaths;
     ResolvedProductPtr product;
+    bool productReused = false; // Taken over from the previous resolve, see reusableProduct().
+    Set<QString> buildSystemFiles; // Without the ones the files inherit from.
     TimingData timingData;
     std::unique_ptr<DependenciesContext> dependenciesContext;
 
@@ -306,6 +313,8 @@ public:
     std::lock_guard<std::mutex> probesCacheLock();
     void setOldProjectProbes(const std::vector<ProbeConstPtr> &oldProbes);
     void setOldProductProbes(const QHash<QString, std::vector<ProbeConstPtr>> &oldProbes);
+    void setReusableProducts(const QHash<QString, ResolvedProductPtr> &products);
+    ResolvedProductPtr reusableProduct(const QString &uniqueName) const;
     void addNewlyResolvedProbe(const ProbeConstPtr &probe);
     void addProjectLevelProbe(const ProbeConstPtr &probe);
     const std::vector<ProbeConstPtr> projectLevelProbes() const;
@@ -315,11 +324,24 @@ public:
     void incrementProbesCount() { ++m_probesInfo.probesEncountered; }
     void incrementReusedCurrentProbesCount() { ++m_probesInfo.probesCachedCurrent; }
     void incrementReusedOldProbesCount() { ++m_probesInfo.probesCachedOld; }
+    void incrementReusedCachedProbesCount() { ++m_probesInfo.probesCachedShared; }
     void incrementRunProbesCount() { ++m_probesInfo.probesRun; }
     int probesEncounteredCount() const { return m_probesInfo.probesEncountered; }
     int probesRunCount() const { return m_probesInfo.probesRun; }
     int reusedOldProbesCount() const { return m_probesInfo.probesCachedOld; }
     int reusedCurrentProbesCount() const { return m_probesInfo.probesCachedCurrent; }
+    int reusedCachedProbesCount() const { return m_probesInfo.probesCachedShared; }
+
+    // Returns a shared instance for equal values. The returned map must not be modified.
+    PropertyMapPtr internedPropertyMap(const QVariantMap &value);
+    struct PropertyMapStats {
+        int mapsRequested = 0;
+        int uniqueMaps = 0;
+        int moduleValuesRequested = 0;
+        int uniqueModuleValues = 0;
+        qint64 bytesSaved = 0; // Approximated via the size of the serialized values.
+    };
+    PropertyMapStats propertyMapStats() const { return m_propertyMaps.lock().get().stats; }
 
     TimingData &timingData() { return m_timingData; }
     ItemReaderCache &itemReaderCache() { return m_itemReaderCache; }
@@ -390,11 +412,24 @@ private:
         quint64 probesRun = 0;
         quint64 probesCachedCurrent = 0;
         quint64 probesCachedOld = 0;
+        quint64 probesCachedShared = 0;
     } m_probesInfo;
     std::mutex m_probesMutex;
 
+    // Products from the previous resolve that may be taken over if nothing they depend on
+    // has changed. The keys are unique product names. Not modified during resolving.
+    QHash<QString, ResolvedProductPtr> m_reusableProducts;
+
     std::vector<std::unique_ptr<ItemPool>> m_itemPools;
 
+    // The keys are digests, see PropertyMapInternal::digest().
+    struct PropertyMapCache {
+        QHash<QByteArray, PropertyMapPtr> maps;
+        QHash<QByteArray, QVariant> moduleValues;
+        PropertyMapStats stats;
+    };
+    MutexData<PropertyMapCache, std::mutex> m_propertyMaps;
+
     FileTime m_lastResolveTime;
 
     std::atomic_bool m_canceled = false;
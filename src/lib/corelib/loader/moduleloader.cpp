@@ -163,6 +163,9 @@ Item *searchAndLoadModuleFile(
 
 Item *ModuleLoader::load()
 {
+    TraceSpan loadSpan([this] { return m_moduleName.toString(); }, "module");
+    if (loadSpan.isActive())
+        loadSpan.addArgument(QStringLiteral("product"), m_product.displayName());
     SearchPathsManager searchPathsManager(m_loaderState.itemReader());
 
     QStringList existingPaths = findModuleDirectories();
@@ -186,6 +189,7 @@ Item *ModuleLoader::load()
     for (int i = 0; i < existingPaths.size(); ++i) {
         const QStringList &moduleFileNames = getModuleFilePaths(existingPaths.at(i));
         for (const QString &filePath : moduleFileNames) {
+            m_product.buildSystemFiles << filePath;
             const auto [module, triedToLoad] = loadModuleFile(fullName, filePath);
             if (module)
                 candidates.emplace_back(module, 0, i);
@@ -0,0 +1,402 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "parsedqbsfile.h"
+
+#include <language/asttools.h>
+#include <language/identifiersearch.h>
+#include <logging/categories.h>
+#include <parser/qmljsast_p.h>
+#include <parser/qmljsastvisitor_p.h>
+#include <parser/qmljsengine_p.h>
+#include <parser/qmljslexer_p.h>
+#include <parser/qmljsparser_p.h>
+#include <tools/error.h>
+#include <tools/persistence.h>
+#include <tools/stringconstants.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qsavefile.h>
+
+#include <utility>
+
+using namespace QbsQmlJS;
+
+namespace qbs {
+namespace Internal {
+
+static const char parsedFileMagic[] = "QBSPARSEDFILE1";
+
+namespace {
+class AstConverter : public AST::Visitor
+{
+public:
+    explicit AstConverter(ParsedQbsFile &file) : m_file(file), m_members(&file.members) {}
+
+private:
+    bool visit(AST::UiProgram *uiProgram) override
+    {
+        for (const auto *it = uiProgram->imports; it; it = it->next)
+            m_file.imports.push_back(convertImport(*it->import));
+        return true;
+    }
+
+    bool visit(AST::UiObjectDefinition *ast) override
+    {
+        ParsedQbsFile::Member &member = addMember(ParsedQbsFile::Member::Type::ObjectDefinition);
+        member.name = toStringList(ast->qualifiedTypeNameId);
+        member.nameToken = ast->qualifiedTypeNameId->identifierToken;
+        member.lastNameToken = ast->qualifiedTypeNameId->lastSourceLocation();
+        member.endToken = ast->lastSourceLocation();
+        if (ast->initializer) {
+            std::vector<ParsedQbsFile::Member> * const outerMembers
+                    = std::exchange(m_members, &member.members);
+            ast->initializer->accept(this);
+            m_members = outerMembers;
+        }
+        return false;
+    }
+
+    bool visit(AST::UiPublicMember *ast) override
+    {
+        ParsedQbsFile::Member &member = addMember(ParsedQbsFile::Member::Type::PublicMember);
+        member.name = QStringList(ast->name.toString());
+        member.nameToken = ast->identifierToken;
+        member.memberType = ast->memberType.toString();
+        member.typeModifier = ast->typeModifier.toString();
+        member.typeToken = ast->typeToken;
+        member.colonToken = ast->colonToken;
+        member.isSignal = ast->type == AST::UiPublicMember::Signal;
+        member.isReadOnly = ast->isReadonlyMember;
+        if (ast->statement)
+            member.statement = convertStatement(ast->statement);
+        return false;
+    }
+
+    bool visit(AST::UiScriptBinding *ast) override
+    {
+        ParsedQbsFile::Member &member = addMember(ParsedQbsFile::Member::Type::ScriptBinding);
+        if (ast->qualifiedId) {
+            member.name = toStringList(ast->qualifiedId);
+            member.nameToken = ast->qualifiedId->identifierToken;
+        }
+        member.statement = convertStatement(ast->statement);
+        return false;
+    }
+
+    ParsedQbsFile::Member &addMember(ParsedQbsFile::Member::Type type)
+    {
+        m_members->emplace_back();
+        m_members->back().type = type;
+        return m_members->back();
+    }
+
+    static ParsedQbsFile::Import convertImport(const AST::UiImport &import)
+    {
+        ParsedQbsFile::Import result;
+        if (import.importUri)
+            result.uri = toStringList(import.importUri);
+        if (!import.fileName.isNull())
+            result.fileName = import.fileName.toString();
+        if (!import.importId.isNull())
+            result.importId = import.importId.toString();
+        result.importToken = import.importToken;
+        result.fileNameToken = import.fileNameToken;
+        result.versionToken = import.versionToken;
+        result.asToken = import.asToken;
+        result.importIdToken = import.importIdToken;
+        return result;
+    }
+
+    static ParsedQbsFile::Statement convertStatement(AST::Statement *statement)
+    {
+        ParsedQbsFile::Statement result;
+        const AST::SourceLocation first = statement->firstSourceLocation();
+        result.range = AST::SourceLocation(first.begin(),
+                                           statement->lastSourceLocation().end() - first.begin(),
+                                           first.startLine, first.startColumn);
+        result.isBlock = AST::cast<AST::Block *>(statement);
+        if (const auto expStmt = AST::cast<AST::ExpressionStatement *>(statement)) {
+            if (const auto idExp = AST::cast<AST::IdentifierExpression *>(expStmt->expression))
+                result.identifier = idExp->name.toString();
+        }
+
+        IdentifierSearch idsearch;
+        idsearch.add(StringConstants::baseVar(), &result.usesBase);
+        idsearch.add(StringConstants::outerVar(), &result.usesOuter);
+        idsearch.add(StringConstants::originalVar(), &result.usesOriginal);
+        idsearch.start(statement);
+        return result;
+    }
+
+    ParsedQbsFile &m_file;
+    std::vector<ParsedQbsFile::Member> *m_members;
+};
+} // namespace
+
+std::shared_ptr<const ParsedQbsFile> ParsedQbsFile::parse(const QString &filePath,
+                                                          const QString &code)
+{
+    QbsQmlJS::Engine engine;
+    QbsQmlJS::Lexer lexer(&engine);
+    lexer.setCode(code, 1);
+    QbsQmlJS::Parser parser(&engine);
+    if (!parser.parse()) {
+        const QList<QbsQmlJS::DiagnosticMessage> &parserMessages = parser.diagnosticMessages();
+        if (Q_UNLIKELY(!parserMessages.empty())) {
+            ErrorInfo err;
+            for (const QbsQmlJS::DiagnosticMessage &msg : parserMessages)
+                err.append(msg.message, toCodeLocation(filePath, msg.loc));
+            throw err;
+        }
+    }
+
+    const auto parsedFile = std::make_shared<ParsedQbsFile>();
+    AstConverter converter(*parsedFile);
+    parser.ast()->accept(&converter);
+    return parsedFile;
+}
+
+static void storeLocation(QDataStream &stream, const ParsedQbsFile::SourceLocation &location)
+{
+    stream << location.offset << location.length << location.startLine << location.startColumn;
+}
+
+static void loadLocation(QDataStream &stream, ParsedQbsFile::SourceLocation &location)
+{
+    stream >> location.offset >> location.length >> location.startLine >> location.startColumn;
+}
+
+static void storeStatement(QDataStream &stream, const ParsedQbsFile::Statement &statement)
+{
+    storeLocation(stream, statement.range);
+    stream << statement.identifier << statement.isBlock << statement.usesBase
+           << statement.usesOuter << statement.usesOriginal;
+}
+
+static void loadStatement(QDataStream &stream, ParsedQbsFile::Statement &statement)
+{
+    loadLocation(stream, statement.range);
+    stream >> statement.identifier >> statement.isBlock >> statement.usesBase
+           >> statement.usesOuter >> statement.usesOriginal;
+}
+
+static void storeMembers(QDataStream &stream, const std::vector<ParsedQbsFile::Member> &members)
+{
+    stream << quint32(members.size());
+    for (const ParsedQbsFile::Member &member : members) {
+        stream << quint8(member.type) << member.name;
+        storeLocation(stream, member.nameToken);
+        storeLocation(stream, member.lastNameToken);
+        storeLocation(stream, member.endToken);
+        storeMembers(stream, member.members);
+        stream << member.memberType << member.typeModifier;
+        storeLocation(stream, member.typeToken);
+        storeLocation(stream, member.colonToken);
+        stream << member.isSignal << member.isReadOnly << member.statement.has_value();
+        if (member.statement)
+            storeStatement(stream, *member.statement);
+    }
+}
+
+static void loadMembers(QDataStream &stream, std::vector<ParsedQbsFile::Member> &members)
+{
+    quint32 count = 0;
+    stream >> count;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        ParsedQbsFile::Member &member = members.emplace_back();
+        quint8 type = 0;
+        stream >> type >> member.name;
+        member.type = static_cast<ParsedQbsFile::Member::Type>(type);
+        loadLocation(stream, member.nameToken);
+        loadLocation(stream, member.lastNameToken);
+        loadLocation(stream, member.endToken);
+        loadMembers(stream, member.members);
+        stream >> member.memberType >> member.typeModifier;
+        loadLocation(stream, member.typeToken);
+        loadLocation(stream, member.colonToken);
+        bool hasStatement = false;
+        stream >> member.isSignal >> member.isReadOnly >> hasStatement;
+        if (hasStatement)
+            loadStatement(stream, member.statement.emplace());
+    }
+}
+
+void ParsedQbsFile::store(QDataStream &stream) const
+{
+    stream << quint32(imports.size());
+    for (const Import &import : imports) {
+        stream << import.uri << import.fileName << import.importId;
+        storeLocation(stream, import.importToken);
+        storeLocation(stream, import.fileNameToken);
+        storeLocation(stream, import.versionToken);
+        storeLocation(stream, import.asToken);
+        storeLocation(stream, import.importIdToken);
+    }
+    storeMembers(stream, members);
+}
+
+void ParsedQbsFile::load(QDataStream &stream)
+{
+    quint32 importCount = 0;
+    stream >> importCount;
+    for (quint32 i = 0; i < importCount && stream.status() == QDataStream::Ok; ++i) {
+        Import &import = imports.emplace_back();
+        stream >> import.uri >> import.fileName >> import.importId;
+        loadLocation(stream, import.importToken);
+        loadLocation(stream, import.fileNameToken);
+        loadLocation(stream, import.versionToken);
+        loadLocation(stream, import.asToken);
+        loadLocation(stream, import.importIdToken);
+    }
+    loadMembers(stream, members);
+}
+
+ParsedQbsFileCache &ParsedQbsFileCache::instance()
+{
+    static ParsedQbsFileCache cache(CacheDirectory::defaultPath("QBS_PARSED_FILE_CACHE_DIR",
+                                                                QStringLiteral("parsed-files")));
+    return cache;
+}
+
+ParsedQbsFileCache::ParsedQbsFileCache(const QString &directory, qint64 maxSize)
+    : m_directory(directory, maxSize)
+{
+}
+
+std::shared_ptr<const ParsedQbsFile> ParsedQbsFileCache::retrieveOrParse(const QString &filePath,
+                                                                         const QString &code)
+{
+    const QByteArray contentDigest = QCryptographicHash::hash(
+                QByteArray::fromRawData(reinterpret_cast<const char *>(code.constData()),
+                                        code.size() * int(sizeof(QChar))),
+                QCryptographicHash::Sha1);
+    {
+        const auto entries = m_entries.lock_shared();
+        const auto it = entries.get().find(filePath);
+        if (it != entries.get().cend() && it->second.contentDigest == contentDigest) {
+            ++m_memoryHitCount;
+            return it->second.parsedFile;
+        }
+    }
+
+    Entry entry{contentDigest, load(filePath, contentDigest)};
+    if (entry.parsedFile) {
+        ++m_diskHitCount;
+    } else {
+        entry.parsedFile = ParsedQbsFile::parse(filePath, code);
+        ++m_parseCount;
+        store(filePath, entry);
+    }
+    m_entries.lock().get()[filePath] = entry;
+    return entry.parsedFile;
+}
+
+ParsedQbsFileCache::Stats ParsedQbsFileCache::stats() const
+{
+    return {m_parseCount, m_memoryHitCount, m_diskHitCount};
+}
+
+// One entry per file, which gets replaced when the file changes.
+QString ParsedQbsFileCache::entryFilePath(const QString &filePath) const
+{
+    const QByteArray pathDigest
+            = QCryptographicHash::hash(filePath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_directory.path() + QLatin1Char('/') + QString::fromLatin1(pathDigest);
+}
+
+std::shared_ptr<const ParsedQbsFile> ParsedQbsFileCache::load(
+        const QString &filePath, const QByteArray &contentDigest) const
+{
+    if (!m_directory.isEnabled())
+        return {};
+    QFile file(entryFilePath(filePath));
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    QDataStream stream(&file);
+    stream.setVersion(dataStreamVersion);
+    QByteArray magic;
+    QByteArray qbsVersion;
+    QString storedFilePath;
+    QByteArray storedContentDigest;
+    stream >> magic >> qbsVersion >> storedFilePath >> storedContentDigest;
+    if (stream.status() != QDataStream::Ok || magic != parsedFileMagic
+            || qbsVersion != QBS_VERSION || storedFilePath != filePath) {
+        qCDebug(lcModuleLoader) << "ignoring invalid parsed file cache entry" << file.fileName();
+        return {};
+    }
+    if (storedContentDigest != contentDigest)
+        return {};
+    const auto parsedFile = std::make_shared<ParsedQbsFile>();
+    parsedFile->load(stream);
+    if (stream.status() != QDataStream::Ok) {
+        qCDebug(lcModuleLoader) << "ignoring invalid parsed file cache entry" << file.fileName();
+        return {};
+    }
+    m_directory.entryUsed(file);
+    return parsedFile;
+}
+
+// Failing to store an entry only costs parsing the file in the next run,
+// so errors are not reported.
+void ParsedQbsFileCache::store(const QString &filePath, const Entry &entry)
+{
+    if (!m_directory.isEnabled() || !QDir().mkpath(m_directory.path()))
+        return;
+    QSaveFile file(entryFilePath(filePath));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    QDataStream stream(&file);
+    stream.setVersion(dataStreamVersion);
+    stream << QByteArray(parsedFileMagic) << QByteArray(QBS_VERSION) << filePath
+           << entry.contentDigest;
+    entry.parsedFile->store(stream);
+    const qint64 size = file.pos();
+    if (!file.commit()) {
+        qCDebug(lcModuleLoader) << "failed to store parsed file cache entry" << file.fileName();
+        return;
+    }
+    m_directory.entryStored(size);
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,187 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PARSEDQBSFILE_H
+#define QBS_PARSEDQBSFILE_H
+
+#include <parser/qmljsastfwd_p.h>
+#include <tools/cachedirectory.h>
+#include <tools/mutexdata.h>
+#include <tools/qbs_export.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QDataStream;
+QT_END_NAMESPACE
+
+namespace qbs {
+namespace Internal {
+
+/*!
+ * The parts of a parsed .qbs file that the ItemReaderASTVisitor needs for creating items.
+ * Unlike the parser's AST, this does not refer to any memory other than the file content,
+ * so it can be kept across resolves and stored on disk. Source code is referred to by its
+ * position in the file content.
+ */
+class QBS_AUTOTEST_EXPORT ParsedQbsFile
+{
+public:
+    using SourceLocation = QbsQmlJS::AST::SourceLocation;
+
+    struct Import
+    {
+        QStringList uri; // Empty for file imports.
+        QString fileName; // Null for URI imports.
+        QString importId; // Null if there was no "as".
+        SourceLocation importToken;
+        SourceLocation fileNameToken;
+        SourceLocation versionToken;
+        SourceLocation asToken;
+        SourceLocation importIdToken;
+    };
+
+    // The right-hand side of a binding.
+    struct Statement
+    {
+        SourceLocation range; // Position of the first token, length of the whole statement.
+        QString identifier; // Set if the statement consists of nothing but an identifier.
+        bool isBlock = false;
+        bool usesBase = false;
+        bool usesOuter = false;
+        bool usesOriginal = false;
+    };
+
+    struct Member
+    {
+        enum class Type : quint8 { ObjectDefinition, PublicMember, ScriptBinding };
+        Type type = Type::ObjectDefinition;
+
+        // The type name for object definitions, the binding name otherwise.
+        QStringList name;
+        SourceLocation nameToken;
+        SourceLocation lastNameToken;
+
+        // Object definitions.
+        SourceLocation endToken;
+        std::vector<Member> members;
+
+        // Property declarations.
+        QString memberType;
+        QString typeModifier;
+        SourceLocation typeToken;
+        SourceLocation colonToken;
+        bool isSignal = false;
+        bool isReadOnly = false;
+
+        std::optional<Statement> statement;
+    };
+
+    // Throws on syntax errors.
+    static std::shared_ptr<const ParsedQbsFile> parse(const QString &filePath,
+                                                      const QString &code);
+
+    void store(QDataStream &stream) const;
+    void load(QDataStream &stream);
+
+    std::vector<Import> imports;
+    std::vector<Member> members;
+};
+
+/*!
+ * Keeps the ParsedQbsFile of each file read, both in memory for the whole process and on disk.
+ * An entry is used as long as the content of its file does not change.
+ * The directory can be changed via the environment variable QBS_PARSED_FILE_CACHE_DIR;
+ * setting it to an empty value keeps the cache in memory only. If the directory grows beyond
+ * the size limit, the entries of the least recently read files are removed.
+ */
+class QBS_AUTOTEST_EXPORT ParsedQbsFileCache
+{
+public:
+    struct Stats
+    {
+        int parsed = 0;
+        int memoryHits = 0;
+        int diskHits = 0;
+    };
+
+    static ParsedQbsFileCache &instance();
+
+    static const qint64 defaultMaxSize = 64 * 1024 * 1024;
+
+    // An empty directory means in-memory only.
+    explicit ParsedQbsFileCache(const QString &directory, qint64 maxSize = defaultMaxSize);
+
+    std::shared_ptr<const ParsedQbsFile> retrieveOrParse(const QString &filePath,
+                                                         const QString &code);
+
+    QString directory() const { return m_directory.path(); }
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        QByteArray contentDigest;
+        std::shared_ptr<const ParsedQbsFile> parsedFile;
+    };
+
+    QString entryFilePath(const QString &filePath) const;
+    std::shared_ptr<const ParsedQbsFile> load(const QString &filePath,
+                                              const QByteArray &contentDigest) const;
+    void store(const QString &filePath, const Entry &entry);
+
+    CacheDirectory m_directory;
+    MutexData<std::unordered_map<QString, Entry>> m_entries;
+    std::atomic_int m_parseCount = 0;
+    std::atomic_int m_memoryHitCount = 0;
+    std::atomic_int m_diskHitCount = 0;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PARSEDQBSFILE_H
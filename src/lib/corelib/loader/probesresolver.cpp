@@ -48,11 +48,13 @@
 #include <language/filecontext.h>
 #include <language/item.h>
 #include <language/language.h>
+#include <language/probecache.h>
 #include <language/scriptengine.h>
 #include <language/value.h>
 #include <logging/categories.h>
 #include <logging/logger.h>
 #include <logging/translator.h>
+#include <tools/fileinfo.h>
 #include <tools/profiling.h>
 #include <tools/scripttools.h>
 #include <tools/setupprojectparameters.h>
@@ -63,6 +65,21 @@
 namespace qbs {
 namespace Internal {
 
+namespace {
+class ProbeInputsRecorder
+{
+public:
+    ProbeInputsRecorder(ScriptEngine *engine, ProbeInputs *inputs) : m_engine(engine)
+    {
+        m_engine->setProbeInputs(inputs);
+    }
+    ~ProbeInputsRecorder() { m_engine->setProbeInputs(nullptr); }
+
+private:
+    ScriptEngine * const m_engine;
+};
+} // namespace
+
 static QString probeGlobalId(Item *probe)
 {
     QString id;
@@ -150,13 +167,35 @@ void ProbesResolver::resolveProbe(ProductContext &productContext, Item *parent,
         qCDebug(lcModuleLoader) << "probe results cached from earlier run";
         m_loaderState.topLevelProject().incrementReusedOldProbesCount();
     }
+    ProbeCache &probeCache = ProbeCache::instance();
+    QByteArray probeCacheKey;
+    if (!resolvedProbe && condition && probeCache.isEnabled()) {
+        probeCacheKey = ProbeCache::key(configureScript->file()->filePath(), sourceCode,
+                                        initialProperties);
+        // With forced probe execution, the entry only gets refreshed.
+        if (!m_loaderState.parameters().forceProbeExecution()) {
+            resolvedProbe = findCachedProbe(probeId, probe->location(), probeCacheKey,
+                                            condition, initialProperties, sourceCode);
+        }
+        if (resolvedProbe) {
+            qCDebug(lcModuleLoader) << "probe results taken from probe cache";
+            m_loaderState.topLevelProject().incrementReusedCachedProbesCount();
+            m_loaderState.topLevelProject().addNewlyResolvedProbe(resolvedProbe);
+        }
+    }
     ScopedJsValue configureScope(ctx, JS_UNDEFINED);
     ImportReferences importedFilesUsedInConfigure;
+    ProbeInputs probeInputs;
     if (!condition) {
         qCDebug(lcModuleLoader) << "Probe disabled; skipping";
     } else if (!resolvedProbe) {
         m_loaderState.topLevelProject().incrementRunProbesCount();
         qCDebug(lcModuleLoader) << "configure script needs to run";
+        TraceSpan probeSpan(probeId, "probe");
+        if (probeSpan.isActive()) {
+            probeSpan.addArgument(QStringLiteral("product"), productContext.displayName());
+            probeSpan.addArgument(QStringLiteral("location"), probe->location().toString());
+        }
         const Evaluator::FileContextScopes fileCtxScopes
                 = evaluator.fileContextScopes(configureScript->file());
         configureScope.setValue(engine->newObject());
@@ -165,11 +204,15 @@ void ProbesResolver::resolveProbe(ProductContext &productContext, Item *parent,
         engine->clearTrackedScriptAccesses();
         const JSValue scopes[] = {
             fileCtxScopes.fileScope, fileCtxScopes.importScope, configureScope};
-        ScopedJsValue sv(
-            ctx,
-            engine->evaluate(
-                JsValueOwner::Caller, configureScript->sourceCodeForEvaluation(), {}, 1, scopes));
-        engine->throwOnJsError(configureScript->location());
+        {
+            const ProbeInputsRecorder inputsRecorder(
+                        engine, probeCacheKey.isEmpty() ? nullptr : &probeInputs);
+            ScopedJsValue sv(
+                ctx,
+                engine->evaluate(JsValueOwner::Caller, configureScript->sourceCodeForEvaluation(),
+                                 {}, 1, scopes));
+            engine->throwOnJsError(configureScript->location());
+        }
         importedFilesUsedInConfigure = engine->importedFilesUsedInScript();
     } else {
         importedFilesUsedInConfigure = resolvedProbe->importedFilesUsed();
@@ -240,6 +283,17 @@ void ProbesResolver::resolveProbe(ProductContext &productContext, Item *parent,
             storedValues,
             importedFilesUsedInConfigure);
         m_loaderState.topLevelProject().addNewlyResolvedProbe(resolvedProbe);
+        if (!probeCacheKey.isEmpty()) {
+            ProbeCache::Entry entry;
+            for (auto it = storedValues.cbegin(); it != storedValues.cend(); ++it)
+                entry.values.insert(it.key(), it.value()->value());
+            for (const ImportReference &importedFile : importedFilesUsedInConfigure) {
+                entry.importedFiles << importedFile.first;
+                probeInputs.addFileUsed(importedFile.first);
+            }
+            entry.inputs = std::move(probeInputs);
+            probeCache.insert(probeCacheKey, entry);
+        }
     }
     if (isProjectLevelProbe)
         m_loaderState.topLevelProject().addProjectLevelProbe(resolvedProbe);
@@ -286,6 +340,33 @@ ProbeConstPtr ProbesResolver::findCurrentProbe(
     });
 }
 
+ProbeConstPtr ProbesResolver::findCachedProbe(
+        const QString &globalId,
+        const CodeLocation &location,
+        const QByteArray &cacheKey,
+        bool condition,
+        const QVariantMap &initialProperties,
+        const QString &sourceCode) const
+{
+    const std::optional<ProbeCache::Entry> entry = ProbeCache::instance().lookup(
+                cacheKey, m_loaderState.evaluator().engine()->environment());
+    if (!entry)
+        return {};
+    QMap<QString, VariantValuePtr> storedValues;
+    for (auto it = entry->values.cbegin(); it != entry->values.cend(); ++it)
+        storedValues.insert(it.key(), VariantValue::createStored(it.value()));
+
+    // The imported files are among the inputs, so they are known to be unchanged.
+    ImportReferences importedFilesUsed;
+    for (const QString &importedFile : entry->importedFiles)
+        importedFilesUsed.emplace_back(importedFile, FileInfo(importedFile).lastModified());
+    const ProbeConstPtr probe = Probe::create(globalId, location, condition, sourceCode,
+                                              initialProperties, storedValues, importedFilesUsed);
+    if (!probeMatches(probe, condition, initialProperties, sourceCode, CompareScript::Yes))
+        return {};
+    return probe;
+}
+
 bool ProbesResolver::probeMatches(const ProbeConstPtr &probe, bool condition,
         const QVariantMap &initialProperties, const QString &configureScript,
         CompareScript compareScript) const
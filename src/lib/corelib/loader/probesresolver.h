@@ -66,6 +66,10 @@ private:
                                       const QString &sourceCode) const;
     ProbeConstPtr findCurrentProbe(const CodeLocation &location, bool condition,
                                    const QVariantMap &initialProperties) const;
+    ProbeConstPtr findCachedProbe(const QString &globalId, const CodeLocation &location,
+                                  const QByteArray &cacheKey, bool condition,
+                                  const QVariantMap &initialProperties,
+                                  const QString &sourceCode) const;
     enum class CompareScript { No, Yes };
     bool probeMatches(const ProbeConstPtr &probe, bool condition,
                       const QVariantMap &initialProperties, const QString &configureScript,
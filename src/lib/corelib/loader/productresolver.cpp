@@ -125,6 +125,7 @@ public:
     void start();
 
 private:
+    bool takeOverProduct();
     void resolveProductFully();
     void createProductConfig();
     void resolveGroup(Item *item, ModuleContext *moduleContext);
@@ -547,6 +548,9 @@ void ProductResolverStage2::start()
 {
     m_loaderState.evaluator().clearPropertyDependencies();
 
+    if (takeOverProduct())
+        return;
+
     ResolvedProductPtr product = ResolvedProduct::create();
     product->enabled = m_product.project->project->enabled;
     product->moduleProperties = PropertyMapInternal::create();
@@ -597,6 +601,51 @@ void ProductResolverStage2::start()
     }
 }
 
+// The product from the previous resolve can be used as-is if none of its build system files
+// have changed (the caller ensures that) and its dependencies are the very same objects,
+// which implies they have been taken over as well.
+// Note that this only saves stage 2: By the time we get here, the product item has been
+// loaded and its modules, dependencies and probes have been resolved in stage 1, which
+// happens for every product regardless of whether it ends up being taken over.
+bool ProductResolverStage2::takeOverProduct()
+{
+    const ResolvedProductPtr oldProduct
+        = m_loaderState.topLevelProject().reusableProduct(m_product.uniqueName());
+    if (!oldProduct || !oldProduct->enabled || m_product.delayedError.hasError()
+        || !m_product.bulkDependencies.empty()) {
+        return false;
+    }
+    if (oldProduct->probes != m_product.probes)
+        return false;
+
+    // Dependencies pulled in via the Export item are not covered by the check below.
+    if (!oldProduct->exportedModule.productDependencies.empty())
+        return false;
+
+    std::vector<std::pair<const ResolvedProduct *, bool>> dependencies;
+    for (const Item::Module &module : m_product.item->modules()) {
+        if (!module.product)
+            continue;
+        if (!module.product->product)
+            return false;
+        dependencies.emplace_back(module.product->product.get(), module.minimal);
+    }
+    std::vector<std::pair<const ResolvedProduct *, bool>> oldDependencies;
+    for (const ProductDependency &dep : oldProduct->dependencies)
+        oldDependencies.emplace_back(dep.product.get(), dep.minimal);
+    std::sort(dependencies.begin(), dependencies.end());
+    std::sort(oldDependencies.begin(), oldDependencies.end());
+    if (dependencies != oldDependencies)
+        return false;
+
+    qCDebug(lcProjectResolver) << "taking over product" << oldProduct->uniqueName()
+                               << "from previous resolve";
+    oldProduct->project = m_product.project->project;
+    m_product.product = oldProduct;
+    m_product.productReused = true;
+    return true;
+}
+
 void ProductResolverStage2::resolveProductFully()
 {
     Item * const item = m_product.item;
@@ -699,7 +748,8 @@ void ProductResolverStage2::createProductConfig()
 {
     EvalCacheEnabler cachingEnabler(&m_loaderState.evaluator(),
                                     m_product.product->sourceDirectory);
-    m_product.product->moduleProperties->setValue(evaluateModuleValues(m_product.item));
+    m_product.product->moduleProperties = m_loaderState.topLevelProject().internedPropertyMap(
+        evaluateModuleValues(m_product.item));
     m_product.product->productProperties = m_propertiesEvaluator.evaluateProperties(
         m_product.item, m_product.item, QVariantMap(), true, true);
 }
@@ -733,11 +783,9 @@ void ProductResolverStage2::resolveGroupFully(
 
     const auto getGroupPropertyMap = [&](const ArtifactProperties *existingProps) {
         PropertyMapPtr moduleProperties;
-        bool newPropertyMapRequired = false;
         if (existingProps)
             moduleProperties = existingProps->propertyMap();
         if (!moduleProperties) {
-            newPropertyMapRequired = true;
             moduleProperties = m_currentGroup
                     ? m_currentGroup->properties
                     : m_product.product->moduleProperties;
@@ -745,9 +793,8 @@ void ProductResolverStage2::resolveGroupFully(
         const QVariantMap newModuleProperties = resolveAdditionalModuleProperties(
             item, moduleProperties->value(), false);
         if (!newModuleProperties.empty()) {
-            if (newPropertyMapRequired)
-                moduleProperties = PropertyMapInternal::create();
-            moduleProperties->setValue(newModuleProperties);
+            moduleProperties = m_loaderState.topLevelProject().internedPropertyMap(
+                newModuleProperties);
         }
         return moduleProperties;
     };
@@ -1310,8 +1357,8 @@ void ProductResolverStage2::finalizeArtifactProperties()
                     const QVariantMap newProps = resolveAdditionalModuleProperties(
                         filterGroup.item, artifact->properties->value(), true);
                     if (newProps != artifact->properties->value()) {
-                        artifact->properties = PropertyMapInternal::create();
-                        artifact->properties->setValue(newProps);
+                        artifact->properties
+                            = m_loaderState.topLevelProject().internedPropertyMap(newProps);
                     }
                     artifact->fileTags.unite(filterGroup.extraTags);
                 }
@@ -1350,6 +1397,8 @@ void ProductResolverStage2::collectProductDependencies()
 
 void ExportsResolver::start()
 {
+    if (m_product.productReused) // Exported module was taken over along with the product.
+        return;
     resolveShadowProduct();
     collectExportedProductDependencies();
 }
@@ -44,6 +44,8 @@
 #include "productresolver.h"
 
 #include <language/evaluator.h>
+#include <language/filecontext.h>
+#include <language/item.h>
 #include <language/language.h>
 #include <language/scriptengine.h>
 #include <logging/categories.h>
@@ -95,6 +97,7 @@ class ProductsResolver
 {
 public:
     ProductsResolver(LoaderState &loaderState) : m_loaderState(loaderState) {}
+    ~ProductsResolver();
     void resolve();
 
 private:
@@ -114,6 +117,7 @@ private:
     void waitForBulkDependency(const ProductWithLoaderState &product);
     void unblockProductsWaitingForDependency(ProductContext &finishedProduct);
     void postProcess();
+    void collectBuildSystemFiles(ProductContext &product);
     void checkForMissedBulkDependencies(const ProductContext &product);
 
     static int dependsItemCount(const Item *item);
@@ -133,6 +137,7 @@ private:
     std::vector<std::unique_ptr<LoaderState>> m_loaderStatePool;
     std::vector<LoaderState *> m_availableLoaderStates;
     std::mutex m_cancelingMutex;
+    std::unordered_map<const LoaderState *, int> m_traceLanes;
     std::launch m_asyncMode = std::launch::async;
     int m_maxJobCount = m_loaderState.parameters().maxJobCount();
     bool m_canceling = false;
@@ -143,6 +148,21 @@ void resolveProducts(LoaderState &loaderState)
     ProductsResolver(loaderState).resolve();
 }
 
+ProductsResolver::~ProductsResolver()
+{
+    if (!m_loaderState.parameters().reuseScriptEngines())
+        return;
+
+    // The evaluators of the loader states must be gone before their engines can be handed on.
+    m_availableLoaderStates.clear();
+    m_loaderStatePool.clear();
+    for (auto &engine : m_enginePool) {
+        if (ProgressObserver * const observer = m_loaderState.topLevelProject().progressObserver())
+            observer->removeScriptEngine(engine.get());
+        ScriptEngine::recycle(std::move(engine));
+    }
+}
+
 void ProductsResolver::resolve()
 {
     initialize();
@@ -209,7 +229,9 @@ void ProductsResolver::initializeLoaderStatePool()
     m_loaderState.evaluator().engine()->setSetupProjectParameters(m_loaderState.parameters());
     for (std::size_t i = 0; i < m_enginePool.capacity(); ++i) {
         ScriptEngine &engine = *m_enginePool.emplace_back(
-            ScriptEngine::create(m_loaderState.logger(), EvalContext::PropertyEvaluation));
+            m_loaderState.parameters().reuseScriptEngines()
+                ? ScriptEngine::acquire(m_loaderState.logger(), EvalContext::PropertyEvaluation)
+                : ScriptEngine::create(m_loaderState.logger(), EvalContext::PropertyEvaluation));
         ItemPool &itemPool = topLevelProject.createItemPool();
         engine.setEnvironment(m_loaderState.parameters().adjustedEnvironment());
         auto loaderState = std::make_unique<LoaderState>(
@@ -222,6 +244,13 @@ void ProductsResolver::initializeLoaderStatePool()
             topLevelProject.progressObserver()->addScriptEngine(m_enginePool.back().get());
     }
     qCDebug(lcLoaderScheduling) << "using" << m_availableLoaderStates.size() << "loader states";
+    if (TraceRecorder::instance().isEnabled()) {
+        const int laneCount = int(m_availableLoaderStates.size());
+        const int firstLane = TraceRecorder::instance().reserveLanes(
+            laneCount, Tr::tr("Resolver thread"));
+        for (int i = 0; i < laneCount; ++i)
+            m_traceLanes.emplace(m_availableLoaderStates.at(i), firstLane + i);
+    }
     if (int(m_availableLoaderStates.size()) == 1)
         m_asyncMode = std::launch::deferred;
 }
@@ -356,9 +385,15 @@ void ProductsResolver::startJob(const ProductWithLoaderState &product, Deferral
     try {
         const auto it = m_runningThreads.emplace(product.product, ThreadInfo(std::async(m_asyncMode,
             [this, product, deferral] {
+                const auto laneIt = m_traceLanes.find(product.loaderState);
+                TraceLaneSwitcher laneSwitcher(laneIt != m_traceLanes.cend()
+                                               ? laneIt->second : -1);
+                TraceSpan productSpan(product.product->displayName(), "resolve");
                 product.loaderState->itemReader().setExtraSearchPathsStack(
                 product.product->project->searchPathsStack);
                 resolveProduct(*product.product, deferral, *product.loaderState);
+                if (product.product->dependenciesResolvingPending())
+                    productSpan.addArgument(QStringLiteral("deferred"), true);
 
                 // The search paths stack can change during dependency resolution
                 // (due to module providers); check that we've rolled back all the changes
@@ -530,8 +565,10 @@ void ProductsResolver::unblockProductsWaitingForDependency(ProductContext &finis
 void ProductsResolver::postProcess()
 {
     for (ProductContext * const product : m_finishedProducts) {
-        if (product->product)
+        if (product->product) {
             product->product->project->products.push_back(product->product);
+            collectBuildSystemFiles(*product);
+        }
 
         // This has to be done in post-processing, because we need both product and shadow product
         // to be ready, and contrary to what one might assume, there is no proper ordering
@@ -557,6 +594,20 @@ void ProductsResolver::postProcess()
     }
 }
 
+// Remembers which project and module files went into the product, so that the product can
+// be taken over as-is in the next resolve if none of them change.
+void ProductsResolver::collectBuildSystemFiles(ProductContext &product)
+{
+    Set<QString> files = product.buildSystemFiles;
+    if (product.shadowProduct)
+        files.unite(product.shadowProduct->buildSystemFiles);
+    files << product.item->file()->filePath();
+    for (const ProjectContext *p = product.project; p; p = p->parent)
+        files << p->item->file()->filePath();
+    product.product->buildSystemFiles
+        = m_loaderState.topLevelProject().itemReaderCache().withBaseFiles(files);
+}
+
 void ProductsResolver::checkForMissedBulkDependencies(const ProductContext &product)
 {
     if (!product.product || !product.product->enabled || !product.bulkDependencies.empty())
@@ -41,6 +41,7 @@
 
 #include "itemreader.h"
 #include "loaderutils.h"
+#include "parsedqbsfile.h"
 #include "productscollector.h"
 #include "productsresolver.h"
 
@@ -53,6 +54,7 @@
 #include <language/filetags.h>
 #include <language/item.h>
 #include <language/itempool.h>
+#include <language/jsbytecodecache.h>
 #include <language/language.h>
 #include <language/propertymapinternal.h>
 #include <language/resolvedfilecontext.h>
@@ -138,6 +140,8 @@ public:
     TopLevelProjectContext topLevelProject;
     LoaderState state{setupParams, topLevelProject, itemPool, *engine, logger};
     Item *rootProjectItem = nullptr;
+    JsBytecodeCache::Stats bytecodeCacheStatsAtStart;
+    ParsedQbsFileCache::Stats parsedFileCacheStatsAtStart;
 };
 
 ProjectResolver::ProjectResolver(const SetupProjectParameters &parameters, ScriptEngine *engine,
@@ -170,6 +174,11 @@ void ProjectResolver::setLastResolveTime(const FileTime &time)
     d->state.topLevelProject().setLastResolveTime(time);
 }
 
+void ProjectResolver::setReusableProducts(const QHash<QString, ResolvedProductPtr> &products)
+{
+    d->state.topLevelProject().setReusableProducts(products);
+}
+
 void ProjectResolver::setStoredProfiles(const QVariantMap &profiles)
 {
     d->state.topLevelProject().setProfileConfigs(profiles);
@@ -209,6 +218,8 @@ TopLevelProjectPtr ProjectResolver::resolve()
     d->engine->clearImportsCache();
     d->engine->clearTrackedScriptAccesses();
     d->engine->enableProfiling(d->setupParams.logElapsedTime());
+    d->bytecodeCacheStatsAtStart = JsBytecodeCache::instance().stats();
+    d->parsedFileCacheStatsAtStart = ParsedQbsFileCache::instance().stats();
     d->logger.clearWarnings();
     EvalContextSwitcher evalContextSwitcher(d->engine, EvalContext::PropertyEvaluation);
 
@@ -551,13 +562,43 @@ void ProjectResolver::Private::printProfilingInfo()
     state.logger().qbsLog(LoggerInfo, true)
         << "    "
         << Tr::tr("%1 probes encountered, %2 configure scripts executed, "
-                  "%3 re-used from current run, %4 re-used from earlier run.")
+                  "%3 re-used from current run, %4 re-used from earlier run, "
+                  "%5 taken from the probe cache.")
            .arg(state.topLevelProject().probesEncounteredCount())
            .arg(state.topLevelProject().probesRunCount())
            .arg(state.topLevelProject().reusedCurrentProbesCount())
-           .arg(state.topLevelProject().reusedOldProbesCount());
+           .arg(state.topLevelProject().reusedOldProbesCount())
+           .arg(state.topLevelProject().reusedCachedProbesCount());
     print(2, Tr::tr("Property checking took %1."),
           state.topLevelProject().timingData().propertyChecking);
+    const TopLevelProjectContext::PropertyMapStats propertyMapStats
+        = state.topLevelProject().propertyMapStats();
+    state.logger().qbsLog(LoggerInfo, true)
+        << "  "
+        << Tr::tr("%1 module property maps requested, %2 unique; "
+                  "%3 module values requested, %4 unique. Sharing saved about %5 KiB.")
+           .arg(propertyMapStats.mapsRequested)
+           .arg(propertyMapStats.uniqueMaps)
+           .arg(propertyMapStats.moduleValuesRequested)
+           .arg(propertyMapStats.uniqueModuleValues)
+           .arg(propertyMapStats.bytesSaved / 1024);
+
+    // The cache is shared with other resolve operations running in parallel, which are
+    // included in these numbers.
+    const JsBytecodeCache::Stats bytecodeCacheStats = JsBytecodeCache::instance().stats();
+    state.logger().qbsLog(LoggerInfo, true)
+        << "  "
+        << Tr::tr("%1 scripts compiled to bytecode, %2 taken from memory, %3 from disk.")
+           .arg(bytecodeCacheStats.compiled - bytecodeCacheStatsAtStart.compiled)
+           .arg(bytecodeCacheStats.memoryHits - bytecodeCacheStatsAtStart.memoryHits)
+           .arg(bytecodeCacheStats.diskHits - bytecodeCacheStatsAtStart.diskHits);
+    const ParsedQbsFileCache::Stats parsedFileCacheStats = ParsedQbsFileCache::instance().stats();
+    state.logger().qbsLog(LoggerInfo, true)
+        << "  "
+        << Tr::tr("%1 project files parsed, %2 taken from memory, %3 from disk.")
+           .arg(parsedFileCacheStats.parsed - parsedFileCacheStatsAtStart.parsed)
+           .arg(parsedFileCacheStats.memoryHits - parsedFileCacheStatsAtStart.memoryHits)
+           .arg(parsedFileCacheStats.diskHits - parsedFileCacheStatsAtStart.diskHits);
 }
 
 } // namespace Internal
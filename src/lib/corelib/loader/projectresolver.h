@@ -69,6 +69,7 @@ public:
     void setOldProjectProbes(const std::vector<ProbeConstPtr> &oldProbes);
     void setOldProductProbes(const QHash<QString, std::vector<ProbeConstPtr>> &oldProbes);
     void setLastResolveTime(const FileTime &time);
+    void setReusableProducts(const QHash<QString, ResolvedProductPtr> &products);
     void setStoredProfiles(const QVariantMap &profiles);
     void setStoredModuleProviderInfo(const StoredModuleProviderInfo &providerInfo);
     TopLevelProjectPtr resolve();
@@ -52,7 +52,7 @@ class BuildOptionsPrivate : public QSharedData
 public:
     BuildOptionsPrivate()
         : maxJobCount(0), dryRun(false), keepGoing(false), forceTimestampCheck(false),
-          forceOutputCheck(false),
+          forceOutputCheck(false), checkContents(false),
           logElapsedTime(false), echoMode(defaultCommandEchoMode()), install(true),
           removeExistingInstallation(false), onlyExecuteRules(false)
     {
@@ -63,11 +63,19 @@ public:
     QStringList activeFileTags;
     JobLimits jobLimits;
     QString settingsDir;
+    QString traceFilePath;
+    QString actionCacheDir;
+    int actionCacheMaxSize = 5 * 1024; // In MiB.
+    QString remoteActionCacheUrl;
+    QStringList memoryHeavyJobPools;
+    int minAvailableMemory = 0; // In MiB.
+    int maxMemoryPressure = 0; // In percent.
     int maxJobCount;
     bool dryRun;
     bool keepGoing;
     bool forceTimestampCheck;
     bool forceOutputCheck;
+    bool checkContents;
     bool logElapsedTime;
     CommandEchoMode echoMode;
     bool install;
@@ -99,6 +107,7 @@ BuildOptions::~BuildOptions() = default;
 
 /*!
  * \brief If non-empty, qbs pretends that only these files have changed.
+ * This applies to source files as well as to files found by dependency scanners.
  * By default, this list is empty.
  */
 QStringList BuildOptions::changedFiles() const
@@ -305,6 +314,143 @@ void BuildOptions::setForceOutputCheck(bool enabled)
     d->forceOutputCheck = enabled;
 }
 
+/*!
+ * \brief Returns true if qbs records a content digest for generated artifacts and
+ * considers an artifact unchanged if it was re-generated with identical content.
+ * The default is \c false.
+ */
+bool BuildOptions::checkContents() const
+{
+    return d->checkContents;
+}
+
+/*!
+ * \brief Controls whether qbs should compare the contents of re-generated artifacts with
+ * the ones from the previous build. If the content did not change, artifacts depending
+ * on it are not considered out of date. Enabling this adds the cost of hashing all generated
+ * files to the build.
+ */
+void BuildOptions::setCheckContents(bool enabled)
+{
+    d->checkContents = enabled;
+}
+
+/*!
+ * \brief The directory of the action cache.
+ * If this is non-empty, the results of commands are stored there and re-used instead
+ * of running the commands again, if the command lines and inputs are the same.
+ * The default is an empty string, which means that no action cache is used.
+ */
+QString BuildOptions::actionCacheDirectory() const
+{
+    return d->actionCacheDir;
+}
+
+/*!
+ * \brief Sets the directory of the action cache.
+ * The same directory can be shared between several build directories and projects.
+ */
+void BuildOptions::setActionCacheDirectory(const QString &directory)
+{
+    d->actionCacheDir = directory;
+}
+
+/*!
+ * \brief The size in MiB that the action cache may occupy on disk.
+ * If the cache grows beyond this size, the least recently used entries are removed
+ * at the end of the build. The default is 5120.
+ */
+int BuildOptions::actionCacheMaxSize() const
+{
+    return d->actionCacheMaxSize;
+}
+
+/*!
+ * \brief Sets the size in MiB that the action cache may occupy on disk.
+ */
+void BuildOptions::setActionCacheMaxSize(int sizeInMiB)
+{
+    d->actionCacheMaxSize = sizeInMiB;
+}
+
+/*!
+ * \brief The URL of a remote action cache.
+ * On a miss in the local action cache, the entry is looked up there, and newly created
+ * entries are uploaded to it. Supported are "http://host[:port][/path]" and
+ * "unix:/path/to/socket". If no local action cache directory is set, a default location
+ * is used. The default is an empty string, which means that no remote cache is used.
+ */
+QString BuildOptions::remoteActionCacheUrl() const
+{
+    return d->remoteActionCacheUrl;
+}
+
+/*!
+ * \brief Sets the URL of the remote action cache.
+ */
+void BuildOptions::setRemoteActionCacheUrl(const QString &url)
+{
+    d->remoteActionCacheUrl = url;
+}
+
+/*!
+ * \brief The amount of memory in MiB that needs to be available for new jobs to get started.
+ * While the system has less memory available, no further jobs are started until
+ * running ones have finished or memory is freed otherwise. At least one job is always
+ * allowed to run, so the build does not stall. The default is 0, which means that
+ * the available memory is not checked.
+ */
+int BuildOptions::minAvailableMemory() const
+{
+    return d->minAvailableMemory;
+}
+
+/*!
+ * \brief Sets the amount of memory in MiB that needs to be available for new jobs to get started.
+ */
+void BuildOptions::setMinAvailableMemory(int sizeInMiB)
+{
+    d->minAvailableMemory = sizeInMiB;
+}
+
+/*!
+ * \brief The memory pressure in percent above which no new jobs get started.
+ * The memory pressure is the share of time in which tasks were stalled waiting for memory
+ * during the last ten seconds, as reported by the Linux kernel's pressure stall information.
+ * The default is 0, which means that the memory pressure is not checked.
+ * On other operating systems, this setting has no effect.
+ */
+int BuildOptions::maxMemoryPressure() const
+{
+    return d->maxMemoryPressure;
+}
+
+/*!
+ * \brief Sets the memory pressure in percent above which no new jobs get started.
+ */
+void BuildOptions::setMaxMemoryPressure(int percentage)
+{
+    d->maxMemoryPressure = percentage;
+}
+
+/*!
+ * \brief The job pools whose jobs are held back when memory is low.
+ * The default is an empty list, which means that all jobs are held back.
+ * \sa minAvailableMemory(), maxMemoryPressure()
+ */
+QStringList BuildOptions::memoryHeavyJobPools() const
+{
+    return d->memoryHeavyJobPools;
+}
+
+/*!
+ * \brief Sets the job pools whose jobs are held back when memory is low.
+ */
+void BuildOptions::setMemoryHeavyJobPools(const QStringList &jobPools)
+{
+    d->memoryHeavyJobPools = jobPools;
+}
+
 /*!
  * \brief Returns true iff the time the operation takes will be logged.
  * The default is \c false.
@@ -322,6 +468,25 @@ void BuildOptions::setLogElapsedTime(bool log)
     d->logElapsedTime = log;
 }
 
+/*!
+ * \brief Returns the file that a timeline of the build will be written to.
+ * The default is an empty string, which means no timeline is recorded.
+ */
+QString BuildOptions::traceFilePath() const
+{
+    return d->traceFilePath;
+}
+
+/*!
+ * \brief Controls whether a timeline of the build will be written to \a filePath.
+ * The file is in the Trace Event Format, which can be viewed with chrome://tracing or Perfetto.
+ * It contains one span per job, as well as spans for storing the build graph.
+ */
+void BuildOptions::setTraceFilePath(const QString &filePath)
+{
+    d->traceFilePath = filePath;
+}
+
 /*!
  * \brief The kind of output that is displayed when executing commands.
  */
@@ -451,7 +616,15 @@ qbs::BuildOptions qbs::BuildOptions::fromJson(const QJsonObject &data)
     setValueFromJson(opt.d->keepGoing, data, "keep-going");
     setValueFromJson(opt.d->forceTimestampCheck, data, "check-timestamps");
     setValueFromJson(opt.d->forceOutputCheck, data, "check-outputs");
+    setValueFromJson(opt.d->checkContents, data, "check-contents");
     setValueFromJson(opt.d->logElapsedTime, data, "log-time");
+    setValueFromJson(opt.d->traceFilePath, data, "trace-file");
+    setValueFromJson(opt.d->actionCacheDir, data, "action-cache");
+    setValueFromJson(opt.d->actionCacheMaxSize, data, "action-cache-max-size");
+    setValueFromJson(opt.d->remoteActionCacheUrl, data, "remote-action-cache");
+    setValueFromJson(opt.d->minAvailableMemory, data, "min-available-memory");
+    setValueFromJson(opt.d->maxMemoryPressure, data, "max-memory-pressure");
+    setValueFromJson(opt.d->memoryHeavyJobPools, data, "memory-heavy-job-pools");
     setValueFromJson(opt.d->echoMode, data, "command-echo-mode");
     setValueFromJson(opt.d->install, data, "install");
     setValueFromJson(opt.d->removeExistingInstallation, data, "clean-install-root");
@@ -98,9 +98,33 @@ public:
     bool forceOutputCheck() const;
     void setForceOutputCheck(bool enabled);
 
+    bool checkContents() const;
+    void setCheckContents(bool enabled);
+
+    QString actionCacheDirectory() const;
+    void setActionCacheDirectory(const QString &directory);
+
+    int actionCacheMaxSize() const;
+    void setActionCacheMaxSize(int sizeInMiB);
+
+    QString remoteActionCacheUrl() const;
+    void setRemoteActionCacheUrl(const QString &url);
+
+    int minAvailableMemory() const;
+    void setMinAvailableMemory(int sizeInMiB);
+
+    int maxMemoryPressure() const;
+    void setMaxMemoryPressure(int percentage);
+
+    QStringList memoryHeavyJobPools() const;
+    void setMemoryHeavyJobPools(const QStringList &jobPools);
+
     bool logElapsedTime() const;
     void setLogElapsedTime(bool log);
 
+    QString traceFilePath() const;
+    void setTraceFilePath(const QString &filePath);
+
     CommandEchoMode echoMode() const;
     void setEchoMode(CommandEchoMode echoMode);
 
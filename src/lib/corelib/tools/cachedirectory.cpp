@@ -0,0 +1,129 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "cachedirectory.h"
+
+#include <logging/categories.h>
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qdiriterator.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qstandardpaths.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+
+CacheDirectory::CacheDirectory(const QString &path, qint64 maxSize)
+    : m_path(path), m_maxSize(maxSize)
+{
+}
+
+QString CacheDirectory::defaultPath(const char *environmentVariable, const QString &subDirectory)
+{
+    if (qEnvironmentVariableIsSet(environmentVariable))
+        return qEnvironmentVariable(environmentVariable);
+    const QString cacheLocation
+            = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (cacheLocation.isEmpty())
+        return {};
+    return cacheLocation + QLatin1String("/qbs/") + subDirectory;
+}
+
+// Looking at the size of the directory is not free, so it is only done when this process
+// stores its first entry and then again whenever it has written another quarter of the limit.
+void CacheDirectory::entryStored(qint64 size)
+{
+    const qint64 bytesWrittenBefore = m_bytesWritten.fetch_add(size);
+    const qint64 pruneInterval = std::max<qint64>(m_maxSize / 4, 1);
+    if (bytesWrittenBefore == 0
+            || bytesWrittenBefore / pruneInterval != (bytesWrittenBefore + size) / pruneInterval) {
+        prune();
+    }
+}
+
+// The modification time serves as the time of last use when pruning.
+void CacheDirectory::entryUsed(QFileDevice &file) const
+{
+    file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+}
+
+// Removes the least recently used entries until the directory is well below the size limit,
+// so that pruning does not happen again right away.
+void CacheDirectory::prune()
+{
+    if (!isEnabled())
+        return;
+    struct EntryFile
+    {
+        QString filePath;
+        QDateTime lastUsed;
+        qint64 size = 0;
+    };
+    std::vector<EntryFile> entryFiles;
+    qint64 totalSize = 0;
+    QDirIterator it(m_path, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo fileInfo = it.fileInfo();
+        entryFiles.push_back({fileInfo.filePath(), fileInfo.lastModified(), fileInfo.size()});
+        totalSize += fileInfo.size();
+    }
+    if (totalSize <= m_maxSize)
+        return;
+
+    std::sort(entryFiles.begin(), entryFiles.end(),
+              [](const EntryFile &e1, const EntryFile &e2) { return e1.lastUsed < e2.lastUsed; });
+    const qint64 targetSize = m_maxSize / 4 * 3;
+    for (const EntryFile &entryFile : entryFiles) {
+        if (totalSize <= targetSize)
+            break;
+        if (QFile::remove(entryFile.filePath))
+            totalSize -= entryFile.size;
+    }
+    qCDebug(lcProjectResolver) << "pruned cache directory" << m_path << "to" << totalSize
+                               << "bytes";
+}
+
+} // namespace Internal
+} // namespace qbs
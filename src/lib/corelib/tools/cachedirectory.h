@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_CACHEDIRECTORY_H
+#define QBS_CACHEDIRECTORY_H
+
+#include "qbs_export.h"
+
+#include <QtCore/qstring.h>
+
+#include <atomic>
+
+QT_BEGIN_NAMESPACE
+class QFileDevice;
+QT_END_NAMESPACE
+
+namespace qbs {
+namespace Internal {
+
+/*!
+ * A directory below the user's cache location in which qbs keeps data across processes.
+ * Its size is bounded: When it grows beyond the limit, the least recently used entry files
+ * are removed. Entry files are created by the respective cache, which reports them via
+ * entryStored() and entryUsed().
+ */
+class QBS_AUTOTEST_EXPORT CacheDirectory
+{
+public:
+    // An empty path means that nothing is stored on disk.
+    CacheDirectory(const QString &path, qint64 maxSize);
+
+    // The value of the environment variable, if it is set, otherwise the sub-directory
+    // of <cache location>/qbs.
+    static QString defaultPath(const char *environmentVariable, const QString &subDirectory);
+
+    QString path() const { return m_path; }
+    bool isEnabled() const { return !m_path.isEmpty(); }
+
+    void entryStored(qint64 size);
+    void entryUsed(QFileDevice &file) const;
+    void prune();
+
+private:
+    const QString m_path;
+    const qint64 m_maxSize;
+    std::atomic<qint64> m_bytesWritten = 0;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_CACHEDIRECTORY_H
@@ -0,0 +1,128 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "filestatusprefetcher.h"
+
+#include "fileinfo.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <utility>
+
+namespace qbs {
+namespace Internal {
+
+// Below this number of files, the overhead of starting threads is not worth it.
+static const int minFileCountForThreads = 256;
+
+static FileStatusPrefetcher::FileStatus retrieveFileStatus(const QString &filePath)
+{
+    const FileInfo fi(filePath);
+    FileStatusPrefetcher::FileStatus status;
+    status.exists = fi.exists();
+    status.isDir = fi.isDir();
+    status.lastModified = fi.lastModified();
+    status.lastStatusChange = fi.lastStatusChange();
+    return status;
+}
+
+void FileStatusPrefetcher::addFile(const QString &filePath)
+{
+    m_pendingFiles.push_back(filePath);
+}
+
+void FileStatusPrefetcher::run(int maxThreadCount)
+{
+    using Entry = std::pair<const QString *, FileStatus *>;
+
+    // The hash must be complete before the worker threads start writing into its values,
+    // as rehashing would invalidate the pointers.
+    for (const QString &filePath : m_pendingFiles)
+        m_statuses.insert(filePath, FileStatus());
+    m_pendingFiles.clear();
+
+    // Files in the same directory are looked up by the same thread, so the lookups
+    // do not contend for the same directory inode and profit from its cached entries.
+    QHash<QString, std::vector<Entry>> entriesPerDirectory;
+    for (auto it = m_statuses.begin(); it != m_statuses.end(); ++it)
+        entriesPerDirectory[FileInfo::path(it.key())].emplace_back(&it.key(), &it.value());
+    std::vector<std::vector<Entry>> groups;
+    groups.reserve(entriesPerDirectory.size());
+    for (auto it = entriesPerDirectory.begin(); it != entriesPerDirectory.end(); ++it)
+        groups.push_back(std::move(it.value()));
+
+    std::atomic<std::size_t> nextGroup = 0;
+    const auto worker = [&groups, &nextGroup] {
+        for (std::size_t i = nextGroup++; i < groups.size(); i = nextGroup++) {
+            for (const Entry &entry : std::as_const(groups[i]))
+                *entry.second = retrieveFileStatus(*entry.first);
+        }
+    };
+
+    if (maxThreadCount <= 0)
+        maxThreadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    int threadCount = 1;
+    if (m_statuses.size() >= minFileCountForThreads)
+        threadCount = std::min(maxThreadCount, int(groups.size()));
+    std::vector<std::future<void>> futures;
+    for (int i = 1; i < threadCount; ++i)
+        futures.push_back(std::async(std::launch::async, worker));
+    worker();
+    for (std::future<void> &future : futures)
+        future.get();
+}
+
+void FileStatusPrefetcher::clear()
+{
+    m_pendingFiles.clear();
+    m_statuses.clear();
+}
+
+FileStatusPrefetcher::FileStatus FileStatusPrefetcher::status(const QString &filePath) const
+{
+    const auto it = m_statuses.constFind(filePath);
+    if (it != m_statuses.constEnd())
+        return it.value();
+    return retrieveFileStatus(filePath);
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,87 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_FILESTATUSPREFETCHER_H
+#define QBS_FILESTATUSPREFETCHER_H
+
+#include "filetime.h"
+
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+
+/*!
+ * Collects existence and timestamp information for a large number of files up front.
+ * The files are grouped by directory, and the groups are distributed over several threads,
+ * which hides the latency of the individual stat() calls on network file systems.
+ * Files that were not prefetched are looked up on demand.
+ */
+class FileStatusPrefetcher
+{
+public:
+    struct FileStatus
+    {
+        bool exists = false;
+        bool isDir = false;
+        FileTime lastModified;
+        FileTime lastStatusChange;
+    };
+
+    void addFile(const QString &filePath);
+    void run(int maxThreadCount);
+    void clear();
+
+    int fileCount() const { return int(m_statuses.size()); }
+    FileStatus status(const QString &filePath) const;
+    bool exists(const QString &filePath) const { return status(filePath).exists; }
+    FileTime lastModified(const QString &filePath) const { return status(filePath).lastModified; }
+
+private:
+    std::vector<QString> m_pendingFiles;
+    QHash<QString, FileStatus> m_statuses;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_FILESTATUSPREFETCHER_H
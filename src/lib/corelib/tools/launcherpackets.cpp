@@ -125,7 +125,10 @@ void ProcessFinishedPacket::doSerialize(QDataStream &stream) const
 {
     stream << errorString << stdOut << stdErr
            << static_cast<quint8>(exitStatus) << static_cast<quint8>(error)
-           << exitCode;
+           << exitCode
+           << resourceUsage.elapsedTime << resourceUsage.userTime << resourceUsage.systemTime
+           << resourceUsage.maxResidentSetSize << resourceUsage.blockInputOperations
+           << resourceUsage.blockOutputOperations;
 }
 
 void ProcessFinishedPacket::doDeserialize(QDataStream &stream)
@@ -136,7 +139,10 @@ void ProcessFinishedPacket::doDeserialize(QDataStream &stream)
     exitStatus = static_cast<QProcess::ExitStatus>(val);
     stream >> val;
     error = static_cast<QProcess::ProcessError>(val);
-    stream >> exitCode;
+    stream >> exitCode
+           >> resourceUsage.elapsedTime >> resourceUsage.userTime >> resourceUsage.systemTime
+           >> resourceUsage.maxResidentSetSize >> resourceUsage.blockInputOperations
+           >> resourceUsage.blockOutputOperations;
 }
 
 ShutdownPacket::ShutdownPacket() : LauncherPacket(LauncherPacketType::Shutdown, 0) { }
@@ -153,6 +153,17 @@ private:
     void doDeserialize(QDataStream &stream) override;
 };
 
+// Values that could not be determined are -1.
+struct ProcessResourceUsage
+{
+    qint64 elapsedTime = -1; // In milliseconds.
+    qint64 userTime = -1; // In milliseconds.
+    qint64 systemTime = -1; // In milliseconds.
+    qint64 maxResidentSetSize = -1; // In bytes.
+    qint64 blockInputOperations = -1;
+    qint64 blockOutputOperations = -1;
+};
+
 class ProcessFinishedPacket : public LauncherPacket
 {
 public:
@@ -164,6 +175,7 @@ public:
     QProcess::ExitStatus exitStatus = QProcess::ExitStatus::NormalExit;
     QProcess::ProcessError error = QProcess::ProcessError::UnknownError;
     int exitCode = 0;
+    ProcessResourceUsage resourceUsage;
 
 private:
     void doSerialize(QDataStream &stream) const override;
@@ -0,0 +1,140 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "memorymonitor.h"
+
+#if defined(Q_OS_WIN)
+#   include <QtCore/qt_windows.h>
+#elif defined(Q_OS_LINUX)
+#   include <QtCore/qfile.h>
+#endif
+
+namespace qbs {
+namespace Internal {
+
+static const int sampleInterval = 100; // In milliseconds.
+
+MemoryMonitor::MemoryMonitor(qint64 minAvailableMemory, double maxMemoryPressure)
+    : m_minAvailableMemory(minAvailableMemory), m_maxMemoryPressure(maxMemoryPressure)
+{
+}
+
+bool MemoryMonitor::isMemoryLow()
+{
+    if (!isEnabled())
+        return false;
+    if (!m_sampleTimer.isValid() || m_sampleTimer.hasExpired(sampleInterval)) {
+        if (m_minAvailableMemory > 0)
+            m_availableMemory = readAvailableMemory();
+        if (m_maxMemoryPressure > 0)
+            m_memoryPressure = readMemoryPressure();
+        m_sampleTimer.start();
+    }
+    if (m_minAvailableMemory > 0 && m_availableMemory >= 0
+            && m_availableMemory < m_minAvailableMemory) {
+        return true;
+    }
+    return m_maxMemoryPressure > 0 && m_memoryPressure > m_maxMemoryPressure;
+}
+
+// Returns the amount of memory in bytes that can be used without swapping, or -1 if unknown.
+qint64 MemoryMonitor::readAvailableMemory()
+{
+#if defined(Q_OS_WIN)
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof status;
+    if (!GlobalMemoryStatusEx(&status))
+        return -1;
+    return qint64(status.ullAvailPhys);
+#elif defined(Q_OS_LINUX)
+    QFile meminfo(QStringLiteral("/proc/meminfo"));
+    if (!meminfo.open(QIODevice::ReadOnly))
+        return -1;
+    while (!meminfo.atEnd()) {
+        const QByteArray line = meminfo.readLine();
+        if (!line.startsWith("MemAvailable:"))
+            continue;
+
+        // Format: "MemAvailable:   12345678 kB"
+        const QList<QByteArray> fields = line.simplified().split(' ');
+        if (fields.size() < 2)
+            return -1;
+        bool ok;
+        const qint64 value = fields.at(1).toLongLong(&ok);
+        if (!ok)
+            return -1;
+        return fields.size() >= 3 && fields.at(2) == "kB" ? value * 1024 : value;
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+// Returns the percentage of time in the last ten seconds in which at least one task
+// was stalled on memory, or -1 if unknown.
+double MemoryMonitor::readMemoryPressure()
+{
+#if defined(Q_OS_LINUX)
+    QFile pressureFile(QStringLiteral("/proc/pressure/memory"));
+    if (!pressureFile.open(QIODevice::ReadOnly))
+        return -1;
+    while (!pressureFile.atEnd()) {
+        const QByteArray line = pressureFile.readLine();
+        if (!line.startsWith("some "))
+            continue;
+
+        // Format: "some avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+        const QList<QByteArray> fields = line.simplified().split(' ');
+        for (const QByteArray &field : fields) {
+            if (!field.startsWith("avg10="))
+                continue;
+            bool ok;
+            const double value = field.mid(6).toDouble(&ok);
+            return ok ? value : -1;
+        }
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,80 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_MEMORYMONITOR_H
+#define QBS_MEMORYMONITOR_H
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qglobal.h>
+
+namespace qbs {
+namespace Internal {
+
+/*!
+ * Tells whether the system is running low on memory, based on the amount of available memory
+ * and, on Linux, the memory pressure stall information. The values are sampled at most
+ * every 100 ms, so the check is cheap enough to be done for every job that is about to start.
+ * Values that cannot be determined on the current platform never count as low memory.
+ */
+class MemoryMonitor
+{
+public:
+    MemoryMonitor(qint64 minAvailableMemory = 0, double maxMemoryPressure = 0);
+
+    bool isEnabled() const { return m_minAvailableMemory > 0 || m_maxMemoryPressure > 0; }
+    bool isMemoryLow();
+
+    qint64 availableMemory() const { return m_availableMemory; }
+    double memoryPressure() const { return m_memoryPressure; }
+
+    static qint64 readAvailableMemory();
+    static double readMemoryPressure();
+
+private:
+    qint64 m_minAvailableMemory;
+    double m_maxMemoryPressure;
+    qint64 m_availableMemory = -1;
+    double m_memoryPressure = -1;
+    QElapsedTimer m_sampleTimer;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_MEMORYMONITOR_H
@@ -0,0 +1,135 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "pathatomtable.h"
+
+#include "qbsassert.h"
+
+#include <mutex>
+
+namespace qbs {
+namespace Internal {
+
+PathAtomTable &PathAtomTable::instance()
+{
+    static PathAtomTable table;
+    return table;
+}
+
+PathAtomTable::PathAtomTable() : m_chunks(new std::atomic<QString *>[maxChunkCount]())
+{
+    const Atom empty = insert(QStringView());
+    QBS_CHECK(empty == emptyAtom);
+}
+
+PathAtomTable::~PathAtomTable()
+{
+    for (int i = 0; i < maxChunkCount; ++i)
+        delete[] m_chunks[i].load(std::memory_order_relaxed);
+}
+
+// An object that starts using the table while the last one goes away either increases
+// the count before it is checked, or it waits for the lock before it gets its first atom.
+void PathAtomTable::removeUse()
+{
+    if (m_useCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+    const std::unique_lock lock(m_mutex);
+    if (m_useCount.load(std::memory_order_acquire) == 0)
+        clear();
+}
+
+PathAtom PathAtomTable::atom(QStringView string)
+{
+    {
+        const std::shared_lock lock(m_mutex);
+        const auto it = m_atoms.constFind(string);
+        if (it != m_atoms.constEnd())
+            return it.value();
+    }
+
+    const std::unique_lock lock(m_mutex);
+    const auto it = m_atoms.constFind(string);
+    if (it != m_atoms.constEnd())
+        return it.value();
+    return insert(string);
+}
+
+PathAtom PathAtomTable::existingAtom(QStringView string) const
+{
+    const std::shared_lock lock(m_mutex);
+    return m_atoms.value(string, invalidAtom);
+}
+
+int PathAtomTable::size() const
+{
+    const std::shared_lock lock(m_mutex);
+    return int(m_size);
+}
+
+// Called with the lock held exclusively, or from the constructor.
+PathAtom PathAtomTable::insert(QStringView string)
+{
+    const Atom newAtom = m_size;
+    const int chunkIndex = newAtom >> chunkBits;
+    QBS_CHECK(chunkIndex < maxChunkCount);
+    QString *chunk = m_chunks[chunkIndex].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new QString[chunkSize];
+        m_chunks[chunkIndex].store(chunk, std::memory_order_release);
+    }
+    QString &storedString = chunk[newAtom & chunkMask];
+    storedString = string.toString();
+    m_atoms.insert(storedString, newAtom);
+    ++m_size;
+    return newAtom;
+}
+
+// Called with the lock held exclusively.
+void PathAtomTable::clear()
+{
+    m_atoms.clear();
+    for (int i = 0; i < maxChunkCount; ++i)
+        delete[] m_chunks[i].exchange(nullptr, std::memory_order_relaxed);
+    m_size = 0;
+    insert(QStringView());
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,125 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PATHATOMTABLE_H
+#define QBS_PATHATOMTABLE_H
+
+#include "qbs_export.h"
+
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <shared_mutex>
+
+namespace qbs {
+namespace Internal {
+
+/*!
+ * Interns the directory and file name components of file paths.
+ * The same directories and file names come up over and over again in artifacts, file
+ * dependencies and scan results, so each of them is stored only once for the whole process
+ * and referred to by an integer ID. Retrieving the string of an atom does not need to lock.
+ * Single atoms are never removed, but the table gets emptied once the last object using
+ * atoms is gone, so a long-running process does not keep the paths of closed projects.
+ */
+class QBS_AUTOTEST_EXPORT PathAtomTable
+{
+public:
+    using Atom = quint32;
+    static constexpr Atom emptyAtom = 0;
+    static constexpr Atom invalidAtom = std::numeric_limits<Atom>::max();
+
+    static PathAtomTable &instance();
+
+    PathAtomTable();
+    ~PathAtomTable();
+
+    Atom atom(QStringView string);
+    Atom existingAtom(QStringView string) const; // Returns invalidAtom if not interned yet.
+    const QString &string(Atom atom) const
+    {
+        return m_chunks[atom >> chunkBits].load(std::memory_order_acquire)[atom & chunkMask];
+    }
+    int size() const;
+
+    // Objects holding atoms of the global table have one of these as their first member.
+    class Use
+    {
+    public:
+        Use() { instance().addUse(); }
+        Use(const Use &) : Use() {}
+        Use &operator=(const Use &) { return *this; }
+        ~Use() { instance().removeUse(); }
+    };
+    void addUse() { m_useCount.fetch_add(1, std::memory_order_relaxed); }
+    void removeUse();
+
+    // For lookup tables indexed by directory and file name.
+    static quint64 pathKey(Atom dirAtom, Atom fileNameAtom)
+    {
+        return (quint64(dirAtom) << 32) | fileNameAtom;
+    }
+
+private:
+    Atom insert(QStringView string);
+    void clear();
+
+    static constexpr int chunkBits = 12;
+    static constexpr Atom chunkSize = 1 << chunkBits;
+    static constexpr Atom chunkMask = chunkSize - 1;
+    static constexpr int maxChunkCount = 1 << 16;
+
+    // The chunks never move, so the string of an atom can be accessed while
+    // other threads add new atoms.
+    const std::unique_ptr<std::atomic<QString *>[]> m_chunks;
+    mutable std::shared_mutex m_mutex;
+    QHash<QStringView, Atom> m_atoms; // Views into the chunks.
+    Atom m_size = 0;
+    std::atomic_int m_useCount = 0;
+};
+
+using PathAtom = PathAtomTable::Atom;
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PATHATOMTABLE_H
@@ -40,15 +40,50 @@
 #include "persistence.h"
 
 #include "fileinfo.h"
+#include "stlutils.h"
+#include <logging/categories.h>
 #include <logging/translator.h>
 #include <tools/error.h>
 
+#include <QtCore/qdatastream.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qrandom.h>
+#include <QtCore/qsavefile.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(Q_OS_WIN)
+#include <QtCore/qt_windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace qbs {
 namespace Internal {
 
-static const char QBS_PERSISTENCE_MAGIC[] = "QBSPERSISTENCE-147";
+// The file starts with the magic token, followed by the sections and the head data.
+// It ends with the offset of the head data, so that the head can be read without
+// looking at the sections. Integers are varint-encoded, strings are stored once per section
+// as UTF-8 and referenced by ID afterwards, see idStoreValue().
+static const char QBS_PERSISTENCE_MAGIC[] = "QBSPERSISTENCE-158";
+static const qsizetype magicSize = sizeof QBS_PERSISTENCE_MAGIC - 1;
+static const qsizetype headOffsetSize = sizeof(quint64);
+static const qsizetype writeChunkSize = 1 << 20;
+
+// The journal starts with its own magic token and the generation of the main file it belongs
+// to. It is followed by records, each of which consists of its size and the same kind of data
+// as the main file: the sections that were stored again, a head listing all sections
+// and the offset of that head. The size is filled in after the record has been written,
+// so a record that was cut off by a crash is recognizable as such and gets ignored.
+static const char QBS_JOURNAL_MAGIC[] = "QBSJOURNAL-153";
+static const qsizetype journalMagicSize = sizeof QBS_JOURNAL_MAGIC - 1;
+static const qsizetype journalHeaderSize = journalMagicSize + sizeof(quint64);
+static const qsizetype recordSizeSize = sizeof(quint64);
+static const int maxJournalRecords = 64;
 
 NoBuildGraphError::NoBuildGraphError(const QString &filePath)
     : ErrorInfo(Tr::tr("Build graph not found for configuration '%1'. Expected location was '%2'.")
@@ -56,10 +91,40 @@ NoBuildGraphError::NoBuildGraphError(const QString &filePath)
 {
 }
 
-PersistentPool::PersistentPool(Logger &logger) : m_logger(logger)
+static ErrorInfo invalidDataError()
+{
+    return ErrorInfo(Tr::tr("Failure loading build graph: The data is corrupt."));
+}
+
+static quint64 objectKey(const PersistentPool::ObjectRef &ref)
+{
+    return (quint64(quint32(ref.first)) << 32) | quint32(ref.second);
+}
+
+static quint64 readLittleEndian64(const char *data)
+{
+    quint64 value;
+    std::memcpy(&value, data, sizeof value);
+    return qFromLittleEndian(value);
+}
+
+// Maps the file, so strings and byte arrays are decoded directly from the page cache.
+// Falls back to reading it in one go on file systems that do not support mapping.
+static const char *mapFile(QFile &file, QByteArray &buffer, qint64 &size)
+{
+    buffer.clear();
+    size = file.size();
+    const uchar * const mappedData = size > 0 ? file.map(0, size) : nullptr;
+    if (mappedData)
+        return reinterpret_cast<const char *>(mappedData);
+    buffer = file.readAll();
+    size = buffer.size();
+    return buffer.constData();
+}
+
+PersistentPool::PersistentPool(Logger logger) : m_logger(std::move(logger))
 {
     Q_UNUSED(m_logger);
-    m_stream.setVersion(QDataStream::Qt_4_8);
 }
 
 PersistentPool::~PersistentPool() = default;
@@ -74,80 +139,765 @@ void PersistentPool::load(const QString &filePath)
                     .arg(filePath, file->errorString()));
     }
 
-    m_stream.setDevice(file.get());
-    QByteArray magic;
-    m_stream >> magic;
-    if (magic != QBS_PERSISTENCE_MAGIC) {
-        m_stream.setDevice(nullptr);
+    m_data = nullptr;
+    m_readPos = m_readEnd = nullptr;
+    qint64 fileSize;
+    const char * const data = mapFile(*file, m_readBuffer, fileSize);
+    const QByteArray magic(data, std::min(magicSize, qsizetype(fileSize)));
+    if (magic != QByteArray(QBS_PERSISTENCE_MAGIC)) {
+        m_readBuffer.clear();
         throw ErrorInfo(Tr::tr("Cannot use stored build graph at '%1': Incompatible file format. "
                            "Expected magic token '%2', got '%3'.")
                     .arg(filePath, QLatin1String(QBS_PERSISTENCE_MAGIC),
                          QString::fromLatin1(magic)));
     }
+    if (fileSize < magicSize + headOffsetSize)
+        throw invalidDataError();
+    const quint64 headOffset = readLittleEndian64(data + fileSize - headOffsetSize);
+    if (headOffset < quint64(magicSize) || headOffset > quint64(fileSize - headOffsetSize))
+        throw invalidDataError();
 
-    m_stream >> m_headData.projectConfig;
+    m_filePath = filePath;
     m_file = std::move(file);
-    m_loadedRaw.clear();
-    m_loaded.clear();
-    m_storageIndices.clear();
-    m_stringStorage.clear();
-    m_inverseStringStorage.clear();
+    m_data = data;
+    m_mainDataSize = qint64(headOffset);
+    m_loadedSections.clear();
+    m_loadedObjectRefs.clear();
+    loadHead(m_data + headOffset, m_data + fileSize - headOffsetSize, m_headData, m_generation);
+    for (const SectionInfo &section : std::as_const(m_headData.sections)) {
+        if (section.journaled || section.offset < magicSize || section.size < 0
+                || section.offset + section.size > m_mainDataSize) {
+            throw invalidDataError();
+        }
+    }
+    loadJournal();
+    m_loadedSections.resize(m_headData.sections.size());
+}
+
+void PersistentPool::loadHead(const char *begin, const char *end, HeadData &headData,
+                              quint64 &generation)
+{
+    m_headSection = LoadedSection();
+    m_currentLoadSection = &m_headSection;
+    m_currentLoadSectionIndex = -1;
+    m_readPos = begin;
+    m_readEnd = end;
+    load(headData.projectConfig, headData.sections, generation);
+    const bool complete = m_readPos == m_readEnd;
+    m_headSection = LoadedSection();
+    m_currentLoadSection = nullptr;
+    m_readPos = m_readEnd = nullptr;
+    if (!complete)
+        throw invalidDataError();
+}
+
+// A journal that does not belong to the main file, e.g. because the process got killed
+// between writing a new main file and removing the old journal, is ignored, and so are
+// incomplete records at its end.
+void PersistentPool::loadJournal()
+{
+    m_journalFile.reset();
+    m_journalBuffer.clear();
+    m_journalData = nullptr;
+    m_journalSize = 0;
+    m_journalRecordCount = 0;
+
+    std::unique_ptr<QFile> file(new QFile(journalFilePath(m_filePath)));
+    if (!file->open(QFile::ReadOnly))
+        return;
+    QByteArray buffer;
+    qint64 fileSize;
+    const char * const data = mapFile(*file, buffer, fileSize);
+    if (fileSize < journalHeaderSize
+            || QByteArray(data, journalMagicSize) != QByteArray(QBS_JOURNAL_MAGIC)
+            || readLittleEndian64(data + journalMagicSize) != m_generation) {
+        qCDebug(lcBuildGraph) << "ignoring journal that does not belong to" << m_filePath;
+        return;
+    }
+
+    qint64 pos = journalHeaderSize;
+    while (fileSize - pos >= recordSizeSize) {
+        const quint64 recordSize = readLittleEndian64(data + pos);
+        if (recordSize < quint64(headOffsetSize)
+                || recordSize > quint64(fileSize - pos - recordSizeSize)) {
+            break;
+        }
+        const qint64 recordEnd = pos + recordSizeSize + qint64(recordSize);
+        const quint64 headOffset = readLittleEndian64(data + recordEnd - headOffsetSize);
+        if (headOffset < quint64(pos + recordSizeSize)
+                || headOffset > quint64(recordEnd - headOffsetSize)) {
+            break;
+        }
+        HeadData headData;
+        quint64 generation;
+        try {
+            loadHead(data + headOffset, data + recordEnd - headOffsetSize, headData, generation);
+        } catch (const ErrorInfo &) {
+            break;
+        }
+        const bool sectionsAreValid = generation == m_generation
+                && Internal::all_of(headData.sections, [&](const SectionInfo &section) {
+            const qint64 begin = section.journaled ? journalHeaderSize : magicSize;
+            const qint64 end = section.journaled ? qint64(headOffset) : m_mainDataSize;
+            return section.offset >= begin && section.size >= 0
+                    && section.offset + section.size <= end;
+        });
+        if (!sectionsAreValid)
+            break;
+        m_headData = headData;
+        ++m_journalRecordCount;
+        pos = recordEnd;
+    }
+    if (pos != fileSize)
+        qCDebug(lcBuildGraph) << "ignoring incomplete data at the end of the journal";
+
+    m_journalFile = std::move(file);
+    m_journalBuffer = buffer;
+    m_journalData = data;
+    m_journalSize = pos;
+}
+
+QString PersistentPool::journalFilePath(const QString &filePath)
+{
+    return filePath + QStringLiteral(".journal");
+}
+
+bool PersistentPool::journalNeedsCompaction() const
+{
+    return m_journalRecordCount >= maxJournalRecords || m_journalSize > m_mainDataSize / 2;
+}
+
+int PersistentPool::sectionIndex(const QString &key) const
+{
+    for (int i = 0; i < sectionCount(); ++i) {
+        if (m_headData.sections[i].key == key)
+            return i;
+    }
+    return -1;
+}
+
+bool PersistentPool::isSectionLoaded(int section) const
+{
+    return m_loadedSections.at(section).state != LoadedSection::NotLoaded;
+}
+
+bool PersistentPool::allSectionsLoaded() const
+{
+    return Internal::all_of(m_loadedSections, [](const LoadedSection &section) {
+        return section.state == LoadedSection::Loaded;
+    });
+}
+
+std::vector<int> PersistentPool::unloadedSectionsReferringTo(const void *object) const
+{
+    std::vector<int> sections;
+    const auto it = m_loadedObjectRefs.find(object);
+    if (it == m_loadedObjectRefs.cend())
+        return sections;
+    for (int i = 0; i < sectionCount(); ++i) {
+        if (m_loadedSections[i].state != LoadedSection::NotLoaded)
+            continue;
+        const std::vector<ObjectRef> &foreignObjects = m_headData.sections[i].foreignObjects;
+        if (std::binary_search(foreignObjects.cbegin(), foreignObjects.cend(), it->second))
+            sections.push_back(i);
+    }
+    return sections;
 }
 
-void PersistentPool::setupWriteStream(const QString &filePath)
+PersistentPool::ReadState PersistentPool::beginLoadSection(int section)
 {
+    QBS_CHECK(section >= 0 && section < sectionCount());
+    LoadedSection &loadedSection = m_loadedSections[section];
+    QBS_CHECK(loadedSection.state == LoadedSection::NotLoaded);
+    const ReadState previousState{m_currentLoadSectionIndex, m_readPos, m_readEnd};
+    loadedSection.state = LoadedSection::Loading;
+    m_currentLoadSection = &loadedSection;
+    m_currentLoadSectionIndex = section;
+    m_readPos = sectionData(section);
+    m_readEnd = m_readPos + m_headData.sections[section].size;
+    return previousState;
+}
+
+void PersistentPool::endLoadSection(const ReadState &previousState)
+{
+    LoadedSection &loadedSection = *m_currentLoadSection;
+    if (m_readPos != m_readEnd)
+        throw invalidDataError();
+
+    // Every object that was referenced must have been defined by now.
+    for (std::size_t id = 0; id < loadedSection.defined.size(); ++id) {
+        if (!loadedSection.defined[id]
+                && (loadedSection.rawObjects[id] || loadedSection.sharedObjects[id])) {
+            throw invalidDataError();
+        }
+    }
+    loadedSection.state = LoadedSection::Loaded;
+    loadedSection.strings = {};
+    loadedSection.environments = {};
+    loadedSection.stringLists = {};
+
+    m_currentLoadSectionIndex = previousState.section;
+    m_currentLoadSection = previousState.section >= 0
+            ? &m_loadedSections[previousState.section] : nullptr;
+    m_readPos = previousState.pos;
+    m_readEnd = previousState.end;
+}
+
+PersistentPool::LoadedReference PersistentPool::loadObjectReference()
+{
+    const quint64 value = readVarUInt();
+    if (value == 0)
+        return {};
+    const quint64 id = value >> 2;
+    const quint64 kind = value & 3;
+    if (kind == 0 || id > quint64(std::numeric_limits<PersistentObjectId>::max())
+            || m_currentLoadSectionIndex < 0) {
+        throw invalidDataError();
+    }
+    LoadedReference ref;
+    ref.section = m_currentLoadSectionIndex;
+    ref.id = PersistentObjectId(id);
+    ref.isDefinition = kind == Definition;
+    if (kind == ForeignReference) {
+        const quint64 section = readVarUInt();
+        if (section >= quint64(m_loadedSections.size()) || int(section) == ref.section)
+            throw invalidDataError();
+        ref.section = int(section);
+        if (m_loadedSections[ref.section].state == LoadedSection::NotLoaded && m_sectionLoader)
+            m_sectionLoader(ref.section);
+        if (m_loadedSections[ref.section].state == LoadedSection::NotLoaded) {
+            throw ErrorInfo(Tr::tr("Failure loading build graph: Section '%1' is required, "
+                                   "but was not loaded.")
+                            .arg(m_headData.sections[ref.section].key));
+        }
+    }
+
+    LoadedSection &section = m_loadedSections[ref.section];
+    if (std::size_t(ref.id) >= section.defined.size()) {
+        if (section.state == LoadedSection::Loaded)
+            throw invalidDataError();
+        section.rawObjects.resize(ref.id + 1);
+        section.sharedObjects.resize(ref.id + 1);
+        section.defined.resize(ref.id + 1);
+    } else if (ref.isDefinition ? bool(section.defined[ref.id])
+                                : !section.defined[ref.id]
+                                  && section.state == LoadedSection::Loaded) {
+        throw invalidDataError();
+    }
+    return ref;
+}
+
+void PersistentPool::registerLoadedObject(const LoadedReference &ref, const void *address)
+{
+    m_loadedSections[ref.section].defined[ref.id] = true;
+    if (m_keepObjectIds)
+        m_loadedObjectRefs[address] = ObjectRef(ref.section, ref.id);
+}
+
+// The sections that were not loaded are needed for copying, but the file is about to be
+// replaced, so we keep their data in memory.
+void PersistentPool::detachFromFile()
+{
+    QBS_CHECK(m_currentLoadSectionIndex < 0);
+    if (!m_file)
+        return;
+    QByteArray buffer;
+    for (int i = 0; i < sectionCount(); ++i) {
+        if (m_loadedSections[i].state != LoadedSection::NotLoaded)
+            continue;
+        SectionInfo &section = m_headData.sections[i];
+        const qint64 offset = buffer.size();
+        buffer.append(sectionData(i), section.size);
+        section.offset = offset;
+        section.journaled = false;
+    }
+    m_readBuffer = buffer;
+    m_data = m_readBuffer.constData();
+    m_file.reset();
+    m_journalFile.reset();
+    m_journalBuffer.clear();
+    m_journalData = nullptr;
+}
+
+void PersistentPool::setupWriteStream(const QString &filePath, PersistentPool *loadedPool)
+{
+    QBS_CHECK(loadedPool != this);
+    if (loadedPool)
+        loadedPool->detachFromFile();
+
     QString dirPath = FileInfo::path(filePath);
     if (!FileInfo::exists(dirPath) && !QDir().mkpath(dirPath)) {
         throw ErrorInfo(Tr::tr("Failure storing build graph: Cannot create directory '%1'.")
                         .arg(dirPath));
     }
 
-    if (QFile::exists(filePath) && !QFile::remove(filePath)) {
-        throw ErrorInfo(Tr::tr("Failure storing build graph: Cannot remove old file '%1'")
-                        .arg(filePath));
-    }
-    QBS_CHECK(!QFile::exists(filePath));
-    std::unique_ptr<QFile> file(new QFile(filePath));
+    // The old file gets replaced only once the new one is complete.
+    std::unique_ptr<QSaveFile> file(new QSaveFile(filePath));
     if (!file->open(QFile::WriteOnly)) {
         throw ErrorInfo(Tr::tr("Failure storing build graph: "
                 "Cannot open file '%1' for writing: %2").arg(filePath, file->errorString()));
     }
 
-    m_stream.setDevice(file.get());
+    m_filePath = filePath;
+    m_writeFile = std::move(file);
+    m_writingJournal = false;
+    m_generation = QRandomGenerator::global()->generate64();
+    m_writeOffset = 0;
+    setupWriteStreamCommon(loadedPool);
+    if (loadedPool) {
+        for (int i = 0; i < loadedPool->sectionCount(); ++i)
+            m_sectionsToCopy[i] = !loadedPool->isSectionLoaded(i);
+    }
+
+    // The real magic token is written last, so that an incomplete file is never considered valid.
+    const QByteArray placeholder(magicSize, '\0');
+    writeRaw(placeholder.constData(), placeholder.size());
+}
+
+void PersistentPool::setupJournalWriteStream(PersistentPool *loadedPool,
+                                             const std::vector<bool> &sectionsToCopy)
+{
+    QBS_CHECK(loadedPool && loadedPool != this);
+    QBS_CHECK(int(sectionsToCopy.size()) == loadedPool->sectionCount());
+    m_filePath = loadedPool->m_filePath;
+    m_writeFile.reset();
+    m_writingJournal = true;
+    m_generation = loadedPool->m_generation;
+    m_createJournal = loadedPool->m_journalSize == 0;
+    m_journalRecordOffset = m_createJournal ? journalHeaderSize : loadedPool->m_journalSize;
+    m_writeOffset = m_journalRecordOffset + recordSizeSize;
+    setupWriteStreamCommon(loadedPool);
+    for (int i = 0; i < loadedPool->sectionCount(); ++i) {
+        QBS_CHECK(sectionsToCopy[i] || loadedPool->isSectionLoaded(i));
+        m_sectionsToCopy[i] = sectionsToCopy[i];
+    }
+}
+
+// All other sections are considered copied, so objects from there are stored as references,
+// just like in a journal record.
+void PersistentPool::setupSnapshotStream(PersistentPool *loadedPool, int section)
+{
+    QBS_CHECK(loadedPool && loadedPool != this);
+    m_writeFile.reset();
+    m_writingJournal = true;
+    m_writeOffset = 0;
+    setupWriteStreamCommon(loadedPool);
+    for (int i = 0; i < loadedPool->sectionCount(); ++i)
+        m_sectionsToCopy[i] = i != section;
+    for (int i = 0; i < section; ++i)
+        copySection(i);
+}
+
+void PersistentPool::setupWriteStreamCommon(PersistentPool *loadedPool)
+{
+    m_writeError = false;
+    m_writeBuffer.clear();
+    m_writeBuffer.reserve(writeChunkSize);
+    m_loadedPool = loadedPool;
+    m_headData.sections.clear();
+    m_currentStoreSection = -1;
+    m_storageIndices.clear();
+    m_nextObjectIds.clear();
+    m_currentForeignObjects.clear();
+    m_sectionsToCopy.assign(loadedPool ? loadedPool->sectionCount() : 0, false);
+    m_copiedSections.clear();
+    m_definedObjects.clear();
+    resetWriteValueStorage();
+}
+
+void PersistentPool::beginStoreSection(const QString &key)
+{
+    QBS_CHECK(m_currentStoreSection < 0);
+    const int section = sectionCount();
+    PersistentObjectId firstObjectId = 0;
+    if (m_loadedPool) {
+        // Objects keep their IDs, so new ones must not collide with these.
+        QBS_CHECK(section < m_loadedPool->sectionCount());
+        QBS_CHECK(m_loadedPool->m_headData.sections[section].key == key);
+        QBS_CHECK(!m_sectionsToCopy[section]);
+        const LoadedSection &loadedSection = m_loadedPool->m_loadedSections[section];
+        QBS_CHECK(loadedSection.state == LoadedSection::Loaded);
+        firstObjectId = PersistentObjectId(loadedSection.defined.size());
+    }
+    SectionInfo info;
+    info.key = key;
+    info.offset = m_writeOffset;
+    info.journaled = m_writingJournal;
+    m_headData.sections.push_back(info);
+    m_nextObjectIds.push_back(firstObjectId);
+    m_copiedSections.push_back(false);
+    m_currentStoreSection = section;
+    m_currentForeignObjects.clear();
+    resetWriteValueStorage();
+}
+
+void PersistentPool::endStoreSection()
+{
+    QBS_CHECK(m_currentStoreSection >= 0);
+    SectionInfo &info = m_headData.sections.back();
+    info.size = m_writeOffset - info.offset;
+    std::sort(m_currentForeignObjects.begin(), m_currentForeignObjects.end());
+    m_currentForeignObjects.erase(std::unique(m_currentForeignObjects.begin(),
+                                              m_currentForeignObjects.end()),
+                                  m_currentForeignObjects.end());
+    info.foreignObjects = std::move(m_currentForeignObjects);
+    m_currentForeignObjects.clear();
+    m_currentStoreSection = -1;
+}
+
+void PersistentPool::copySection(int loadedSection)
+{
+    QBS_CHECK(m_loadedPool);
+    QBS_CHECK(m_currentStoreSection < 0);
+    QBS_CHECK(loadedSection == sectionCount());
+    QBS_CHECK(m_sectionsToCopy[loadedSection]);
+    SectionInfo info = m_loadedPool->m_headData.sections[loadedSection];
+    if (!m_writingJournal) {
+        const char * const data = m_loadedPool->sectionData(loadedSection);
+        info.offset = m_writeOffset;
+        info.journaled = false;
+        writeRaw(data, info.size);
+    }
+    m_headData.sections.push_back(info);
+    m_nextObjectIds.push_back(0);
+    m_copiedSections.push_back(true);
+}
+
+// Copied sections refer to objects by the IDs they had when the file was loaded. This is only
+// valid if all of these objects were stored again under the same ID.
+bool PersistentPool::copiedSectionsAreConsistent() const
+{
+    for (const auto &stored : m_storageIndices) {
+        if (!stored.second.defined)
+            return false;
+    }
+    for (std::size_t i = 0; i < m_copiedSections.size(); ++i) {
+        if (!m_copiedSections[i])
+            continue;
+        for (const ObjectRef &ref : m_headData.sections[i].foreignObjects) {
+            if (ref.first >= int(m_copiedSections.size()))
+                return false;
+            if (!m_copiedSections[ref.first] && !m_definedObjects.count(objectKey(ref)))
+                return false;
+        }
+    }
+    return true;
+}
+
+void PersistentPool::finalizeWriteStream()
+{
+    QBS_CHECK(m_currentStoreSection < 0);
+    const quint64 headOffset = qToLittleEndian(quint64(m_writeOffset));
+    resetWriteValueStorage();
+    store(m_headData.projectConfig, m_headData.sections, m_generation);
+    writeRaw(&headOffset, sizeof headOffset);
+    m_loadedPool = nullptr;
+    if (m_writingJournal) {
+        finalizeJournalRecord();
+        return;
+    }
+
+    const auto file = static_cast<QSaveFile *>(m_writeFile.get());
+    flushWriteBuffer();
+    if (!m_writeError) {
+        m_writeError = !file->flush() || !file->seek(0)
+                || file->write(QBS_PERSISTENCE_MAGIC, magicSize) != magicSize
+                || !file->commit();
+    }
+    const QString errorString = file->errorString();
+    m_writeFile.reset();
+    if (m_writeError)
+        throw ErrorInfo(Tr::tr("Failure serializing build graph: %1").arg(errorString));
+    m_mainDataSize = qint64(qFromLittleEndian(headOffset));
+    m_journalSize = 0;
+    m_journalRecordCount = 0;
+
+    // The old journal cannot be mistaken for one belonging to the new file, as the generation
+    // differs, so there is no harm if this fails.
+    QFile::remove(journalFilePath(m_filePath));
+}
+
+// QFile::flush() only hands the data over to the operating system.
+static bool syncToDisk(QFile &file)
+{
+    if (!file.flush())
+        return false;
+#if defined(Q_OS_WIN)
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle())));
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+void PersistentPool::finalizeJournalRecord()
+{
+    QFile file(journalFilePath(m_filePath));
+    bool success = file.open(QFile::ReadWrite);
+    if (success && m_createJournal) {
+        QByteArray header(QBS_JOURNAL_MAGIC, journalMagicSize);
+        const quint64 generation = qToLittleEndian(m_generation);
+        header.append(reinterpret_cast<const char *>(&generation), sizeof generation);
+        success = file.resize(0) && file.write(header) == header.size();
+    }
+
+    // Incomplete data from an earlier attempt is cut off first. The record data must be on disk
+    // before its size is, or a crash could leave behind a valid-looking record with garbage.
+    const quint64 recordSize = qToLittleEndian(
+                quint64(m_writeOffset - m_journalRecordOffset - recordSizeSize));
+    const QByteArray placeholder(recordSizeSize, '\0');
+    success = success
+            && (file.size() == m_journalRecordOffset || file.resize(m_journalRecordOffset))
+            && file.seek(m_journalRecordOffset)
+            && file.write(placeholder) == recordSizeSize
+            && file.write(m_writeBuffer) == m_writeBuffer.size() && syncToDisk(file)
+            && file.seek(m_journalRecordOffset)
+            && file.write(reinterpret_cast<const char *>(&recordSize), recordSizeSize)
+                == recordSizeSize
+            && syncToDisk(file);
+    m_writeBuffer.clear();
+    if (!success) {
+        const QString errorString = file.errorString();
+        file.resize(m_journalRecordOffset);
+        throw ErrorInfo(Tr::tr("Failure serializing build graph: %1").arg(errorString));
+    }
+    m_journalSize = m_writeOffset;
+}
+
+void PersistentPool::adoptStoredData(const PersistentPool &storingPool)
+{
+    QBS_CHECK(m_currentLoadSectionIndex < 0);
+    QBS_CHECK(&storingPool != this);
+    const std::vector<SectionInfo> &storedSections = storingPool.m_headData.sections;
+    QBS_CHECK(m_loadedSections.empty() || m_loadedSections.size() == storedSections.size());
+    m_loadedSections.resize(storedSections.size());
+    m_keepObjectIds = true;
+
+    // Objects of the sections that were written anew are known under their new IDs now.
+    for (auto it = m_loadedObjectRefs.begin(); it != m_loadedObjectRefs.end();) {
+        if (storingPool.m_copiedSections[it->second.first])
+            ++it;
+        else
+            it = m_loadedObjectRefs.erase(it);
+    }
+    for (const auto &stored : storingPool.m_storageIndices) {
+        if (stored.second.defined && !storingPool.m_copiedSections[stored.second.ref.first])
+            m_loadedObjectRefs[stored.first] = stored.second.ref;
+    }
+    for (std::size_t i = 0; i < storedSections.size(); ++i) {
+        if (storingPool.m_copiedSections[i])
+            continue;
+        LoadedSection &section = m_loadedSections[i];
+        const std::size_t objectCount = std::max(section.defined.size(),
+                                                 std::size_t(storingPool.m_nextObjectIds[i]));
+        section.state = LoadedSection::Loaded;
+        section.defined.resize(objectCount, true);
+        section.rawObjects.resize(objectCount);
+        section.sharedObjects.resize(objectCount);
+    }
+
+    m_headData = storingPool.m_headData;
+    m_generation = storingPool.m_generation;
+    if (storingPool.m_writingJournal) {
+        m_journalSize = storingPool.m_journalSize;
+        m_journalRecordCount = storingPool.m_createJournal ? 1 : m_journalRecordCount + 1;
+        return;
+    }
+
+    // The sections that were copied are now in the new file.
+    m_filePath = storingPool.m_filePath;
+    m_readBuffer.clear();
+    m_data = nullptr;
+    m_journalFile.reset();
+    m_journalBuffer.clear();
+    m_journalData = nullptr;
+    m_journalSize = 0;
+    m_journalRecordCount = 0;
+    m_mainDataSize = storingPool.m_mainDataSize;
+    std::unique_ptr<QFile> file(new QFile(m_filePath));
+    if (!file->open(QFile::ReadOnly)) {
+        throw ErrorInfo(Tr::tr("Could not open open build graph file '%1': %2")
+                    .arg(m_filePath, file->errorString()));
+    }
+    qint64 fileSize;
+    m_data = mapFile(*file, m_readBuffer, fileSize);
     m_file = std::move(file);
-    m_stream << QByteArray(qstrlen(QBS_PERSISTENCE_MAGIC), 0) << m_headData.projectConfig;
-    m_lastStoredObjectId = 0;
+}
+
+void PersistentPool::resetWriteValueStorage()
+{
     m_lastStoredStringId = 0;
     m_lastStoredEnvId = 0;
     m_lastStoredStringListId = 0;
+    m_inverseStringStorage.clear();
+    m_inverseEnvStorage.clear();
+    m_inverseStringListStorage.clear();
 }
 
-void PersistentPool::finalizeWriteStream()
+bool PersistentPool::storeObjectReference(const void *address)
 {
-    if (m_stream.status() != QDataStream::Ok)
-        throw ErrorInfo(Tr::tr("Failure serializing build graph."));
-    m_stream.device()->seek(0);
-    m_stream << QByteArray(QBS_PERSISTENCE_MAGIC);
-    if (m_stream.status() != QDataStream::Ok)
-        throw ErrorInfo(Tr::tr("Failure serializing build graph."));
-    const auto file = static_cast<QFile *>(m_stream.device());
-    if (!file->flush()) {
-        file->close();
-        file->remove();
-        throw ErrorInfo(Tr::tr("Failure serializing build graph: %1").arg(file->errorString()));
+    QBS_CHECK(m_currentStoreSection >= 0);
+    const auto it = m_storageIndices.find(address);
+    if (it != m_storageIndices.end()) {
+        StoredObject &stored = it->second;
+        if (stored.ref.first != m_currentStoreSection) {
+            storeForeignReference(stored.ref);
+            return false;
+        }
+        if (stored.defined) {
+            writeVarUInt((quint64(stored.ref.second) << 2) | LocalReference);
+            return false;
+        }
+
+        // An earlier section referred to the object, expecting it to be defined here.
+        stored.defined = true;
+        m_definedObjects.insert(objectKey(stored.ref));
+        writeVarUInt((quint64(stored.ref.second) << 2) | Definition);
+        return true;
+    }
+
+    ObjectRef ref(m_currentStoreSection, -1);
+    if (m_loadedPool) {
+        const auto loadedIt = m_loadedPool->m_loadedObjectRefs.find(address);
+        if (loadedIt != m_loadedPool->m_loadedObjectRefs.cend()) {
+            const ObjectRef &loadedRef = loadedIt->second;
+            if (loadedRef.first != m_currentStoreSection && m_sectionsToCopy[loadedRef.first]) {
+                // The section is kept as it is, so it still defines the object.
+                m_storageIndices.emplace(address, StoredObject{loadedRef, true});
+                storeForeignReference(loadedRef);
+                return false;
+            }
+            if (loadedRef.first == m_currentStoreSection) {
+                ref.second = loadedRef.second;
+            } else if (loadedRef.first > m_currentStoreSection) {
+                m_storageIndices.emplace(address, StoredObject{loadedRef, false});
+                storeForeignReference(loadedRef);
+                return false;
+            }
+        }
     }
+    if (ref.second < 0)
+        ref.second = m_nextObjectIds[m_currentStoreSection]++;
+    m_storageIndices.emplace(address, StoredObject{ref, true});
+    if (m_loadedPool)
+        m_definedObjects.insert(objectKey(ref));
+    writeVarUInt((quint64(ref.second) << 2) | Definition);
+    return true;
+}
+
+void PersistentPool::storeForeignReference(const ObjectRef &ref)
+{
+    writeVarUInt((quint64(ref.second) << 2) | ForeignReference);
+    writeVarUInt(quint64(ref.first));
+    m_currentForeignObjects.push_back(ref);
+}
+
+void PersistentPool::writeRaw(const void *data, qsizetype size)
+{
+    m_writeOffset += size;
+    m_writeBuffer.append(static_cast<const char *>(data), size);
+    if (m_writeBuffer.size() >= writeChunkSize)
+        flushWriteBuffer();
+}
+
+void PersistentPool::writeVarUInt(quint64 value)
+{
+    char bytes[10];
+    int count = 0;
+    while (value >= 0x80) {
+        bytes[count++] = char((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    bytes[count++] = char(value);
+    writeRaw(bytes, count);
+}
+
+void PersistentPool::flushWriteBuffer()
+{
+    if (m_writeBuffer.isEmpty() || m_writingJournal)
+        return;
+    if (!m_writeError && m_writeFile->write(m_writeBuffer) != m_writeBuffer.size())
+        m_writeError = true;
+    m_writeBuffer.resize(0);
+}
+
+const char *PersistentPool::readRaw(qsizetype size)
+{
+    if (size < 0 || size > m_readEnd - m_readPos)
+        throw ErrorInfo(Tr::tr("Failure loading build graph: Unexpected end of data."));
+    const char * const data = m_readPos;
+    m_readPos += size;
+    return data;
+}
+
+quint64 PersistentPool::readVarUInt()
+{
+    quint64 value = 0;
+    for (int shift = 0; shift < 64 && m_readPos != m_readEnd; shift += 7) {
+        const auto byte = quint8(*m_readPos++);
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+    if (m_readPos == m_readEnd)
+        throw ErrorInfo(Tr::tr("Failure loading build graph: Unexpected end of data."));
+    throw ErrorInfo(Tr::tr("Failure loading build graph: Invalid integer encoding."));
+}
+
+// Types without a dedicated encoding are rare in the build graph; they are serialized
+// via QDataStream into an opaque byte array.
+static QByteArray variantToBlob(const QVariant &variant)
+{
+    QByteArray blob;
+    QDataStream stream(&blob, QIODevice::WriteOnly);
+    stream.setVersion(dataStreamVersion);
+    stream << variant;
+    return blob;
+}
+
+static QVariant variantFromBlob(const QByteArray &blob)
+{
+    QDataStream stream(blob);
+    stream.setVersion(dataStreamVersion);
+    QVariant variant;
+    stream >> variant;
+    return variant;
 }
 
 void PersistentPool::storeVariant(const QVariant &variant)
 {
     if (variant.isNull()) {
-        m_stream << quint32(QMetaType::User);
-        m_stream << variant;
+        store(quint32(QMetaType::User), variantToBlob(variant));
         return;
     }
     const auto type = static_cast<quint32>(variant.userType());
-    m_stream << type;
+    store(type);
     switch (type) {
+    case QMetaType::Bool:
+        store(variant.toBool());
+        break;
+    case QMetaType::Int:
+        store(variant.toInt());
+        break;
+    case QMetaType::UInt:
+        store(variant.toUInt());
+        break;
+    case QMetaType::LongLong:
+        store(variant.toLongLong());
+        break;
+    case QMetaType::ULongLong:
+        store(variant.toULongLong());
+        break;
+    case QMetaType::Double: {
+        const double d = variant.toDouble();
+        quint64 bits;
+        std::memcpy(&bits, &d, sizeof bits);
+        bits = qToLittleEndian(bits);
+        writeRaw(&bits, sizeof bits);
+        break;
+    }
+    case QMetaType::QByteArray:
+        store(variant.toByteArray());
+        break;
     case QMetaType::QString:
         store(variant.toString());
         break;
@@ -161,7 +911,7 @@ void PersistentPool::storeVariant(const QVariant &variant)
         store(variant.toMap());
         break;
     default:
-        m_stream << variant;
+        store(variantToBlob(variant));
     }
 }
 
@@ -170,6 +920,33 @@ QVariant PersistentPool::loadVariant()
     const auto type = load<quint32>();
     QVariant value;
     switch (type) {
+    case QMetaType::Bool:
+        value = load<bool>();
+        break;
+    case QMetaType::Int:
+        value = load<int>();
+        break;
+    case QMetaType::UInt:
+        value = load<uint>();
+        break;
+    case QMetaType::LongLong:
+        value = load<qlonglong>();
+        break;
+    case QMetaType::ULongLong:
+        value = load<qulonglong>();
+        break;
+    case QMetaType::Double: {
+        quint64 bits;
+        std::memcpy(&bits, readRaw(sizeof bits), sizeof bits);
+        bits = qFromLittleEndian(bits);
+        double d;
+        std::memcpy(&d, &bits, sizeof d);
+        value = d;
+        break;
+    }
+    case QMetaType::QByteArray:
+        value = load<QByteArray>();
+        break;
     case QMetaType::QString:
         value = load<QString>();
         break;
@@ -183,28 +960,21 @@ QVariant PersistentPool::loadVariant()
         value = load<QVariantMap>();
         break;
     default:
-        m_stream >> value;
+        value = variantFromBlob(load<QByteArray>());
     }
     return value;
 }
 
-void PersistentPool::clear()
-{
-    m_loaded.clear();
-    m_storageIndices.clear();
-    m_stringStorage.clear();
-    m_inverseStringStorage.clear();
-}
-
 void PersistentPool::doLoadValue(QString &s)
 {
-    m_stream >> s;
+    const auto size = qsizetype(readVarUInt());
+    s = QString::fromUtf8(readRaw(size), size);
 }
 
 void PersistentPool::doLoadValue(QStringList &l)
 {
-    int size;
-    m_stream >> size;
+    const auto size = load<int>();
+    l.reserve(size);
     for (int i = 0; i < size; ++i)
         l << load<QString>();
 }
@@ -218,12 +988,14 @@ void PersistentPool::doLoadValue(QProcessEnvironment &env)
 
 void PersistentPool::doStoreValue(const QString &s)
 {
-    m_stream << s;
+    const QByteArray utf8 = s.toUtf8();
+    writeVarUInt(quint64(utf8.size()));
+    writeRaw(utf8.constData(), utf8.size());
 }
 
 void PersistentPool::doStoreValue(const QStringList &l)
 {
-    m_stream << int(l.size());
+    store(int(l.size()));
     for (const QString &s : l)
         store(s);
 }
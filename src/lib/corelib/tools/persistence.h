@@ -45,7 +45,9 @@
 #include <tools/qbsassert.h>
 #include <tools/qttools.h>
 
+#include <QtCore/qbytearray.h>
 #include <QtCore/qdatastream.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qflags.h>
 #include <QtCore/qprocess.h>
 #include <QtCore/qregularexpression.h>
@@ -53,15 +55,21 @@
 #include <QtCore/qstringlist.h>
 #include <QtCore/qvariant.h>
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace qbs {
 namespace Internal {
 
+// The QDataStream version of everything qbs serializes with it, be it for storing on disk
+// or for computing digests.
+constexpr QDataStream::Version dataStreamVersion = QDataStream::Qt_5_15;
+
 class NoBuildGraphError : public ErrorInfo
 {
 public:
@@ -71,16 +79,42 @@ public:
 template<typename T, typename Enable = void>
 struct PPHelper;
 
-class PersistentPool
+class QBS_AUTOTEST_EXPORT PersistentPool
 {
 public:
-    PersistentPool(Logger &logger);
+    PersistentPool(Logger logger);
     ~PersistentPool();
 
+    enum OpType { Store, Load };
+    using PersistentObjectId = int;
+
+    // Identifies an object by the section it is defined in and its ID within that section.
+    using ObjectRef = std::pair<int, PersistentObjectId>;
+
+    // The data is split into sections that can be decoded independently of each other.
+    // References to objects defined in other sections are listed in the index, so it is known
+    // which sections need to be loaded before an object can be removed and which
+    // sections can be copied verbatim when storing again.
+    class SectionInfo
+    {
+    public:
+        QString key;
+        qint64 offset = 0;
+        qint64 size = 0;
+        bool journaled = false; // The data is in the journal file rather than in the main file.
+        std::vector<ObjectRef> foreignObjects; // Sorted.
+
+        template<OpType opType> void completeSerializationOp(PersistentPool &pool)
+        {
+            pool.serializationOp<opType>(key, offset, size, journaled, foreignObjects);
+        }
+    };
+
     class HeadData
     {
     public:
         QVariantMap projectConfig;
+        std::vector<SectionInfo> sections; // Maintained by the pool.
     };
 
     template<typename ...Types> void store(const Types &...args)
@@ -98,7 +132,6 @@ public:
         return tmp;
     }
 
-    enum OpType { Store, Load };
     template<OpType type, typename ...Types> void serializationOp(const Types &...args)
     {
         static_assert(type == Store);
@@ -112,16 +145,91 @@ public:
             load(args...);
     }
 
+    // Reading. load() only reads the head data; the sections are decoded on request.
+    // If there is a journal for the file, the most recent version of each section is used.
     void load(const QString &filePath);
-    void setupWriteStream(const QString &filePath);
+    int sectionCount() const { return int(m_headData.sections.size()); }
+    int sectionIndex(const QString &key) const;
+    bool isSectionLoaded(int section) const;
+    bool allSectionsLoaded() const;
+    template<typename F> void loadSection(int section, const F &loadFunction);
+
+    // Called when an object from a section that has not been loaded yet is referenced.
+    // The function is expected to load that section.
+    using SectionLoader = std::function<void(int section)>;
+    void setSectionLoader(const SectionLoader &loader) { m_sectionLoader = loader; }
+
+    // Remembers which object was loaded from where, so that a pool storing the data again
+    // can keep the IDs and copy the sections that were not loaded.
+    void setKeepObjectIds(bool keep) { m_keepObjectIds = keep; }
+    std::vector<int> unloadedSectionsReferringTo(const void *object) const;
+    void forgetObject(const void *object) { m_loadedObjectRefs.erase(object); }
+
+    // Writing. If loadedPool is given, its sections must be stored or copied in their
+    // original order, and the ones that were not loaded must be copied.
+    void setupWriteStream(const QString &filePath, PersistentPool *loadedPool = nullptr);
+
+    // Like setupWriteStream(), but only the stored sections get written, as a new record
+    // in the journal of the loaded pool's file. The copied sections stay where they are.
+    void setupJournalWriteStream(PersistentPool *loadedPool,
+                                 const std::vector<bool> &sectionsToCopy);
+
+    template<typename F> void storeSection(const QString &key, const F &storeFunction);
+    void copySection(int loadedSection);
+    bool copiedSectionsAreConsistent() const;
     void finalizeWriteStream();
-    void clear();
+
+    // Makes the data that was just written by storingPool the base for the next write,
+    // as if it had been loaded. The sections stored by storingPool are considered loaded.
+    void adoptStoredData(const PersistentPool &storingPool);
+
+    // Debugging aid: The data that the given loaded section would be stored as if a journal
+    // record were written now. Nothing gets written; storeFunction gets the storing pool.
+    template<typename F> QByteArray sectionSnapshot(int section, const F &storeFunction);
+
+    // Whether the journal has grown so much that the next write should not go there.
+    bool journalNeedsCompaction() const;
+    static QString journalFilePath(const QString &filePath);
 
     const HeadData &headData() const { return m_headData; }
     void setHeadData(const HeadData &hd) { m_headData = hd; }
 
 private:
-    using PersistentObjectId = int;
+    struct LoadedSection
+    {
+        enum State { NotLoaded, Loading, Loaded };
+        State state = NotLoaded;
+        std::vector<void *> rawObjects;
+        std::vector<std::shared_ptr<void>> sharedObjects;
+        std::vector<bool> defined;
+        std::vector<QString> strings;
+        std::vector<QProcessEnvironment> environments;
+        std::vector<QStringList> stringLists;
+    };
+
+    struct LoadedReference
+    {
+        int section = -1; // -1 for null pointers.
+        PersistentObjectId id = 0;
+        bool isDefinition = false;
+    };
+
+    struct ReadState
+    {
+        int section = -1;
+        const char *pos = nullptr;
+        const char *end = nullptr;
+    };
+
+    struct StoredObject
+    {
+        ObjectRef ref;
+        bool defined = false;
+    };
+
+    // An object reference is written as (id << 2 | kind), followed by the section index
+    // for foreign references. Zero denotes a null pointer.
+    enum ReferenceKind { Definition = 1, LocalReference = 2, ForeignReference = 3 };
 
     template <typename T> T *idLoad();
     template <class T> std::shared_ptr<T> idLoadS();
@@ -132,10 +240,45 @@ private:
     void doLoadValue(QProcessEnvironment &env);
 
     template<typename T> void storeSharedObject(const T *object);
+    bool storeObjectReference(const void *address);
+    void storeForeignReference(const ObjectRef &ref);
+    LoadedReference loadObjectReference();
+    void registerLoadedObject(const LoadedReference &ref, const void *address);
+
+    void beginStoreSection(const QString &key);
+    void endStoreSection();
+    void setupWriteStreamCommon(PersistentPool *loadedPool);
+    void setupSnapshotStream(PersistentPool *loadedPool, int section);
+    void finalizeJournalRecord();
+    void resetWriteValueStorage();
+    ReadState beginLoadSection(int section);
+    void endLoadSection(const ReadState &previousState);
+    void loadHead(const char *begin, const char *end, HeadData &headData, quint64 &generation);
+    void loadJournal();
+    void detachFromFile();
+    const char *sectionData(int section) const
+    {
+        const SectionInfo &info = m_headData.sections[section];
+        return (info.journaled ? m_journalData : m_data) + info.offset;
+    }
 
     void storeVariant(const QVariant &variant);
     QVariant loadVariant();
 
+    // Low-level encoding. Integers are written as LEB128 varints (signed ones zigzag-encoded),
+    // so the many small IDs, sizes and enum values in the build graph take a single byte.
+    void writeRaw(const void *data, qsizetype size);
+    void writeVarUInt(quint64 value);
+    void writeVarInt(qint64 value) { writeVarUInt((quint64(value) << 1) ^ quint64(value >> 63)); }
+    void flushWriteBuffer();
+    const char *readRaw(qsizetype size);
+    quint64 readVarUInt();
+    qint64 readVarInt()
+    {
+        const quint64 v = readVarUInt();
+        return qint64(v >> 1) ^ -qint64(v & 1);
+    }
+
     template <typename T> void idStoreValue(const T &value);
 
     void doStoreValue(const QString &s);
@@ -150,24 +293,62 @@ private:
     static const inline PersistentObjectId EmptyValueId = -2;
     static const inline PersistentObjectId NullValueId = -3;
 
-    std::unique_ptr<QIODevice> m_file;
-    QDataStream m_stream;
+    QString m_filePath;
+    std::unique_ptr<QFile> m_file;
+    std::unique_ptr<QFile> m_journalFile;
+    std::unique_ptr<QFileDevice> m_writeFile;
+
+    // Data is collected here and written to m_writeFile in large chunks. Journal records
+    // are collected completely and only written in finalizeWriteStream().
+    QByteArray m_writeBuffer;
+    qint64 m_writeOffset = 0;
+    bool m_writeError = false;
+    bool m_writingJournal = false;
+    bool m_createJournal = false;
+    qint64 m_journalRecordOffset = 0;
+
+    // Points into the memory-mapped files, or into the buffers if mapping was not possible.
+    QByteArray m_readBuffer;
+    QByteArray m_journalBuffer;
+    const char *m_data = nullptr;
+    const char *m_journalData = nullptr;
+    const char *m_readPos = nullptr;
+    const char *m_readEnd = nullptr;
+    qint64 m_mainDataSize = 0; // The section data of the main file, i.e. without the head.
+    qint64 m_journalSize = 0; // The valid part of the journal file, 0 if there is none.
+    int m_journalRecordCount = 0;
+
     HeadData m_headData;
-    std::vector<void *> m_loadedRaw;
-    std::vector<std::shared_ptr<void>> m_loaded;
-    std::unordered_map<const void*, int> m_storageIndices;
-    PersistentObjectId m_lastStoredObjectId = 0;
 
-    std::vector<QString> m_stringStorage;
+    // Random number connecting a journal to the main file it was written for.
+    quint64 m_generation = 0;
+
+    // Load state. The head data is decoded with m_headSection, which has no objects.
+    std::vector<LoadedSection> m_loadedSections;
+    LoadedSection m_headSection;
+    LoadedSection *m_currentLoadSection = nullptr;
+    int m_currentLoadSectionIndex = -1;
+    SectionLoader m_sectionLoader;
+    bool m_keepObjectIds = false;
+    std::unordered_map<const void *, ObjectRef> m_loadedObjectRefs;
+
+    // Store state.
+    PersistentPool *m_loadedPool = nullptr;
+    int m_currentStoreSection = -1;
+    std::unordered_map<const void*, StoredObject> m_storageIndices;
+    std::vector<PersistentObjectId> m_nextObjectIds;
+    std::vector<ObjectRef> m_currentForeignObjects;
+    std::vector<bool> m_sectionsToCopy; // Indexed by the sections of the loaded pool.
+    std::vector<bool> m_copiedSections;
+    std::unordered_set<quint64> m_definedObjects; // Only filled when storing a loaded pool.
+
     QHash<QString, int> m_inverseStringStorage;
     PersistentObjectId m_lastStoredStringId = 0;
-    std::vector<QProcessEnvironment> m_envStorage;
     QHash<QProcessEnvironment, int> m_inverseEnvStorage;
     PersistentObjectId m_lastStoredEnvId = 0;
-    std::vector<QStringList> m_stringListStorage;
     QHash<QStringList, int> m_inverseStringListStorage;
     PersistentObjectId m_lastStoredStringListId = 0;
-    Logger &m_logger;
+    Logger m_logger;
 
     template<typename T, typename Enable>
     friend struct PPHelper;
@@ -175,47 +356,66 @@ private:
 
 template<typename T> inline const void *uniqueAddress(const T *t) { return t; }
 
+template<typename F> inline void PersistentPool::loadSection(int section, const F &loadFunction)
+{
+    const ReadState previousState = beginLoadSection(section);
+    loadFunction();
+    endLoadSection(previousState);
+}
+
+template<typename F>
+inline void PersistentPool::storeSection(const QString &key, const F &storeFunction)
+{
+    beginStoreSection(key);
+    storeFunction();
+    endStoreSection();
+}
+
+template<typename F>
+inline QByteArray PersistentPool::sectionSnapshot(int section, const F &storeFunction)
+{
+    PersistentPool pool(m_logger);
+    pool.setupSnapshotStream(this, section);
+    pool.beginStoreSection(m_headData.sections.at(section).key);
+    storeFunction(pool);
+    pool.endStoreSection();
+    return pool.m_writeBuffer;
+}
+
 template<typename T> inline void PersistentPool::storeSharedObject(const T *object)
 {
     if (!object) {
-        m_stream << -1;
+        writeVarUInt(0);
         return;
     }
-    const void * const addr = uniqueAddress(object);
-    const auto found = m_storageIndices.find(addr);
-    if (found == m_storageIndices.end()) {
-        PersistentObjectId id = m_lastStoredObjectId++;
-        m_storageIndices[addr] = id;
-        m_stream << id;
+    if (storeObjectReference(uniqueAddress(object)))
         store(*object);
-    } else {
-        m_stream << found->second;
-    }
 }
 
 template <typename T> inline T *PersistentPool::idLoad()
 {
-    PersistentObjectId id;
-    m_stream >> id;
-
-    if (id < 0)
+    const LoadedReference ref = loadObjectReference();
+    if (ref.section < 0)
         return nullptr;
 
-    if (id < static_cast<PersistentObjectId>(m_loadedRaw.size()))
-        return static_cast<T *>(m_loadedRaw.at(id));
-
-    auto i = m_loadedRaw.size();
-    m_loadedRaw.resize(id + 1);
-    for (; i < m_loadedRaw.size(); ++i)
-        m_loadedRaw[i] = nullptr;
-
-    const auto t = new T;
-    m_loadedRaw[id] = t;
-    load(*t);
+    // Objects referenced before their definition (possible for cycles across sections)
+    // are created right away and filled in when the definition is encountered.
+    LoadedSection &section = m_loadedSections[ref.section];
+    void *&object = section.rawObjects[ref.id];
+    if (!object)
+        object = new T;
+    const auto t = static_cast<T *>(object);
+    if (ref.isDefinition) {
+        registerLoadedObject(ref, uniqueAddress(t));
+        load(*t);
+    }
     return t;
 }
 
-template<> inline std::vector<QString> &PersistentPool::idStorage() { return m_stringStorage; }
+template<> inline std::vector<QString> &PersistentPool::idStorage()
+{
+    return m_currentLoadSection->strings;
+}
 template<> inline QHash<QString, PersistentPool::PersistentObjectId> &PersistentPool::idMap()
 {
     return m_inverseStringStorage;
@@ -226,7 +426,7 @@ template<> inline PersistentPool::PersistentObjectId &PersistentPool::lastStored
 }
 template<> inline std::vector<QStringList> &PersistentPool::idStorage()
 {
-    return m_stringListStorage;
+    return m_currentLoadSection->stringLists;
 }
 template<> inline QHash<QStringList, PersistentPool::PersistentObjectId> &PersistentPool::idMap()
 {
@@ -238,7 +438,7 @@ template<> inline PersistentPool::PersistentObjectId &PersistentPool::lastStored
 }
 template<> inline std::vector<QProcessEnvironment> &PersistentPool::idStorage()
 {
-    return m_envStorage;
+    return m_currentLoadSection->environments;
 }
 template<> inline QHash<QProcessEnvironment, PersistentPool::PersistentObjectId>
 &PersistentPool::idMap()
@@ -253,26 +453,25 @@ template<> inline PersistentPool::PersistentObjectId
 
 template <class T> inline std::shared_ptr<T> PersistentPool::idLoadS()
 {
-    PersistentObjectId id;
-    m_stream >> id;
-
-    if (id < 0)
+    const LoadedReference ref = loadObjectReference();
+    if (ref.section < 0)
         return std::shared_ptr<T>();
 
-    if (id < static_cast<PersistentObjectId>(m_loaded.size()))
-        return std::static_pointer_cast<T>(m_loaded.at(id));
-
-    m_loaded.resize(id + 1);
-    const std::shared_ptr<T> t = T::create();
-    m_loaded[id] = t;
-    load(*t);
+    LoadedSection &section = m_loadedSections[ref.section];
+    std::shared_ptr<void> &object = section.sharedObjects[ref.id];
+    if (!object)
+        object = T::create();
+    const std::shared_ptr<T> t = std::static_pointer_cast<T>(object);
+    if (ref.isDefinition) {
+        registerLoadedObject(ref, uniqueAddress(t.get()));
+        load(*t);
+    }
     return t;
 }
 
 template<typename T> inline T PersistentPool::idLoadValue()
 {
-    int id;
-    m_stream >> id;
+    const auto id = PersistentObjectId(readVarInt());
     if (id == NullValueId)
         return T();
     if (id == EmptyValueId) {
@@ -296,22 +495,22 @@ void PersistentPool::idStoreValue(const T &value)
 {
     if constexpr (std::is_same_v<T, QString>) {
         if (value.isNull()) {
-            m_stream << NullValueId;
+            writeVarInt(NullValueId);
             return;
         }
     }
     if (value.isEmpty()) {
-        m_stream << EmptyValueId;
+        writeVarInt(EmptyValueId);
         return;
     }
     int id = idMap<T>().value(value, ValueNotFoundId);
     if (id < 0) {
         id = lastStoredId<T>()++;
         idMap<T>().insert(value, id);
-        m_stream << id;
+        writeVarInt(id);
         doStoreValue(value);
     } else {
-        m_stream << id;
+        writeVarInt(id);
     }
 }
 
@@ -350,18 +549,19 @@ struct PPHelper<T, std::enable_if_t<std::is_member_function_pointer_v<
 
 template<typename T> struct PPHelper<T, std::enable_if_t<std::is_integral_v<T>>>
 {
-    static void store(const T &value, PersistentPool *pool) { pool->m_stream << value; }
-    static void load(T &value, PersistentPool *pool) { pool->m_stream >> value; }
-};
-
-template<> struct PPHelper<long>
-{
-    static void store(long value, PersistentPool *pool) { pool->m_stream << qint64(value); }
-    static void load(long &value, PersistentPool *pool)
+    static void store(const T &value, PersistentPool *pool)
     {
-        qint64 v;
-        pool->m_stream >> v;
-        value = long(v);
+        if constexpr (std::is_signed_v<T>)
+            pool->writeVarInt(value);
+        else
+            pool->writeVarUInt(value);
+    }
+    static void load(T &value, PersistentPool *pool)
+    {
+        if constexpr (std::is_signed_v<T>)
+            value = static_cast<T>(pool->readVarInt());
+        else
+            value = static_cast<T>(pool->readVarUInt());
     }
 };
 
@@ -370,11 +570,11 @@ template<typename T> struct PPHelper<T, std::enable_if_t<std::is_enum_v<T>>>
     using U = std::underlying_type_t<T>;
     static void store(const T &value, PersistentPool *pool)
     {
-        pool->m_stream << static_cast<U>(value);
+        pool->store(static_cast<U>(value));
     }
     static void load(T &value, PersistentPool *pool)
     {
-        pool->m_stream >> reinterpret_cast<U &>(value);
+        value = static_cast<T>(pool->load<U>());
     }
 };
 
@@ -415,6 +615,30 @@ template<typename T> struct PPHelper<T, std::enable_if_t<std::is_same_v<T, QStri
     static void load(T &v, PersistentPool *pool) { v = pool->idLoadValue<T>(); }
 };
 
+// Byte arrays are stored as size + 1 followed by the raw data, with 0 denoting a null array.
+template<> struct PPHelper<QByteArray>
+{
+    static void store(const QByteArray &v, PersistentPool *pool)
+    {
+        if (v.isNull()) {
+            pool->writeVarUInt(0);
+            return;
+        }
+        pool->writeVarUInt(quint64(v.size()) + 1);
+        pool->writeRaw(v.constData(), v.size());
+    }
+    static void load(QByteArray &v, PersistentPool *pool)
+    {
+        const quint64 sizePlusOne = pool->readVarUInt();
+        if (sizePlusOne == 0) {
+            v = QByteArray();
+            return;
+        }
+        const auto size = qsizetype(sizePlusOne - 1);
+        v = QByteArray(pool->readRaw(size), size);
+    }
+};
+
 template<> struct PPHelper<QVariant>
 {
     static void store(const QVariant &v, PersistentPool *pool) { pool->storeVariant(v); }
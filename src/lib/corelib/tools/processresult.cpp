@@ -124,6 +124,59 @@ QStringList ProcessResult::stdErr() const
     return d->stdErr;
 }
 
+/*!
+ * \brief Returns the time in milliseconds it took the command to finish,
+ *        or -1 if it is not known.
+ */
+qint64 ProcessResult::elapsedTime() const
+{
+    return d->elapsedTime;
+}
+
+/*!
+ * \brief Returns the CPU time in milliseconds the command spent in user mode,
+ *        or -1 if it is not known.
+ */
+qint64 ProcessResult::userTime() const
+{
+    return d->userTime;
+}
+
+/*!
+ * \brief Returns the CPU time in milliseconds the command spent in kernel mode,
+ *        or -1 if it is not known.
+ */
+qint64 ProcessResult::systemTime() const
+{
+    return d->systemTime;
+}
+
+/*!
+ * \brief Returns the peak resident set size of the command in bytes, or -1 if it is not known.
+ */
+qint64 ProcessResult::maxResidentSetSize() const
+{
+    return d->maxResidentSetSize;
+}
+
+/*!
+ * \brief Returns the number of times the command had to read from a block device,
+ *        or -1 if it is not known.
+ */
+qint64 ProcessResult::blockInputOperations() const
+{
+    return d->blockInputOperations;
+}
+
+/*!
+ * \brief Returns the number of times the command had to write to a block device,
+ *        or -1 if it is not known.
+ */
+qint64 ProcessResult::blockOutputOperations() const
+{
+    return d->blockOutputOperations;
+}
+
 static QJsonValue processErrorToJson(QProcess::ProcessError error)
 {
     switch (error) {
@@ -139,6 +192,17 @@ static QJsonValue processErrorToJson(QProcess::ProcessError error)
 
 QJsonObject qbs::ProcessResult::toJson() const
 {
+    QJsonObject resourceUsage;
+    const auto insertIfKnown = [&resourceUsage](const QString &key, qint64 value) {
+        if (value >= 0)
+            resourceUsage.insert(key, value);
+    };
+    insertIfKnown(QStringLiteral("elapsed-time"), elapsedTime());
+    insertIfKnown(QStringLiteral("user-time"), userTime());
+    insertIfKnown(QStringLiteral("system-time"), systemTime());
+    insertIfKnown(QStringLiteral("max-resident-set-size"), maxResidentSetSize());
+    insertIfKnown(QStringLiteral("block-input-operations"), blockInputOperations());
+    insertIfKnown(QStringLiteral("block-output-operations"), blockOutputOperations());
     return QJsonObject{
         {QStringLiteral("success"), success()},
         {QStringLiteral("executable-file-path"), executableFilePath()},
@@ -147,7 +211,8 @@ QJsonObject qbs::ProcessResult::toJson() const
         {QStringLiteral("error"), processErrorToJson(error())},
         {QStringLiteral("exit-code"), exitCode()},
         {QStringLiteral("stdout"), QJsonArray::fromStringList(stdOut())},
-        {QStringLiteral("stderr"), QJsonArray::fromStringList(stdErr())}
+        {QStringLiteral("stderr"), QJsonArray::fromStringList(stdErr())},
+        {QStringLiteral("resource-usage"), resourceUsage}
     };
 }
 
@@ -52,12 +52,14 @@ QT_END_NAMESPACE
 
 namespace qbs {
 namespace Internal {
+class ActionCache;
 class ProcessCommandExecutor;
 class ProcessResultPrivate;
 }
 
 class QBS_EXPORT ProcessResult
 {
+    friend class qbs::Internal::ActionCache;
     friend class qbs::Internal::ProcessCommandExecutor;
 public:
     ProcessResult();
@@ -76,6 +78,13 @@ public:
     QStringList stdOut() const;
     QStringList stdErr() const;
 
+    qint64 elapsedTime() const;
+    qint64 userTime() const;
+    qint64 systemTime() const;
+    qint64 maxResidentSetSize() const;
+    qint64 blockInputOperations() const;
+    qint64 blockOutputOperations() const;
+
 private:
     QExplicitlySharedDataPointer<Internal::ProcessResultPrivate> d;
 };
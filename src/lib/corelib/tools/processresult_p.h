@@ -58,6 +58,13 @@ public:
     int exitCode = 0;
     QStringList stdOut;
     QStringList stdErr;
+
+    qint64 elapsedTime = -1;
+    qint64 userTime = -1;
+    qint64 systemTime = -1;
+    qint64 maxResidentSetSize = -1;
+    qint64 blockInputOperations = -1;
+    qint64 blockOutputOperations = -1;
 };
 
 } // namespace Internal
@@ -41,7 +41,12 @@
 
 #include <logging/logger.h>
 #include <logging/translator.h>
+#include <tools/qbsassert.h>
 
+#include <QtCore/qfile.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
 #include <QtCore/qstring.h>
 
 namespace qbs {
@@ -102,6 +107,168 @@ void AccumulatingTimer::stop()
     m_timer.invalidate();
 }
 
+static thread_local int currentLane = 0;
+
+TraceRecorder &TraceRecorder::instance()
+{
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+TraceRecorder::TraceRecorder()
+{
+    m_timer.start();
+}
+
+// A new trace drops the events of the previous one, unless another recording is still
+// running. Continuing a trace keeps the events recorded since the last trace file was written,
+// e.g. so that the trace file of a build also contains the preceding resolve.
+void TraceRecorder::startRecording(StartMode mode)
+{
+    std::lock_guard lock(m_mutex);
+    if (m_activeRecordings++ == 0) {
+        if (mode == StartMode::NewTrace)
+            m_events.clear();
+        m_enabled = true;
+    }
+}
+
+void TraceRecorder::stopRecording()
+{
+    std::lock_guard lock(m_mutex);
+    QBS_CHECK(m_activeRecordings > 0);
+    if (--m_activeRecordings == 0)
+        m_enabled = false;
+}
+
+void TraceRecorder::clearEvents()
+{
+    std::lock_guard lock(m_mutex);
+    if (m_activeRecordings == 0)
+        std::vector<Event>().swap(m_events);
+}
+
+qint64 TraceRecorder::currentTimestamp() const
+{
+    return m_timer.nsecsElapsed() / 1000;
+}
+
+int TraceRecorder::currentThreadLane()
+{
+    if (currentLane == 0)
+        currentLane = reserveLanes(1, Tr::tr("Thread"));
+    return currentLane;
+}
+
+void TraceRecorder::setCurrentThreadLane(int lane)
+{
+    currentLane = lane;
+}
+
+int TraceRecorder::reserveLanes(int count, const QString &name)
+{
+    std::lock_guard lock(m_mutex);
+    const int firstLane = m_nextLane;
+    m_nextLane += count;
+    for (int i = 0; i < count; ++i)
+        m_laneNames.insert(firstLane + i, QStringLiteral("%1 %2").arg(name).arg(firstLane + i));
+    return firstLane;
+}
+
+void TraceRecorder::addEvent(const QString &name, const QString &category, qint64 start,
+                             qint64 end, int lane, const QVariantMap &args)
+{
+    if (!m_enabled)
+        return;
+    std::lock_guard lock(m_mutex);
+    m_events.push_back({name, category, start, end - start, lane, args});
+}
+
+bool TraceRecorder::writeToFile(const QString &filePath, QString *errorMessage) const
+{
+    QJsonArray traceEvents;
+    {
+        std::lock_guard lock(m_mutex);
+        for (auto it = m_laneNames.cbegin(); it != m_laneNames.cend(); ++it) {
+            traceEvents.append(QJsonObject{
+                {QStringLiteral("name"), QStringLiteral("thread_name")},
+                {QStringLiteral("ph"), QStringLiteral("M")},
+                {QStringLiteral("pid"), 1},
+                {QStringLiteral("tid"), it.key()},
+                {QStringLiteral("args"), QJsonObject{{QStringLiteral("name"), it.value()}}}});
+        }
+        for (const Event &event : m_events) {
+            QJsonObject eventObject{
+                {QStringLiteral("name"), event.name},
+                {QStringLiteral("cat"), event.category},
+                {QStringLiteral("ph"), QStringLiteral("X")},
+                {QStringLiteral("ts"), event.start},
+                {QStringLiteral("dur"), event.duration},
+                {QStringLiteral("pid"), 1},
+                {QStringLiteral("tid"), event.lane}};
+            if (!event.args.isEmpty())
+                eventObject.insert(QStringLiteral("args"), QJsonObject::fromVariantMap(event.args));
+            traceEvents.append(eventObject);
+        }
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        *errorMessage = file.errorString();
+        return false;
+    }
+    const QJsonObject trace{{QStringLiteral("traceEvents"), traceEvents},
+                            {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")}};
+    if (file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) == -1) {
+        *errorMessage = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+TraceSpan::TraceSpan(const QString &name, const char *category, int lane)
+    : m_name(name), m_category(category), m_lane(lane)
+{
+    TraceRecorder &recorder = TraceRecorder::instance();
+    if (recorder.isEnabled())
+        m_start = recorder.currentTimestamp();
+}
+
+TraceSpan::~TraceSpan()
+{
+    finish();
+}
+
+void TraceSpan::addArgument(const QString &key, const QVariant &value)
+{
+    if (isActive())
+        m_args.insert(key, value);
+}
+
+void TraceSpan::finish()
+{
+    if (!isActive())
+        return;
+    TraceRecorder &recorder = TraceRecorder::instance();
+    recorder.addEvent(m_name, QLatin1String(m_category), m_start, recorder.currentTimestamp(),
+                      m_lane == -1 ? recorder.currentThreadLane() : m_lane, m_args);
+    m_start = -1;
+}
+
+TraceLaneSwitcher::TraceLaneSwitcher(int lane)
+{
+    if (lane == -1)
+        return;
+    m_oldLane = currentLane;
+    TraceRecorder::setCurrentThreadLane(lane);
+}
+
+TraceLaneSwitcher::~TraceLaneSwitcher()
+{
+    if (m_oldLane != -1)
+        TraceRecorder::setCurrentThreadLane(m_oldLane);
+}
+
 QString elapsedTimeString(qint64 elapsedTimeInNs)
 {
     qint64 ms = elapsedTimeInNs / (1000ll * 1000ll);
@@ -40,13 +40,18 @@
 #ifndef QBS_PROFILING_H
 #define QBS_PROFILING_H
 
+#include "qbs_export.h"
+
 #include <QtCore/qelapsedtimer.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qvariant.h>
 
+#include <atomic>
 #include <memory>
-
-QT_BEGIN_NAMESPACE
-class QString;
-QT_END_NAMESPACE
+#include <mutex>
+#include <type_traits>
+#include <vector>
 
 namespace qbs {
 namespace Internal {
@@ -78,6 +83,94 @@ private:
     qint64 * const m_elapsedTime;
 };
 
+// Collects a timeline of activities in the Trace Event Format, which is understood by
+// chrome://tracing and Perfetto. There is one instance per process, and all functions
+// are thread-safe. Activities are organized in lanes, which show up as threads in the viewer.
+// Recording is enabled while at least one job that wants a trace file is running.
+class QBS_AUTOTEST_EXPORT TraceRecorder
+{
+public:
+    static TraceRecorder &instance();
+
+    enum class StartMode { NewTrace, ContinueTrace };
+    void startRecording(StartMode mode);
+    void stopRecording();
+    void clearEvents(); // Unless recording is active.
+    bool isEnabled() const { return m_enabled; }
+
+    qint64 currentTimestamp() const; // In microseconds.
+    int currentThreadLane();
+    static void setCurrentThreadLane(int lane);
+    int reserveLanes(int count, const QString &name);
+
+    void addEvent(const QString &name, const QString &category, qint64 start, qint64 end,
+                  int lane, const QVariantMap &args = {});
+    bool writeToFile(const QString &filePath, QString *errorMessage) const;
+
+private:
+    TraceRecorder();
+
+    struct Event
+    {
+        QString name;
+        QString category;
+        qint64 start;
+        qint64 duration;
+        int lane;
+        QVariantMap args;
+    };
+
+    QElapsedTimer m_timer;
+    std::atomic_bool m_enabled = false;
+    mutable std::mutex m_mutex;
+    std::vector<Event> m_events;
+    QHash<int, QString> m_laneNames;
+    int m_nextLane = 1;
+    int m_activeRecordings = 0;
+};
+
+// Records a span from its construction to its destruction, if tracing is enabled.
+// The name can also be given as a function, which is only called if tracing is enabled.
+class TraceSpan
+{
+public:
+    TraceSpan(const QString &name, const char *category, int lane = -1);
+    template<typename NameGetter,
+             typename = std::enable_if_t<std::is_invocable_r_v<QString, NameGetter>>>
+    TraceSpan(const NameGetter &getName, const char *category, int lane = -1)
+        : m_category(category), m_lane(lane)
+    {
+        TraceRecorder &recorder = TraceRecorder::instance();
+        if (recorder.isEnabled()) {
+            m_name = getName();
+            m_start = recorder.currentTimestamp();
+        }
+    }
+    ~TraceSpan();
+
+    bool isActive() const { return m_start != -1; }
+    void addArgument(const QString &key, const QVariant &value);
+    void finish();
+
+private:
+    QString m_name;
+    const char * const m_category;
+    const int m_lane;
+    QVariantMap m_args;
+    qint64 m_start = -1;
+};
+
+// Makes trace spans created in the current thread go to the given lane while in scope.
+class TraceLaneSwitcher
+{
+public:
+    TraceLaneSwitcher(int lane);
+    ~TraceLaneSwitcher();
+
+private:
+    int m_oldLane = -1;
+};
+
 } // namespace Internal
 } // namespace qbs
 
@@ -38,6 +38,8 @@
 ****************************************************************************/
 #include "progressobserver.h"
 
+#include "stlutils.h"
+
 namespace qbs {
 namespace Internal {
 
@@ -101,5 +103,11 @@ void ProgressObserver::setFinished()
     setProgressValue(maximum());
 }
 
+// For engines that are handed on before the operation has finished.
+void ProgressObserver::removeScriptEngine(ScriptEngine *engine)
+{
+    removeOne(m_scriptEngines, engine);
+}
+
 } // namespace Internal
 } // namespace qbs
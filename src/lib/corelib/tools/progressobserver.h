@@ -69,6 +69,7 @@ public:
     void setFinished();
 
     void addScriptEngine(ScriptEngine *engine) { m_scriptEngines.push_back(engine); }
+    void removeScriptEngine(ScriptEngine *engine);
 
 protected:
     const std::vector<ScriptEngine *> &scriptEngines() const { return m_scriptEngines; }
@@ -70,6 +70,7 @@ void QbsProcess::start(const QString &command, const QStringList &arguments)
     }
     m_command = command;
     m_arguments = arguments;
+    m_resourceUsage = ProcessResourceUsage();
     m_state = QProcess::Starting;
     if (LauncherInterface::socket()->isReady())
         doStart();
@@ -178,6 +179,7 @@ void QbsProcess::handleFinishedPacket(const QByteArray &packetData)
     m_stdout = packet.stdOut;
     m_stderr = packet.stdErr;
     m_errorString = packet.errorString;
+    m_resourceUsage = packet.resourceUsage;
     emit finished(m_exitCode);
 }
 
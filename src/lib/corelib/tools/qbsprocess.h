@@ -67,6 +67,7 @@ public:
     int exitCode() const { return m_exitCode; }
     QProcess::ProcessError error() const { return m_error; }
     QString errorString() const { return m_errorString; }
+    const ProcessResourceUsage &resourceUsage() const { return m_resourceUsage; }
 
 signals:
     void errorOccurred(QProcess::ProcessError error);
@@ -93,6 +94,7 @@ private:
     QByteArray m_stdout;
     QByteArray m_stderr;
     QString m_errorString;
+    ProcessResourceUsage m_resourceUsage;
     QProcess::ProcessError m_error = QProcess::UnknownError;
     QProcess::ProcessState m_state = QProcess::NotRunning;
     int m_exitCode = 0;
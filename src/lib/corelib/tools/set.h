@@ -50,6 +50,7 @@
 #endif
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -338,6 +339,381 @@ template<typename T> Set<T> &Set<T>::subtract(const Set<T> &other)
     return *this;
 }
 
+/*
+ * Sets of pointers are the ones that get large in practice: the parents and children of
+ * build graph nodes, the artifacts of a product and so on. As the order of pointer values
+ * carries no meaning anyway, these sets keep their elements in a vector in the order of
+ * insertion and look them up linearly while they are small. Once they grow beyond
+ * indexThreshold elements, an open-addressing hash table of positions is added, so that
+ * insertion, lookup and removal do not depend on the size of the set.
+ * Removal moves the last element into the gap, so the iteration order is determined solely
+ * by the sequence of operations on the set, and never by pointer values.
+ */
+template<typename T> class Set<T *>
+{
+    using Storage = std::vector<T *>;
+public:
+    using const_iterator = typename Storage::const_iterator;
+    using iterator = typename Storage::iterator;
+    using reverse_iterator = typename Storage::reverse_iterator;
+    using const_reverse_iterator = typename Storage::const_reverse_iterator;
+    using size_type = typename Storage::size_type;
+    using value_type = T *;
+    using difference_type = typename Storage::difference_type;
+    using pointer = typename Storage::pointer;
+    using const_pointer = typename Storage::const_pointer;
+    using reference = typename Storage::reference;
+    using const_reference = typename Storage::const_reference;
+
+    static constexpr size_type indexThreshold = 16;
+
+    iterator begin() { return m_data.begin(); }
+    iterator end() { return m_data.end(); }
+    reverse_iterator rbegin() { return m_data.rbegin(); }
+    reverse_iterator rend() { return m_data.rend(); }
+    const_reverse_iterator rbegin() const { return m_data.rbegin(); }
+    const_reverse_iterator rend() const { return m_data.rend(); }
+    const_reverse_iterator crbegin() const { return m_data.crbegin(); }
+    const_reverse_iterator crend() const { return m_data.crend(); }
+    const_iterator begin() const { return m_data.begin(); }
+    const_iterator end() const { return m_data.end(); }
+    const_iterator cbegin() const { return m_data.cbegin(); }
+    const_iterator cend() const { return m_data.cend(); }
+    const_iterator constBegin() const { return m_data.cbegin(); }
+    const_iterator constEnd() const { return m_data.cend(); }
+
+    Set() = default;
+    Set(const std::initializer_list<T *> &list);
+    template<typename InputIterator>
+    Set(InputIterator first, InputIterator last);
+
+    Set &unite(const Set &other);
+    Set &operator+=(const Set &other) { return unite(other); }
+    Set &operator|=(const Set &other) { return unite(other); }
+
+    Set &subtract(const Set &other);
+    Set &operator-=(const Set &other) { return subtract(other); }
+
+    Set &intersect(const Set &other);
+    Set &operator&=(const Set &other) { return intersect(other); }
+    Set &operator&=(T *v) { return intersect(Set{ v }); }
+
+    iterator find(T *v);
+    const_iterator find(T *v) const;
+    std::pair<iterator, bool> insert(T *v);
+    Set &operator+=(T *v) { insert(v); return *this; }
+    Set &operator|=(T *v) { return operator+=(v); }
+    Set &operator<<(T *v) { return operator+=(v); }
+
+    bool contains(T *v) const { return position(v) != npos; }
+    bool contains(const Set &other) const;
+    bool empty() const { return m_data.empty(); }
+    size_type size() const { return m_data.size(); }
+    size_type capacity() const { return m_data.capacity(); }
+    bool intersects(const Set &other) const;
+
+    bool remove(T *v);
+    void operator-=(T *v) { remove(v); }
+    iterator erase(iterator it);
+    iterator erase(iterator first, iterator last);
+
+    void clear() { m_data.clear(); m_index.clear(); }
+    void reserve(size_type size) { m_data.reserve(size); }
+
+    void swap(Set &other) { m_data.swap(other.m_data); m_index.swap(other.m_index); }
+
+    void load(PersistentPool &pool);
+    void store(PersistentPool &pool) const;
+
+#ifdef QT_CORE_LIB
+    QStringList toStringList() const;
+    QString toString(T * const &value) const { return value->toString(); }
+    QString toString() const;
+#endif
+
+    template<typename U> static Set filtered(const Set<U> &s);
+
+    bool operator==(const Set &other) const { return size() == other.size() && contains(other); }
+    bool operator!=(const Set &other) const { return !(*this == other); }
+
+private:
+    static constexpr size_type npos = size_type(-1);
+
+    static size_type hash(const T *v)
+    {
+        return size_type((std::uint64_t(std::uintptr_t(v)) * 0x9e3779b97f4a7c15ULL) >> 32);
+    }
+
+    size_type position(const T *v) const;
+    size_type slot(const T *v) const;
+    void removeAt(size_type pos);
+    void removeSlot(size_type slot);
+    void rebuildIndex();
+    T *loadElem(PersistentPool &pool) { return pool.load<T *>(); }
+    void storeElem(PersistentPool &pool, T * const &v) const { pool.store(v); }
+
+    Storage m_data;
+
+    // Positions in m_data plus one, zero denotes a free slot. Empty while the set is small.
+    std::vector<std::uint32_t> m_index;
+};
+
+template<typename T> Set<T *>::Set(const std::initializer_list<T *> &list)
+{
+    reserve(list.size());
+    for (T * const v : list)
+        insert(v);
+}
+
+template<typename T>
+template<typename InputIterator>
+Set<T *>::Set(InputIterator first, InputIterator last)
+{
+    reserveIfForwardIterator(&m_data, first, last);
+    for (; first != last; ++first)
+        insert(*first);
+}
+
+template<typename T> typename Set<T *>::size_type Set<T *>::slot(const T *v) const
+{
+    const size_type mask = m_index.size() - 1;
+    for (size_type s = hash(v) & mask;; s = (s + 1) & mask) {
+        const std::uint32_t entry = m_index[s];
+        if (entry == 0 || m_data[entry - 1] == v)
+            return s;
+    }
+}
+
+template<typename T> typename Set<T *>::size_type Set<T *>::position(const T *v) const
+{
+    if (m_index.empty()) {
+        const auto it = std::find(m_data.cbegin(), m_data.cend(), v);
+        return it == m_data.cend() ? npos : size_type(it - m_data.cbegin());
+    }
+    const std::uint32_t entry = m_index[slot(v)];
+    return entry == 0 ? npos : entry - 1;
+}
+
+template<typename T> void Set<T *>::rebuildIndex()
+{
+    if (m_data.size() <= indexThreshold) {
+        m_index.clear();
+        return;
+    }
+
+    // Keep the load factor at or below one half.
+    size_type indexSize = 2 * indexThreshold;
+    while (indexSize < 2 * m_data.size())
+        indexSize *= 2;
+    m_index.assign(indexSize, 0);
+    const size_type mask = indexSize - 1;
+    for (size_type i = 0; i < m_data.size(); ++i) {
+        size_type s = hash(m_data[i]) & mask;
+        while (m_index[s] != 0)
+            s = (s + 1) & mask;
+        m_index[s] = std::uint32_t(i + 1);
+    }
+}
+
+template<typename T> void Set<T *>::removeSlot(size_type s)
+{
+    // Backward shift deletion: Move up entries whose probe sequence passes the new hole.
+    const size_type mask = m_index.size() - 1;
+    size_type hole = s;
+    for (size_type next = (hole + 1) & mask; m_index[next] != 0; next = (next + 1) & mask) {
+        const size_type home = hash(m_data[m_index[next] - 1]) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            m_index[hole] = m_index[next];
+            hole = next;
+        }
+    }
+    m_index[hole] = 0;
+}
+
+template<typename T> void Set<T *>::removeAt(size_type pos)
+{
+    const size_type last = m_data.size() - 1;
+    if (!m_index.empty()) {
+        removeSlot(slot(m_data[pos]));
+        if (pos != last)
+            m_index[slot(m_data[last])] = std::uint32_t(pos + 1);
+    }
+    if (pos != last)
+        m_data[pos] = m_data[last];
+    m_data.pop_back();
+    if (!m_index.empty() && m_data.size() <= indexThreshold / 2)
+        m_index.clear();
+}
+
+template<typename T> typename Set<T *>::iterator Set<T *>::find(T *v)
+{
+    const size_type pos = position(v);
+    return pos == npos ? end() : begin() + pos;
+}
+
+template<typename T> typename Set<T *>::const_iterator Set<T *>::find(T *v) const
+{
+    const size_type pos = position(v);
+    return pos == npos ? cend() : cbegin() + pos;
+}
+
+template<typename T> std::pair<typename Set<T *>::iterator, bool> Set<T *>::insert(T *v)
+{
+    if (m_index.empty()) {
+        const auto it = std::find(m_data.begin(), m_data.end(), v);
+        if (it != m_data.end())
+            return std::make_pair(it, false);
+        m_data.push_back(v);
+        if (m_data.size() > indexThreshold)
+            rebuildIndex();
+        return std::make_pair(m_data.end() - 1, true);
+    }
+    const size_type s = slot(v);
+    if (m_index[s] != 0)
+        return std::make_pair(m_data.begin() + (m_index[s] - 1), false);
+    m_data.push_back(v);
+    if (2 * m_data.size() > m_index.size())
+        rebuildIndex();
+    else
+        m_index[s] = std::uint32_t(m_data.size());
+    return std::make_pair(m_data.end() - 1, true);
+}
+
+template<typename T> bool Set<T *>::remove(T *v)
+{
+    const size_type pos = position(v);
+    if (pos == npos)
+        return false;
+    removeAt(pos);
+    return true;
+}
+
+template<typename T> typename Set<T *>::iterator Set<T *>::erase(iterator it)
+{
+    const size_type pos = it - m_data.begin();
+    removeAt(pos);
+    return m_data.begin() + pos;
+}
+
+template<typename T> typename Set<T *>::iterator Set<T *>::erase(iterator first, iterator last)
+{
+    const auto offset = first - m_data.begin();
+    m_data.erase(first, last);
+    rebuildIndex();
+    return m_data.begin() + offset;
+}
+
+template<typename T> Set<T *> &Set<T *>::unite(const Set &other)
+{
+    if (empty()) {
+        *this = other;
+        return *this;
+    }
+    reserve(size() + other.size());
+    for (T * const v : other)
+        insert(v);
+    return *this;
+}
+
+template<typename T> Set<T *> &Set<T *>::subtract(const Set &other)
+{
+    if (&other == this) {
+        clear();
+        return *this;
+    }
+    if (empty() || other.empty())
+        return *this;
+    if (other.size() < size()) {
+        for (T * const v : other)
+            remove(v);
+        return *this;
+    }
+    const auto newEnd = std::remove_if(m_data.begin(), m_data.end(),
+                                       [&other](T *v) { return other.contains(v); });
+    if (newEnd != m_data.end())
+        erase(newEnd, m_data.end());
+    return *this;
+}
+
+template<typename T> Set<T *> &Set<T *>::intersect(const Set &other)
+{
+    if (&other == this)
+        return *this;
+    const auto newEnd = std::remove_if(m_data.begin(), m_data.end(),
+                                       [&other](T *v) { return !other.contains(v); });
+    if (newEnd != m_data.end())
+        erase(newEnd, m_data.end());
+    return *this;
+}
+
+template<typename T> bool Set<T *>::contains(const Set &other) const
+{
+    if (other.size() > size())
+        return false;
+    return std::all_of(other.cbegin(), other.cend(), [this](T *v) { return contains(v); });
+}
+
+template<typename T> bool Set<T *>::intersects(const Set &other) const
+{
+    const Set &smaller = size() <= other.size() ? *this : other;
+    const Set &larger = &smaller == this ? other : *this;
+    return std::any_of(smaller.cbegin(), smaller.cend(),
+                       [&larger](T *v) { return larger.contains(v); });
+}
+
+template<typename T> void Set<T *>::load(PersistentPool &pool)
+{
+    clear();
+    int i = pool.load<int>();
+    reserve(i);
+    for (; --i >= 0;)
+        m_data.push_back(loadElem(pool));
+    rebuildIndex();
+}
+
+template<typename T> void Set<T *>::store(PersistentPool &pool) const
+{
+    pool.store(static_cast<int>(size()));
+    for (T * const v : m_data)
+        storeElem(pool, v);
+}
+
+#ifdef QT_CORE_LIB
+template<typename T> QStringList Set<T *>::toStringList() const
+{
+    return transformed<QStringList>(*this, [this](T *e) { return toString(e); });
+}
+
+template<typename T> QString Set<T *>::toString() const
+{
+    return QLatin1Char('[') + toStringList().join(QLatin1String(", ")) + QLatin1Char(']');
+}
+#endif
+
+template<typename T> template<typename U> Set<T *> Set<T *>::filtered(const Set<U> &s)
+{
+    static_assert(std::is_pointer_v<U>, "Set::filtered() assumes pointer types");
+    Set<T *> filteredSet;
+    for (auto &u : s) {
+        if (hasDynamicType<T>(u))
+            filteredSet.m_data.push_back(static_cast<T *>(u));
+    }
+    filteredSet.rebuildIndex();
+    return filteredSet;
+}
+
+template<typename T> Set<T *> operator-(const Set<T *> &set1, const Set<T *> &set2)
+{
+    Set<T *> result = set1;
+    return result -= set2;
+}
+
+template<typename T> Set<T *> operator&(const Set<T *> &set1, const Set<T *> &set2)
+{
+    Set<T *> result = set1;
+    return result &= set2;
+}
+
 template<typename T> Set<T> operator+(const Set<T> &set1, const Set<T> &set2)
 {
     Set<T> result = set1;
@@ -74,6 +74,8 @@ public:
         , logElapsedTime(false)
         , forceProbeExecution(false)
         , waitLockBuildGraph(false)
+        , restoreBuildDataOnDemand(false)
+        , reuseScriptEngines(false)
         , restoreBehavior(SetupProjectParameters::RestoreAndTrackChanges)
         , propertyCheckingMode(ErrorHandlingMode::Strict)
         , productErrorMode(ErrorHandlingMode::Strict)
@@ -88,6 +90,7 @@ public:
     QStringList pluginPaths;
     QString libexecPath;
     QString settingsBaseDir;
+    QString traceFilePath;
     QVariantMap overriddenValues;
     QVariantMap buildConfiguration;
     mutable QVariantMap buildConfigurationTree;
@@ -99,6 +102,8 @@ public:
     bool logElapsedTime;
     bool forceProbeExecution;
     bool waitLockBuildGraph;
+    bool restoreBuildDataOnDemand;
+    bool reuseScriptEngines;
     SetupProjectParameters::RestoreBehavior restoreBehavior;
     ErrorHandlingMode propertyCheckingMode;
     ErrorHandlingMode productErrorMode;
@@ -165,8 +170,10 @@ SetupProjectParameters SetupProjectParameters::fromJson(const QJsonObject &data)
     setValueFromJson(params.d->overriddenValues, data, "overridden-properties");
     setValueFromJson(params.d->dryRun, data, "dry-run");
     setValueFromJson(params.d->logElapsedTime, data, "log-time");
+    setValueFromJson(params.d->traceFilePath, data, "trace-file");
     setValueFromJson(params.d->forceProbeExecution, data, "force-probe-execution");
     setValueFromJson(params.d->waitLockBuildGraph, data, "wait-lock-build-graph");
+    setValueFromJson(params.d->restoreBuildDataOnDemand, data, "restore-build-data-on-demand");
     setValueFromJson(params.d->environment, data, "environment");
     setValueFromJson(params.d->restoreBehavior, data, "restore-behavior");
     setValueFromJson(params.d->propertyCheckingMode, data, "error-handling-mode");
@@ -175,6 +182,56 @@ SetupProjectParameters SetupProjectParameters::fromJson(const QJsonObject &data)
     return params;
 }
 
+static QString restoreBehaviorName(SetupProjectParameters::RestoreBehavior restoreBehavior)
+{
+    switch (restoreBehavior) {
+    case SetupProjectParameters::RestoreOnly:
+        return QStringLiteral("restore-only");
+    case SetupProjectParameters::ResolveOnly:
+        return QStringLiteral("resolve-only");
+    case SetupProjectParameters::RestoreAndResolve:
+        return QStringLiteral("restore-and-resolve");
+    case SetupProjectParameters::RestoreAndTrackChanges:
+        break;
+    }
+    return QStringLiteral("restore-and-track-changes");
+}
+
+/*!
+ * \brief Returns the parameters in the format understood by fromJson().
+ * Search paths, plugin paths and the libexec path are not included.
+ */
+QJsonObject SetupProjectParameters::toJson() const
+{
+    QJsonObject data;
+    data.insert(QLatin1String("top-level-profile"), d->topLevelProfile);
+    data.insert(QLatin1String("configuration-name"), d->configurationName);
+    data.insert(QLatin1String("project-file-path"), d->projectFilePath);
+    data.insert(QLatin1String("build-root"), d->buildRoot);
+    data.insert(QLatin1String("settings-directory"), d->settingsBaseDir);
+    data.insert(QLatin1String("max-job-count"), d->maxJobCount);
+    data.insert(QLatin1String("overridden-properties"),
+                QJsonObject::fromVariantMap(d->overriddenValues));
+    data.insert(QLatin1String("dry-run"), d->dryRun);
+    data.insert(QLatin1String("log-time"), d->logElapsedTime);
+    data.insert(QLatin1String("trace-file"), d->traceFilePath);
+    data.insert(QLatin1String("force-probe-execution"), d->forceProbeExecution);
+    data.insert(QLatin1String("wait-lock-build-graph"), d->waitLockBuildGraph);
+    data.insert(QLatin1String("restore-build-data-on-demand"), d->restoreBuildDataOnDemand);
+    QJsonObject environment;
+    const QStringList envKeys = d->environment.keys();
+    for (const QString &key : envKeys)
+        environment.insert(key, d->environment.value(key));
+    data.insert(QLatin1String("environment"), environment);
+    data.insert(QLatin1String("restore-behavior"), restoreBehaviorName(d->restoreBehavior));
+    data.insert(QLatin1String("error-handling-mode"),
+                d->propertyCheckingMode == ErrorHandlingMode::Relaxed
+                ? QLatin1String("relaxed") : QLatin1String("strict"));
+    data.insert(QLatin1String("deprecation-warning-mode"),
+                deprecationWarningModeName(d->deprecationWarningMode));
+    return data;
+}
+
 SetupProjectParameters &SetupProjectParameters::operator=(SetupProjectParameters &&other) Q_DECL_NOEXCEPT = default;
 
 /*!
@@ -586,6 +643,24 @@ void SetupProjectParameters::setLogElapsedTime(bool logElapsedTime)
     d->logElapsedTime = logElapsedTime;
 }
 
+/*!
+ * \brief Returns the file that a timeline of the resolve process will be written to.
+ */
+QString SetupProjectParameters::traceFilePath() const
+{
+    return d->traceFilePath;
+}
+
+/*!
+ * Controls whether a timeline of the resolve process will be written to \a filePath.
+ * The file is in the Trace Event Format, which can be viewed with chrome://tracing or Perfetto.
+ * The default is an empty string, which means no timeline is recorded.
+ */
+void SetupProjectParameters::setTraceFilePath(const QString &filePath)
+{
+    d->traceFilePath = filePath;
+}
+
 
 /*!
  * \brief Returns true iff probes should be re-run.
@@ -622,6 +697,47 @@ void SetupProjectParameters::setWaitLockBuildGraph(bool wait)
     d->waitLockBuildGraph = wait;
 }
 
+/*!
+ * \brief Returns true if the build data of products is only read from the stored build graph
+ * when it is needed.
+ */
+bool SetupProjectParameters::restoreBuildDataOnDemand() const
+{
+    return d->restoreBuildDataOnDemand;
+}
+
+/*!
+ * Controls whether the build data of products is read from the stored build graph only when
+ * an operation needs it, that is, when the respective products or products depending on them
+ * are built, cleaned or installed. This speeds up operations on a few products of a large
+ * project. Note that the ProjectData of a project restored this way does not list
+ * the generated artifacts of products whose build data has not been read.
+ * The default is \c false.
+ */
+void SetupProjectParameters::setRestoreBuildDataOnDemand(bool onDemand)
+{
+    d->restoreBuildDataOnDemand = onDemand;
+}
+
+/*!
+ * \brief Returns true if the JavaScript engines used for resolving are kept for later resolves.
+ */
+bool SetupProjectParameters::reuseScriptEngines() const
+{
+    return d->reuseScriptEngines;
+}
+
+/*!
+ * Controls whether the additional JavaScript engines that are set up for resolving products
+ * in parallel are kept in the process when resolving has finished, so that later resolves
+ * can use them instead of setting up new ones. This is meant for long-lived processes that
+ * resolve projects repeatedly. The default is \c false.
+ */
+void SetupProjectParameters::setReuseScriptEngines(bool reuse)
+{
+    d->reuseScriptEngines = reuse;
+}
+
 /*!
  * \brief Gets the environment used while resolving the project.
  */
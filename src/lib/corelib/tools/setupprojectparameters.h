@@ -73,6 +73,7 @@ public:
     SetupProjectParameters &operator=(SetupProjectParameters &&other) Q_DECL_NOEXCEPT;
 
     static SetupProjectParameters fromJson(const QJsonObject &data);
+    QJsonObject toJson() const;
 
     QString topLevelProfile() const;
     void setTopLevelProfile(const QString &profile);
@@ -126,12 +127,21 @@ public:
     bool logElapsedTime() const;
     void setLogElapsedTime(bool logElapsedTime);
 
+    QString traceFilePath() const;
+    void setTraceFilePath(const QString &filePath);
+
     bool forceProbeExecution() const;
     void setForceProbeExecution(bool force);
 
     bool waitLockBuildGraph() const;
     void setWaitLockBuildGraph(bool wait);
 
+    bool restoreBuildDataOnDemand() const;
+    void setRestoreBuildDataOnDemand(bool onDemand);
+
+    bool reuseScriptEngines() const;
+    void setReuseScriptEngines(bool reuse);
+
     QProcessEnvironment environment() const;
     void setEnvironment(const QProcessEnvironment &env);
     QProcessEnvironment adjustedEnvironment() const;
@@ -41,7 +41,12 @@
 
 #include "launcherlogging.h"
 
+#ifdef Q_OS_UNIX
+#include "unixprocess.h"
+#endif
+
 #include <QtCore/qcoreapplication.h>
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qprocess.h>
 #include <QtCore/qtimer.h>
 #include <QtNetwork/qlocalsocket.h>
@@ -49,17 +54,40 @@
 namespace qbs {
 namespace Internal {
 
-class Process : public QProcess
+#ifdef Q_OS_UNIX
+using ProcessBase = UnixProcess;
+#else
+using ProcessBase = QProcess;
+#endif
+
+class Process : public ProcessBase
 {
     Q_OBJECT
 public:
     Process(quintptr token, QObject *parent = nullptr) :
-        QProcess(parent), m_token(token), m_stopTimer(new QTimer(this))
+        ProcessBase(parent), m_token(token), m_stopTimer(new QTimer(this))
     {
         m_stopTimer->setSingleShot(true);
         connect(m_stopTimer, &QTimer::timeout, this, &Process::cancel);
     }
 
+    void start(const QString &command, const QStringList &arguments)
+    {
+        m_elapsedTimer.start();
+        ProcessBase::start(command, arguments);
+    }
+
+    ProcessResourceUsage resourceUsage() const
+    {
+#ifdef Q_OS_UNIX
+        ProcessResourceUsage usage = ProcessBase::resourceUsage();
+#else
+        ProcessResourceUsage usage;
+#endif
+        usage.elapsedTime = m_elapsedTimer.elapsed();
+        return usage;
+    }
+
     void cancel()
     {
         switch (m_stopState) {
@@ -94,6 +122,7 @@ signals:
 private:
     const quintptr m_token;
     QTimer * const m_stopTimer;
+    QElapsedTimer m_elapsedTimer;
     enum class StopState { Inactive, Terminating, Killing } m_stopState = StopState::Inactive;
 };
 
@@ -198,6 +227,7 @@ void LauncherSocketHandler::handleProcessFinished()
     packet.exitStatus = proc->exitStatus();
     packet.stdErr = proc->readAllStandardError();
     packet.stdOut = proc->readAllStandardOutput();
+    packet.resourceUsage = proc->resourceUsage();
     sendPacket(packet);
 }
 
@@ -272,8 +302,9 @@ void LauncherSocketHandler::sendPacket(const LauncherPacket &packet)
 Process *LauncherSocketHandler::setupProcess(quintptr token)
 {
     const auto p = new Process(token, this);
-    connect(p, &QProcess::errorOccurred, this, &LauncherSocketHandler::handleProcessError);
-    connect(p, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+    connect(p, &ProcessBase::errorOccurred, this, &LauncherSocketHandler::handleProcessError);
+    connect(p, static_cast<void (ProcessBase::*)(int, QProcess::ExitStatus)>(
+                &ProcessBase::finished),
             this, &LauncherSocketHandler::handleProcessFinished);
     connect(p, &Process::failedToStop, this, &LauncherSocketHandler::handleStopFailure);
     return p;
@@ -0,0 +1,395 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "unixprocess.h"
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qsocketnotifier.h>
+#include <QtCore/qstandardpaths.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace qbs {
+namespace Internal {
+
+static int sigChldPipe[2] = {-1, -1};
+
+static QList<UnixProcess *> &runningProcesses()
+{
+    static QList<UnixProcess *> processes;
+    return processes;
+}
+
+static void handleSigChld(int)
+{
+    const int savedErrno = errno;
+    const char c = 0;
+    const ssize_t written = ::write(sigChldPipe[1], &c, 1);
+    Q_UNUSED(written);
+    errno = savedErrno;
+}
+
+static bool createPipe(int fds[2])
+{
+    if (::pipe(fds) == -1)
+        return false;
+    for (int i = 0; i < 2; ++i)
+        ::fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    return true;
+}
+
+static void closePipe(int fds[2])
+{
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+static void setNonBlocking(int fd)
+{
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+static qint64 toMilliseconds(const timeval &time)
+{
+    return qint64(time.tv_sec) * 1000 + time.tv_usec / 1000;
+}
+
+UnixProcess::UnixProcess(QObject *parent) : QObject(parent)
+{
+    // A self-pipe tells the event loop about terminated children.
+    if (sigChldPipe[0] != -1)
+        return;
+    if (!createPipe(sigChldPipe))
+        qFatal("Cannot create pipe: %s", std::strerror(errno));
+    setNonBlocking(sigChldPipe[0]);
+    setNonBlocking(sigChldPipe[1]);
+    struct sigaction action;
+    std::memset(&action, 0, sizeof action);
+    action.sa_handler = handleSigChld;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    ::sigaction(SIGCHLD, &action, nullptr);
+    const auto notifier = new QSocketNotifier(sigChldPipe[0], QSocketNotifier::Read,
+                                              QCoreApplication::instance());
+    QObject::connect(notifier, &QSocketNotifier::activated, notifier, [] {
+        char buf[64];
+        while (::read(sigChldPipe[0], buf, sizeof buf) > 0)
+            ;
+        reapChildren();
+    });
+}
+
+UnixProcess::~UnixProcess()
+{
+    if (m_pid > 0) {
+        ::kill(m_pid, SIGKILL);
+        int status;
+        while (::waitpid(m_pid, &status, 0) == -1 && errno == EINTR)
+            ;
+        runningProcesses().removeOne(this);
+    }
+    closeChannel(m_stdout);
+    closeChannel(m_stderr);
+}
+
+void UnixProcess::start(const QString &program, const QStringList &arguments)
+{
+    m_error = QProcess::UnknownError;
+    m_errorString.clear();
+    m_exitCode = 0;
+    m_exitStatus = QProcess::NormalExit;
+    m_resourceUsage = ProcessResourceUsage();
+    m_stdout.data.clear();
+    m_stderr.data.clear();
+
+    // Like QProcess, look up programs without a path in the launcher's PATH.
+    const QString executable = program.contains(QLatin1Char('/'))
+            ? program : QStandardPaths::findExecutable(program);
+    if (executable.isEmpty()) {
+        failToStart(QStringLiteral("No such file or directory"));
+        return;
+    }
+
+    // The child must not allocate memory, so everything it needs is prepared up front.
+    std::vector<QByteArray> argumentData{executable.toLocal8Bit()};
+    for (const QString &arg : arguments)
+        argumentData.push_back(arg.toLocal8Bit());
+    std::vector<char *> argv;
+    for (QByteArray &arg : argumentData)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+    std::vector<QByteArray> environmentData;
+    for (const QString &var : std::as_const(m_environment))
+        environmentData.push_back(var.toLocal8Bit());
+    std::vector<char *> envp;
+    for (QByteArray &var : environmentData)
+        envp.push_back(var.data());
+    envp.push_back(nullptr);
+    char ** const childEnvironment = m_environment.empty() ? environ : envp.data();
+    const QByteArray workingDir = m_workingDirectory.toLocal8Bit();
+    struct sigaction defaultAction;
+    std::memset(&defaultAction, 0, sizeof defaultAction);
+    defaultAction.sa_handler = SIG_DFL;
+    sigset_t emptySignalSet;
+    sigemptyset(&emptySignalSet);
+
+    int stdoutPipe[2];
+    int stderrPipe[2];
+    int startPipe[2]; // Reports exec() failures.
+    if (!createPipe(stdoutPipe)) {
+        failToStart(QString::fromLocal8Bit(std::strerror(errno)));
+        return;
+    }
+    if (!createPipe(stderrPipe)) {
+        failToStart(QString::fromLocal8Bit(std::strerror(errno)));
+        closePipe(stdoutPipe);
+        return;
+    }
+    if (!createPipe(startPipe)) {
+        failToStart(QString::fromLocal8Bit(std::strerror(errno)));
+        closePipe(stdoutPipe);
+        closePipe(stderrPipe);
+        return;
+    }
+
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        // Only async-signal-safe functions from here on.
+        ::dup2(stdoutPipe[1], STDOUT_FILENO);
+        ::dup2(stderrPipe[1], STDERR_FILENO);
+        const int devNull = ::open("/dev/null", O_RDONLY);
+        if (devNull != -1) {
+            ::dup2(devNull, STDIN_FILENO);
+            if (devNull != STDIN_FILENO)
+                ::close(devNull);
+        }
+        ::sigaction(SIGCHLD, &defaultAction, nullptr);
+        ::sigaction(SIGPIPE, &defaultAction, nullptr);
+        ::sigprocmask(SIG_SETMASK, &emptySignalSet, nullptr);
+        if (workingDir.isEmpty() || ::chdir(workingDir.constData()) == 0)
+            ::execve(argv.front(), argv.data(), childEnvironment);
+        const int error = errno;
+        const ssize_t written = ::write(startPipe[1], &error, sizeof error);
+        Q_UNUSED(written);
+        ::_exit(127);
+    }
+
+    const int forkError = errno;
+    ::close(stdoutPipe[1]);
+    ::close(stderrPipe[1]);
+    ::close(startPipe[1]);
+    if (pid == -1) {
+        ::close(stdoutPipe[0]);
+        ::close(stderrPipe[0]);
+        ::close(startPipe[0]);
+        failToStart(QString::fromLocal8Bit(std::strerror(forkError)));
+        return;
+    }
+
+    // The pipe gets closed without data on a successful exec().
+    int childError = 0;
+    ssize_t bytesRead;
+    do {
+        bytesRead = ::read(startPipe[0], &childError, sizeof childError);
+    } while (bytesRead == -1 && errno == EINTR);
+    ::close(startPipe[0]);
+    if (bytesRead == sizeof childError) {
+        int status;
+        while (::waitpid(pid, &status, 0) == -1 && errno == EINTR)
+            ;
+        ::close(stdoutPipe[0]);
+        ::close(stderrPipe[0]);
+        failToStart(QString::fromLocal8Bit(std::strerror(childError)));
+        return;
+    }
+
+    m_pid = pid;
+    setupChannel(m_stdout, stdoutPipe[0]);
+    setupChannel(m_stderr, stderrPipe[0]);
+    runningProcesses().push_back(this);
+}
+
+void UnixProcess::terminate()
+{
+    if (m_pid > 0)
+        ::kill(m_pid, SIGTERM);
+}
+
+void UnixProcess::kill()
+{
+    if (m_pid > 0)
+        ::kill(m_pid, SIGKILL);
+}
+
+QProcess::ProcessState UnixProcess::state() const
+{
+    return m_pid > 0 ? QProcess::Running : QProcess::NotRunning;
+}
+
+QByteArray UnixProcess::readAllStandardOutput()
+{
+    return std::exchange(m_stdout.data, QByteArray());
+}
+
+QByteArray UnixProcess::readAllStandardError()
+{
+    return std::exchange(m_stderr.data, QByteArray());
+}
+
+void UnixProcess::reapChildren()
+{
+    const QList<UnixProcess *> processes = runningProcesses();
+    for (UnixProcess * const process : processes) {
+        // Finishing a process can lead to other processes getting deleted.
+        if (runningProcesses().contains(process))
+            process->tryReap();
+    }
+}
+
+bool UnixProcess::tryReap()
+{
+    int status;
+    struct rusage usage;
+    pid_t result;
+    do {
+        result = ::wait4(m_pid, &status, WNOHANG, &usage);
+    } while (result == -1 && errno == EINTR);
+    if (result == 0)
+        return false;
+
+    m_pid = 0;
+    runningProcesses().removeOne(this);
+
+    // The child has terminated, so everything it wrote is available in the pipes.
+    // We do not wait for the end of the streams, as they might have been inherited by
+    // processes that the child started.
+    readChannel(m_stdout);
+    readChannel(m_stderr);
+    closeChannel(m_stdout);
+    closeChannel(m_stderr);
+
+    if (result == -1) {
+        m_exitCode = -1;
+        m_exitStatus = QProcess::CrashExit;
+    } else if (WIFEXITED(status)) {
+        m_exitCode = WEXITSTATUS(status);
+        m_exitStatus = QProcess::NormalExit;
+    } else {
+        m_exitCode = WIFSIGNALED(status) ? WTERMSIG(status) : -1;
+        m_exitStatus = QProcess::CrashExit;
+    }
+    if (result != -1) {
+        m_resourceUsage.userTime = toMilliseconds(usage.ru_utime);
+        m_resourceUsage.systemTime = toMilliseconds(usage.ru_stime);
+#ifdef Q_OS_DARWIN
+        m_resourceUsage.maxResidentSetSize = usage.ru_maxrss;
+#else
+        m_resourceUsage.maxResidentSetSize = qint64(usage.ru_maxrss) * 1024;
+#endif
+        m_resourceUsage.blockInputOperations = usage.ru_inblock;
+        m_resourceUsage.blockOutputOperations = usage.ru_oublock;
+    }
+    if (m_exitStatus == QProcess::CrashExit) {
+        m_error = QProcess::Crashed;
+        m_errorString = QStringLiteral("Process crashed.");
+        emit errorOccurred(m_error);
+    }
+    emit finished(m_exitCode, m_exitStatus);
+    return true;
+}
+
+void UnixProcess::setupChannel(Channel &channel, int fd)
+{
+    setNonBlocking(fd);
+    channel.fd = fd;
+    channel.notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(channel.notifier, &QSocketNotifier::activated, this, [this, &channel] {
+        readChannel(channel);
+    });
+}
+
+void UnixProcess::readChannel(Channel &channel)
+{
+    while (channel.fd != -1) {
+        char buf[4096];
+        const ssize_t bytesRead = ::read(channel.fd, buf, sizeof buf);
+        if (bytesRead > 0) {
+            channel.data.append(buf, int(bytesRead));
+            continue;
+        }
+        if (bytesRead == -1 && errno == EINTR)
+            continue;
+        if (bytesRead == 0 || errno != EAGAIN)
+            closeChannel(channel); // End of stream or error.
+        break;
+    }
+}
+
+void UnixProcess::closeChannel(Channel &channel)
+{
+    if (channel.fd == -1)
+        return;
+    channel.notifier->setEnabled(false);
+    channel.notifier->deleteLater(); // We might be in a slot connected to the notifier.
+    channel.notifier = nullptr;
+    ::close(channel.fd);
+    channel.fd = -1;
+}
+
+void UnixProcess::failToStart(const QString &reason)
+{
+    m_error = QProcess::FailedToStart;
+    m_errorString = QStringLiteral("Process failed to start: %1").arg(reason);
+    emit errorOccurred(m_error);
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,118 @@
+/****************************************************************************
+**
+** Copyright (C) 2026 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_UNIXPROCESS_H
+#define QBS_UNIXPROCESS_H
+
+#include <launcherpackets.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qstringlist.h>
+
+#include <sys/types.h>
+
+QT_BEGIN_NAMESPACE
+class QSocketNotifier;
+QT_END_NAMESPACE
+
+namespace qbs {
+namespace Internal {
+
+// Provides the subset of the QProcess interface that the launcher needs.
+// Unlike QProcess, it reaps the child itself via wait4(), which lets us report
+// the resources the child has consumed.
+class UnixProcess : public QObject
+{
+    Q_OBJECT
+public:
+    explicit UnixProcess(QObject *parent = nullptr);
+    ~UnixProcess() override;
+
+    void setEnvironment(const QStringList &environment) { m_environment = environment; }
+    void setWorkingDirectory(const QString &workingDir) { m_workingDirectory = workingDir; }
+    void start(const QString &program, const QStringList &arguments);
+    void terminate();
+    void kill();
+
+    QProcess::ProcessState state() const;
+    QProcess::ProcessError error() const { return m_error; }
+    QString errorString() const { return m_errorString; }
+    int exitCode() const { return m_exitCode; }
+    QProcess::ExitStatus exitStatus() const { return m_exitStatus; }
+    QByteArray readAllStandardOutput();
+    QByteArray readAllStandardError();
+    ProcessResourceUsage resourceUsage() const { return m_resourceUsage; }
+
+signals:
+    void errorOccurred(QProcess::ProcessError error);
+    void finished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    struct Channel
+    {
+        int fd = -1;
+        QSocketNotifier *notifier = nullptr;
+        QByteArray data;
+    };
+
+    static void reapChildren();
+    bool tryReap();
+    void setupChannel(Channel &channel, int fd);
+    void readChannel(Channel &channel);
+    void closeChannel(Channel &channel);
+    void failToStart(const QString &reason);
+
+    QStringList m_environment;
+    QString m_workingDirectory;
+    Channel m_stdout;
+    Channel m_stderr;
+    pid_t m_pid = 0;
+    QProcess::ProcessError m_error = QProcess::UnknownError;
+    QString m_errorString;
+    int m_exitCode = 0;
+    QProcess::ExitStatus m_exitStatus = QProcess::NormalExit;
+    ProcessResourceUsage m_resourceUsage;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // Include guard
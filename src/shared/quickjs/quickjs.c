@@ -58293,6 +58293,15 @@ void setFunctionExitedHandler(JSContext *ctx, FunctionExitedHandler *handler)
     ctx->handleFunctionExited = handler;
 }
 
+JSValue evalFunctionWithThis(JSContext *ctx, JSValue fun_obj, JSValueConst this_obj)
+{
+    if (!ctx->rt->current_stack_frame) {
+        JS_FreeValueRT(ctx->rt, ctx->error_back_trace);
+        ctx->error_back_trace = JS_UNDEFINED;
+    }
+    return JS_EvalFunctionInternal(ctx, fun_obj, this_obj, NULL, NULL);
+}
+
 #ifndef NDEBUG
 static void *watchedRefCount = NULL;
 
@@ -1286,6 +1286,9 @@ typedef void FunctionExitedHandler(JSContext *ctx);
 void setFunctionEnteredHandler(JSContext *ctx, FunctionEnteredHandler *handler);
 void setFunctionExitedHandler(JSContext *ctx, FunctionExitedHandler *handler);
 
+// Like JS_EvalFunction(), but with the given this object, as with JS_EvalThis().
+JSValue evalFunctionWithThis(JSContext *ctx, JSValue fun_obj, JSValueConst this_obj);
+
 #ifndef NDEBUG
 void watchRefCount(void *p);
 #endif
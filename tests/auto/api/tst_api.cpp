@@ -168,6 +168,7 @@ void TestApi::initTestCase()
                                               m_workingDataDir, false, true, &errorMessage),
              qPrintable(errorMessage));
     QVERIFY(copyDllExportHeader(m_sourceDataDir, m_workingDataDir));
+    redirectUserCaches(m_workingDataDir);
 }
 
 void TestApi::init()
@@ -361,6 +362,61 @@ void TestApi::buildGraphLocking()
     QVERIFY2(!QFileInfo(newLockFile).exists(), qPrintable(newLockFile));
 }
 
+void TestApi::buildGraphLockHeldUntilStored()
+{
+    // The build job reports its result before the build graph has been stored.
+    // The lock must be held until the store has been committed, so that a competing
+    // process never sees an incomplete build graph.
+    qbs::SetupProjectParameters setupParams = defaultSetupParameters("buildgraph-store");
+    removeBuildDir(setupParams);
+    std::unique_ptr<qbs::SetupProjectJob> setupJob(qbs::Project().setupProject(setupParams,
+                                                                        m_logSink, nullptr));
+    waitForFinished(setupJob.get());
+    QVERIFY2(!setupJob->error().hasError(), qPrintable(setupJob->error().toString()));
+    qbs::Project project = setupJob->project();
+    const QString buildDirName = relativeBuildDir(setupParams.configurationName());
+    const QString lockFile = setupParams.buildRoot() + '/' + buildDirName + '/' + buildDirName
+            + ".bg.lock";
+    const QString bgFilePath = setupParams.buildRoot() + '/' + relativeBuildGraphFilePath();
+
+    std::unique_ptr<qbs::BuildJob> buildJob(project.buildAllProducts(qbs::BuildOptions()));
+    BuildDescriptionReceiver receiver;
+    connect(buildJob.get(), &qbs::BuildJob::reportCommandDescription, &receiver,
+            &BuildDescriptionReceiver::handleDescription);
+    waitForFinished(buildJob.get());
+    QVERIFY2(!buildJob->error().hasError(), qPrintable(buildJob->error().toString()));
+    QVERIFY2(receiver.descriptions.contains("generating outputs"),
+             qPrintable(receiver.descriptions));
+    QVERIFY2(QFileInfo(lockFile).isFile(), qPrintable(lockFile));
+
+    setupJob.reset(qbs::Project().setupProject(setupParams, m_logSink, nullptr));
+    waitForFinished(setupJob.get());
+    QVERIFY(setupJob->error().hasError());
+    QVERIFY2(setupJob->error().toString().contains("lock"),
+             qPrintable(setupJob->error().toString()));
+
+    // Letting go of the project waits for the store, so once the lock is gone,
+    // the build graph on disk must know about all outputs.
+    buildJob.reset(nullptr);
+    setupJob.reset(nullptr);
+    project = qbs::Project();
+    QVERIFY2(!QFileInfo::exists(lockFile), qPrintable(lockFile));
+    QVERIFY2(QFileInfo(bgFilePath).isFile(), qPrintable(bgFilePath));
+    setupParams.setOverrideBuildGraphData(false);
+    setupJob.reset(qbs::Project().setupProject(setupParams, m_logSink, nullptr));
+    waitForFinished(setupJob.get());
+    QVERIFY2(!setupJob->error().hasError(), qPrintable(setupJob->error().toString()));
+    project = setupJob->project();
+    receiver.descriptions.clear();
+    buildJob.reset(project.buildAllProducts(qbs::BuildOptions()));
+    connect(buildJob.get(), &qbs::BuildJob::reportCommandDescription, &receiver,
+            &BuildDescriptionReceiver::handleDescription);
+    waitForFinished(buildJob.get());
+    QVERIFY2(!buildJob->error().hasError(), qPrintable(buildJob->error().toString()));
+    QVERIFY2(!receiver.descriptions.contains("generating outputs"),
+             qPrintable(receiver.descriptions));
+}
+
 void TestApi::buildProject()
 {
     QFETCH(QString, projectSubDir);
@@ -63,6 +63,7 @@ private slots:
     void buildErrorCodeLocation();
     void buildGraphInfo();
     void buildGraphLocking();
+    void buildGraphLockHeldUntilStored();
     void buildProject();
     void buildProject_data();
     void buildProjectDryRun();
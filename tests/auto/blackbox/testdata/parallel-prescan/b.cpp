@@ -0,0 +1,3 @@
+#include <other.h>
+
+int b() { return other(); }
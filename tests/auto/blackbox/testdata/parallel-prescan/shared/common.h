@@ -0,0 +1,3 @@
+#include "detail.h"
+
+inline int common() { return detail(); }
@@ -0,0 +1,3 @@
+#include "leaf.h"
+
+inline int detail() { return leaf(); }
@@ -0,0 +1 @@
+inline int leaf() { return 0; }
@@ -0,0 +1,3 @@
+#include "leaf.h"
+
+inline int other() { return leaf() + 1; }
@@ -42,6 +42,7 @@
 #include <tools/stlutils.h>
 #include <tools/version.h>
 
+#include <QtCore/qcoreapplication.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qjsonarray.h>
@@ -55,6 +56,8 @@
 #include <QtCore/qtemporaryfile.h>
 #include <QtCore/qversionnumber.h>
 
+#include <QtNetwork/qlocalsocket.h>
+
 #include <algorithm>
 #include <functional>
 #include <regex>
@@ -417,6 +420,75 @@ TestBlackbox::TestBlackbox() : TestBlackboxBase (SRCDIR "/testdata", "blackbox")
 {
 }
 
+void TestBlackbox::actionCache()
+{
+    QDir::setCurrent(testDataDir + "/action-cache");
+    const QString cacheDir = QDir::currentPath() + "/action-cache-dir";
+    QbsRunParameters params(QStringList{"--action-cache", cacheDir});
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("copying input.txt"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("(cached)"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Action cache: 0 hit(s), 1 miss(es)."),
+             m_qbsStdout.constData());
+    QVERIFY(QFileInfo(cacheDir).isDir());
+
+    // A different build directory re-uses the result.
+    params.buildDirectory = "other-build";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("copying input.txt"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("(cached)"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Action cache: 1 hit(s), 0 miss(es)."),
+             m_qbsStdout.constData());
+    TEXT_FILE_COMPARE("other-build/" + relativeProductBuildDir("p") + "/output.txt",
+                      relativeProductBuildDir("p") + "/output.txt");
+
+    // Changed input, so the command has to run.
+    params.buildDirectory.clear();
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("input.txt", "old", "new");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("copying input.txt"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("(cached)"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Action cache: 0 hit(s), 1 miss(es)."),
+             m_qbsStdout.constData());
+
+    // Switching back to the old content is a cache hit again.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("input.txt", "new", "old");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("(cached)"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Action cache: 1 hit(s), 0 miss(es)."),
+             m_qbsStdout.constData());
+    TEXT_FILE_COMPARE("input.txt", relativeProductBuildDir("p") + "/output.txt");
+
+    // Without the option, the cache is not consulted.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("input.txt");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("copying input.txt"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("Action cache:"), m_qbsStdout.constData());
+
+    // Overwriting a restored output without the cache leaves the cache entry intact.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("input.txt", "old", "newer");
+    QCOMPARE(runQbs(), 0);
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("input.txt", "newer", "old");
+    params.buildDirectory = "third-build";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("(cached)"), m_qbsStdout.constData());
+    TEXT_FILE_COMPARE("input.txt", "third-build/" + relativeProductBuildDir("p") + "/output.txt");
+
+    // Content checking shares the post-processing of commands with the cache, but works
+    // without it.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("input.txt", "old", "newest");
+    QCOMPARE(runQbs(QbsRunParameters(QStringList("--check-contents"))), 0);
+    QVERIFY2(m_qbsStdout.contains("copying input.txt"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("Action cache:"), m_qbsStdout.constData());
+    TEXT_FILE_COMPARE("input.txt", relativeProductBuildDir("p") + "/output.txt");
+}
+
 void TestBlackbox::allowedValues()
 {
     QFETCH(QString, property);
@@ -853,6 +925,56 @@ void TestBlackbox::buildEnvChange()
     QVERIFY(runQbs(params) != 0);
 }
 
+void TestBlackbox::buildGraphJournal()
+{
+    QDir::setCurrent(testDataDir + "/build-graph-journal");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("generating one.gen"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating two.gen"), m_qbsStdout.constData());
+    const QString bgFilePath = relativeBuildGraphFilePath();
+    const QString journalFilePath = bgFilePath + ".journal";
+    QVERIFY(!QFileInfo::exists(journalFilePath));
+    const auto readFile = [](const QString &filePath) {
+        QFile file(filePath);
+        return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    };
+    const QByteArray bgContents = readFile(bgFilePath);
+    QVERIFY(!bgContents.isEmpty());
+
+    // After an incremental build, the changes are appended to the journal.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("one.txt");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("generating one.gen"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating two.gen"), m_qbsStdout.constData());
+    QVERIFY(QFileInfo::exists(journalFilePath));
+    QCOMPARE(readFile(bgFilePath), bgContents);
+
+    // A record that was cut off, e.g. because qbs got killed while writing it, is ignored.
+    {
+        QFile journalFile(journalFilePath);
+        QVERIFY2(journalFile.open(QIODevice::Append), qPrintable(journalFile.errorString()));
+        journalFile.write(QByteArray(8, '\0') + "incomplete");
+    }
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStderr.contains("Cannot use stored build graph"), m_qbsStderr.constData());
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("two.txt");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating one.gen"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating two.gen"), m_qbsStdout.constData());
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating"), m_qbsStdout.constData());
+
+    // Re-resolving writes the complete build graph file, which makes the journal obsolete.
+    QCOMPARE(runQbs(QbsRunParameters("resolve", QStringList("project.dummy:true"))), 0);
+    QVERIFY(!QFileInfo::exists(journalFilePath));
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::buildGraphVersions()
 {
     QDir::setCurrent(testDataDir + "/build-graph-versions");
@@ -883,6 +1005,99 @@ void TestBlackbox::buildGraphVersions()
     QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
 }
 
+void TestBlackbox::buildStateFingerprint()
+{
+    QDir::setCurrent(testDataDir + "/build-state-fingerprint");
+    const QByteArray fastPathMessage = "Build state fingerprint matches";
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("generating default.gen"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating non-default.gen"), m_qbsStdout.constData());
+    const QString fingerprintFilePath = relativeBuildGraphFilePath() + ".fingerprint";
+    QVERIFY(QFileInfo::exists(fingerprintFilePath));
+
+    // A null build does not need to set up the project.
+    QCOMPARE(runQbs(QStringList("-v")), 0);
+    QVERIFY2(m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QVERIFY2(m_qbsStdout.contains("Build done for configuration default."),
+             m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating"), m_qbsStdout.constData());
+
+    // A fingerprint for all products also covers the default ones, but not the other way around.
+    QCOMPARE(runQbs(QStringList{"-v", "--all-products"}), 0);
+    QVERIFY2(!m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QVERIFY2(m_qbsStdout.contains("generating non-default.gen"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating default.gen"), m_qbsStdout.constData());
+    QCOMPARE(runQbs(QStringList{"-v", "--all-products"}), 0);
+    QVERIFY2(m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QCOMPARE(runQbs(QStringList("-v")), 0);
+    QVERIFY2(m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+
+    // Only a real build can provide statistics and traces.
+    QCOMPARE(runQbs(QStringList{"-v", "--stats"}), 0);
+    QVERIFY2(!m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QCOMPARE(runQbs(QStringList{"-v", "--trace-file", "trace.json"}), 0);
+    QVERIFY2(!m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QVERIFY(regularFileExists("trace.json"));
+    QVERIFY(QFile::remove("trace.json"));
+
+    // Changed source files are detected.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("default.txt");
+    QCOMPARE(runQbs(QStringList("-v")), 0);
+    QVERIFY2(!m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QVERIFY2(m_qbsStdout.contains("generating default.gen"), m_qbsStdout.constData());
+    QCOMPARE(runQbs(QStringList("-v")), 0);
+    QVERIFY2(m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+
+    // So are changed project files.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("build-state-fingerprint.qbs");
+    QCOMPARE(runQbs(QStringList("-v")), 0);
+    QVERIFY2(!m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating"), m_qbsStdout.constData());
+
+    // Storing a changed build graph invalidates the fingerprint.
+    QCOMPARE(runQbs(QbsRunParameters("resolve", QStringList("project.dummy:true"))), 0);
+    QVERIFY(!QFileInfo::exists(fingerprintFilePath));
+    QCOMPARE(runQbs(QStringList("-v")), 0);
+    QVERIFY2(!m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating"), m_qbsStdout.constData());
+    QVERIFY(QFileInfo::exists(fingerprintFilePath));
+
+    // A build without installation does not cover one with installation.
+    const QString installedFile = defaultInstallRoot + "/default.txt";
+    QVERIFY(regularFileExists(installedFile));
+    QVERIFY(QFile::remove(installedFile));
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("default.txt");
+    QCOMPARE(runQbs(QStringList{"-v", "--no-install"}), 0);
+    QVERIFY2(!m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QVERIFY2(m_qbsStdout.contains("generating default.gen"), m_qbsStdout.constData());
+    QVERIFY(!QFileInfo::exists(installedFile));
+    QCOMPARE(runQbs(QStringList{"-v", "--no-install"}), 0);
+    QVERIFY2(m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QCOMPARE(runQbs(QStringList("-v")), 0);
+    QVERIFY2(!m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QVERIFY(regularFileExists(installedFile));
+    QCOMPARE(runQbs(QStringList("-v")), 0);
+    QVERIFY2(m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+
+    // Neither does a build with a different install root.
+    const QString otherInstallRoot = QDir::currentPath() + "/other-install-root";
+    QCOMPARE(runQbs(QStringList{"-v", "modules.qbs.installRoot:" + otherInstallRoot}), 0);
+    QVERIFY2(!m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QVERIFY(regularFileExists(otherInstallRoot + "/default.txt"));
+    QCOMPARE(runQbs(QStringList{"-v", "modules.qbs.installRoot:" + otherInstallRoot}), 0);
+    QVERIFY2(m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+
+    // Installed files that disappeared get installed again.
+    QVERIFY(QFile::remove(otherInstallRoot + "/default.txt"));
+    QCOMPARE(runQbs(QStringList("-v")), 0);
+    QVERIFY2(!m_qbsStderr.contains(fastPathMessage), m_qbsStderr.constData());
+    QVERIFY(regularFileExists(otherInstallRoot + "/default.txt"));
+    rmDirR(otherInstallRoot);
+}
+
 void TestBlackbox::buildVariantDefaults_data()
 {
     QTest::addColumn<QString>("configName");
@@ -1914,6 +2129,58 @@ void TestBlackbox::versionScript()
     QVERIFY2(globalSymbols.contains("dummyGlobal"), allSymbols.constData());
 }
 
+void TestBlackbox::watchMode()
+{
+    QDir::setCurrent(testDataDir + "/watch-mode");
+    const QbsRunParameters params;
+    QProcess qbs;
+    qbs.start(qbsExecutableFilePath, QStringList{"build", "--settings-dir", params.settingsDir,
+                                                 "-d", ".", "--watch",
+                                                 "profile:" + params.profile});
+    QVERIFY2(qbs.waitForStarted(), qPrintable(qbs.errorString()));
+    QByteArray output;
+    const auto waitForOutput = [&qbs, &output](const QByteArray &text) {
+        QElapsedTimer timer;
+        timer.start();
+        while (!output.contains(text) && timer.elapsed() < testTimeoutInMsecs()) {
+            qbs.waitForReadyRead(1000);
+            output += qbs.readAllStandardOutput();
+        }
+        const auto pos = output.indexOf(text);
+        if (pos == -1)
+            return false;
+        output.remove(0, pos + text.size());
+        return true;
+    };
+    QVERIFY2(waitForOutput("copying input.txt"), output.constData());
+    QVERIFY2(waitForOutput("Watching"), output.constData());
+    TEXT_FILE_COMPARE(relativeProductBuildDir("p") + "/output.txt", "input.txt");
+
+    // Changing a source file triggers a rebuild.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("input.txt", "old", "new");
+    QVERIFY2(waitForOutput("copying input.txt"), output.constData());
+    QVERIFY2(waitForOutput("Watching"), output.constData());
+    TEXT_FILE_COMPARE(relativeProductBuildDir("p") + "/output.txt", "input.txt");
+
+    // Changing a project file triggers a re-resolve and then a rebuild.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("watch-mode.qbs", "copying", "duplicating");
+    QVERIFY2(waitForOutput("duplicating input.txt"), output.constData());
+    QVERIFY2(waitForOutput("Watching"), output.constData());
+
+    // Errors do not end watch mode.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("input.txt", "new", "fail");
+    QVERIFY2(waitForOutput("Watching"), output.constData());
+    const QByteArray errorOutput = qbs.readAllStandardError();
+    QVERIFY2(errorOutput.contains("input must not contain 'fail'"), errorOutput.constData());
+    QCOMPARE(qbs.state(), QProcess::Running);
+
+    qbs.kill();
+    QVERIFY(qbs.waitForFinished());
+}
+
 void TestBlackbox::wholeArchive()
 {
     QDir::setCurrent(testDataDir + "/whole-archive");
@@ -2295,6 +2562,27 @@ void TestBlackbox::conflictingPropertyValues()
     }
 }
 
+void TestBlackbox::criticalPathScheduling()
+{
+    QDir::setCurrent(testDataDir + "/critical-path-scheduling");
+    const QbsRunParameters params(QStringList{"-j", "1"});
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("generating slow.out"), m_qbsStdout.constData());
+
+    // With one job, the commands run in the order of the durations recorded in the first build.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("fast.txt");
+    touch("medium.txt");
+    touch("slow.txt");
+    QCOMPARE(runQbs(params), 0);
+    const qsizetype slowIndex = m_qbsStdout.indexOf("generating slow.out");
+    const qsizetype mediumIndex = m_qbsStdout.indexOf("generating medium.out");
+    const qsizetype fastIndex = m_qbsStdout.indexOf("generating fast.out");
+    QVERIFY2(slowIndex != -1 && mediumIndex != -1 && fastIndex != -1, m_qbsStdout.constData());
+    QVERIFY2(slowIndex < mediumIndex, m_qbsStdout.constData());
+    QVERIFY2(mediumIndex < fastIndex, m_qbsStdout.constData());
+}
+
 void TestBlackbox::cpuFeatures()
 {
     QDir::setCurrent(testDataDir + "/cpu-features");
@@ -2583,6 +2871,44 @@ void TestBlackbox::separateDebugInfo()
     }
 }
 
+static QStringList traceEventCategories(const QString &traceFilePath, QStringList *names)
+{
+    QFile traceFile(traceFilePath);
+    if (!traceFile.open(QIODevice::ReadOnly))
+        return {};
+    const QJsonArray events = QJsonDocument::fromJson(traceFile.readAll()).object()
+            .value("traceEvents").toArray();
+    QStringList categories;
+    for (const QJsonValue &event : events) {
+        const QJsonObject eventObject = event.toObject();
+        if (eventObject.value("ph").toString() != "X")
+            continue;
+        categories << eventObject.value("cat").toString();
+        *names << eventObject.value("name").toString();
+    }
+    return categories;
+}
+
+void TestBlackbox::traceFile()
+{
+    QDir::setCurrent(testDataDir + "/trace-file");
+    QStringList names;
+    QCOMPARE(runQbs(QbsRunParameters("resolve", {"--trace-file", "resolve-trace.json"})), 0);
+    QStringList categories = traceEventCategories("resolve-trace.json", &names);
+    QVERIFY2(categories.contains("resolve"), qPrintable(categories.join(',')));
+    QVERIFY2(categories.contains("probe"), qPrintable(categories.join(',')));
+    QVERIFY2(categories.contains("buildgraph"), qPrintable(categories.join(',')));
+    QVERIFY2(names.contains("p"), qPrintable(names.join(',')));
+
+    names.clear();
+    QCOMPARE(runQbs(QStringList{"--trace-file", "build-trace.json"}), 0);
+    QVERIFY2(m_qbsStdout.contains("creating blubb.txt"), m_qbsStdout.constData());
+    categories = traceEventCategories("build-trace.json", &names);
+    QVERIFY2(categories.contains("job"), qPrintable(categories.join(',')));
+    QVERIFY2(categories.contains("rule"), qPrintable(categories.join(',')));
+    QVERIFY2(names.contains("creating blubb.txt"), qPrintable(names.join(',')));
+}
+
 void TestBlackbox::trackAddFile()
 {
     QList<QByteArray> output;
@@ -2979,6 +3305,73 @@ void TestBlackbox::referenceErrorInExport()
         m_qbsStderr.constData());
 }
 
+void TestBlackbox::remoteActionCache()
+{
+    QDir::setCurrent(testDataDir + "/remote-action-cache");
+    const QString serverFilePath = HostOsInfo::appendExecutableSuffix(
+                QFileInfo(qbsExecutableFilePath).absolutePath() + "/qbs-action-cache-server");
+    QProcess server;
+    server.start(serverFilePath, {"--directory", QDir::currentPath() + "/server-storage"});
+    QVERIFY2(server.waitForStarted(), qPrintable(server.errorString()));
+    QVERIFY2(server.waitForReadyRead(), server.readAllStandardError().constData());
+    const QString url = QString::fromLocal8Bit(server.readLine()).trimmed();
+    QVERIFY2(url.startsWith("http://"), qPrintable(url));
+
+    // The first build populates the server.
+    QbsRunParameters params(QStringList{"--action-cache", QDir::currentPath() + "/cache-1",
+                                        "--remote-action-cache", url});
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("(cached)"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Remote action cache: 0 hit(s), 1 upload(s)."),
+             m_qbsStdout.constData());
+
+    // An empty local cache, as on a different machine, is filled from the server.
+    params.arguments = QStringList{"--action-cache", QDir::currentPath() + "/cache-2",
+                                   "--remote-action-cache", url};
+    params.buildDirectory = "other-build";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("(cached)"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Action cache: 1 hit(s), 0 miss(es)."),
+             m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Remote action cache: 1 hit(s), 0 upload(s)."),
+             m_qbsStdout.constData());
+    TEXT_FILE_COMPARE("other-build/" + relativeProductBuildDir("p") + "/output.txt",
+                      "input.txt");
+
+    // Entries sent in chunked transfer encoding, as many proxies do, are understood as well.
+    QProcess chunkedServer;
+    chunkedServer.start(serverFilePath, {"--directory", QDir::currentPath() + "/server-storage",
+                                         "--chunked"});
+    QVERIFY2(chunkedServer.waitForStarted(), qPrintable(chunkedServer.errorString()));
+    QVERIFY2(chunkedServer.waitForReadyRead(),
+             chunkedServer.readAllStandardError().constData());
+    const QString chunkedUrl = QString::fromLocal8Bit(chunkedServer.readLine()).trimmed();
+    QbsRunParameters chunkedParams(QStringList{"--action-cache", QDir::currentPath() + "/cache-3",
+                                               "--remote-action-cache", chunkedUrl});
+    chunkedParams.buildDirectory = "third-build";
+    QCOMPARE(runQbs(chunkedParams), 0);
+    QVERIFY2(m_qbsStdout.contains("Remote action cache: 1 hit(s), 0 upload(s)."),
+             m_qbsStdout.constData());
+    TEXT_FILE_COMPARE("third-build/" + relativeProductBuildDir("p") + "/output.txt",
+                      "input.txt");
+    chunkedServer.kill();
+    QVERIFY(chunkedServer.waitForFinished());
+
+    // If the server is gone, the build goes on without it.
+    server.kill();
+    QVERIFY(server.waitForFinished());
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("input.txt", "old", "new");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStderr.contains("is not available"), m_qbsStderr.constData());
+    QVERIFY2(m_qbsStdout.contains("copying input.txt"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("(cached)"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Action cache: 0 hit(s), 1 miss(es)."),
+             m_qbsStdout.constData());
+    TEXT_FILE_COMPARE("other-build/" + relativeProductBuildDir("p") + "/output.txt",
+                      "input.txt");
+}
+
 void TestBlackbox::removeDuplicateLibraries_data()
 {
     QTest::addColumn<bool>("removeDuplicates");
@@ -3045,6 +3438,74 @@ void TestBlackbox::reproducibleBuild_data()
     QTest::newRow("reproducible build") << true;
 }
 
+void TestBlackbox::resolveServer()
+{
+    QDir::setCurrent(testDataDir + "/resolve-server");
+    const QString serverName = "qbs-resolve-server-test-"
+            + QString::number(QCoreApplication::applicationPid());
+    const QString serverLogFilePath = QDir::currentPath() + "/server-log.txt";
+    QProcess server;
+    QProcessEnvironment serverEnv = QProcessEnvironment::systemEnvironment();
+    serverEnv.insert("QT_LOGGING_RULES", "qbs.buildgraph.debug=true");
+    server.setProcessEnvironment(serverEnv);
+    server.setStandardErrorFile(serverLogFilePath);
+    server.start(qbsExecutableFilePath, QStringList{"session", "--resolve-server", serverName});
+    QVERIFY2(server.waitForStarted(), qPrintable(server.errorString()));
+    const auto serverIsListening = [&serverName] {
+        QLocalSocket socket;
+        socket.connectToServer(serverName);
+        return socket.waitForConnected(100);
+    };
+    QTRY_VERIFY_WITH_TIMEOUT(serverIsListening(), 10000);
+    QCOMPARE(server.state(), QProcess::Running);
+
+    QbsRunParameters params("build", QStringList{"--log-level", "debug"});
+    params.environment.insert("QBS_RESOLVE_SERVER", serverName);
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStderr.contains("Cannot reach resolve server"), m_qbsStderr.constData());
+    QVERIFY2(m_qbsStdout.contains("probe says old message"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("creating output.txt"), m_qbsStdout.constData());
+    READ_TEXT_FILE(relativeProductBuildDir("p") + "/output.txt", oldOutput);
+    QCOMPARE(oldOutput, QByteArray("old message"));
+
+    // Nothing changed, so the server can use the project from the previous run. The build
+    // has changed the build graph, which the server has loaded again in the meantime.
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("probe says"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("creating output.txt"), m_qbsStdout.constData());
+    const auto serverLog = [&serverLogFilePath] {
+        QFile logFile(serverLogFilePath);
+        return logFile.open(QIODevice::ReadOnly) ? logFile.readAll() : QByteArray();
+    };
+    QVERIFY2(serverLog().contains("build graph is unchanged, using the project in memory"),
+             serverLog().constData());
+
+    // Changes to the project file are picked up.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("resolve-server.qbs", "old message", "new message");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("probe says new message"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("creating output.txt"), m_qbsStdout.constData());
+    READ_TEXT_FILE(relativeProductBuildDir("p") + "/output.txt", newOutput);
+    QCOMPARE(newOutput, QByteArray("new message"));
+
+    // Resolve errors are reported by the client.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("resolve-server.qbs", "type: \"output\"", "type: \"output\"\n    blubb: 1");
+    params.expectFailure = true;
+    QVERIFY(runQbs(params) != 0);
+    QVERIFY2(m_qbsStderr.contains("blubb"), m_qbsStderr.constData());
+    QCOMPARE(server.state(), QProcess::Running);
+
+    // Without a server, the project is resolved locally.
+    server.kill();
+    QVERIFY(server.waitForFinished());
+    REPLACE_IN_FILE("resolve-server.qbs", "\n    blubb: 1", "");
+    params.expectFailure = false;
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStderr.contains("Cannot reach resolve server"), m_qbsStderr.constData());
+}
+
 void TestBlackbox::responseFiles()
 {
     QDir::setCurrent(testDataDir + "/response-files");
@@ -3970,6 +4431,122 @@ void TestBlackbox::overrideProjectProperties()
     QCOMPARE(runQbs(params), 0);
 }
 
+void TestBlackbox::parallelPrescan()
+{
+    QDir::setCurrent(testDataDir + "/parallel-prescan");
+
+    // With one job, inputs are scanned on the executor thread, otherwise in worker threads.
+    // The latter scan the headers shared by all products concurrently.
+    QbsRunParameters serialParams(QStringList{"-j", "1"});
+    serialParams.buildDirectory = "serial-build";
+    QbsRunParameters parallelParams(QStringList{"-j", "8"});
+    parallelParams.buildDirectory = "parallel-build";
+    QCOMPARE(runQbs(serialParams), 0);
+    QCOMPARE(runQbs(parallelParams), 0);
+    QVERIFY2(m_qbsStdout.count("compiling") == 12, m_qbsStdout.constData());
+
+    const auto compiledFiles = [this] {
+        QStringList lines;
+        for (const QByteArray &line : m_qbsStdout.split('\n')) {
+            if (line.startsWith("compiling"))
+                lines << QString::fromLocal8Bit(line.trimmed());
+        }
+        lines.sort();
+        return lines;
+    };
+
+    // Both builds have found the same dependencies, so a header change has the same effect.
+    for (const QString &header : QStringList{"leaf.h", "detail.h", "common.h", "other.h"}) {
+        WAIT_FOR_NEW_TIMESTAMP();
+        touch("shared/" + header);
+        QCOMPARE(runQbs(serialParams), 0);
+        const QStringList serialFiles = compiledFiles();
+        QVERIFY2(!serialFiles.isEmpty(), qPrintable(header));
+        QCOMPARE(runQbs(parallelParams), 0);
+        QCOMPARE(compiledFiles(), serialFiles);
+    }
+}
+
+void TestBlackbox::partialBuildGraphLoading()
+{
+    QDir::setCurrent(testDataDir + "/partial-build-graph-loading");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("generating lib.gen"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating app.gen"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating other.gen"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("combining"), m_qbsStdout.constData());
+
+    // Only the build data of "app" and its dependency gets loaded. The one of "other" is
+    // carried over unchanged when the build graph is stored.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("lib.txt");
+    touch("other.txt");
+    QbsRunParameters params(QStringList{"-p", "app"});
+    params.environment.insert("QT_LOGGING_RULES", "qbs.buildgraph.debug=true");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("generating lib.gen"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating app.gen"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating other.gen"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("combining"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStderr.contains("restoring build data of product \"lib\""),
+             m_qbsStderr.constData());
+    QVERIFY2(m_qbsStderr.contains("restoring build data of product \"app\""),
+             m_qbsStderr.constData());
+    QVERIFY2(!m_qbsStderr.contains("restoring build data of product \"other\""),
+             m_qbsStderr.constData());
+
+    QCOMPARE(runQbs(QbsRunParameters("list-products")), 0);
+    QVERIFY2(m_qbsStdout.contains("app") && m_qbsStdout.contains("lib")
+             && m_qbsStdout.contains("other"), m_qbsStdout.constData());
+
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating lib.gen"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating app.gen"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating other.gen"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("combining"), m_qbsStdout.constData());
+
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("combining"), m_qbsStdout.constData());
+}
+
+void TestBlackbox::partialReResolve()
+{
+    QDir::setCurrent(testDataDir + "/partial-re-resolve");
+    const QbsRunParameters params("resolve", QStringList{"--log-level", "debug"});
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("evaluating a"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating b"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating c"), m_qbsStdout.constData());
+
+    // Only the product whose file has changed gets set up anew.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("c.qbs", "c1", "c2");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("evaluating a"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("evaluating b"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating c"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStderr.contains("Took over 2 of 3 products"), m_qbsStderr.constData());
+
+    // Products depending on a changed product are set up anew as well.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("a.qbs", "a1", "a2");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("evaluating a"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating b"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("evaluating c"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStderr.contains("Took over 1 of 3 products"), m_qbsStderr.constData());
+
+    // The project file is relevant to all products.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("partial-re-resolve.qbs", "p1", "p2");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("evaluating a"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating b"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating c"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStderr.contains("Took over"), m_qbsStderr.constData());
+}
+
 void TestBlackbox::partiallyBuiltDependency_data()
 {
     QTest::addColumn<QByteArray>("mode");
@@ -4252,6 +4829,52 @@ void TestBlackbox::preventFloatingPointValues()
     QVERIFY2(m_qbsStdout.contains("version: 1.50"), m_qbsStdout.constData());
 }
 
+void TestBlackbox::probeCache()
+{
+    QDir::setCurrent(testDataDir + "/probe-cache");
+    QbsRunParameters params("resolve");
+    params.environment.insert("QBS_PROBE_CACHE_DIR", QDir::currentPath() + "/probe-cache-dir");
+    params.environment.insert("PROBE_CACHE_TEST_VAR", "v1");
+    params.buildDirectory = "build1";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: input1v1"), m_qbsStdout.constData());
+
+    // A fresh build directory takes the result from the cache.
+    params.buildDirectory = "build2";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: input1v1"), m_qbsStdout.constData());
+
+    // Changing an environment variable used by the probe invalidates the entry.
+    params.environment.insert("PROBE_CACHE_TEST_VAR", "v2");
+    params.buildDirectory = "build3";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: input1v2"), m_qbsStdout.constData());
+
+    // So does changing a file read by the probe.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("input.txt", "input1", "input2");
+    params.buildDirectory = "build4";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: input2v2"), m_qbsStdout.constData());
+
+    // Forcing probe execution bypasses the cache.
+    params.buildDirectory = "build5";
+    params.arguments << "--force-probe-execution";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+
+    // Without the environment variable, the cache is not used.
+    params.environment.remove("QBS_PROBE_CACHE_DIR");
+    params.arguments.clear();
+    params.buildDirectory = "build6";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::probeChangeTracking()
 {
     QDir::setCurrent(testDataDir + "/probe-change-tracking");
@@ -5917,6 +6540,42 @@ void TestBlackbox::commandFile()
     QCOMPARE(runQbs(params), 0);
 }
 
+void TestBlackbox::commandStats()
+{
+    QDir::setCurrent(testDataDir + "/command-stats");
+    QCOMPARE(runQbs(QbsRunParameters(QStringList("--stats"))), 0);
+    QVERIFY2(m_qbsStdout.contains("copying input.txt"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("1 command(s) were run."), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Commands that took the longest:"), m_qbsStdout.constData());
+    if (HostOsInfo::isAnyUnixHost()) {
+        QVERIFY2(m_qbsStdout.contains("Commands that used the most CPU time:"),
+                 m_qbsStdout.constData());
+        QVERIFY2(m_qbsStdout.contains("Commands that used the most memory:"),
+                 m_qbsStdout.constData());
+
+        // Any process occupies some memory.
+        const QRegularExpression memoryPattern("^\\s+(\\d+\\.\\d) MiB  .*cat",
+                                               QRegularExpression::MultilineOption);
+        const QRegularExpressionMatch match
+                = memoryPattern.match(QString::fromLocal8Bit(m_qbsStdout));
+        QVERIFY2(match.hasMatch(), m_qbsStdout.constData());
+        QVERIFY2(match.captured(1).toDouble() > 0, m_qbsStdout.constData());
+    }
+    QVERIFY2(QRegularExpression("^\\s+\\d+\\.\\d\\d s  ", QRegularExpression::MultilineOption)
+             .match(QString::fromLocal8Bit(m_qbsStdout)).hasMatch(), m_qbsStdout.constData());
+
+    // Nothing to do, nothing to report.
+    QCOMPARE(runQbs(QbsRunParameters(QStringList("--stats"))), 0);
+    QVERIFY2(!m_qbsStdout.contains("copying input.txt"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("Commands that took the longest:"), m_qbsStdout.constData());
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("input.txt");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("copying input.txt"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("Commands that took the longest:"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::compilerDefinesByLanguage()
 {
     QDir::setCurrent(testDataDir + "/compilerDefinesByLanguage");
@@ -8865,6 +9524,40 @@ void TestBlackbox::topLevelSearchPath()
     QCOMPARE(runQbs(params), 0);
 }
 
+void TestBlackbox::checkContents()
+{
+    QDir::setCurrent(testDataDir + "/check-contents");
+    QbsRunParameters params(QStringList("--check-contents"));
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("generating intermediate.txt"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating final.txt"), m_qbsStdout.constData());
+
+    // The intermediate file gets re-generated with the same content, so the final file
+    // is not rebuilt.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("input.txt", "alpha", "alpha\nbeta");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("generating intermediate.txt"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating final.txt"), m_qbsStdout.constData());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating intermediate.txt"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating final.txt"), m_qbsStdout.constData());
+
+    // A real content change propagates.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("input.txt", "alpha", "gamma");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("generating intermediate.txt"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating final.txt"), m_qbsStdout.constData());
+
+    // Without the option, timestamps are all that counts.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("input.txt", "beta", "delta");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("generating intermediate.txt"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating final.txt"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::checkProjectFilePath()
 {
     QDir::setCurrent(testDataDir + "/project_filepath_check");
@@ -9974,6 +10667,29 @@ void TestBlackbox::maximumCxxLanguageVersion()
              m_qbsStdout.constData());
 }
 
+void TestBlackbox::memoryThrottling()
+{
+    QDir::setCurrent(testDataDir + "/memory-throttling");
+    const QStringList outputs{"a.out", "b.out", "c.out", "d.out"};
+
+    // No system has that much memory, so there is never more than one job running.
+    // The build must still finish.
+    QbsRunParameters params(QStringList{"-j", "4", "--min-available-memory", "100000000"});
+    QCOMPARE(runQbs(params), 0);
+    for (const QString &output : outputs)
+        QVERIFY(regularFileExists(relativeProductBuildDir("p") + '/' + output));
+    if (HostOsInfo::isLinuxHost() || HostOsInfo::isWindowsHost())
+        QVERIFY2(m_qbsStdout.contains("due to low memory"), m_qbsStdout.constData());
+
+    // Jobs from other pools are not affected.
+    rmDirR(relativeBuildDir());
+    params.arguments << "--memory-heavy-job-pools" << "linker";
+    QCOMPARE(runQbs(params), 0);
+    for (const QString &output : outputs)
+        QVERIFY(regularFileExists(relativeProductBuildDir("p") + '/' + output));
+    QVERIFY2(!m_qbsStdout.contains("due to low memory"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::minimumSystemVersion()
 {
     rmDirR(relativeBuildDir());
@@ -10254,6 +10970,73 @@ void TestBlackbox::badInterpreter()
     QCOMPARE(runQbs(QbsRunParameters("run", QStringList() << "-p" << "script-ok")), 0);
 }
 
+void TestBlackbox::benchNullBuild_data()
+{
+    QTest::addColumn<int>("fileCount");
+    QTest::newRow("1000 files") << 1000;
+    QTest::newRow("10000 files") << 10000;
+    QTest::newRow("50000 files") << 50000;
+}
+
+void TestBlackbox::benchNullBuild()
+{
+    SKIP_UNLESS_BENCHMARKING();
+    QFETCH(int, fileCount);
+    QDir::setCurrent(testDataDir + "/bench-null-build");
+    rmDirR(relativeBuildDir());
+    QVERIFY(QDir("src").removeRecursively());
+
+    // Spread the files over directories with 100 entries each, like in a real source tree.
+    for (int i = 0; i < fileCount; ++i) {
+        const QString dirPath = QStringLiteral("src/dir%1").arg(i / 100);
+        if (i % 100 == 0)
+            QVERIFY(QDir().mkpath(dirPath));
+        QFile file(dirPath + QStringLiteral("/file%1.txt").arg(i));
+        QVERIFY2(file.open(QIODevice::WriteOnly), qPrintable(file.errorString()));
+    }
+    QCOMPARE(runQbs(), 0);
+
+    // Every null build has to check the timestamps of all source files.
+    QBENCHMARK {
+        QCOMPARE(runQbs(), 0);
+    }
+    QVERIFY2(!m_qbsStdout.contains("Resolving"), m_qbsStdout.constData());
+}
+
+void TestBlackbox::benchScheduler_data()
+{
+    QTest::addColumn<int>("fileCount");
+    QTest::newRow("1000 files") << 1000;
+    QTest::newRow("10000 files") << 10000;
+    QTest::newRow("30000 files") << 30000;
+}
+
+void TestBlackbox::benchScheduler()
+{
+    SKIP_UNLESS_BENCHMARKING();
+
+    QFETCH(int, fileCount);
+    QDir::setCurrent(testDataDir + "/bench-scheduler");
+    rmDirR(relativeBuildDir());
+    QVERIFY(QDir("src").removeRecursively());
+    for (int i = 0; i < fileCount; ++i) {
+        const QString dirPath = QStringLiteral("src/dir%1").arg(i / 100);
+        if (i % 100 == 0)
+            QVERIFY(QDir().mkpath(dirPath));
+        QFile file(dirPath + QStringLiteral("/file%1.in").arg(i));
+        QVERIFY2(file.open(QIODevice::WriteOnly), qPrintable(file.errorString()));
+    }
+    QCOMPARE(runQbs(QbsRunParameters("resolve")), 0);
+
+    // In a dry run, all nodes get scheduled, but no commands are run. The aggregate node
+    // has all the other generated nodes as children, the common node has them as parents.
+    QbsRunParameters params(QStringList("--dry-run"));
+    QBENCHMARK {
+        QCOMPARE(runQbs(params), 0);
+    }
+    QVERIFY(!regularFileExists(relativeProductBuildDir("p") + "/aggregate.txt"));
+}
+
 void TestBlackbox::bomSources()
 {
     QDir::setCurrent(testDataDir + "/bom-sources");
@@ -40,6 +40,7 @@ public:
     TestBlackbox();
 
 private slots:
+    void actionCache();
     void allowedValues();
     void allowedValues_data();
     void addFileTagToGeneratedArtifact();
@@ -58,6 +59,10 @@ private slots:
     void autotests();
     void auxiliaryInputsFromDependencies();
     void badInterpreter();
+    void benchNullBuild_data();
+    void benchNullBuild();
+    void benchScheduler_data();
+    void benchScheduler();
     void bomSources();
     void boolValueInProfile();
     void buildDataOfDisabledProduct();
@@ -65,7 +70,9 @@ private slots:
     void buildDirPlaceholders_data();
     void buildDirPlaceholders();
     void buildEnvChange();
+    void buildGraphJournal();
     void buildGraphVersions();
+    void buildStateFingerprint();
     void buildVariantDefaults_data();
     void buildVariantDefaults();
     void capnproto();
@@ -77,6 +84,7 @@ private slots:
     void changeInDisabledProduct();
     void changeInImportedFile();
     void changeTrackingAndMultiplexing();
+    void checkContents();
     void checkProjectFilePath();
     void checkTimestamps();
     void chooseModuleInstanceByPriorityAndVersion();
@@ -85,6 +93,7 @@ private slots:
     void cli();
     void combinedSources();
     void commandFile();
+    void commandStats();
     void compilerDefinesByLanguage();
     void cppLibrary();
     void conditionalExport();
@@ -97,6 +106,7 @@ private slots:
     void conanfileProbe();
     void conflictingPropertyValues_data();
     void conflictingPropertyValues();
+    void criticalPathScheduling();
     void cpuFeatures();
     void cxxModules_data();
     void cxxModules();
@@ -227,6 +237,7 @@ private slots:
     void makefileGenerator();
     void maximumCLanguageVersion();
     void maximumCxxLanguageVersion();
+    void memoryThrottling();
     void minimumSystemVersion();
     void minimumSystemVersion_data();
     void missingBuildGraph();
@@ -259,6 +270,9 @@ private slots:
     void outputArtifactAutoTagging();
     void outputRedirection();
     void overrideProjectProperties();
+    void parallelPrescan();
+    void partialBuildGraphLoading();
+    void partialReResolve();
     void partiallyBuiltDependency_data();
     void partiallyBuiltDependency();
     void pathProbe_data();
@@ -275,6 +289,7 @@ private slots:
     void precompiledAndPrefixHeaders();
     void precompiledHeaderAndRedefine();
     void preventFloatingPointValues();
+    void probeCache();
     void probeChangeTracking();
     void probeProperties();
     void probesAndShadowProducts();
@@ -312,12 +327,14 @@ private slots:
     void recursiveRenaming();
     void recursiveWildcards();
     void referenceErrorInExport();
+    void remoteActionCache();
     void removeDuplicateLibraries_data();
     void removeDuplicateLibraries();
     void reproducibleBuild();
     void reproducibleBuild_data();
     void require();
     void rescueTransformerData();
+    void resolveServer();
     void responseFiles();
     void retaggedOutputArtifact();
     void rpathlinkDeduplication();
@@ -369,6 +386,7 @@ private slots:
     void textTemplate();
     void toolLookup();
     void topLevelSearchPath();
+    void traceFile();
     void trackAddFile();
     void trackAddFileTag();
     void trackAddProduct();
@@ -390,6 +408,7 @@ private slots:
     void versionCheck();
     void versionCheck_data();
     void versionScript();
+    void watchMode();
     void wholeArchive();
     void wholeArchive_data();
     void wildCardsAndRules();
@@ -194,6 +194,7 @@ void TestBlackboxBase::initTestCase()
     rmDirR(testDataDir);
     QDir().mkpath(testDataDir);
     ccp(testSourceDir, testDataDir);
+    redirectUserCaches(testDataDir);
     QDir().mkpath(testDataDir + "/find");
     ccp(testSourceDir + "/../find", testDataDir + "/find");
     QVERIFY(copyDllExportHeader(testSourceDir, testDataDir));
@@ -42,6 +42,7 @@
 #include <buildgraph/artifact.h>
 #include <buildgraph/buildgraph.h>
 #include <buildgraph/cycledetector.h>
+#include <buildgraph/jobbudget.h>
 #include <buildgraph/productbuilddata.h>
 #include <buildgraph/projectbuilddata.h>
 #include <language/language.h>
@@ -144,6 +145,66 @@ void TestBuildGraph::testCycle()
     QVERIFY(!cycleDetected(productWithNoCycle()));
 }
 
+void TestBuildGraph::testJobBudget()
+{
+    using qbs::Internal::JobBudget;
+    JobBudget budget;
+    const int config1 = 1;
+    const int config2 = 2;
+    const int config3 = 3;
+    QStringList wakeUps;
+    budget.registerClient(&config1, 2, [&wakeUps] { wakeUps << QStringLiteral("config1"); });
+    budget.registerClient(&config2, 2, [&wakeUps] { wakeUps << QStringLiteral("config2"); });
+    budget.registerClient(&config3, 1, [&wakeUps] { wakeUps << QStringLiteral("config3"); });
+    QCOMPARE(budget.capacity(), 2);
+
+    // The tokens are shared by all clients.
+    const JobBudget::PoolLimits noPool;
+    QVERIFY(budget.tryAcquire(&config1, 10, noPool) == JobBudget::AcquireResult::Acquired);
+    QVERIFY(budget.tryAcquire(&config2, 10, noPool) == JobBudget::AcquireResult::Acquired);
+    QCOMPARE(budget.freeTokens(), 0);
+    QVERIFY(budget.tryAcquire(&config1, 5, noPool) == JobBudget::AcquireResult::BlockedByBudget);
+    QVERIFY(budget.tryAcquire(&config3, 7, noPool) == JobBudget::AcquireResult::BlockedByBudget);
+
+    // A released token goes to the waiting client with the most expensive work,
+    // no matter who released it.
+    budget.release(&config1, {});
+    QCOMPARE(wakeUps, QStringList{QStringLiteral("config3")});
+    QCOMPARE(budget.freeTokens(), 0);
+    QVERIFY(budget.tryAcquire(&config2, 20, noPool) == JobBudget::AcquireResult::BlockedByBudget);
+    QVERIFY(budget.tryAcquire(&config3, 7, noPool) == JobBudget::AcquireResult::Acquired);
+
+    // An unused reservation is passed on.
+    wakeUps.clear();
+    budget.release(&config3, {});
+    QCOMPARE(wakeUps, QStringList{QStringLiteral("config2")});
+    budget.returnUnusedTokens(&config2);
+    QCOMPARE(wakeUps, (QStringList{QStringLiteral("config2"), QStringLiteral("config1")}));
+    budget.returnUnusedTokens(&config1);
+    QCOMPARE(budget.freeTokens(), 1);
+
+    // Job pool limits apply to the jobs of all clients.
+    const JobBudget::PoolLimits linkerPool{{QStringLiteral("linker"), 1}};
+    QVERIFY(budget.tryAcquire(&config1, 1, linkerPool) == JobBudget::AcquireResult::Acquired);
+    QCOMPARE(budget.jobCount(QStringLiteral("linker")), 1);
+    budget.release(&config2, {});
+    QVERIFY(budget.tryAcquire(&config2, 1, linkerPool)
+            == JobBudget::AcquireResult::BlockedByJobLimit);
+    wakeUps.clear();
+    budget.release(&config1, {QStringLiteral("linker")});
+    QCOMPARE(wakeUps, QStringList{QStringLiteral("config2")});
+    QCOMPARE(budget.jobCount(QStringLiteral("linker")), 0);
+    QVERIFY(budget.tryAcquire(&config2, 1, linkerPool) == JobBudget::AcquireResult::Acquired);
+
+    // Leaving clients give back their tokens.
+    budget.unregisterClient(&config2);
+    QCOMPARE(budget.jobCount(QStringLiteral("linker")), 0);
+    QCOMPARE(budget.freeTokens(), 2);
+    budget.unregisterClient(&config1);
+    budget.unregisterClient(&config3);
+    QCOMPARE(budget.capacity(), 0);
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
@@ -49,10 +49,13 @@
 #include <language/identifiersearch.h>
 #include <language/item.h>
 #include <language/itempool.h>
+#include <language/jsbytecodecache.h>
 #include <language/language.h>
+#include <language/probecache.h>
 #include <language/propertymapinternal.h>
 #include <language/scriptengine.h>
 #include <language/value.h>
+#include <loader/parsedqbsfile.h>
 #include <loader/projectresolver.h>
 #include <parser/qmljslexer_p.h>
 #include <parser/qmljsparser_p.h>
@@ -66,8 +69,11 @@
 #include <tools/settings.h>
 #include <tools/stlutils.h>
 
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdiriterator.h>
 #include <QtCore/qjsonobject.h>
 #include <QtCore/qprocess.h>
+#include <QtCore/qtemporarydir.h>
 
 #include <algorithm>
 #include <set>
@@ -213,6 +219,7 @@ void TestLanguage::init()
 
 void TestLanguage::initTestCase()
 {
+    redirectUserCaches(testWorkDir(QStringLiteral("language")));
     m_logger = Logger(m_logSink);
     m_engine = ScriptEngine::create(m_logger, EvalContext::PropertyEvaluation);
 
@@ -1889,6 +1896,82 @@ void TestLanguage::itemScope()
     QCOMPARE(getJsVariant(ctx, evaluator.property(item, "z")).toInt(), 3);
 }
 
+void TestLanguage::jsBytecodeCache()
+{
+    const QByteArray code("function f() { return 42; }");
+    const QByteArray key = JsBytecodeCache::key(code, "file.js", 1);
+    QCOMPARE(JsBytecodeCache::key(code, "file.js", 1), key);
+    QVERIFY(JsBytecodeCache::key(code, "file.js", 2) != key);
+    QVERIFY(JsBytecodeCache::key(code, "other.js", 1) != key);
+    QVERIFY(JsBytecodeCache::key(code + ' ', "file.js", 1) != key);
+
+    // Entries are shared with other processes via the directory.
+    const QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    JsBytecodeCache cache(cacheDir.path());
+    QVERIFY(cache.lookup(key).isEmpty());
+    cache.insert(key, "bytecode");
+    QCOMPARE(cache.lookup(key), QByteArray("bytecode"));
+    QCOMPARE(cache.stats().compiled, 1);
+    QCOMPARE(cache.stats().memoryHits, 1);
+    JsBytecodeCache otherCache(cacheDir.path());
+    QCOMPARE(otherCache.lookup(key), QByteArray("bytecode"));
+    QCOMPARE(otherCache.stats().diskHits, 1);
+    JsBytecodeCache memoryOnlyCache(QString{});
+    memoryOnlyCache.insert(key, "bytecode");
+    QVERIFY(JsBytecodeCache(QString{}).lookup(key).isEmpty());
+
+    // Damaged entries are not used.
+    QDirIterator entryIt(cacheDir.path(), QDir::Files, QDirIterator::Subdirectories);
+    QVERIFY(entryIt.hasNext());
+    QFile entryFile(entryIt.next());
+    QVERIFY(entryFile.open(QIODevice::ReadWrite));
+    const QByteArray entryData = entryFile.readAll();
+    QVERIFY(entryFile.resize(entryData.size() - 1));
+    entryFile.close();
+    QVERIFY(JsBytecodeCache(cacheDir.path()).lookup(key).isEmpty());
+    QVERIFY(entryFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QByteArray damagedData = entryData;
+    damagedData[damagedData.size() - 1] = 'X';
+    entryFile.write(damagedData);
+    entryFile.close();
+    QVERIFY(JsBytecodeCache(cacheDir.path()).lookup(key).isEmpty());
+
+    // The directory gets pruned while entries are written.
+    const QTemporaryDir smallCacheDir;
+    QVERIFY(smallCacheDir.isValid());
+    const auto directorySize = [&smallCacheDir] {
+        qint64 size = 0;
+        QDirIterator it(smallCacheDir.path(), QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext())
+            size += QFileInfo(it.next()).size();
+        return size;
+    };
+    JsBytecodeCache smallCache(smallCacheDir.path(), 1000);
+    for (int i = 0; i < 100; ++i)
+        smallCache.insert(JsBytecodeCache::key(code, "file.js", i), QByteArray(50, 'x'));
+    QVERIFY2(directorySize() < 2000, qPrintable(QString::number(directorySize())));
+    smallCache.prune();
+    QVERIFY2(directorySize() <= 1000, qPrintable(QString::number(directorySize())));
+    QVERIFY(directorySize() > 0);
+
+    // Engines share the compiled code.
+    const QString script = QStringLiteral("(function() { return 6 * 7; })()");
+    const JsBytecodeCache::Stats statsBefore = JsBytecodeCache::instance().stats();
+    for (int i = 0; i < 2; ++i) {
+        const std::unique_ptr<ScriptEngine> engine
+                = ScriptEngine::create(m_logger, EvalContext::PropertyEvaluation);
+        const ScopedJsValue result(engine->context(), engine->evaluateCached(
+                                       JsValueOwner::Caller, script, QStringLiteral("test.js")));
+        QVERIFY(!engine->checkForJsError({}));
+        QCOMPARE(getJsVariant(engine->context(), result).toInt(), 42);
+    }
+    const JsBytecodeCache::Stats statsAfter = JsBytecodeCache::instance().stats();
+    QCOMPARE((statsAfter.compiled + statsAfter.diskHits)
+             - (statsBefore.compiled + statsBefore.diskHits), 1);
+    QCOMPARE(statsAfter.memoryHits - statsBefore.memoryHits, 1);
+}
+
 void TestLanguage::jsExtensions()
 {
     QFile file(testProject("jsextensions.js"));
@@ -2903,6 +2986,92 @@ void TestLanguage::parameterTypes()
     QCOMPARE(exceptionCaught, false);
 }
 
+void TestLanguage::parsedFileCache()
+{
+    const QString filePath = QStringLiteral("/somewhere/file.qbs");
+    const QString code = QStringLiteral("import qbs.FileInfo\n"
+                                        "Product {\n"
+                                        "    property string p: base + 'x'\n"
+                                        "    name: \"theName\"\n"
+                                        "    Group { files: [] }\n"
+                                        "}\n");
+    const std::shared_ptr<const ParsedQbsFile> parsedFile = ParsedQbsFile::parse(filePath, code);
+    QCOMPARE(int(parsedFile->imports.size()), 1);
+    QCOMPARE(parsedFile->imports.front().uri,
+             QStringList({QStringLiteral("qbs"), QStringLiteral("FileInfo")}));
+    QVERIFY(parsedFile->imports.front().fileName.isNull());
+    QVERIFY(parsedFile->imports.front().importId.isNull());
+    QCOMPARE(int(parsedFile->members.size()), 1);
+    const ParsedQbsFile::Member &product = parsedFile->members.front();
+    QVERIFY(product.type == ParsedQbsFile::Member::Type::ObjectDefinition);
+    QCOMPARE(product.name, QStringList(QStringLiteral("Product")));
+    QCOMPARE(int(product.members.size()), 3);
+    const ParsedQbsFile::Member &propertyDecl = product.members.at(0);
+    QVERIFY(propertyDecl.type == ParsedQbsFile::Member::Type::PublicMember);
+    QCOMPARE(propertyDecl.memberType, QStringLiteral("string"));
+    QVERIFY(propertyDecl.statement);
+    QVERIFY(propertyDecl.statement->usesBase);
+    QVERIFY(!propertyDecl.statement->usesOuter);
+    QCOMPARE(code.mid(propertyDecl.statement->range.offset, propertyDecl.statement->range.length),
+             QStringLiteral("base + 'x'"));
+    const ParsedQbsFile::Member &binding = product.members.at(1);
+    QVERIFY(binding.type == ParsedQbsFile::Member::Type::ScriptBinding);
+    QCOMPARE(binding.name, QStringList(QStringLiteral("name")));
+    QVERIFY(binding.statement);
+    QCOMPARE(int(binding.statement->range.startLine), 4);
+    QCOMPARE(code.mid(binding.statement->range.offset, binding.statement->range.length),
+             QStringLiteral("\"theName\""));
+    QCOMPARE(int(product.members.at(2).members.size()), 1);
+
+    bool exceptionCaught = false;
+    try {
+        ParsedQbsFile::parse(filePath, QStringLiteral("Product {"));
+    } catch (const ErrorInfo &e) {
+        exceptionCaught = true;
+        QCOMPARE(e.items().front().codeLocation().filePath(), filePath);
+    }
+    QVERIFY(exceptionCaught);
+
+    const auto serialized = [](const ParsedQbsFile &file) {
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        file.store(stream);
+        return data;
+    };
+    const QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    ParsedQbsFileCache cache(cacheDir.path());
+    const auto cachedFile = cache.retrieveOrParse(filePath, code);
+    QCOMPARE(serialized(*cachedFile), serialized(*parsedFile));
+    QCOMPARE(cache.retrieveOrParse(filePath, code), cachedFile);
+    QCOMPARE(cache.stats().parsed, 1);
+    QCOMPARE(cache.stats().memoryHits, 1);
+
+    // Entries are shared with other processes via the directory.
+    ParsedQbsFileCache otherCache(cacheDir.path());
+    const auto loadedFile = otherCache.retrieveOrParse(filePath, code);
+    QCOMPARE(otherCache.stats().diskHits, 1);
+    QCOMPARE(otherCache.stats().parsed, 0);
+    QCOMPARE(serialized(*loadedFile), serialized(*parsedFile));
+
+    // Changed content invalidates the entry.
+    otherCache.retrieveOrParse(filePath, code + QStringLiteral("// comment\n"));
+    QCOMPARE(otherCache.stats().parsed, 1);
+    QCOMPARE(ParsedQbsFileCache(QString()).retrieveOrParse(filePath, code)->members.size(),
+             parsedFile->members.size());
+
+    // Entries get evicted when the directory exceeds its size limit.
+    const QFileInfoList entryFiles = QDir(cacheDir.path()).entryInfoList(QDir::Files);
+    QCOMPARE(entryFiles.size(), 1);
+    const QTemporaryDir smallCacheDir;
+    QVERIFY(smallCacheDir.isValid());
+    ParsedQbsFileCache smallCache(smallCacheDir.path(), entryFiles.front().size() * 3 / 2);
+    smallCache.retrieveOrParse(filePath, code);
+    QCOMPARE(QDir(smallCacheDir.path()).entryList(QDir::Files).size(), 1);
+    smallCache.retrieveOrParse(filePath + QStringLiteral(".copy"), code);
+    QCOMPARE(QDir(smallCacheDir.path()).entryList(QDir::Files).size(), 1);
+}
+
 void TestLanguage::projectPropertyForwarding()
 {
     bool exceptionCaught = false;
@@ -2959,6 +3128,44 @@ void TestLanguage::pathProperties()
     QCOMPARE(exceptionCaught, false);
 }
 
+void TestLanguage::probeCache()
+{
+    const QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    const QProcessEnvironment env;
+    ProbeCache::Entry entry;
+    entry.values.insert(QStringLiteral("found"), true);
+    const QByteArray key = ProbeCache::key("probe.qbs", "found = true;", {});
+    ProbeCache cache(cacheDir.path());
+    QVERIFY(!cache.lookup(key, env));
+    cache.insert(key, entry);
+    const std::optional<ProbeCache::Entry> storedEntry = ProbeCache(cacheDir.path())
+            .lookup(key, env);
+    QVERIFY(storedEntry);
+    QCOMPARE(storedEntry->values, entry.values);
+    QVERIFY(!ProbeCache(QString()).lookup(key, env));
+
+    // The directory gets pruned while entries are written.
+    const QTemporaryDir smallCacheDir;
+    QVERIFY(smallCacheDir.isValid());
+    const auto directorySize = [&smallCacheDir] {
+        qint64 size = 0;
+        QDirIterator it(smallCacheDir.path(), QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext())
+            size += QFileInfo(it.next()).size();
+        return size;
+    };
+    ProbeCache smallCache(smallCacheDir.path(), 1000);
+    for (int i = 0; i < 100; ++i) {
+        smallCache.insert(ProbeCache::key("probe.qbs", "found = true;",
+                                          {{QStringLiteral("i"), i}}), entry);
+    }
+    QVERIFY2(directorySize() < 2000, qPrintable(QString::number(directorySize())));
+    smallCache.prune();
+    QVERIFY2(directorySize() <= 1000, qPrintable(QString::number(directorySize())));
+    QVERIFY(directorySize() > 0);
+}
+
 void TestLanguage::probesAndMultiplexing()
 {
     bool exceptionCaught = false;
@@ -3451,6 +3658,60 @@ void TestLanguage::requiredAndNonRequiredDependencies_data()
                                                       << false;
 }
 
+void TestLanguage::sharedPropertyMaps()
+{
+    bool exceptionCaught = false;
+    try {
+        resolveProject("shared-property-maps.qbs");
+        QVERIFY(!!project);
+        const QHash<QString, ResolvedProductPtr> products = productsFromProject(project);
+        const ResolvedProductConstPtr p1 = products.value("p1");
+        QVERIFY(!!p1);
+        const ResolvedProductConstPtr p2 = products.value("p2");
+        QVERIFY(!!p2);
+        const auto groupProperties = [&p1](const QString &name) {
+            const auto groupIt = std::find_if(p1->groups.cbegin(), p1->groups.cend(),
+                    [&name](const GroupConstPtr &g) { return g->name == name; });
+            return groupIt != p1->groups.cend() ? (*groupIt)->properties : PropertyMapPtr();
+        };
+        const PropertyMapConstPtr g1Props = groupProperties("g1");
+        QVERIFY(!!g1Props);
+        const PropertyMapConstPtr g2Props = groupProperties("g2");
+        QVERIFY(!!g2Props);
+        const PropertyMapConstPtr g3Props = groupProperties("g3");
+        QVERIFY(!!g3Props);
+
+        // Groups with equal module property values share one map.
+        QVERIFY(g1Props == g2Props);
+        QCOMPARE(g1Props->moduleProperty("dummy", "someString").toString(),
+                 QString("from group"));
+        QVERIFY(g1Props != g3Props);
+        QVERIFY(g1Props->digest() != g3Props->digest());
+        QVERIFY(*g1Props != *g3Props);
+        QVERIFY(g1Props != p1->moduleProperties);
+        for (const SourceArtifactConstPtr &artifact : p1->allEnabledFiles())
+            QVERIFY(artifact->properties == g1Props);
+
+        // Equal values of modules are shared between maps that differ otherwise.
+        QVERIFY(p1->moduleProperties != p2->moduleProperties);
+        QVERIFY(p1->moduleProperties->value().value("dummy2").toMap().isSharedWith(
+                    p2->moduleProperties->value().value("dummy2").toMap()));
+        QVERIFY(p1->moduleProperties->value().value("dummy2").toMap().isSharedWith(
+                    g3Props->value().value("dummy2").toMap()));
+
+        // The digest follows the value.
+        const PropertyMapPtr clone = g1Props->clone();
+        QCOMPARE(clone->digest(), g1Props->digest());
+        QVERIFY(*clone == *g1Props);
+        clone->setValue(g3Props->value());
+        QCOMPARE(clone->digest(), g3Props->digest());
+    } catch (const ErrorInfo &e) {
+        exceptionCaught = true;
+        qDebug() << e.toString();
+    }
+    QCOMPARE(exceptionCaught, false);
+}
+
 void TestLanguage::suppressedAndNonSuppressedErrors()
 {
     try {
@@ -120,6 +120,7 @@ private slots:
     void invalidPropOnNonRequiredModule();
     void itemPrototype();
     void itemScope();
+    void jsBytecodeCache();
     void jsExtensions();
     void jsImportUsedInMultipleScopes_data();
     void jsImportUsedInMultipleScopes();
@@ -155,8 +156,10 @@ private slots:
     void overriddenPropertiesAndPrototypes_data();
     void overriddenVariantProperty();
     void parameterTypes();
+    void parsedFileCache();
     void projectPropertyForwarding();
     void pathProperties();
+    void probeCache();
     void probesAndMultiplexing();
     void productConditions();
     void productDirectories();
@@ -176,6 +179,7 @@ private slots:
     void relaxedErrorMode_data();
     void requiredAndNonRequiredDependencies();
     void requiredAndNonRequiredDependencies_data();
+    void sharedPropertyMaps();
     void suppressedAndNonSuppressedErrors();
     void throwingProbe();
     void throwingProbe_data();
@@ -61,6 +61,13 @@
         f.write(content);                                                           \
     } while (false)
 
+// Benchmarks take a lot of time, so they only run on request.
+#define SKIP_UNLESS_BENCHMARKING()                                                  \
+    do {                                                                            \
+        if (!qEnvironmentVariableIsSet("QBS_AUTOTEST_BENCHMARKS"))                  \
+            QSKIP("Set QBS_AUTOTEST_BENCHMARKS to run benchmarks.");                \
+    } while (false)
+
 inline int testTimeoutInMsecs()
 {
     bool ok;
@@ -343,6 +350,17 @@ inline QString testWorkDir(const QString &testName)
     return QDir::cleanPath(dir + testName + "/testWorkDir");
 }
 
+// Makes qbs keep its persistent caches in the given work directory rather than in the
+// user's cache directory, so test runs neither depend on nor pollute the latter.
+inline void redirectUserCaches(const QString &workDir)
+{
+    const QString cacheDir = workDir + QStringLiteral("/caches");
+    qputenv("QBS_JS_BYTECODE_CACHE_DIR",
+            QFile::encodeName(cacheDir + QStringLiteral("/js-bytecode")));
+    qputenv("QBS_PARSED_FILE_CACHE_DIR",
+            QFile::encodeName(cacheDir + QStringLiteral("/parsed-files")));
+}
+
 inline bool copyDllExportHeader(const QString &srcDataDir, const QString &targetDataDir)
 {
     QFile sourceFile(srcDataDir + "/../../dllexport.h");
@@ -47,7 +47,11 @@
 #include <tools/error.h>
 #include <tools/fileinfo.h>
 #include <tools/filesaver.h>
+#include <logging/ilogsink.h>
+#include <logging/logger.h>
 #include <tools/hostosinfo.h>
+#include <tools/pathatomtable.h>
+#include <tools/persistence.h>
 #include <tools/processutils.h>
 #include <tools/profile.h>
 #include <tools/set.h>
@@ -60,12 +64,18 @@
 #include <QtCore/qdir.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qfileinfo.h>
+#include <QtCore/qpoint.h>
 #include <QtCore/qsettings.h>
 #include <QtCore/qtemporarydir.h>
 #include <QtCore/qtemporaryfile.h>
 
 #include <QtTest/qtest.h>
 
+#include <climits>
+#include <limits>
+#include <memory>
+#include <thread>
+
 using namespace qbs;
 using namespace qbs::Internal;
 
@@ -1122,6 +1132,153 @@ void TestTools::set_intersects()
     QVERIFY(s1.intersects(s3));
 }
 
+void TestTools::set_pointers()
+{
+    // Go beyond the threshold for the hash index and back again.
+    std::vector<int> values(100);
+    Set<int *> s;
+    for (int &v : values)
+        QVERIFY(s.insert(&v).second);
+    QCOMPARE(s.size(), values.size());
+    QVERIFY(!s.insert(&values[50]).second);
+    QCOMPARE(*s.insert(&values[50]).first, &values[50]);
+
+    // Iteration follows insertion order.
+    std::vector<int *> expected;
+    for (int &v : values)
+        expected.push_back(&v);
+    QVERIFY(std::equal(s.cbegin(), s.cend(), expected.cbegin(), expected.cend()));
+
+    for (int i = 0; i < 100; i += 2)
+        QVERIFY(s.remove(&values[i]));
+    QVERIFY(!s.remove(&values[0]));
+    QCOMPARE(s.size(), size_t { 50 });
+    for (int i = 0; i < 100; ++i) {
+        QCOMPARE(s.contains(&values[i]), i % 2 == 1);
+        QCOMPARE(s.find(&values[i]) != s.cend(), i % 2 == 1);
+    }
+
+    for (auto it = s.begin(); it != s.end();) {
+        if (*it - values.data() >= 10)
+            it = s.erase(it);
+        else
+            ++it;
+    }
+    QVERIFY(s == Set<int *>({&values[1], &values[3], &values[5], &values[7], &values[9]}));
+
+    Set<int *> large;
+    for (int &v : values)
+        large << &v;
+    QVERIFY(large.contains(s));
+    QVERIFY(!s.contains(large));
+    QVERIFY(large.intersects(s));
+    QVERIFY((large & s) == s);
+    QCOMPARE((large - s).size(), size_t { 95 });
+    QVERIFY(!(large - s).intersects(s));
+    QVERIFY((large - s) + s == large);
+
+    Set<int *> reordered;
+    for (auto it = values.rbegin(); it != values.rend(); ++it)
+        reordered << &*it;
+    QVERIFY(reordered == large);
+    reordered.subtract(large);
+    QVERIFY(reordered.empty());
+}
+
+void TestTools::set_pointersWithItself()
+{
+    // Below and above the threshold for the hash index.
+    std::vector<int> values(100);
+    for (const int size : {5, 100}) {
+        Set<int *> s;
+        for (int i = 0; i < size; ++i)
+            s << &values[i];
+        const Set<int *> copy = s;
+        s.intersect(s);
+        QVERIFY(s == copy);
+        s &= s;
+        QVERIFY(s == copy);
+        for (int i = 0; i < size; ++i)
+            QVERIFY(s.contains(&values[i]));
+
+        s.subtract(s);
+        QVERIFY(s.empty());
+        QVERIFY(!s.contains(&values[0]));
+        s = copy;
+        s -= s;
+        QVERIFY(s.empty());
+        s << &values[0];
+        QCOMPARE(s.size(), size_t { 1 });
+        QVERIFY(s.contains(&values[0]));
+    }
+}
+
+void TestTools::set_pointersBenchmark_data()
+{
+    // Edge counts as they appear in build graphs of larger projects. Sets of integers
+    // use the sorted representation that sets of pointers had before, so they serve
+    // as the baseline.
+    QTest::addColumn<int>("setCount");
+    QTest::addColumn<int>("setSize");
+    QTest::addColumn<bool>("sorted");
+    const auto addRows = [](const char *name, int setCount, int setSize) {
+        QTest::addRow("%s (pointer set)", name) << setCount << setSize << false;
+        QTest::addRow("%s (sorted set)", name) << setCount << setSize << true;
+    };
+    addRows("outputs of compiler commands", 10000, 2);
+    addRows("inputs of compiler commands", 1000, 30);
+    addRows("aggregate artifacts", 50, 400);
+    addRows("link step of a large library", 5, 4000);
+    addRows("header included everywhere", 1, 20000);
+}
+
+template<typename T> static int connectNodes(int setCount, const std::vector<T> &nodes)
+{
+    // Connect, look up and disconnect, like the build graph does for its nodes.
+    std::vector<Set<T>> sets(setCount);
+    for (Set<T> &s : sets) {
+        for (const T &node : nodes)
+            s.insert(node);
+    }
+    int found = 0;
+    for (const Set<T> &s : sets) {
+        for (const T &node : nodes)
+            found += s.contains(node);
+    }
+    for (Set<T> &s : sets) {
+        for (const T &node : nodes)
+            s.remove(node);
+    }
+    return found;
+}
+
+void TestTools::set_pointersBenchmark()
+{
+    SKIP_UNLESS_BENCHMARKING();
+
+    QFETCH(int, setCount);
+    QFETCH(int, setSize);
+    QFETCH(bool, sorted);
+    std::vector<int> nodeData(setSize);
+    std::vector<int *> nodes;
+    std::vector<quintptr> nodeAddresses;
+    for (int &node : nodeData) {
+        nodes.push_back(&node);
+        nodeAddresses.push_back(quintptr(&node));
+    }
+    int found = 0;
+    if (sorted) {
+        QBENCHMARK {
+            found = connectNodes(setCount, nodeAddresses);
+        }
+    } else {
+        QBENCHMARK {
+            found = connectNodes(setCount, nodes);
+        }
+    }
+    QCOMPARE(found, setCount * setSize);
+}
+
 void TestTools::stringutils_join()
 {
     QFETCH(std::vector<std::string>, input);
@@ -1269,6 +1426,356 @@ void TestTools::span()
     qbs::Internal::span<int> span(vec);
 }
 
+void TestTools::persistentPool()
+{
+    class LogSink : public ILogSink {
+        void doPrintMessage(LoggerLevel, const QString &, const QString &) override { }
+    } dummySink;
+    Logger logger(&dummySink);
+    QTemporaryDir tmpDir;
+    QVERIFY(tmpDir.isValid());
+    const QString filePath = tmpDir.filePath("graph.bg");
+
+    const QVariantMap projectConfig{{"qbs", QVariantMap{{"buildVariant", "debug"}}}};
+    const QVariantList variants{true, -7, 4000000000u, -(qlonglong(1) << 40), 0.25,
+                                QByteArray("raw"), "text", QStringList{"a", "b"},
+                                QVariant(), QPoint(1, 2)};
+    const std::vector<qint64> ints{0, 1, -1, 127, 128, -64, -65, INT_MIN,
+                                   std::numeric_limits<qint64>::max(),
+                                   std::numeric_limits<qint64>::min()};
+    const QString duplicated = QStringLiteral("\u00e4\u20ac/path/to/file.cpp");
+    {
+        PersistentPool pool(logger);
+        PersistentPool::HeadData headData;
+        headData.projectConfig = projectConfig;
+        pool.setHeadData(headData);
+        pool.setupWriteStream(filePath);
+        pool.storeSection(QString(), [&] {
+            pool.store(ints, duplicated, QString(), QString(""), duplicated, QByteArray(),
+                       QByteArray(""), quint64(std::numeric_limits<quint64>::max()), variants);
+        });
+        pool.finalizeWriteStream();
+    }
+
+    PersistentPool pool(logger);
+    pool.load(filePath);
+    QCOMPARE(pool.headData().projectConfig, projectConfig);
+    QCOMPARE(pool.sectionCount(), 1);
+    std::vector<qint64> loadedInts;
+    QStringList loadedStrings;
+    QByteArray nullBytes;
+    QByteArray emptyBytes;
+    quint64 maxValue = 0;
+    QVariantList loadedVariants;
+    pool.loadSection(0, [&] {
+        loadedInts = pool.load<std::vector<qint64>>();
+        for (int i = 0; i < 4; ++i)
+            loadedStrings << pool.load<QString>();
+        pool.load(nullBytes, emptyBytes, maxValue, loadedVariants);
+    });
+    QCOMPARE(loadedInts, ints);
+    QCOMPARE(loadedStrings.at(0), duplicated);
+    QVERIFY(loadedStrings.at(1).isNull());
+    QVERIFY(!loadedStrings.at(2).isNull() && loadedStrings.at(2).isEmpty());
+    QCOMPARE(loadedStrings.at(3), duplicated);
+    QVERIFY(nullBytes.isNull());
+    QVERIFY(!emptyBytes.isNull() && emptyBytes.isEmpty());
+    QCOMPARE(maxValue, std::numeric_limits<quint64>::max());
+    QCOMPARE(loadedVariants.size(), variants.size());
+    for (int i = 0; i < variants.size(); ++i) {
+        QCOMPARE(loadedVariants.at(i).userType(), variants.at(i).userType());
+        QCOMPARE(loadedVariants.at(i), variants.at(i));
+    }
+
+    // Sections that are not fully consumed or read beyond their end are rejected.
+    bool hitEnd = false;
+    try {
+        PersistentPool otherPool(logger);
+        otherPool.load(filePath);
+        otherPool.loadSection(0, [&] {
+            otherPool.load<std::vector<qint64>>();
+            for (int i = 0; i < 1000; ++i)
+                otherPool.load<int>();
+        });
+    } catch (const ErrorInfo &) {
+        hitEnd = true;
+    }
+    QVERIFY(hitEnd);
+}
+
+namespace {
+struct PoolTestNode
+{
+    QString name;
+    PoolTestNode *next = nullptr;
+
+    template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
+    {
+        pool.serializationOp<opType>(name, next);
+    }
+};
+} // namespace
+
+void TestTools::persistentPoolSections()
+{
+    class LogSink : public ILogSink {
+        void doPrintMessage(LoggerLevel, const QString &, const QString &) override { }
+    } dummySink;
+    Logger logger(&dummySink);
+    QTemporaryDir tmpDir;
+    QVERIFY(tmpDir.isValid());
+    const QString filePath = tmpDir.filePath("graph.bg");
+    {
+        PoolTestNode base{"base"};
+        PoolTestNode x{"x", &base};
+        PoolTestNode y{"y", &x};
+        PersistentPool pool(logger);
+        pool.setupWriteStream(filePath);
+        for (PoolTestNode * const node : {&base, &x, &y})
+            pool.storeSection(node->name, [&pool, node] { pool.store(node); });
+        pool.finalizeWriteStream();
+    }
+
+    std::vector<std::unique_ptr<PoolTestNode>> loadedNodes;
+    const auto loadNode = [&loadedNodes](PersistentPool &pool, int section) {
+        PoolTestNode *node = nullptr;
+        pool.loadSection(section, [&pool, &node] { pool.load(node); });
+        loadedNodes.emplace_back(node);
+        return node;
+    };
+
+    // Sections referred to by the requested one get loaded via the section loader.
+    PersistentPool pool(logger);
+    pool.load(filePath);
+    QCOMPARE(pool.sectionCount(), 3);
+    QCOMPARE(pool.sectionIndex("y"), 2);
+    QVERIFY(!pool.isSectionLoaded(0));
+    pool.setSectionLoader([&](int section) { loadNode(pool, section); });
+    const PoolTestNode * const y = loadNode(pool, 2);
+    QVERIFY(pool.allSectionsLoaded());
+    QCOMPARE(y->name, QString("y"));
+    QVERIFY(y->next && y->next->next);
+    QCOMPARE(y->next->name, QString("x"));
+    QCOMPARE(y->next->next->name, QString("base"));
+
+    // Sections that were not loaded can be copied, as long as the objects they refer to
+    // keep their IDs.
+    const QString copyFilePath = tmpDir.filePath("copy.bg");
+    {
+        PersistentPool loadedPool(logger);
+        loadedPool.load(filePath);
+        loadedPool.setKeepObjectIds(true);
+        PoolTestNode * const base = loadNode(loadedPool, 0);
+        QVERIFY(!loadedPool.isSectionLoaded(1));
+        QCOMPARE(loadedPool.unloadedSectionsReferringTo(base), std::vector<int>{1});
+        base->name = "changed";
+
+        PersistentPool copyPool(logger);
+        copyPool.setupWriteStream(copyFilePath, &loadedPool);
+        copyPool.storeSection("base", [&copyPool, base] { copyPool.store(base); });
+        copyPool.copySection(1);
+        copyPool.copySection(2);
+        QVERIFY(copyPool.copiedSectionsAreConsistent());
+        copyPool.finalizeWriteStream();
+
+        PoolTestNode replacement{"replacement"};
+        copyPool.setupWriteStream(tmpDir.filePath("inconsistent.bg"), &loadedPool);
+        copyPool.storeSection("base", [&copyPool, &replacement] {
+            copyPool.store(&replacement);
+        });
+        copyPool.copySection(1);
+        copyPool.copySection(2);
+        QVERIFY(!copyPool.copiedSectionsAreConsistent());
+    }
+
+    PersistentPool copiedPool(logger);
+    copiedPool.load(copyFilePath);
+    copiedPool.setSectionLoader([&](int section) { loadNode(copiedPool, section); });
+    const PoolTestNode * const copiedY = loadNode(copiedPool, 2);
+    QVERIFY(copiedY->next && copiedY->next->next);
+    QCOMPARE(copiedY->next->next->name, QString("changed"));
+}
+
+void TestTools::persistentPoolJournal()
+{
+    class LogSink : public ILogSink {
+        void doPrintMessage(LoggerLevel, const QString &, const QString &) override { }
+    } dummySink;
+    Logger logger(&dummySink);
+    QTemporaryDir tmpDir;
+    QVERIFY(tmpDir.isValid());
+    const QString filePath = tmpDir.filePath("graph.bg");
+    const QString journalFilePath = PersistentPool::journalFilePath(filePath);
+    {
+        PoolTestNode base{"base"};
+        PoolTestNode x{"x", &base};
+        PoolTestNode y{"y", &base};
+        PersistentPool pool(logger);
+        pool.setupWriteStream(filePath);
+        for (PoolTestNode * const node : {&base, &x, &y})
+            pool.storeSection(node->name, [&pool, node] { pool.store(node); });
+        pool.finalizeWriteStream();
+    }
+    const QByteArray mainFileContents = [&filePath] {
+        QFile file(filePath);
+        return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    }();
+    QVERIFY(!mainFileContents.isEmpty());
+    QVERIFY(!QFileInfo::exists(journalFilePath));
+
+    std::vector<std::unique_ptr<PoolTestNode>> loadedNodes;
+    const auto loadNodes = [&loadedNodes](PersistentPool &pool) {
+        std::vector<PoolTestNode *> nodes;
+        for (int i = 0; i < pool.sectionCount(); ++i) {
+            PoolTestNode *node = nullptr;
+            pool.loadSection(i, [&pool, &node] { pool.load(node); });
+            loadedNodes.emplace_back(node);
+            nodes.push_back(node);
+        }
+        return nodes;
+    };
+    const auto checkNodes = [&](const QStringList &expectedNames) {
+        PersistentPool pool(logger);
+        pool.load(filePath);
+        const std::vector<PoolTestNode *> nodes = loadNodes(pool);
+        QCOMPARE(int(nodes.size()), expectedNames.size());
+        for (int i = 0; i < expectedNames.size(); ++i)
+            QCOMPARE(nodes.at(i)->name, expectedNames.at(i));
+        QCOMPARE(nodes.at(1)->next, nodes.at(0));
+        QCOMPARE(nodes.at(2)->next, nodes.at(0));
+    };
+
+    // Only the stored sections end up in the journal; the main file stays untouched.
+    PersistentPool loadedPool(logger);
+    loadedPool.load(filePath);
+    loadedPool.setKeepObjectIds(true);
+    const std::vector<PoolTestNode *> nodes = loadNodes(loadedPool);
+    const auto storeToJournal = [&](int changedSection) {
+        PersistentPool journalPool(logger);
+        journalPool.setHeadData(loadedPool.headData());
+        std::vector<bool> sectionsToCopy(3, true);
+        sectionsToCopy[changedSection] = false;
+        journalPool.setupJournalWriteStream(&loadedPool, sectionsToCopy);
+        for (int i = 0; i < 3; ++i) {
+            if (sectionsToCopy[i]) {
+                journalPool.copySection(i);
+            } else {
+                PoolTestNode * const node = nodes.at(i);
+                journalPool.storeSection(node->name, [&journalPool, node] {
+                    journalPool.store(node);
+                });
+            }
+        }
+        QVERIFY(journalPool.copiedSectionsAreConsistent());
+        journalPool.finalizeWriteStream();
+        loadedPool.adoptStoredData(journalPool);
+    };
+    nodes.at(1)->name = "x2";
+    storeToJournal(1);
+    nodes.at(2)->name = "y2";
+    storeToJournal(2);
+    QVERIFY(QFileInfo::exists(journalFilePath));
+    QCOMPARE(QFileInfo(filePath).size(), qint64(mainFileContents.size()));
+    QVERIFY(!loadedPool.journalNeedsCompaction());
+    checkNodes({"base", "x2", "y2"});
+
+    // A record that was not written completely is ignored and gets overwritten by the next one.
+    {
+        QFile journalFile(journalFilePath);
+        QVERIFY(journalFile.open(QIODevice::Append));
+        journalFile.write(QByteArray(8, '\0') + "garbage");
+    }
+    checkNodes({"base", "x2", "y2"});
+    nodes.at(1)->name = "x3";
+    storeToJournal(1);
+    checkNodes({"base", "x3", "y2"});
+
+    // Changing an object that copied sections refer to requires a full write.
+    {
+        PoolTestNode replacement{"replacement"};
+        PersistentPool journalPool(logger);
+        journalPool.setupJournalWriteStream(&loadedPool, {false, true, true});
+        journalPool.storeSection("base", [&journalPool, &replacement] {
+            journalPool.store(&replacement);
+        });
+        journalPool.copySection(1);
+        journalPool.copySection(2);
+        QVERIFY(!journalPool.copiedSectionsAreConsistent());
+    }
+
+    // Compaction rewrites the main file and removes the journal. A journal that was left over
+    // does not belong to the new main file and thus gets ignored.
+    QFile::copy(journalFilePath, tmpDir.filePath("stale.journal"));
+    {
+        PersistentPool mainPool(logger);
+        mainPool.setHeadData(loadedPool.headData());
+        mainPool.setupWriteStream(filePath, &loadedPool);
+        for (PoolTestNode * const node : nodes)
+            mainPool.storeSection(node->name, [&mainPool, node] { mainPool.store(node); });
+        mainPool.finalizeWriteStream();
+        loadedPool.adoptStoredData(mainPool);
+    }
+    QVERIFY(!QFileInfo::exists(journalFilePath));
+    checkNodes({"base", "x3", "y2"});
+    QVERIFY(QFile::copy(tmpDir.filePath("stale.journal"), journalFilePath));
+    checkNodes({"base", "x3", "y2"});
+}
+
+void TestTools::pathAtomTable()
+{
+    PathAtomTable table;
+    QCOMPARE(table.size(), 1);
+    QCOMPARE(table.atom(QString()), PathAtomTable::emptyAtom);
+    QCOMPARE(table.atom(u""), PathAtomTable::emptyAtom);
+    QVERIFY(table.string(PathAtomTable::emptyAtom).isEmpty());
+
+    const QString dir = QStringLiteral("/some/dir");
+    QCOMPARE(table.existingAtom(dir), PathAtomTable::invalidAtom);
+    const PathAtom dirAtom = table.atom(dir);
+    QVERIFY(dirAtom != PathAtomTable::emptyAtom);
+    QCOMPARE(table.existingAtom(dir), dirAtom);
+    QCOMPARE(table.atom(QStringLiteral("/some/dir/file.cpp").left(dir.size())), dirAtom);
+    QCOMPARE(table.string(dirAtom), dir);
+    const PathAtom fileAtom = table.atom(u"file.cpp");
+    QVERIFY(fileAtom != dirAtom);
+    QCOMPARE(table.string(fileAtom), QStringLiteral("file.cpp"));
+    QCOMPARE(table.size(), 3);
+    QVERIFY(PathAtomTable::pathKey(dirAtom, fileAtom)
+            != PathAtomTable::pathKey(fileAtom, dirAtom));
+
+    // Strings of atoms must stay valid while other threads intern new ones.
+    const QString &dirString = table.string(dirAtom);
+    const int threadCount = 4;
+    const int stringCount = 10000;
+    std::vector<std::vector<PathAtom>> atoms(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&table, &atoms, t] {
+            for (int i = 0; i < stringCount; ++i)
+                atoms[t].push_back(table.atom(QString::number(i)));
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+    QCOMPARE(table.size(), 3 + stringCount);
+    QCOMPARE(&table.string(dirAtom), &dirString);
+    for (int t = 1; t < threadCount; ++t)
+        QCOMPARE(atoms[t], atoms[0]);
+    for (int i = 0; i < stringCount; ++i)
+        QCOMPARE(table.string(atoms[0][i]), QString::number(i));
+
+    // The atoms are dropped only once nothing uses them anymore.
+    table.addUse();
+    table.addUse();
+    table.removeUse();
+    QCOMPARE(table.existingAtom(dir), dirAtom);
+    table.removeUse();
+    QCOMPARE(table.size(), 1);
+    QCOMPARE(table.existingAtom(dir), PathAtomTable::invalidAtom);
+    QCOMPARE(table.atom(QString()), PathAtomTable::emptyAtom);
+    QVERIFY(table.string(table.atom(u"file.cpp")) == QStringLiteral("file.cpp"));
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
@@ -90,6 +90,10 @@ private slots:
     void set_makeSureTheComfortFunctionsCompile();
     void set_initializerList();
     void set_intersects();
+    void set_pointers();
+    void set_pointersWithItself();
+    void set_pointersBenchmark_data();
+    void set_pointersBenchmark();
 
     void stringutils_join();
     void stringutils_join_data();
@@ -103,6 +107,12 @@ private slots:
 
     void span();
 
+    void persistentPool();
+    void persistentPoolJournal();
+    void persistentPoolSections();
+
+    void pathAtomTable();
+
 private:
     QString setupSettingsDir1();
     QString setupSettingsDir2();
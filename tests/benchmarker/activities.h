@@ -32,7 +32,12 @@
 
 namespace qbsBenchmarker {
 
-enum Activity { ActivityResolving = 1, ActivityRuleExecution = 2, ActivityNullBuild = 4 };
+enum Activity {
+    ActivityResolving = 1,
+    ActivityRuleExecution = 2,
+    ActivityNullBuild = 4,
+    ActivityFastNullBuild = 8
+};
 Q_DECLARE_FLAGS(Activities, Activity)
 Q_DECLARE_OPERATORS_FOR_FLAGS(Activities)
 
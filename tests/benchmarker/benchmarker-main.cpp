@@ -67,6 +67,9 @@ static void printResults(Activity activity, const BenchmarkResults &results,
     case ActivityNullBuild:
         std::cout << "Null Build";
         break;
+    case ActivityFastNullBuild:
+        std::cout << "Fast Null Build";
+        break;
     }
     std::cout << " ==========" << std::endl;
     const BenchmarkResult result = results.value(activity);
@@ -100,6 +103,8 @@ static void printResults(Activities activities, const BenchmarkResults &results,
         printResults(ActivityRuleExecution, results, regressionThreshold);
     if (activities & ActivityNullBuild)
         printResults(ActivityNullBuild, results, regressionThreshold);
+    if (activities & ActivityFastNullBuild)
+        printResults(ActivityFastNullBuild, results, regressionThreshold);
 }
 
 int main(int argc, char *argv[])
@@ -39,6 +39,7 @@ namespace qbsBenchmarker {
 static QString resolveActivity() { return "resolving"; }
 static QString ruleExecutionActivity() { return "rule-execution"; }
 static QString nullBuildActivity() { return "null-build"; }
+static QString fastNullBuildActivity() { return "fast-null-build"; }
 static QString allActivities() { return "all"; }
 
 CommandLineParser::CommandLineParser() = default;
@@ -62,9 +63,10 @@ void CommandLineParser::parse()
                                      "repo path");
     parser.addOption(qbsRepoOption);
     QCommandLineOption activitiesOption(QStringList{"activities", "a"},
-            QStringLiteral("The activities to benchmark. Possible values (CSV): %1,%2,%3,%4")
+            QStringLiteral("The activities to benchmark. Possible values (CSV): %1,%2,%3,%4,%5")
                     .arg(resolveActivity(), ruleExecutionActivity(), nullBuildActivity(),
-                         allActivities()), "activities", allActivities());
+                         fastNullBuildActivity(), allActivities()),
+            "activities", allActivities());
     parser.addOption(activitiesOption);
     QCommandLineOption thresholdOption(QStringList{"regression-threshold", "t"},
             "A relative increase higher than this is considered a performance regression. "
@@ -97,7 +99,8 @@ void CommandLineParser::parse()
     m_activities = Activities();
     for (const QString &activityString : activitiesList) {
         if (activityString == allActivities()) {
-            m_activities = ActivityResolving | ActivityRuleExecution | ActivityNullBuild;
+            m_activities = ActivityResolving | ActivityRuleExecution | ActivityNullBuild
+                    | ActivityFastNullBuild;
             break;
         } else if (activityString == resolveActivity()) {
             m_activities = ActivityResolving;
@@ -105,6 +108,8 @@ void CommandLineParser::parse()
             m_activities |= ActivityRuleExecution;
         } else if (activityString == nullBuildActivity()) {
             m_activities |= ActivityNullBuild;
+        } else if (activityString == fastNullBuildActivity()) {
+            m_activities |= ActivityFastNullBuild;
         } else {
             throwException(activitiesOption.names().constFirst(),
                            activityString,
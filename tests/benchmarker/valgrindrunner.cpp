@@ -32,6 +32,7 @@
 
 #include <QtCore/qbuffer.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qdiriterator.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qfuture.h>
 #include <QtCore/qstringlist.h>
@@ -69,6 +70,8 @@ void ValgrindRunner::run()
             traceRuleExecution();
         if (m_activities & ActivityNullBuild)
             traceNullBuild();
+        if (m_activities & ActivityFastNullBuild)
+            traceFastNullBuild();
         return;
     }
 
@@ -79,6 +82,8 @@ void ValgrindRunner::run()
         futures.push_back(QtConcurrent::run([this]{ traceRuleExecution(); }));
     if (m_activities & ActivityNullBuild)
         futures.push_back(QtConcurrent::run([this]{ traceNullBuild(); }));
+    if (m_activities & ActivityFastNullBuild)
+        futures.push_back(QtConcurrent::run([this]{ traceFastNullBuild(); }));
     while (!futures.empty()) {
         futures.front().waitForFinished();
         futures.pop_front();
@@ -107,9 +112,32 @@ void ValgrindRunner::traceNullBuild()
     const QString buildDirMassif = m_baseOutputDir + "/build-dir.null-build.massif";
     runProcess(qbsCommandLine("build", buildDirCallgrind, false));
     runProcess(qbsCommandLine("build", buildDirMassif, false));
+
+    // Otherwise, the build graph would not even get loaded.
+    removeBuildStateFingerprints(buildDirCallgrind);
+    removeBuildStateFingerprints(buildDirMassif);
     traceActivity(ActivityNullBuild, buildDirCallgrind, buildDirMassif);
 }
 
+void ValgrindRunner::traceFastNullBuild()
+{
+    const QString buildDirCallgrind = m_baseOutputDir + "/build-dir.fast-null-build.callgrind";
+    const QString buildDirMassif = m_baseOutputDir + "/build-dir.fast-null-build.massif";
+    runProcess(qbsCommandLine("build", buildDirCallgrind, false));
+    runProcess(qbsCommandLine("build", buildDirMassif, false));
+    traceActivity(ActivityFastNullBuild, buildDirCallgrind, buildDirMassif);
+}
+
+void ValgrindRunner::removeBuildStateFingerprints(const QString &buildDir)
+{
+    QDirIterator it(buildDir, {"*.fingerprint"}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString filePath = it.next();
+        if (!QFile::remove(filePath))
+            throw Exception(QStringLiteral("Failed to remove file '%1'.").arg(filePath));
+    }
+}
+
 void ValgrindRunner::traceActivity(Activity activity, const QString &buildDirCallgrind,
                                    const QString &buildDirMassif)
 {
@@ -130,6 +158,10 @@ void ValgrindRunner::traceActivity(Activity activity, const QString &buildDirCal
         activityString = "null-build";
         qbsCommand = "build";
         break;
+    case ActivityFastNullBuild:
+        activityString = "fast-null-build";
+        qbsCommand = "build";
+        break;
     }
 
     const QString outFileCallgrind = m_baseOutputDir + "/outfile." + activityString + ".callgrind";
@@ -64,8 +64,10 @@ private:
     void traceResolving();
     void traceRuleExecution();
     void traceNullBuild();
+    void traceFastNullBuild();
     void traceActivity(Activity activity, const QString &buildDirCallgrind,
                        const QString &buildDirMassif);
+    static void removeBuildStateFingerprints(const QString &buildDir);
     QStringList qbsCommandLine(const QString &command, const QString &buildDir, bool dryRun) const;
     QStringList wrapForValgrind(const QStringList &commandLine, const QString &tool,
                                 const QString &outFile) const;